@@ -46,6 +46,7 @@ make -j$(sysctl -n hw.ncpu) || { echo "ERROR: Build failed"; exit 1; }
 # Copy module to parent directory
 echo "Installing module..."
 cp signal_processor_cpp*.so ../ || { echo "ERROR: Could not copy module"; exit 1; }
+[ -x sp_batch ] && cp sp_batch ../
 
 echo ""
 echo "==================================="
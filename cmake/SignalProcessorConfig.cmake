@@ -0,0 +1,7 @@
+# Package configuration for find_package(SignalProcessor)
+#
+# Provides the imported target SignalProcessor::signal_processor
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
+include("${CMAKE_CURRENT_LIST_DIR}/SignalProcessorTargets.cmake")
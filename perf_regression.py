@@ -0,0 +1,482 @@
+#!/usr/bin/env python3
+"""
+Performance Regression Harness
+
+Catches releases that silently slow a kernel down. Results are stored as
+JSON (per-repetition timings, median, p99, samples/s and a fingerprint of
+the machine that produced them) and compared against a baseline with a
+Mann-Whitney U test, so a change is only reported when it is both larger
+than the threshold and unlikely to be noise.
+
+Sources:
+  native   signal_processor_bench (Google Benchmark, no Python overhead)
+  python   the signal_processor_cpp entry points (includes the bindings)
+
+Usage:
+  # Measure and save
+  python3 perf_regression.py run -o results.json
+  python3 perf_regression.py run --source python -o results.json
+
+  # Compare two result files; exit status 1 if anything regressed
+  python3 perf_regression.py compare baseline.json results.json
+
+  # Measure and compare against the committed baseline for this machine
+  # (suspected regressions are re-measured once before failing)
+  python3 perf_regression.py check
+
+  # Record the committed baseline for this machine (after a release)
+  python3 perf_regression.py update-baseline
+
+Baselines live in perf_baselines/<source>-<machine key>.json. Timings are
+only comparable on the same hardware, so the key is derived from the CPU
+model and count; record one per reference machine and commit it. Nothing
+here talks to an external service.
+"""
+
+import argparse
+import datetime
+import hashlib
+import json
+import math
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+import time
+from typing import Callable, Dict, List, Optional, Tuple
+
+SCHEMA_VERSION = 1
+# Relative to this script, so the harness works from any directory
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_BENCH = os.path.join(HERE, "build", "signal_processor_bench")
+BASELINE_DIR = os.path.join(HERE, "perf_baselines")
+
+
+# ============================================================================
+# STATISTICS
+# ============================================================================
+
+def percentile(values: List[float], q: float) -> float:
+    """Linearly interpolated percentile (q in [0, 100])"""
+    ordered = sorted(values)
+    if len(ordered) == 1:
+        return ordered[0]
+    rank = (len(ordered) - 1) * q / 100.0
+    low = math.floor(rank)
+    high = min(low + 1, len(ordered) - 1)
+    return ordered[low] + (ordered[high] - ordered[low]) * (rank - low)
+
+
+def mann_whitney_greater(current: List[float], baseline: List[float]) -> float:
+    """
+    One-sided Mann-Whitney U test: p-value for "current tends to be larger
+    (slower) than baseline"
+
+    Rank-based, so a few outlier repetitions (a context switch, a page
+    fault) cannot fake or hide a regression the way they can with a t-test.
+    Uses the normal approximation with tie and continuity corrections,
+    adequate from about 8 repetitions per side.
+    """
+    n1, n2 = len(current), len(baseline)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    combined = sorted([(v, 0) for v in current] + [(v, 1) for v in baseline])
+    ranks = [0.0] * len(combined)
+    tie_term = 0.0
+    i = 0
+    while i < len(combined):
+        j = i
+        while j + 1 < len(combined) and combined[j + 1][0] == combined[i][0]:
+            j += 1
+        average = (i + j) / 2.0 + 1.0
+        for k in range(i, j + 1):
+            ranks[k] = average
+        ties = j - i + 1
+        tie_term += ties ** 3 - ties
+        i = j + 1
+    rank_sum = sum(r for r, (_, group) in zip(ranks, combined) if group == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0 if u <= n1 * n2 / 2.0 else 0.0
+    z = (u - n1 * n2 / 2.0 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def summarize(times_ns: List[float], items_per_call: Optional[float],
+              bytes_per_call: Optional[float]) -> Dict:
+    """Per-benchmark record: the raw repetitions plus their summary"""
+    median = statistics.median(times_ns)
+    record = {
+        "unit": "ns",
+        "repetitions": times_ns,
+        "median_ns": median,
+        "p99_ns": percentile(times_ns, 99.0),
+        "mean_ns": statistics.fmean(times_ns),
+        "stdev_ns": statistics.stdev(times_ns) if len(times_ns) > 1 else 0.0,
+    }
+    if items_per_call:
+        record["samples_per_second"] = items_per_call * 1e9 / median
+    if bytes_per_call:
+        record["bytes_per_second"] = bytes_per_call * 1e9 / median
+    return record
+
+
+# ============================================================================
+# ENVIRONMENT FINGERPRINT
+# ============================================================================
+
+def read_first_line(path: str) -> Optional[str]:
+    try:
+        with open(path) as f:
+            return f.readline().strip()
+    except OSError:
+        return None
+
+
+def cpu_model() -> str:
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or platform.machine()
+
+
+def git_revision() -> Optional[str]:
+    try:
+        out = subprocess.run(["git", "rev-parse", "--short", "HEAD"], capture_output=True,
+                             text=True, cwd=HERE, timeout=10)
+        return out.stdout.strip() or None
+    except (OSError, subprocess.SubprocessError):
+        return None
+
+
+def environment(source: str, bench_context: Optional[Dict] = None) -> Dict:
+    """
+    What produced a result. `key` covers only what makes timings
+    incomparable (CPU and core count); the rest is reported so a surprising
+    comparison can be explained (governor, load, build type, revision).
+    """
+    env = {
+        "source": source,
+        "cpu_model": cpu_model(),
+        "cpu_count": os.cpu_count(),
+        "machine": platform.machine(),
+        "kernel": platform.release(),
+        "python": platform.python_version(),
+        "governor": read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"),
+        "load_average": list(os.getloadavg()) if hasattr(os, "getloadavg") else None,
+        "git_revision": git_revision(),
+    }
+    if bench_context:
+        env["benchmark_library_build"] = bench_context.get("library_build_type")
+        env["mhz_per_cpu"] = bench_context.get("mhz_per_cpu")
+        env["cpu_scaling_enabled"] = bench_context.get("cpu_scaling_enabled")
+    identity = f"{env['cpu_model']}|{env['cpu_count']}|{env['machine']}"
+    env["key"] = hashlib.sha1(identity.encode()).hexdigest()[:12]
+    return env
+
+
+# ============================================================================
+# MEASUREMENT
+# ============================================================================
+
+def run_native(bench: str, repetitions: int, name_filter: Optional[str]) -> Tuple[Dict, Dict]:
+    """Run signal_processor_bench and collect every repetition"""
+    if not os.path.exists(bench):
+        raise SystemExit(f"error: {bench} not found (build with Google Benchmark installed, "
+                         f"or pass --bench / --source python)")
+    cmd = [bench, f"--benchmark_repetitions={repetitions}", "--benchmark_format=json"]
+    if name_filter:
+        cmd.append(f"--benchmark_filter={name_filter}")
+    out = subprocess.run(cmd, capture_output=True, text=True)
+    if out.returncode != 0:
+        raise SystemExit(f"error: {bench} failed:\n{out.stderr}")
+    report = json.loads(out.stdout)
+
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    runs: Dict[str, Dict[str, List[float]]] = {}
+    for entry in report["benchmarks"]:
+        if entry.get("run_type") != "iteration":
+            continue
+        # Warmup settings are not part of what is measured
+        name = re.sub(r"/min_warmup_time:[^/]+", "", entry["run_name"])
+        run = runs.setdefault(name, {"times": [], "items": [], "bytes": []})
+        time_ns = entry["real_time"] * scale[entry.get("time_unit", "ns")]
+        run["times"].append(time_ns)
+        # Per-call work, so throughput can be recomputed from the median
+        if "items_per_second" in entry:
+            run["items"].append(entry["items_per_second"] * time_ns / 1e9)
+        if "bytes_per_second" in entry:
+            run["bytes"].append(entry["bytes_per_second"] * time_ns / 1e9)
+
+    results = {}
+    for name, run in runs.items():
+        items = statistics.median(run["items"]) if run["items"] else None
+        nbytes = statistics.median(run["bytes"]) if run["bytes"] else None
+        results[name] = summarize(run["times"], items, nbytes)
+    return results, environment("native", report.get("context"))
+
+
+def python_kernels() -> Dict[str, Tuple[Callable[[], object], int]]:
+    """The Python entry points worth guarding: name → (call, samples per call)"""
+    import numpy as np
+    import signal_processor_cpp as sp
+
+    rng = np.random.default_rng(1)
+    signal = rng.standard_normal(65536)
+    clean = np.sin(np.arange(65536) * 0.05)
+    frame = signal[:4096].copy()
+    spectrum = sp.compute_fft(frame)
+    iq = (rng.integers(-2000, 2000, size=(65536, 2))).astype(np.int16)
+    return {
+        "apply_lowpass_filter/taps:101/length:65536": (lambda: sp.apply_lowpass_filter(signal, 0.1, 101), 65536),
+        "apply_lowpass_filter/taps:31/length:65536": (lambda: sp.apply_lowpass_filter(signal, 0.1, 31), 65536),
+        "compute_fft/size:4096": (lambda: sp.compute_fft(frame), 4096),
+        "compute_fft/size:65536": (lambda: sp.compute_fft(signal), 65536),
+        "find_peak_frequency/bins:2049": (lambda: sp.find_peak_frequency(spectrum, 1e6), len(spectrum)),
+        "calculate_snr/length:65536": (lambda: sp.calculate_snr(clean, signal), 65536),
+        "generate_test_signal/length:65536": (lambda: sp.generate_test_signal(50e3, 1e6, 0.065536, 0.3), 65536),
+        "apply_lowpass_filter_iq_sc16/length:65536": (lambda: sp.apply_lowpass_filter(iq, 0.1, 101), 65536),
+    }
+
+
+def run_python(repetitions: int, name_filter: Optional[str], min_seconds: float = 0.02) -> Tuple[Dict, Dict]:
+    """
+    Time the bindings with perf_counter: calibrate a call count that lasts
+    at least `min_seconds` (which doubles as warmup), then take
+    `repetitions` timings of that many calls
+    """
+    results = {}
+    pattern = re.compile(name_filter) if name_filter else None
+    for name, (call, samples) in python_kernels().items():
+        if pattern and not pattern.search(name):
+            continue
+        calls = 1
+        while True:
+            start = time.perf_counter()
+            for _ in range(calls):
+                call()
+            elapsed = time.perf_counter() - start
+            if elapsed >= min_seconds:
+                break
+            calls *= 2
+        times = []
+        for _ in range(repetitions):
+            start = time.perf_counter()
+            for _ in range(calls):
+                call()
+            times.append((time.perf_counter() - start) * 1e9 / calls)
+        results[name] = summarize(times, samples, None)
+    return results, environment("python")
+
+
+def measure(args) -> Dict:
+    if args.source == "native":
+        benchmarks, env = run_native(args.bench, args.repetitions, args.filter)
+    else:
+        benchmarks, env = run_python(args.repetitions, args.filter)
+    return {
+        "schema": SCHEMA_VERSION,
+        "created": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds"),
+        "environment": env,
+        "benchmarks": benchmarks,
+    }
+
+
+# ============================================================================
+# COMPARISON
+# ============================================================================
+
+def compare(baseline: Dict, current: Dict, threshold: float, alpha: float) -> Tuple[List[Dict], List[str]]:
+    """
+    Classify every benchmark of `current` against `baseline`
+
+    REGRESSED: median slower by more than `threshold` (fraction) and the
+    U test rejects "no slower" at level `alpha`. Improvements are reported
+    the same way; anything else is "ok". Returns the rows and warnings
+    (e.g. results from different machines).
+    """
+    warnings = []
+    base_env, cur_env = baseline.get("environment", {}), current.get("environment", {})
+    if base_env.get("key") != cur_env.get("key"):
+        warnings.append(f"baseline is from a different machine ({base_env.get('cpu_model')}, "
+                        f"{base_env.get('cpu_count')} CPUs) than this run ({cur_env.get('cpu_model')}, "
+                        f"{cur_env.get('cpu_count')} CPUs): differences may not be regressions")
+    if base_env.get("source") != cur_env.get("source"):
+        warnings.append(f"comparing {base_env.get('source')} results with {cur_env.get('source')} results")
+    if cur_env.get("governor") not in (None, "performance"):
+        warnings.append(f"CPU frequency governor is '{cur_env.get('governor')}': "
+                        "set 'performance' for stable timings")
+
+    rows = []
+    base_runs, cur_runs = baseline.get("benchmarks", {}), current.get("benchmarks", {})
+    for name in sorted(set(base_runs) | set(cur_runs)):
+        if name not in cur_runs:
+            rows.append({"name": name, "status": "missing"})
+            continue
+        if name not in base_runs:
+            rows.append({"name": name, "status": "new", "current_ns": cur_runs[name]["median_ns"]})
+            continue
+        base, cur = base_runs[name], cur_runs[name]
+        change = cur["median_ns"] / base["median_ns"] - 1.0
+        p_slower = mann_whitney_greater(cur["repetitions"], base["repetitions"])
+        p_faster = mann_whitney_greater(base["repetitions"], cur["repetitions"])
+        if change > threshold and p_slower < alpha:
+            status = "REGRESSED"
+        elif change < -threshold and p_faster < alpha:
+            status = "faster"
+        else:
+            status = "ok"
+        rows.append({
+            "name": name, "status": status, "baseline_ns": base["median_ns"], "current_ns": cur["median_ns"],
+            "change": change, "p_value": p_slower if change >= 0 else p_faster,
+            "baseline_p99_ns": base["p99_ns"], "current_p99_ns": cur["p99_ns"],
+        })
+    return rows, warnings
+
+
+def format_time(ns: float) -> str:
+    for unit, factor in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= factor:
+            return f"{ns / factor:.2f} {unit}"
+    return f"{ns:.0f} ns"
+
+
+def print_report(rows: List[Dict], warnings: List[str], threshold: float, alpha: float) -> bool:
+    """Readable comparison table; returns True if anything regressed"""
+    for warning in warnings:
+        print(f"warning: {warning}")
+    width = max([len(r["name"]) for r in rows] + [9])
+    print(f"\n{'benchmark':<{width}}  {'baseline':>10}  {'current':>10}  {'change':>8}  {'p-value':>8}  status")
+    print("-" * (width + 56))
+    for r in rows:
+        if r["status"] in ("missing", "new"):
+            current = format_time(r["current_ns"]) if "current_ns" in r else "-"
+            print(f"{r['name']:<{width}}  {'-':>10}  {current:>10}  {'-':>8}  {'-':>8}  {r['status']}")
+            continue
+        print(f"{r['name']:<{width}}  {format_time(r['baseline_ns']):>10}  {format_time(r['current_ns']):>10}  "
+              f"{r['change'] * 100:>+7.1f}%  {r['p_value']:>8.4f}  {r['status']}")
+
+    regressed = [r for r in rows if r["status"] == "REGRESSED"]
+    print()
+    if regressed:
+        print(f"FAIL: {len(regressed)} benchmark(s) slower than baseline by more than "
+              f"{threshold * 100:.0f}% (p < {alpha}):")
+        for r in regressed:
+            print(f"  {r['name']}: median {format_time(r['baseline_ns'])} -> {format_time(r['current_ns'])} "
+                  f"({r['change'] * 100:+.1f}%), p99 {format_time(r['baseline_p99_ns'])} -> "
+                  f"{format_time(r['current_p99_ns'])}")
+    else:
+        print(f"OK: no benchmark regressed by more than {threshold * 100:.0f}% (p < {alpha})")
+    return bool(regressed)
+
+
+# ============================================================================
+# COMMAND LINE
+# ============================================================================
+
+def load(path: str) -> Dict:
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("schema") != SCHEMA_VERSION:
+        raise SystemExit(f"error: {path} has schema {data.get('schema')}, expected {SCHEMA_VERSION}")
+    return data
+
+
+def save(data: Dict, path: str):
+    directory = os.path.dirname(path)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    with open(path, "w") as f:
+        json.dump(data, f, indent=2)
+        f.write("\n")
+
+
+def baseline_path(source: str, key: str) -> str:
+    return os.path.join(BASELINE_DIR, f"{source}-{key}.json")
+
+
+def main(argv=None) -> int:
+    parser = argparse.ArgumentParser(description="Kernel performance regression harness")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    def add_run_options(p):
+        p.add_argument("--source", choices=["native", "python"], default="native")
+        p.add_argument("--bench", default=DEFAULT_BENCH, help="signal_processor_bench executable")
+        p.add_argument("--repetitions", type=int, default=15)
+        p.add_argument("--filter", help="Only benchmarks whose name matches this regex")
+
+    def add_compare_options(p):
+        p.add_argument("--threshold", type=float, default=5.0, help="Allowed slowdown in percent")
+        p.add_argument("--alpha", type=float, default=0.01, help="Significance level")
+
+    p_run = sub.add_parser("run", help="Measure and write results JSON")
+    add_run_options(p_run)
+    p_run.add_argument("-o", "--output", required=True)
+
+    p_cmp = sub.add_parser("compare", help="Compare two results files")
+    p_cmp.add_argument("baseline")
+    p_cmp.add_argument("current")
+    add_compare_options(p_cmp)
+
+    p_check = sub.add_parser("check", help="Measure and compare against the stored baseline")
+    add_run_options(p_check)
+    add_compare_options(p_check)
+    p_check.add_argument("--baseline", help="Baseline file (default: perf_baselines/<source>-<key>.json)")
+    p_check.add_argument("-o", "--output", help="Also save this run's results")
+    p_check.add_argument("--no-confirm", dest="confirm", action="store_false",
+                         help="Fail on the first measurement, without re-measuring regressions")
+
+    p_update = sub.add_parser("update-baseline", help="Measure and store as this machine's baseline")
+    add_run_options(p_update)
+
+    args = parser.parse_args(argv)
+
+    if args.command == "compare":
+        rows, warnings = compare(load(args.baseline), load(args.current), args.threshold / 100, args.alpha)
+        return 1 if print_report(rows, warnings, args.threshold / 100, args.alpha) else 0
+
+    results = measure(args)
+    if args.command == "run":
+        save(results, args.output)
+        print(f"Wrote {len(results['benchmarks'])} benchmarks to {args.output}")
+        return 0
+    if args.command == "update-baseline":
+        path = baseline_path(args.source, results["environment"]["key"])
+        save(results, path)
+        print(f"Wrote baseline {path} ({len(results['benchmarks'])} benchmarks); commit it to track regressions")
+        return 0
+
+    path = args.baseline or baseline_path(args.source, results["environment"]["key"])
+    if args.output:
+        save(results, args.output)
+    if not os.path.exists(path):
+        print(f"error: no baseline {path} for this machine; record one with "
+              f"'perf_regression.py update-baseline --source {args.source}'", file=sys.stderr)
+        return 2
+    baseline = load(path)
+    rows, warnings = compare(baseline, results, args.threshold / 100, args.alpha)
+    regressed = [r["name"] for r in rows if r["status"] == "REGRESSED"]
+    if regressed and args.confirm:
+        # Timings drift between runs (turbo, thermal state, neighbours on a
+        # shared host) by more than the spread within one run. Re-measure
+        # the suspects; only a slowdown that reproduces is reported.
+        print(f"Re-measuring {len(regressed)} suspected regression(s) to rule out drift...")
+        args.filter = "|".join(f"^{re.escape(name)}(/|$)" for name in regressed)
+        retry = measure(args)
+        results["benchmarks"].update(retry["benchmarks"])
+        if args.output:
+            save(results, args.output)
+        rows, warnings = compare(baseline, results, args.threshold / 100, args.alpha)
+    return 1 if print_report(rows, warnings, args.threshold / 100, args.alpha) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,135 @@
+#include "async_executor.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace signal_processor {
+
+AsyncExecutor::AsyncExecutor(
+    std::size_t num_threads,
+    std::size_t max_queue_depth,
+    std::size_t batch_cost_limit,
+    std::size_t max_batch_jobs
+)
+    : max_queue_depth_(std::max<std::size_t>(max_queue_depth, 1)),
+      batch_cost_limit_(batch_cost_limit),
+      max_batch_jobs_(std::max<std::size_t>(max_batch_jobs, 1)) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    shutdown();
+}
+
+void AsyncExecutor::submit(Job job, std::size_t cost) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Backpressure: the producer waits here instead of growing the queue
+    not_full_.wait(lock, [this] {
+        return stopping_ || queue_.size() < max_queue_depth_;
+    });
+    if (stopping_) {
+        throw std::runtime_error("AsyncExecutor is shutting down");
+    }
+    queue_.push_back(QueuedJob{std::move(job), cost});
+    lock.unlock();
+    not_empty_.notify_one();
+}
+
+bool AsyncExecutor::try_submit(Job job, std::size_t cost) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        throw std::runtime_error("AsyncExecutor is shutting down");
+    }
+    if (queue_.size() >= max_queue_depth_) {
+        ++jobs_rejected_;
+        return false;
+    }
+    queue_.push_back(QueuedJob{std::move(job), cost});
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+void AsyncExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+AsyncExecutorStats AsyncExecutor::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AsyncExecutorStats s;
+    s.num_threads = workers_.size();
+    s.queue_depth = queue_.size();
+    s.max_queue_depth = max_queue_depth_;
+    s.jobs_completed = jobs_completed_;
+    s.batches_run = batches_run_;
+    s.jobs_rejected = jobs_rejected_;
+    return s;
+}
+
+void AsyncExecutor::worker_loop() {
+    /**
+     * Each iteration takes one batch:
+     * - always the job at the head of the queue
+     * - then further jobs while they are "small", i.e. the batch's summed
+     *   cost stays within batch_cost_limit_
+     *
+     * A single large frame therefore runs alone (no added latency for
+     * the jobs behind it), while a burst of tiny frames is drained with
+     * one lock acquisition instead of one per frame.
+     */
+    std::vector<QueuedJob> batch;
+    batch.reserve(max_batch_jobs_);
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;  // Stopping and fully drained
+            }
+
+            std::size_t batch_cost = 0;
+            do {
+                batch_cost += queue_.front().cost;
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            } while (!queue_.empty() &&
+                     batch.size() < max_batch_jobs_ &&
+                     batch_cost + queue_.front().cost <= batch_cost_limit_);
+        }
+        not_full_.notify_all();
+
+        for (QueuedJob& queued : batch) {
+            try {
+                queued.job();
+            } catch (...) {
+                // Jobs report their own errors (futures, callbacks); never
+                // let one take down a worker thread
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_completed_ += batch.size();
+            ++batches_run_;
+        }
+        batch.clear();
+    }
+}
+
+} // namespace signal_processor
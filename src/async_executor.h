@@ -0,0 +1,142 @@
+#ifndef ASYNC_EXECUTOR_H
+#define ASYNC_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Asynchronous Job Execution for Signal Processing
+ *
+ * A fixed pool of native worker threads fed from one bounded job queue.
+ * Control loops submit filter/FFT work and keep servicing I/O while the
+ * DSP runs in the background.
+ *
+ * Key behaviours:
+ * 1. Backpressure - the queue holds at most max_queue_depth jobs;
+ *    submit() blocks and try_submit() refuses once it is full
+ * 2. Batching - a worker that wakes up drains several small jobs under a
+ *    single lock acquisition, so thousands of tiny frames do not pay one
+ *    mutex round-trip and one wakeup each
+ * 3. Orderly shutdown - queued jobs are always run before the workers exit
+ */
+
+namespace signal_processor {
+
+/**
+ * Snapshot of executor counters (see AsyncExecutor::stats())
+ */
+struct AsyncExecutorStats {
+    std::size_t num_threads = 0;
+    std::size_t queue_depth = 0;       // Jobs waiting right now
+    std::size_t max_queue_depth = 0;   // Backpressure threshold
+    std::uint64_t jobs_completed = 0;
+    std::uint64_t batches_run = 0;     // jobs_completed / batches_run = mean batch size
+    std::uint64_t jobs_rejected = 0;   // try_submit() calls refused by a full queue
+};
+
+class AsyncExecutor {
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * @param num_threads Worker count (0 = std::thread::hardware_concurrency())
+     * @param max_queue_depth Jobs allowed to wait before submitters are throttled
+     * @param batch_cost_limit Jobs are batched together while their summed
+     *                         cost (typically sample count) stays below this
+     * @param max_batch_jobs Upper bound on jobs taken in one batch
+     */
+    explicit AsyncExecutor(
+        std::size_t num_threads = 0,
+        std::size_t max_queue_depth = 1024,
+        std::size_t batch_cost_limit = 65536,
+        std::size_t max_batch_jobs = 32
+    );
+
+    // Runs every queued job, then joins the workers
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    /**
+     * Queue a job, blocking while the queue is full
+     *
+     * @param job Work to run on a worker thread; must not throw
+     * @param cost Relative size used for batching (e.g. sample count)
+     * @throws std::runtime_error if the executor is shutting down
+     */
+    void submit(Job job, std::size_t cost = 0);
+
+    /**
+     * Queue a job only if there is room
+     *
+     * @return false (and counts a rejection) when the queue is full
+     * @throws std::runtime_error if the executor is shutting down
+     */
+    bool try_submit(Job job, std::size_t cost = 0);
+
+    /**
+     * Run any callable and get its result through a std::future
+     *
+     * Exceptions thrown by `fn` are delivered through the future.
+     *
+     * Example:
+     *   auto fut = executor.async([&] { return compute_fft(frame); }, frame.size());
+     *   auto spectrum = fut.get();
+     */
+    template <typename Fn>
+    auto async(Fn&& fn, std::size_t cost = 0)
+        -> std::future<std::invoke_result_t<std::decay_t<Fn>>> {
+        using Result = std::invoke_result_t<std::decay_t<Fn>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> result = task->get_future();
+        submit([task] { (*task)(); }, cost);
+        return result;
+    }
+
+    /**
+     * Stop accepting work, run everything already queued and join workers
+     *
+     * Safe to call more than once; the destructor calls it too.
+     */
+    void shutdown();
+
+    AsyncExecutorStats stats() const;
+
+private:
+    struct QueuedJob {
+        Job job;
+        std::size_t cost;
+    };
+
+    void worker_loop();
+
+    const std::size_t max_queue_depth_;
+    const std::size_t batch_cost_limit_;
+    const std::size_t max_batch_jobs_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<QueuedJob> queue_;
+    bool stopping_ = false;
+
+    std::uint64_t jobs_completed_ = 0;
+    std::uint64_t batches_run_ = 0;
+    std::uint64_t jobs_rejected_ = 0;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace signal_processor
+
+#endif // ASYNC_EXECUTOR_H
@@ -0,0 +1,323 @@
+#include "batch_processor.h"
+#include "capture_reader.h"
+#include "capture_writer.h"
+#include "fftw_planner.h"
+#include "signal_processor.h"
+#include "stream_processors.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <fftw3.h>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace signal_processor {
+
+// ============================================================================
+// OUTPUT FILES
+// ============================================================================
+
+namespace {
+
+struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+FilePtr open_file(const std::string& path, const char* mode) {
+    FilePtr file(std::fopen(path.c_str(), mode));
+    if (!file) {
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    }
+    return file;
+}
+
+// ============================================================================
+// WELCH PSD
+// ============================================================================
+
+/**
+ * Averaged periodogram (Welch's method)
+ *
+ * Hann-windowed frames with 50% overlap; |X[k]|² is summed over every
+ * frame and normalized at the end. Averaging K frames cuts the variance of
+ * the noise floor by ~K, which is what makes a weak carrier stand out in a
+ * long recording.
+ *
+ * Real input uses an r2c transform (N/2 + 1 bins, one-sided); complex
+ * input a c2c transform (N bins, two-sided).
+ */
+template <typename Sample>
+class WelchPsd {
+public:
+    static constexpr bool kComplex = !std::is_same<Sample, double>::value;
+
+    explicit WelchPsd(int fft_size)
+        : size_(static_cast<std::size_t>(fft_size)),
+          hop_(std::max<std::size_t>(size_ / 2, 1)),
+          bins_(kComplex ? size_ : size_ / 2 + 1),
+          window_(size_),
+          power_(bins_, 0.0),
+          in_(default_buffer_pool(), size_),
+          out_(default_buffer_pool(), bins_) {
+        for (std::size_t n = 0; n < size_; ++n) {
+            window_[n] = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / size_);
+            window_power_ += window_[n] * window_[n];
+        }
+
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        if constexpr (kComplex) {
+            plan_ = fftw_plan_dft_1d(static_cast<int>(size_), reinterpret_cast<fftw_complex*>(in_.data()),
+                                     out_.data(), FFTW_FORWARD, FFTW_ESTIMATE);
+        } else {
+            plan_ = fftw_plan_dft_r2c_1d(static_cast<int>(size_), in_.data(), out_.data(), FFTW_ESTIMATE);
+        }
+    }
+
+    ~WelchPsd() {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        fftw_destroy_plan(plan_);
+    }
+
+    WelchPsd(const WelchPsd&) = delete;
+    WelchPsd& operator=(const WelchPsd&) = delete;
+
+    void process(const Sample* input, std::size_t length) {
+        pending_.insert(pending_.end(), input, input + length);
+
+        std::size_t start = 0;
+        while (pending_.size() - start >= size_) {
+            Sample* frame = in_.data();
+            for (std::size_t n = 0; n < size_; ++n) {
+                frame[n] = pending_[start + n] * window_[n];
+            }
+            fftw_execute(plan_);
+            for (std::size_t k = 0; k < bins_; ++k) {
+                power_[k] += out_[k][0] * out_[k][0] + out_[k][1] * out_[k][1];
+            }
+            ++frames_;
+            start += hop_;
+        }
+        pending_.erase(pending_.begin(), pending_.begin() + start);
+    }
+
+    std::uint64_t frames() const { return frames_; }
+
+    /**
+     * Power spectral density in dB per Hz, ordered by frequency
+     *
+     * @param sample_rate Rate of the samples fed to process()
+     * @param frequencies Receives the bin frequencies in Hz (IQ spectra are
+     *                    shifted so they run from -rate/2 to +rate/2)
+     */
+    std::vector<double> density_db(double sample_rate, std::vector<double>& frequencies) const {
+        const double norm = 1.0 / (std::max<std::uint64_t>(frames_, 1) * sample_rate * window_power_);
+        std::vector<double> psd(bins_);
+        frequencies.resize(bins_);
+
+        for (std::size_t i = 0; i < bins_; ++i) {
+            std::size_t k = i;
+            double bin = static_cast<double>(i);
+            if constexpr (kComplex) {
+                // fftshift: output index i holds bin (i - N/2) mod N
+                k = (i + size_ - size_ / 2) % size_;
+                bin = static_cast<double>(i) - static_cast<double>(size_ / 2);
+            }
+            double value = power_[k] * norm;
+            if (!kComplex && k != 0 && !(size_ % 2 == 0 && k == size_ / 2)) {
+                value *= 2.0;  // One-sided: fold the negative frequencies in
+            }
+            psd[i] = 10.0 * std::log10(value + 1e-300);
+            frequencies[i] = bin * sample_rate / size_;
+        }
+        return psd;
+    }
+
+private:
+    std::size_t size_;
+    std::size_t hop_;
+    std::size_t bins_;
+    std::vector<double> window_;
+    double window_power_ = 0.0;
+    std::vector<double> power_;
+    std::vector<Sample> pending_;
+    std::uint64_t frames_ = 0;
+    PooledBuffer<Sample> in_;
+    PooledBuffer<fftw_complex> out_;
+    fftw_plan plan_ = nullptr;
+};
+
+// ============================================================================
+// PROCESSING CHAIN
+// ============================================================================
+
+void validate(const BatchConfig& config) {
+    if (config.sample_rate <= 0.0) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    if (config.decimation < 1) {
+        throw std::invalid_argument("Decimation factor must be at least 1");
+    }
+    if (config.cutoff_hz < 0.0 || config.cutoff_hz >= config.sample_rate / 2.0) {
+        throw std::invalid_argument("Cutoff must be between 0 and sample_rate / 2");
+    }
+    if ((config.cutoff_hz > 0.0 || config.decimation > 1) && config.num_taps < 1) {
+        throw std::invalid_argument("Number of taps must be positive");
+    }
+    if (config.fft_size < 0 || config.fft_size == 1) {
+        throw std::invalid_argument("FFT size must be 0 (off) or at least 2");
+    }
+    if (config.block_size == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+}
+
+template <typename Sample>
+BatchResult run_chain(const MappedCapture& capture, const BatchConfig& config) {
+    constexpr bool kComplex = !std::is_same<Sample, double>::value;
+
+    BatchResult result;
+    result.output_rate = config.sample_rate / config.decimation;
+
+    // Filter stage: a decimator absorbs the low-pass as its anti-aliasing
+    // filter; without decimation it is a plain streaming FIR
+    std::optional<StreamingFir<Sample>> fir;
+    std::optional<Decimator<Sample>> decimator;
+    if (config.decimation > 1) {
+        double cutoff = config.cutoff_hz > 0.0 ? config.cutoff_hz / config.sample_rate
+                                               : 0.4 / config.decimation;
+        decimator.emplace(config.decimation, design_lowpass_filter(cutoff, config.num_taps));
+    } else if (config.cutoff_hz > 0.0) {
+        fir.emplace(design_lowpass_filter(config.cutoff_hz / config.sample_rate, config.num_taps));
+    }
+
+    std::optional<WelchPsd<Sample>> psd;
+    if (config.fft_size > 0) {
+        psd.emplace(config.fft_size);
+    }
+
+    // Processed samples are recorded as float32 (f32 / cf32) - half the
+    // disk traffic of float64 and well beyond the dynamic range of any ADC.
+    // The writer flushes on its own thread, so disk stalls overlap the DSP.
+    std::optional<CaptureWriter> samples_out;
+    if (!config.samples_path.empty()) {
+        CaptureWriterConfig writer_config;
+        writer_config.format = kComplex ? SampleFormat::CF32 : SampleFormat::F32;
+        samples_out.emplace(config.samples_path, writer_config);
+    }
+
+    // f64 / cf64 captures already hold Sample values: the chain reads the
+    // mapped file directly instead of converting into `block` (unless a
+    // header leaves the data misaligned)
+    const bool zero_copy = sizeof(Sample) == sample_format_size(capture.format()) &&
+                           (capture.format() == SampleFormat::F64 ||
+                            capture.format() == SampleFormat::CF64) &&
+                           capture.aligned();
+
+    std::vector<Sample> block(config.block_size);
+    std::vector<Sample> decimated(decimator ? decimator->max_output(config.block_size) : 0);
+
+    CaptureStream stream(capture, config.block_size);
+    BlockView view;
+    while (stream.next(view)) {
+        const std::size_t count = view.count;
+        result.samples_in += count;
+
+        const Sample* input = static_cast<const Sample*>(view.data);
+        if (!zero_copy) {
+            capture.convert(view, reinterpret_cast<double*>(block.data()), config.scale);
+            input = block.data();
+        }
+
+        const Sample* output = input;
+        std::size_t produced = count;
+        if (decimator) {
+            produced = decimator->process(input, count, decimated.data());
+            output = decimated.data();
+        } else if (fir) {
+            // Out of place: `input` may point into the read-only mapping
+            fir->process(input, count, block.data());
+            output = block.data();
+        }
+        result.samples_out += produced;
+
+        if (psd) {
+            psd->process(output, produced);
+        }
+        if (samples_out) {
+            samples_out->write(output, produced);
+        }
+    }
+
+    if (samples_out) {
+        samples_out->close();
+    }
+
+    if (psd) {
+        result.psd_frames = psd->frames();
+        if (result.psd_frames > 0) {
+            std::vector<double> frequencies;
+            std::vector<double> density = psd->density_db(result.output_rate, frequencies);
+
+            std::size_t peak = std::max_element(density.begin(), density.end()) - density.begin();
+            result.peak_frequency = frequencies[peak];
+            result.peak_power_db = density[peak];
+
+            if (!config.psd_path.empty()) {
+                FilePtr csv = open_file(config.psd_path, "w");
+                std::fprintf(csv.get(), "frequency_hz,power_db\n");
+                for (std::size_t i = 0; i < density.size(); ++i) {
+                    std::fprintf(csv.get(), "%.6f,%.4f\n", frequencies[i], density[i]);
+                }
+                if (std::fflush(csv.get()) != 0) {
+                    throw std::runtime_error(config.psd_path + ": write failed");
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+BatchResult process_file(const std::string& input_path, const BatchConfig& config) {
+    auto start = std::chrono::steady_clock::now();
+
+    // SigMF metadata describes the recording; it overrides the format and
+    // (when present) the sample rate given in the config
+    BatchConfig effective = config;
+    MappedCapture capture = [&] {
+        if (MappedCapture::is_sigmf_path(input_path)) {
+            MappedCapture sigmf = MappedCapture::open_sigmf(input_path);
+            effective.format = sigmf.format();
+            if (sigmf.info().sample_rate > 0.0) {
+                effective.sample_rate = sigmf.info().sample_rate;
+            }
+            return sigmf;
+        }
+        return MappedCapture(input_path, config.format);
+    }();
+    validate(effective);
+
+    BatchResult result;
+    try {
+        result = is_complex_format(effective.format)
+            ? run_chain<std::complex<double>>(capture, effective)
+            : run_chain<double>(capture, effective);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(input_path + ": " + e.what());
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace signal_processor
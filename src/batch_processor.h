@@ -0,0 +1,93 @@
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include "capture_reader.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Offline Batch Processing
+ *
+ * Runs a fixed processing chain over a recorded capture file without going
+ * through Python:
+ *
+ *   capture → convert → [low-pass | decimate] → [Welch PSD → peak] → outputs
+ *
+ * The capture is memory-mapped (capture_reader.h) and streamed in blocks
+ * through the stateful processors of stream_processors.h, so memory use is
+ * bounded by the block size no matter how large the recording is, and the
+ * filtered output is identical to filtering the whole file in one piece.
+ *
+ * One call processes one file on the calling thread. File-level
+ * parallelism (many captures at once) is the caller's job - see the
+ * sp_batch command-line tool, which fans files out over an AsyncExecutor.
+ */
+
+namespace signal_processor {
+
+/**
+ * Processing chain configuration
+ *
+ * Every stage is optional; a default-constructed config just converts the
+ * file and counts its samples.
+ */
+struct BatchConfig {
+    // Input description; for SigMF recordings the metadata takes precedence
+    SampleFormat format = SampleFormat::CF32;
+    double sample_rate = 1.0;        // Hz, of the input file
+
+    // Scale for integer formats (0 = full scale maps to ±1.0)
+    double scale = 0.0;
+
+    // Low-pass stage: cutoff in Hz (0 = off) and filter length
+    double cutoff_hz = 0.0;
+    int num_taps = 101;
+
+    // Decimation factor (1 = off). When set, the low-pass (cutoff_hz, or
+    // 40% of the output rate if no cutoff was given) becomes the
+    // decimator's anti-aliasing filter rather than a separate stage.
+    int decimation = 1;
+
+    // Welch PSD: FFT size (0 = off). Frames overlap by 50% and use a Hann
+    // window. Peak detection runs on the averaged PSD.
+    int fft_size = 0;
+
+    // Samples per block (working memory ~ block_size * 16 bytes * 3)
+    std::size_t block_size = 1 << 16;
+
+    // Outputs (empty = not written)
+    std::string samples_path;  // Processed stream, float32 (f32 or cf32)
+    std::string psd_path;      // CSV: frequency_hz,power_db
+};
+
+/**
+ * What processing one file produced
+ */
+struct BatchResult {
+    std::uint64_t samples_in = 0;
+    std::uint64_t samples_out = 0;   // After decimation
+    double output_rate = 0.0;        // Hz, after decimation
+    std::uint64_t psd_frames = 0;    // Frames averaged into the PSD
+    double peak_frequency = 0.0;     // Hz (negative = below center for IQ)
+    double peak_power_db = 0.0;      // dB (power spectral density, per Hz)
+    double seconds = 0.0;            // Wall-clock processing time
+};
+
+/**
+ * Process one capture file with the configured chain
+ *
+ * Trailing bytes that do not form a whole sample are ignored.
+ *
+ * @param input_path Raw capture file, or a SigMF recording (.sigmf-meta or
+ *                   .sigmf-data path)
+ * @param config Chain configuration
+ * @return Sample counts, PSD peak and timing
+ * @throws std::invalid_argument for bad configurations
+ * @throws std::runtime_error if a file cannot be opened, read or written
+ */
+BatchResult process_file(const std::string& input_path, const BatchConfig& config);
+
+} // namespace signal_processor
+
+#endif // BATCH_PROCESSOR_H
@@ -1,17 +1,819 @@
 #include <pybind11/pybind11.h>
-#include <pybind11/stl.h>
 #include <pybind11/complex.h>
+#include <pybind11/numpy.h>
+#include <pybind11/eval.h>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include "signal_processor.h"
+#include "async_executor.h"
+#include "thread_pool.h"
+#include "buffer_pool.h"
+#include "memory_policy.h"
+#include "realtime.h"
+#include "stream_processors.h"
+#include "capture_reader.h"
+#include "capture_writer.h"
+#include "flowgraph.h"
+#include "instrumentation.h"
+#include "trace.h"
+#include "ring_buffer.h"
+#include "shm_ring.h"
+#include "sample_convert.h"
+#include "vita49.h"
+#include <cstdint>
+#include <type_traits>
 
 namespace py = pybind11;
 
+// NumPy input types accepted by every binding.
+//
+// c_style | forcecast means a C-contiguous array of the right dtype is passed
+// through untouched (zero-copy: we read its buffer in place), while strided
+// views, other dtypes and plain Python lists fall back to a single contiguous
+// conversion done by NumPy itself - never an element-by-element object walk.
+using RealArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using ComplexArray = py::array_t<std::complex<double>, py::array::c_style | py::array::forcecast>;
+
+// float32 inputs are matched exactly (no forcecast) so they select the
+// single-precision kernels instead of being widened to float64.
+using Float32Array = py::array_t<float, py::array::c_style>;
+
+// Exact-dtype array (no forcecast): used for caller-provided `out=` buffers,
+// which must be written in place, and where an unsafe cast must not match.
+template <typename T>
+using ExactArray = py::array_t<T, py::array::c_style>;
+
+// Exact dtype in any layout: raw-format and complex inputs must select their
+// overload even as strided views (which RealArray would otherwise forcecast,
+// dropping the scale or the imaginary part); made contiguous on entry.
+template <typename T>
+using DtypeArray = py::array_t<T, 0>;
+
+namespace {
+
+// Validate a 1-D input buffer and return its element count.
+template <typename Array>
+std::size_t vector_length(const Array& array, const char* name) {
+    if (array.ndim() != 1) {
+        throw py::value_error(std::string(name) + " must be a 1-D array");
+    }
+    return static_cast<std::size_t>(array.shape(0));
+}
+
+// Run native work with the GIL released.
+//
+// Callers must already hold every buffer they pass in (the argument casters
+// keep the NumPy arrays alive for the whole call), and must not touch any
+// Python object inside `work`. The result is a plain C++ value, built
+// before the GIL is re-acquired on return.
+template <typename Work>
+auto without_gil(Work&& work) {
+    py::gil_scoped_release release;
+    return work();
+}
+
+// Hand a C++ result to NumPy without copying.
+//
+// The vector is moved onto the heap and a capsule owning it becomes the
+// array's base object: NumPy views the vector's storage directly and the
+// capsule destructor frees it when the last reference goes away.
+template <typename T>
+py::array_t<T> to_ndarray(std::vector<T>&& values) {
+    auto* owned = new std::vector<T>(std::move(values));
+    py::capsule owner(owned, [](void* p) {
+        delete static_cast<std::vector<T>*>(p);
+    });
+    return py::array_t<T>(owned->size(), owned->data(), owner);
+}
+
+// ============================================================================
+// RAW SAMPLE FORMAT SUPPORT
+// ============================================================================
+
+// `array` itself when already C-contiguous, else a contiguous copy (same dtype)
+template <typename T>
+ExactArray<T> contiguous(const DtypeArray<T>& array) {
+    auto result = ExactArray<T>::ensure(array);
+    if (!result) {
+        throw py::error_already_set();
+    }
+    return result;
+}
+
+// Integer input layout: 1-D = real samples, shape (N, 2) = interleaved I/Q
+// (sc16 / sc8 as delivered by SDR hardware)
+template <typename Raw>
+bool is_interleaved_iq(const ExactArray<Raw>& array) {
+    if (array.ndim() == 1) {
+        return false;
+    }
+    if (array.ndim() == 2 && array.shape(1) == 2) {
+        return true;
+    }
+    throw py::value_error("integer input must be 1-D (real) or shape (N, 2) (interleaved I/Q)");
+}
+
+double scale_or(const py::object& scale, double fallback) {
+    return scale.is_none() ? fallback : scale.cast<double>();
+}
+
+template <typename Raw>
+py::object filter_raw(const DtypeArray<Raw>& raw, double cutoff_freq, int num_taps,
+                      const py::object& scale_arg, double default_scale) {
+    ExactArray<Raw> input = contiguous(raw);
+    bool iq = is_interleaved_iq(input);
+    std::size_t length = static_cast<std::size_t>(input.shape(0));
+    double scale = scale_or(scale_arg, default_scale);
+    const Raw* data = input.data();
+    if (iq) {
+        return to_ndarray(without_gil([&] {
+            return signal_processor::apply_lowpass_filter_iq(data, length, cutoff_freq, num_taps, scale);
+        }));
+    }
+    return to_ndarray(without_gil([&] {
+        return signal_processor::apply_lowpass_filter(data, length, cutoff_freq, num_taps, scale);
+    }));
+}
+
+template <typename Raw>
+py::object fft_raw(const DtypeArray<Raw>& raw, const py::object& scale_arg, double default_scale) {
+    ExactArray<Raw> input = contiguous(raw);
+    bool iq = is_interleaved_iq(input);
+    std::size_t length = static_cast<std::size_t>(input.shape(0));
+    double scale = scale_or(scale_arg, default_scale);
+    const Raw* data = input.data();
+    if (iq) {
+        return to_ndarray(without_gil([&] {
+            return signal_processor::compute_fft_iq(data, length, scale);
+        }));
+    }
+    return to_ndarray(without_gil([&] {
+        return signal_processor::compute_fft(data, length, scale);
+    }));
+}
+
+// complex64 / complex128 arrays are interleaved float/double pairs
+template <typename Real>
+py::object filter_complex(const DtypeArray<std::complex<Real>>& iq, double cutoff_freq,
+                          int num_taps, const py::object& scale_arg) {
+    ExactArray<std::complex<Real>> input = contiguous(iq);
+    std::size_t length = vector_length(input, "input");
+    double scale = scale_or(scale_arg, 1.0);
+    const Real* data = reinterpret_cast<const Real*>(input.data());
+    return to_ndarray(without_gil([&] {
+        return signal_processor::apply_lowpass_filter_iq(data, length, cutoff_freq, num_taps, scale);
+    }));
+}
+
+template <typename Real>
+py::object fft_complex(const DtypeArray<std::complex<Real>>& iq, const py::object& scale_arg) {
+    ExactArray<std::complex<Real>> input = contiguous(iq);
+    std::size_t length = vector_length(input, "input");
+    double scale = scale_or(scale_arg, 1.0);
+    const Real* data = reinterpret_cast<const Real*>(input.data());
+    return to_ndarray(without_gil([&] {
+        return signal_processor::compute_fft_iq(data, length, scale);
+    }));
+}
+
+// ============================================================================
+// ASYNC EXECUTION SUPPORT
+// ============================================================================
+
+// Module-wide executor, created on first use. Only touched with the GIL held.
+std::unique_ptr<signal_processor::AsyncExecutor>& executor_slot() {
+    static std::unique_ptr<signal_processor::AsyncExecutor> slot;
+    return slot;
+}
+
+signal_processor::AsyncExecutor& default_executor() {
+    auto& slot = executor_slot();
+    if (!slot) {
+        slot = std::make_unique<signal_processor::AsyncExecutor>();
+    }
+    return *slot;
+}
+
+// Drain and join an executor that is no longer installed. Workers need the
+// GIL to publish results, so it must be released while we wait for them.
+void retire_executor(std::unique_ptr<signal_processor::AsyncExecutor> executor) {
+    if (executor) {
+        py::gil_scoped_release release;
+        executor.reset();
+    }
+}
+
+void shutdown_executor() {
+    retire_executor(std::move(executor_slot()));
+}
+
+// NativeFuture class object (a concurrent.futures.Future subclass defined at
+// import). Held as a leaked handle so no destructor runs after finalization.
+py::handle native_future_type;
+
+py::object to_python(double value) {
+    return py::float_(value);
+}
+
+template <typename T>
+py::object to_python(std::vector<T>&& values) {
+    return to_ndarray(std::move(values));
+}
+
+// Same mapping pybind11 applies to synchronous calls
+py::object python_exception(std::exception_ptr error) {
+    auto raise = [](PyObject* type, const char* message) {
+        return py::reinterpret_borrow<py::object>(type)(message);
+    };
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::bad_alloc& e) {
+        return raise(PyExc_MemoryError, e.what());
+    } catch (const std::domain_error& e) {
+        return raise(PyExc_ValueError, e.what());
+    } catch (const std::invalid_argument& e) {
+        return raise(PyExc_ValueError, e.what());
+    } catch (const std::length_error& e) {
+        return raise(PyExc_ValueError, e.what());
+    } catch (const std::out_of_range& e) {
+        return raise(PyExc_IndexError, e.what());
+    } catch (const std::range_error& e) {
+        return raise(PyExc_ValueError, e.what());
+    } catch (const std::overflow_error& e) {
+        return raise(PyExc_OverflowError, e.what());
+    } catch (const std::exception& e) {
+        return raise(PyExc_RuntimeError, e.what());
+    } catch (...) {
+        return raise(PyExc_RuntimeError, "unknown native error");
+    }
+}
+
+// Python objects belonging to one queued call. Cleared explicitly while the
+// GIL is held, so the job itself can be destroyed on any thread.
+struct PendingCall {
+    py::object future;
+    py::object inputs;
+};
+
+/**
+ * Queue `compute` on the native executor and return a NativeFuture
+ *
+ * @param inputs Arrays read by `compute`; referenced until it finishes
+ * @param cost Batching weight (sample count)
+ * @param block Wait for queue space (true) or raise when full (false)
+ * @param compute GIL-free callable returning a double or std::vector
+ */
+template <typename Compute>
+py::object submit_native(py::object inputs, std::size_t cost, bool block, Compute compute) {
+    auto call = std::make_shared<PendingCall>();
+    call->future = native_future_type();
+    call->inputs = std::move(inputs);
+    py::object future = call->future;
+
+    signal_processor::AsyncExecutor::Job job = [call, compute]() mutable {
+        using Result = decltype(compute());
+        std::optional<Result> result;
+        std::exception_ptr error;
+        try {
+            result.emplace(compute());
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        py::gil_scoped_acquire gil;
+        try {
+            if (!call->future.attr("cancelled")().cast<bool>()) {
+                if (error) {
+                    call->future.attr("set_exception")(python_exception(error));
+                } else {
+                    call->future.attr("set_result")(to_python(std::move(*result)));
+                }
+            }
+        } catch (py::error_already_set&) {
+            // Cancelled between the check and set_result: nothing to deliver
+        }
+        call->future = py::object();
+        call->inputs = py::object();
+    };
+
+    signal_processor::AsyncExecutor& executor = default_executor();
+    bool queued = true;
+    {
+        // Waiting for queue space must not hold the GIL: the workers need
+        // it to complete the very jobs that will free that space
+        py::gil_scoped_release release;
+        if (block) {
+            executor.submit(std::move(job), cost);
+        } else {
+            queued = executor.try_submit(std::move(job), cost);
+        }
+    }
+    if (!queued) {
+        // queue.Full, as put_nowait() raises on a full queue.Queue
+        py::object full = py::module_::import("queue").attr("Full");
+        PyErr_SetString(full.ptr(), "executor queue is full (max_queue_depth reached)");
+        throw py::error_already_set();
+    }
+    return future;
+}
+
+template <typename Array>
+py::object submit_filter(const Array& input, double cutoff_freq, int num_taps, bool block) {
+    std::size_t length = vector_length(input, "input");
+    const auto* data = input.data();
+    return submit_native(input, length, block, [=] {
+        return signal_processor::apply_lowpass_filter(data, length, cutoff_freq, num_taps);
+    });
+}
+
+template <typename Array>
+py::object submit_fft(const Array& input, bool block) {
+    std::size_t length = vector_length(input, "input");
+    const auto* data = input.data();
+    return submit_native(input, length, block, [=] {
+        return signal_processor::compute_fft(data, length);
+    });
+}
+
+// ============================================================================
+// STREAMING PROCESSOR SUPPORT
+// ============================================================================
+
+// A stateful processor as bound to Python. process() runs with the GIL
+// released, so the GIL no longer serializes calls on one object: every
+// method that reads or changes the processor's state holds `mutex` instead.
+template <typename Processor>
+struct Locked : Processor {
+    using Processor::Processor;
+    std::mutex mutex;
+};
+
+// Lock `self` for the rest of a call. The GIL is released while waiting, so
+// no thread ever blocks on the mutex holding the GIL and the lock holder can
+// always re-acquire it.
+template <typename Processor>
+std::unique_lock<std::mutex> hold(Locked<Processor>& self) {
+    py::gil_scoped_release release;
+    return std::unique_lock<std::mutex>(self.mutex);
+}
+
+template <typename T>
+const char* dtype_name() {
+    return std::is_same<T, double>::value ? "float64" : "complex128";
+}
+
+// Resolve the `out=None` argument of process(): allocate a fresh array, or
+// check that the caller's array can be written in place (right dtype,
+// C-contiguous, writeable, big enough). Never copies.
+template <typename T>
+ExactArray<T> output_array(const py::object& out, std::size_t needed) {
+    if (out.is_none()) {
+        return ExactArray<T>(static_cast<py::ssize_t>(needed));
+    }
+    if (!py::isinstance<ExactArray<T>>(out)) {
+        throw py::type_error(std::string("out must be a C-contiguous ") + dtype_name<T>() + " array");
+    }
+    auto array = py::reinterpret_borrow<ExactArray<T>>(out);
+    if (array.ndim() != 1 || static_cast<std::size_t>(array.shape(0)) < needed) {
+        throw py::value_error("out must be 1-D with room for " + std::to_string(needed) + " samples");
+    }
+    if (!array.writeable()) {
+        throw py::value_error("out must be writeable");
+    }
+    return array;
+}
+
+// `out` (a (>= frames, bins) complex128 array) or a fresh array, for STFTs
+ExactArray<std::complex<double>> frames_array(const py::object& out, std::size_t frames, std::size_t bins) {
+    using Bin = std::complex<double>;
+    if (out.is_none()) {
+        return ExactArray<Bin>(std::vector<py::ssize_t>{
+            static_cast<py::ssize_t>(frames), static_cast<py::ssize_t>(bins)});
+    }
+    if (!py::isinstance<ExactArray<Bin>>(out)) {
+        throw py::type_error("out must be a C-contiguous complex128 array");
+    }
+    auto result = py::reinterpret_borrow<ExactArray<Bin>>(out);
+    if (result.ndim() != 2 ||
+        static_cast<std::size_t>(result.shape(1)) != bins ||
+        static_cast<std::size_t>(result.shape(0)) < frames) {
+        throw py::value_error("out must have shape (>= " + std::to_string(frames) +
+                              ", " + std::to_string(bins) + ")");
+    }
+    if (!result.writeable()) {
+        throw py::value_error("out must be writeable");
+    }
+    return result;
+}
+
+// View of the first `count` rows of `array` (the array itself if exact)
+py::object leading(const py::array& array, std::size_t count) {
+    if (static_cast<std::size_t>(array.shape(0)) == count) {
+        return array;
+    }
+    return array[py::slice(0, static_cast<py::ssize_t>(count), 1)];
+}
+
+// Integer block for a complex processor as complex128: (N, 2) sc16 / sc8
+// interleaved I/Q (the layout cs16 / cs8 captures stream in) or 1-D real
+// samples, scaled to full scale by default as for apply_lowpass_filter
+template <typename Raw>
+ComplexArray iq_block(const DtypeArray<Raw>& raw, const py::object& scale_arg, double default_scale) {
+    ExactArray<Raw> input = contiguous(raw);
+    bool iq = is_interleaved_iq(input);
+    std::size_t length = static_cast<std::size_t>(input.shape(0));
+    double scale = scale_or(scale_arg, default_scale);
+    ComplexArray samples(static_cast<py::ssize_t>(length));
+    const Raw* data = input.data();
+    double* output = reinterpret_cast<double*>(samples.mutable_data());
+    without_gil([&] {
+        if (iq) {
+            signal_processor::convert_samples(data, 2 * length, output, scale);
+            return;
+        }
+        for (std::size_t i = 0; i < length; ++i) {
+            output[2 * i] = data[i] * scale;
+            output[2 * i + 1] = 0.0;
+        }
+    });
+    return samples;
+}
+
+// int16 / int8 process() overloads for a complex processor whose complex128
+// process() is `process`, so capture and VITA-49 blocks feed it directly
+template <typename Class, typename Process>
+void def_iq_process(Class& cls, Process process) {
+    using Self = typename Class::type;
+    cls.def("process",
+            [process](Self& self, const DtypeArray<std::int16_t>& block, const py::object& out,
+                      const py::object& scale) {
+                return process(self, iq_block(block, scale, signal_processor::kScaleS16), out);
+            },
+            py::arg("block"), py::arg("out") = py::none(), py::arg("scale") = py::none(),
+            "int16 overload: (N, 2) sc16 I/Q or 1-D real; default scale 1/32768.")
+        .def("process",
+             [process](Self& self, const DtypeArray<std::int8_t>& block, const py::object& out,
+                       const py::object& scale) {
+                 return process(self, iq_block(block, scale, signal_processor::kScaleS8), out);
+             },
+             py::arg("block"), py::arg("out") = py::none(), py::arg("scale") = py::none(),
+             "int8 overload: (N, 2) sc8 I/Q or 1-D real; default scale 1/128.");
+}
+
+template <typename Array>
+auto to_vector(const Array& array, const char* name) {
+    std::size_t length = vector_length(array, name);
+    using T = typename std::remove_const<typename std::remove_pointer<decltype(array.data())>::type>::type;
+    return std::vector<T>(array.data(), array.data() + length);
+}
+
+// StreamingFir<Sample> / Decimator<Sample> for real (float64) or complex
+// (complex128) streams. InputArray is the forcecast array type for Sample.
+template <typename Sample, typename InputArray>
+void bind_streaming_fir(py::module_& m, const char* name, const char* doc) {
+    using Fir = Locked<signal_processor::StreamingFir<Sample>>;
+    auto process = [](Fir& self, const InputArray& block, const py::object& out) {
+        std::size_t length = vector_length(block, "block");
+        ExactArray<Sample> result = output_array<Sample>(out, length);
+        const Sample* input = block.data();
+        Sample* output = result.mutable_data();
+        auto lock = hold(self);
+        {
+            py::gil_scoped_release release;
+            self.process(input, length, output);
+        }
+        return leading(result, length);
+    };
+    py::class_<Fir> cls(m, name, doc);
+    cls.def(py::init([](const RealArray& taps) {
+                 return std::make_unique<Fir>(to_vector(taps, "taps"));
+             }),
+             py::arg("taps"))
+        .def(py::init([](double cutoff_freq, int num_taps) {
+                 return std::make_unique<Fir>(
+                     signal_processor::design_lowpass_filter(cutoff_freq, num_taps));
+             }),
+             py::arg("cutoff_freq"), py::arg("num_taps"))
+        .def("process", process,
+             py::arg("block"), py::arg("out") = py::none(),
+             "Filter one block; returns `out` (or a new array) holding len(block) samples.")
+        .def("reset",
+             [](Fir& self) {
+                 auto lock = hold(self);
+                 self.reset();
+             },
+             "Clear the filter history.")
+        .def("snapshot",
+             [](Fir& self) {
+                 auto lock = hold(self);
+                 py::dict state;
+                 state["history"] = to_ndarray(self.snapshot());
+                 return state;
+             },
+             "Return the filter state as a dict (for restore()).")
+        .def("restore",
+             [](Fir& self, const py::dict& state) {
+                 auto history = to_vector(state["history"].cast<InputArray>(), "history");
+                 auto lock = hold(self);
+                 self.restore(history);
+             },
+             py::arg("state"))
+        .def_property_readonly("taps", [](const Fir& self) {
+            return to_ndarray(std::vector<double>(self.taps()));
+        });
+    if constexpr (std::is_same<Sample, std::complex<double>>::value) {
+        def_iq_process(cls, process);
+    }
+}
+
+template <typename Sample, typename InputArray>
+void bind_decimator(py::module_& m, const char* name, const char* doc) {
+    using Dec = Locked<signal_processor::Decimator<Sample>>;
+    auto process = [](Dec& self, const InputArray& block, const py::object& out) {
+        std::size_t length = vector_length(block, "block");
+        ExactArray<Sample> result = output_array<Sample>(out, self.max_output(length));
+        const Sample* input = block.data();
+        Sample* output = result.mutable_data();
+        std::size_t produced;
+        auto lock = hold(self);
+        {
+            py::gil_scoped_release release;
+            produced = self.process(input, length, output);
+        }
+        return leading(result, produced);
+    };
+    py::class_<Dec> cls(m, name, doc);
+    cls.def(py::init([](int factor, const RealArray& taps) {
+                 return std::make_unique<Dec>(factor, to_vector(taps, "taps"));
+             }),
+             py::arg("factor"), py::arg("taps"))
+        .def(py::init([](int factor, int num_taps) {
+                 return std::make_unique<Dec>(factor, num_taps);
+             }),
+             py::arg("factor"), py::arg("num_taps"))
+        .def("process", process,
+             py::arg("block"), py::arg("out") = py::none(),
+             "Filter and downsample one block; returns a view of the samples produced.")
+        .def("max_output", &Dec::max_output, py::arg("length"),
+             "Size `out` must have for a block of `length` samples.")
+        .def("reset",
+             [](Dec& self) {
+                 auto lock = hold(self);
+                 self.reset();
+             })
+        .def("snapshot",
+             [](Dec& self) {
+                 auto lock = hold(self);
+                 typename Dec::State snapshot = self.snapshot();
+                 py::dict state;
+                 state["history"] = to_ndarray(std::move(snapshot.history));
+                 state["phase"] = snapshot.phase;
+                 return state;
+             })
+        .def("restore",
+             [](Dec& self, const py::dict& state) {
+                 typename Dec::State restored;
+                 restored.history = to_vector(state["history"].cast<InputArray>(), "history");
+                 restored.phase = state["phase"].cast<int>();
+                 auto lock = hold(self);
+                 self.restore(restored);
+             },
+             py::arg("state"))
+        .def_property_readonly("factor", &Dec::factor);
+    if constexpr (std::is_same<Sample, std::complex<double>>::value) {
+        def_iq_process(cls, process);
+    }
+}
+
+// ============================================================================
+// MULTI-CHANNEL BATCH SUPPORT
+// ============================================================================
+
+// A list of 1-D float64 arrays (or anything convertible) as channel views.
+// `arrays` keeps converted copies alive for as long as the views are used.
+std::vector<signal_processor::ChannelView> channel_views(const py::sequence& channels,
+                                                         std::vector<RealArray>& arrays,
+                                                         const char* name) {
+    std::vector<signal_processor::ChannelView> views;
+    arrays.reserve(py::len(channels));
+    for (const py::handle& channel : channels) {
+        arrays.push_back(channel.cast<RealArray>());
+        views.push_back({arrays.back().data(), vector_length(arrays.back(), name)});
+    }
+    return views;
+}
+
+template <typename T>
+py::list to_ndarray_list(std::vector<std::vector<T>>&& outputs) {
+    py::list result;
+    for (auto& output : outputs) {
+        result.append(to_ndarray(std::move(output)));
+    }
+    return result;
+}
+
+// ============================================================================
+// MEMORY PLACEMENT SUPPORT
+// ============================================================================
+
+// huge_pages="none"/"transparent"/"2m"/"1g", numa_node=None (first touch) or a node
+signal_processor::MemoryPolicy memory_policy(const std::string& huge_pages, const py::object& numa_node,
+                                             bool prefault = false) {
+    signal_processor::MemoryPolicy policy;
+    policy.huge_pages = signal_processor::parse_huge_pages(huge_pages);
+    policy.numa_node = numa_node.is_none() ? -1 : numa_node.cast<int>();
+    if (policy.numa_node < -1) {
+        throw std::invalid_argument("numa_node must be None or a node number");
+    }
+    policy.prefault = prefault;
+    return policy;
+}
+
+// ============================================================================
+// SAMPLE RING SUPPORT
+// ============================================================================
+
+// MpmcRing<Sample> for Python: safe with any number of Python threads on
+// either side, and the copies run with the GIL released.
+template <typename Sample, typename InputArray>
+void bind_sample_ring(py::module_& m, const char* name, const char* doc) {
+    using Ring = signal_processor::MpmcRing<Sample>;
+    py::class_<Ring>(m, name, doc)
+        .def(py::init([](std::size_t capacity, const std::string& huge_pages, const py::object& numa_node) {
+                 return std::make_unique<Ring>(capacity, memory_policy(huge_pages, numa_node));
+             }),
+             py::arg("capacity"), py::arg("huge_pages") = "transparent", py::arg("numa_node") = py::none())
+        .def("write",
+             [](Ring& self, const InputArray& samples) {
+                 std::size_t length = vector_length(samples, "samples");
+                 const Sample* data = samples.data();
+                 return without_gil([&] { return self.write(data, length); });
+             },
+             py::arg("samples"),
+             "Copy in as many samples as fit without blocking; returns how many were accepted")
+        .def("read",
+             [](Ring& self, const py::object& max_count, const py::object& out) {
+                 std::size_t limit = max_count.is_none() ? self.capacity() : max_count.cast<std::size_t>();
+                 if (!out.is_none()) {
+                     limit = std::min(limit, static_cast<std::size_t>(py::len(out)));
+                 }
+                 ExactArray<Sample> output = output_array<Sample>(out, limit);
+                 Sample* data = output.mutable_data();
+                 std::size_t count = without_gil([&] { return self.read(data, limit); });
+                 return leading(output, count);
+             },
+             py::arg("max_count") = py::none(), py::arg("out") = py::none(),
+             "Copy out up to max_count available samples (an empty array if none)")
+        .def("close", &Ring::close)
+        .def_property_readonly("closed", &Ring::closed)
+        .def_property_readonly("capacity", &Ring::capacity)
+        .def_property_readonly("mirrored", &Ring::mirrored)
+        .def_property_readonly("huge_pages",
+                               [](const Ring& self) { return signal_processor::huge_pages_name(self.huge_pages()); })
+        .def_property_readonly("numa_bound", &Ring::numa_bound)
+        .def("first_touch", [](Ring& self) { without_gil([&] { self.first_touch(); }); },
+             "Fault the ring's pages in from the calling thread, so first-touch NUMA\n"
+             "placement puts them on its node. Call from the consumer before streaming.")
+        .def_property_readonly("overruns", &Ring::overruns)
+        .def("__len__", &Ring::size);
+}
+
+// ============================================================================
+// CAPTURE FILE SUPPORT
+// ============================================================================
+
+// NumPy element type of a sample format; complex integer formats are
+// stored as (N, 2) arrays of their component type, the same layout the
+// filter/FFT functions accept for sc16 / sc8
+py::dtype format_dtype(signal_processor::SampleFormat format) {
+    using signal_processor::SampleFormat;
+    switch (format) {
+        case SampleFormat::F32: return py::dtype::of<float>();
+        case SampleFormat::F64: return py::dtype::of<double>();
+        case SampleFormat::S16:
+        case SampleFormat::CS16: return py::dtype::of<std::int16_t>();
+        case SampleFormat::S8:
+        case SampleFormat::CS8: return py::dtype::of<std::int8_t>();
+        case SampleFormat::CF32: return py::dtype::of<std::complex<float>>();
+        case SampleFormat::CF64: return py::dtype::of<std::complex<double>>();
+    }
+    throw std::invalid_argument("Unknown sample format");
+}
+
+// NumPy view of `count` samples at `data` in the format's own dtype. `base`
+// keeps the memory alive for as long as the view exists.
+py::array format_view(signal_processor::SampleFormat format, const void* data, std::size_t count,
+                      py::handle base) {
+    using signal_processor::SampleFormat;
+    const auto n = static_cast<py::ssize_t>(count);
+    if (format == SampleFormat::CS16 || format == SampleFormat::CS8) {
+        return py::array(format_dtype(format), {n, py::ssize_t(2)}, data, base);
+    }
+    return py::array(format_dtype(format), {n}, data, base);
+}
+
+// Read-only view of a capture block, pointing into the mapping
+py::array capture_view(const signal_processor::MappedCapture& capture,
+                       const signal_processor::BlockView& view, py::handle base) {
+    py::array result = format_view(capture.format(), view.data, view.count, base);
+    if (!capture.aligned()) {
+        // Kernels read their input as typed pointers: hand out an aligned copy
+        return result.attr("copy")();
+    }
+    // The mapping is PROT_READ: a write through the view would segfault
+    result.attr("setflags")(py::arg("write") = false);
+    return result;
+}
+
+// Python timeout (None = wait forever) as the library's seconds argument
+double timeout_seconds(const py::object& timeout) {
+    return timeout.is_none() ? -1.0 : timeout.cast<double>();
+}
+
+signal_processor::OverflowPolicy overflow_policy(const std::string& name) {
+    if (name == "block") {
+        return signal_processor::OverflowPolicy::Block;
+    }
+    if (name == "drop") {
+        return signal_processor::OverflowPolicy::Drop;
+    }
+    throw std::invalid_argument("overflow must be 'block' or 'drop'");
+}
+
+// ============================================================================
+// FLOWGRAPH SUPPORT
+// ============================================================================
+
+// cpus=None or a sequence of CPU numbers (-1 = unpinned)
+std::vector<int> cpu_list(const py::object& cpus) {
+    std::vector<int> result;
+    if (!cpus.is_none()) {
+        for (const py::handle& cpu : cpus) {
+            result.push_back(cpu.cast<int>());
+        }
+    }
+    return result;
+}
+
+py::list string_list(const std::vector<std::string>& strings) {
+    py::list result;
+    for (const std::string& text : strings) {
+        result.append(text);
+    }
+    return result;
+}
+
+// A 1-D float64 or complex128 array (anything else is converted to one of
+// the two, complex dtypes to complex128) as a C++ vector, for ArraySource
+std::shared_ptr<signal_processor::ArraySource> array_source(const py::object& samples) {
+    if (py::isinstance<py::array>(samples) &&
+        py::reinterpret_borrow<py::array>(samples).dtype().kind() == 'c') {
+        return std::make_shared<signal_processor::ArraySource>(
+            to_vector(samples.cast<ComplexArray>(), "samples"));
+    }
+    return std::make_shared<signal_processor::ArraySource>(
+        to_vector(samples.cast<RealArray>(), "samples"));
+}
+
+py::dict flowgraph_stats(const signal_processor::FlowgraphStats& stats) {
+    py::list stages;
+    for (const auto& stage : stats.stages) {
+        py::dict d;
+        d["name"] = stage.name;
+        d["blocks"] = stage.blocks;
+        d["samples"] = stage.samples;
+        d["busy_seconds"] = stage.busy_seconds;
+        d["input_waits"] = stage.input_waits;
+        d["output_waits"] = stage.output_waits;
+        d["cpu"] = stage.cpu;
+        d["pin_failed"] = stage.pin_failed;
+        d["priority"] = stage.priority;
+        d["priority_failed"] = stage.priority_failed;
+        stages.append(d);
+    }
+    py::dict result;
+    result["seconds"] = stats.seconds;
+    result["stages"] = stages;
+    result["memory_locked"] = stats.memory_locked;
+    result["realtime_failures"] = string_list(stats.realtime_failures);
+    return result;
+}
+
+} // namespace
+
 /**
  * Python Bindings for Signal Processor
  *
  * This file creates the bridge between C++ and Python using pybind11
  *
  * What pybind11 does:
- * 1. Automatically converts Python lists ↔ C++ vectors
+ * 1. Reads NumPy buffers in place (Python lists are converted once)
  * 2. Handles complex numbers between NumPy and C++
  * 3. Creates proper Python module that can be imported
  * 4. Generates function signatures and docstrings
@@ -55,11 +857,28 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
 
     // Bind generate_test_signal function
     m.def("generate_test_signal",
-          &signal_processor::generate_test_signal,
+          [](double frequency, double sample_rate, double duration,
+             double noise_amplitude, const py::object& dtype) -> py::array {
+              std::string name = py::dtype::from_args(dtype).attr("name").cast<std::string>();
+              if (name == "float32") {
+                  return to_ndarray(without_gil([&] {
+                      return signal_processor::generate_test_signal_f32(
+                          frequency, sample_rate, duration, noise_amplitude);
+                  }));
+              }
+              if (name != "float64") {
+                  throw py::value_error("dtype must be float64 or float32");
+              }
+              return to_ndarray(without_gil([&] {
+                  return signal_processor::generate_test_signal(
+                      frequency, sample_rate, duration, noise_amplitude);
+              }));
+          },
           py::arg("frequency"),
           py::arg("sample_rate"),
           py::arg("duration"),
           py::arg("noise_amplitude"),
+          py::arg("dtype") = "float64",
           R"pbdoc(
               Generate a test signal (sine wave + Gaussian noise)
 
@@ -68,9 +887,10 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
                   sample_rate (float): Sampling rate in Hz
                   duration (float): Duration in seconds
                   noise_amplitude (float): Standard deviation of noise
+                  dtype (str): "float64" (default) or "float32"
 
               Returns:
-                  list[float]: Signal samples
+                  numpy.ndarray: Signal samples
 
               Example:
                   >>> signal = generate_test_signal(10.0, 1000.0, 1.0, 0.5)
@@ -80,7 +900,14 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
 
     // Bind apply_lowpass_filter function
     m.def("apply_lowpass_filter",
-          &signal_processor::apply_lowpass_filter,
+          [](const RealArray& input, double cutoff_freq, int num_taps) {
+              std::size_t length = vector_length(input, "input");
+              const auto* data = input.data();
+              return to_ndarray(without_gil([&] {
+                  return signal_processor::apply_lowpass_filter(
+                      data, length, cutoff_freq, num_taps);
+              }));
+          },
           py::arg("input"),
           py::arg("cutoff_freq"),
           py::arg("num_taps"),
@@ -90,14 +917,18 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
               Uses windowed-sinc method with Hamming window.
 
               Args:
-                  input (list[float]): Input signal
+                  input (array_like[float]): Input signal. int16/int8
+                                      arrays (1-D real or (N, 2) I/Q) are
+                                      scaled to full scale (1/32768, 1/128)
+                                      unless `scale` is given; other integer
+                                      dtypes are used unscaled
                   cutoff_freq (float): Normalized cutoff frequency (0-1)
                                       0.1 = keep lowest 10% of spectrum
                   num_taps (int): Number of filter coefficients (31, 51, 101 typical)
                                  More taps = sharper cutoff, more computation
 
               Returns:
-                  list[float]: Filtered signal
+                  numpy.ndarray: Filtered signal (float32 in, float32 out)
 
               Example:
                   >>> noisy = [1, 5, 2, 6, 3, 7, 4, 8]
@@ -105,9 +936,85 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
                   # smooth will be less jagged
           )pbdoc");
 
+    // float32 overload: registered second so that float64 keeps winning
+    // every implicit conversion, while exact float32 arrays land here
+    m.def("apply_lowpass_filter",
+          [](const Float32Array& input, double cutoff_freq, int num_taps) {
+              std::size_t length = vector_length(input, "input");
+              const auto* data = input.data();
+              return to_ndarray(without_gil([&] {
+                  return signal_processor::apply_lowpass_filter(
+                      data, length, cutoff_freq, num_taps);
+              }));
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          "Single-precision overload: float32 input returns float32 output.");
+
+    // Raw SDR formats, matched by exact dtype in any layout. int16/int8
+    // arrays are real when 1-D and interleaved I/Q (sc16/sc8) when shaped
+    // (N, 2). Unlike wider integer dtypes, which take the float64 path
+    // unscaled, they are normalized to full scale unless `scale` is given.
+    m.def("apply_lowpass_filter",
+          [](const DtypeArray<std::int16_t>& input, double cutoff_freq, int num_taps,
+             const py::object& scale) {
+              return filter_raw(input, cutoff_freq, num_taps, scale, signal_processor::kScaleS16);
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          py::arg("scale") = py::none(),
+          R"pbdoc(
+              int16 overload: 1-D real or (N, 2) sc16 interleaved I/Q
+
+              Samples are converted (SIMD, scaled by `scale`, default 1/32768)
+              block by block inside the filter - no float64 copy is made.
+              Real input returns float64; I/Q input returns complex128.
+          )pbdoc");
+
+    m.def("apply_lowpass_filter",
+          [](const DtypeArray<std::int8_t>& input, double cutoff_freq, int num_taps,
+             const py::object& scale) {
+              return filter_raw(input, cutoff_freq, num_taps, scale, signal_processor::kScaleS8);
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          py::arg("scale") = py::none(),
+          "int8 overload: 1-D real or (N, 2) sc8 I/Q; default scale 1/128.");
+
+    m.def("apply_lowpass_filter",
+          [](const DtypeArray<std::complex<float>>& input, double cutoff_freq, int num_taps,
+             const py::object& scale) {
+              return filter_complex(input, cutoff_freq, num_taps, scale);
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          py::arg("scale") = py::none(),
+          "complex64 overload: filters I and Q, returns complex128.");
+
+    m.def("apply_lowpass_filter",
+          [](const DtypeArray<std::complex<double>>& input, double cutoff_freq, int num_taps,
+             const py::object& scale) {
+              return filter_complex(input, cutoff_freq, num_taps, scale);
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          py::arg("scale") = py::none(),
+          "complex128 overload: filters I and Q, returns complex128.");
+
     // Bind compute_fft function
     m.def("compute_fft",
-          &signal_processor::compute_fft,
+          [](const RealArray& input) {
+              std::size_t length = vector_length(input, "input");
+              const auto* data = input.data();
+              return to_ndarray(without_gil([&] {
+                  return signal_processor::compute_fft(data, length);
+              }));
+          },
           py::arg("input"),
           R"pbdoc(
               Compute Fast Fourier Transform using FFTW
@@ -115,11 +1022,15 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
               Converts time-domain signal to frequency-domain representation.
 
               Args:
-                  input (list[float]): Real-valued signal samples
+                  input (array_like[float]): Real-valued signal samples.
+                                      int16/int8 arrays are scaled to full
+                                      scale (1/32768, 1/128) unless `scale`
+                                      is given, as for apply_lowpass_filter
 
               Returns:
-                  list[complex]: Complex frequency components
+                  numpy.ndarray[complex]: Complex frequency components
                                 Length is (N/2 + 1) where N = len(input)
+                                complex64 for float32 input, else complex128
 
               Example:
                   >>> signal = [math.sin(2*math.pi*10*t/1000) for t in range(1000)]
@@ -127,9 +1038,66 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
                   >>> # Peak will be at bin 10 (10 Hz)
           )pbdoc");
 
+    m.def("compute_fft",
+          [](const Float32Array& input) {
+              std::size_t length = vector_length(input, "input");
+              const auto* data = input.data();
+              return to_ndarray(without_gil([&] {
+                  return signal_processor::compute_fft(data, length);
+              }));
+          },
+          py::arg("input"),
+          "Single-precision overload: float32 input returns complex64 bins.");
+
+    m.def("compute_fft",
+          [](const DtypeArray<std::int16_t>& input, const py::object& scale) {
+              return fft_raw(input, scale, signal_processor::kScaleS16);
+          },
+          py::arg("input"),
+          py::arg("scale") = py::none(),
+          R"pbdoc(
+              int16 overload: 1-D real (N/2 + 1 bins) or (N, 2) sc16 I/Q
+              (complex FFT, all N bins). Converted straight into FFTW's
+              input buffer; default scale 1/32768.
+          )pbdoc");
+
+    m.def("compute_fft",
+          [](const DtypeArray<std::int8_t>& input, const py::object& scale) {
+              return fft_raw(input, scale, signal_processor::kScaleS8);
+          },
+          py::arg("input"),
+          py::arg("scale") = py::none(),
+          "int8 overload: 1-D real or (N, 2) sc8 I/Q; default scale 1/128.");
+
+    m.def("compute_fft",
+          [](const DtypeArray<std::complex<float>>& input, const py::object& scale) {
+              return fft_complex(input, scale);
+          },
+          py::arg("input"),
+          py::arg("scale") = py::none(),
+          "complex64 overload: complex FFT returning all N complex128 bins.");
+
+    m.def("compute_fft",
+          [](const DtypeArray<std::complex<double>>& input, const py::object& scale) {
+              return fft_complex(input, scale);
+          },
+          py::arg("input"),
+          py::arg("scale") = py::none(),
+          "complex128 overload: complex FFT returning all N bins.");
+
     // Bind calculate_snr function
     m.def("calculate_snr",
-          &signal_processor::calculate_snr,
+          [](const RealArray& signal, const RealArray& noisy) {
+              std::size_t length = vector_length(signal, "signal");
+              if (vector_length(noisy, "noisy") != length) {
+                  throw py::value_error("Signal and noisy vectors must have same size");
+              }
+              const double* clean = signal.data();
+              const double* received = noisy.data();
+              return without_gil([&] {
+                  return signal_processor::calculate_snr(clean, received, length);
+              });
+          },
           py::arg("signal"),
           py::arg("noisy"),
           R"pbdoc(
@@ -138,8 +1106,8 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
               Measures quality of signal reception.
 
               Args:
-                  signal (list[float]): Clean reference signal
-                  noisy (list[float]): Signal with noise added
+                  signal (array_like[float]): Clean reference signal
+                  noisy (array_like[float]): Signal with noise added
 
               Returns:
                   float: SNR in dB
@@ -155,9 +1123,158 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
                   >>> print(f"SNR: {snr:.1f} dB")
           )pbdoc");
 
+    // ========================================================================
+    // MULTI-CHANNEL BATCHES
+    // ========================================================================
+
+    m.def("apply_lowpass_filter_batch",
+          [](const py::sequence& channels, double cutoff_freq, int num_taps) {
+              std::vector<RealArray> arrays;
+              auto views = channel_views(channels, arrays, "channel");
+              return to_ndarray_list(without_gil([&] {
+                  return signal_processor::apply_lowpass_filter_batch(views, cutoff_freq, num_taps);
+              }));
+          },
+          py::arg("channels"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          R"pbdoc(
+              apply_lowpass_filter() on every channel, in parallel
+
+              Channels are spread over a native work-stealing thread pool
+              (one worker per core); channels of different lengths are fine.
+
+              Args:
+                  channels (list of array_like[float]): 1-D channels
+                  cutoff_freq (float): Normalized cutoff (0-1)
+                  num_taps (int): Filter length
+
+              Returns:
+                  list of numpy.ndarray: One filtered array per channel
+          )pbdoc");
+
+    m.def("compute_fft_batch",
+          [](const py::sequence& channels) {
+              std::vector<RealArray> arrays;
+              auto views = channel_views(channels, arrays, "channel");
+              return to_ndarray_list(without_gil([&] {
+                  return signal_processor::compute_fft_batch(views);
+              }));
+          },
+          py::arg("channels"),
+          "compute_fft() on every channel, in parallel; returns a list of arrays.");
+
+    m.def("calculate_snr_batch",
+          [](const py::sequence& signals, const py::sequence& noisy) {
+              std::vector<RealArray> signal_arrays;
+              std::vector<RealArray> noisy_arrays;
+              auto signal_views = channel_views(signals, signal_arrays, "signal");
+              auto noisy_views = channel_views(noisy, noisy_arrays, "noisy");
+              return to_ndarray(without_gil([&] {
+                  return signal_processor::calculate_snr_batch(signal_views, noisy_views);
+              }));
+          },
+          py::arg("signals"),
+          py::arg("noisy"),
+          "calculate_snr() of every (signal, noisy) pair, in parallel; returns an array of dB values.");
+
+    m.def("thread_pool_stats",
+          [] {
+              signal_processor::ThreadPoolStats stats = signal_processor::default_thread_pool().stats();
+              py::dict d;
+              d["num_threads"] = stats.num_threads;
+              d["tasks_executed"] = stats.tasks_executed;
+              d["tasks_stolen"] = stats.tasks_stolen;
+              return d;
+          },
+          "Counters of the work-stealing pool behind the *_batch() functions.");
+
+    m.def("set_thread_pool_realtime",
+          [](const py::object& cpus, int priority, bool lock_memory) {
+              signal_processor::RealtimeConfig config;
+              config.cpus = cpu_list(cpus);
+              config.priority = priority;
+              config.lock_memory = lock_memory;
+              signal_processor::RealtimeReport report =
+                  signal_processor::default_thread_pool().set_realtime(config);
+              py::dict d;
+              d["memory_locked"] = report.memory_locked;
+              d["failures"] = string_list(report.failures);
+              return d;
+          },
+          py::arg("cpus") = py::none(), py::arg("priority") = 0, py::arg("lock_memory") = false,
+          R"pbdoc(
+        Real-time settings for the pool behind the *_batch() functions
+
+        Args:
+            cpus: Pin worker i to CPU cpus[i] (-1 = unpinned)
+            priority: SCHED_FIFO priority 1-99 for every worker (0 = normal)
+            lock_memory: mlockall(MCL_ONFAULT) the process: each page is
+                         locked once touched, so it cannot be reclaimed.
+                         Memory-mapped captures are not read in up front
+
+        Returns:
+            {"memory_locked": bool, "failures": [str, ...]} - one message per
+            setting the system refused (missing CAP_SYS_NICE, RLIMIT_MEMLOCK,
+            ...); the pool keeps working without it
+    )pbdoc");
+
+    m.def("buffer_pool_stats",
+          [] {
+              signal_processor::BufferPoolStats stats = signal_processor::default_buffer_pool().stats();
+              py::dict d;
+              d["acquires"] = stats.acquires;
+              d["thread_cache_hits"] = stats.thread_cache_hits;
+              d["shared_hits"] = stats.shared_hits;
+              d["system_allocations"] = stats.system_allocations;
+              d["system_frees"] = stats.system_frees;
+              d["bytes_in_use"] = stats.bytes_in_use;
+              d["bytes_cached"] = stats.bytes_cached;
+              d["huge_page_bytes"] = stats.huge_page_bytes;
+              d["huge_page_fallbacks"] = stats.huge_page_fallbacks;
+              d["numa_bind_failures"] = stats.numa_bind_failures;
+              return d;
+          },
+          "Counters of the pool that supplies FFT and filter scratch buffers.");
+
+    m.def("trim_buffer_pool",
+          [] { signal_processor::default_buffer_pool().trim(); },
+          "Return the pool's cached (unused) buffers to the operating system.");
+
+    m.def("set_memory_policy",
+          [](const std::string& huge_pages, const py::object& numa_node, bool prefault) {
+              signal_processor::default_buffer_pool().set_memory_policy(
+                  memory_policy(huge_pages, numa_node, prefault));
+          },
+          py::arg("huge_pages") = "transparent", py::arg("numa_node") = py::none(),
+          py::arg("prefault") = false,
+          R"pbdoc(
+        Placement of the large (>= 2 MiB) FFT and filter work buffers
+
+        Args:
+            huge_pages: "none", "transparent" (kernel THP, the default),
+                        "2m" or "1g" (explicit huge pages reserved through
+                        vm.nr_hugepages; falls back to "transparent" when
+                        none are free - see buffer_pool_stats())
+            numa_node: Bind the buffers to this NUMA node; None places each
+                       page on the node of the thread that first touches it
+            prefault: Fault buffers in when they are allocated
+    )pbdoc");
+
+    m.def("numa_node_count", &signal_processor::numa_node_count,
+          "Number of NUMA nodes (1 on machines without NUMA).");
+    m.def("current_numa_node", &signal_processor::current_numa_node,
+          "NUMA node of the CPU the calling thread is running on.");
+
     // Bind find_peak_frequency function
     m.def("find_peak_frequency",
-          &signal_processor::find_peak_frequency,
+          [](const ComplexArray& fft_output, double sample_rate) {
+              std::size_t length = vector_length(fft_output, "fft_output");
+              const auto* bins = fft_output.data();
+              return without_gil([&] {
+                  return signal_processor::find_peak_frequency(bins, length, sample_rate);
+              });
+          },
           py::arg("fft_output"),
           py::arg("sample_rate"),
           R"pbdoc(
@@ -166,7 +1283,7 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
               Detects dominant frequency in signal.
 
               Args:
-                  fft_output (list[complex]): Output from compute_fft()
+                  fft_output (array_like[complex]): Output from compute_fft()
                   sample_rate (float): Original sampling rate in Hz
 
               Returns:
@@ -179,6 +1296,1165 @@ PYBIND11_MODULE(signal_processor_cpp, m) {
                   >>> print(f"Detected: {freq} Hz")  # Should be ~10.0
           )pbdoc");
 
+    // ========================================================================
+    // STREAMING PROCESSORS
+    // ========================================================================
+
+    bind_streaming_fir<double, RealArray>(m, "StreamingFir", R"pbdoc(
+        Stateful FIR filter for a real stream processed block by block
+
+        Filter history carries across process() calls, so any block sizes
+        give the same output as filtering the whole stream at once (delayed
+        by (taps - 1) / 2 samples, as for any causal linear-phase filter).
+
+        Example:
+            >>> fir = StreamingFir(cutoff_freq=0.1, num_taps=51)
+            >>> out = np.empty(1024)
+            >>> for block in blocks:
+            ...     fir.process(block, out=out)   # no allocation per block
+    )pbdoc");
+
+    bind_streaming_fir<std::complex<double>, ComplexArray>(m, "ComplexStreamingFir",
+        "StreamingFir for complex128 (IQ) streams; taps are real. Also takes\n"
+        "(N, 2) int16 / int8 (sc16 / sc8) blocks, scaled to full scale.");
+
+    bind_decimator<double, RealArray>(m, "Decimator", R"pbdoc(
+        Stateful anti-alias filter + downsample-by-factor for a real stream
+
+        Blocks need not be multiples of the factor: the output phase is
+        carried across calls. process() returns only the samples produced.
+
+        Example:
+            >>> dec = Decimator(factor=8, num_taps=127)
+            >>> out = np.empty(dec.max_output(4096))
+            >>> y = dec.process(block, out=out)   # view into out
+    )pbdoc");
+
+    bind_decimator<std::complex<double>, ComplexArray>(m, "ComplexDecimator",
+        "Decimator for complex128 (IQ) streams; taps are real. Also takes\n"
+        "(N, 2) int16 / int8 (sc16 / sc8) blocks, scaled to full scale.");
+
+    using Stft = Locked<signal_processor::Stft>;
+    py::class_<Stft>(m, "Stft", R"pbdoc(
+        Streaming Short-Time Fourier Transform (Hann window, persistent FFTW plan)
+
+        process(block) returns a (frames, frame_size // 2 + 1) complex128
+        array with every frame the block completed; leftover samples wait
+        for the next block.
+    )pbdoc")
+        .def(py::init<int, int>(), py::arg("frame_size"), py::arg("hop_size"))
+        .def("process",
+             [](Stft& self, const RealArray& block, const py::object& out) {
+                 using Bin = std::complex<double>;
+                 std::size_t length = vector_length(block, "block");
+                 // Held from max_frames() on: the frame count depends on the pending samples
+                 auto lock = hold(self);
+                 auto result = frames_array(out, self.max_frames(length), self.bins());
+
+                 const double* input = block.data();
+                 Bin* output = result.mutable_data();
+                 std::size_t produced;
+                 {
+                     py::gil_scoped_release release;
+                     produced = self.process(input, length, output);
+                 }
+                 return leading(result, produced);
+             },
+             py::arg("block"), py::arg("out") = py::none())
+        .def("max_frames",
+             [](Stft& self, std::size_t length) {
+                 auto lock = hold(self);
+                 return self.max_frames(length);
+             },
+             py::arg("length"))
+        .def("reset",
+             [](Stft& self) {
+                 auto lock = hold(self);
+                 self.reset();
+             })
+        .def("snapshot",
+             [](Stft& self) {
+                 auto lock = hold(self);
+                 py::dict state;
+                 state["pending"] = to_ndarray(self.snapshot());
+                 return state;
+             })
+        .def("restore",
+             [](Stft& self, const py::dict& state) {
+                 auto pending = to_vector(state["pending"].cast<RealArray>(), "pending");
+                 auto lock = hold(self);
+                 self.restore(pending);
+             },
+             py::arg("state"))
+        .def_property_readonly("bins", &signal_processor::Stft::bins)
+        .def_property_readonly("frame_size", &signal_processor::Stft::frame_size)
+        .def_property_readonly("hop_size", &signal_processor::Stft::hop_size);
+
+    using IqStft = Locked<signal_processor::IqStft>;
+    auto iq_stft_process = [](IqStft& self, const ComplexArray& block, const py::object& out) {
+        using Bin = std::complex<double>;
+        std::size_t length = vector_length(block, "block");
+        auto lock = hold(self);
+        auto result = frames_array(out, self.max_frames(length), self.bins());
+
+        const Bin* input = block.data();
+        Bin* output = result.mutable_data();
+        std::size_t produced;
+        {
+            py::gil_scoped_release release;
+            produced = self.process(input, length, output);
+        }
+        return leading(result, produced);
+    };
+    py::class_<IqStft> iq_stft(m, "IqStft", R"pbdoc(
+        Streaming STFT of a complex (IQ) stream (Hann window, c2c FFTW plan)
+
+        process(block) returns a (frames, frame_size) complex128 array with
+        every frame the block completed, bins in numpy.fft.fft order
+        (negative frequencies in the upper half).
+    )pbdoc");
+    iq_stft.def(py::init<int, int>(), py::arg("frame_size"), py::arg("hop_size"))
+        .def("process", iq_stft_process, py::arg("block"), py::arg("out") = py::none())
+        .def("max_frames",
+             [](IqStft& self, std::size_t length) {
+                 auto lock = hold(self);
+                 return self.max_frames(length);
+             },
+             py::arg("length"))
+        .def("reset",
+             [](IqStft& self) {
+                 auto lock = hold(self);
+                 self.reset();
+             })
+        .def("snapshot",
+             [](IqStft& self) {
+                 auto lock = hold(self);
+                 py::dict state;
+                 state["pending"] = to_ndarray(self.snapshot());
+                 return state;
+             })
+        .def("restore",
+             [](IqStft& self, const py::dict& state) {
+                 auto pending = to_vector(state["pending"].cast<ComplexArray>(), "pending");
+                 auto lock = hold(self);
+                 self.restore(pending);
+             },
+             py::arg("state"))
+        .def_property_readonly("bins", &signal_processor::IqStft::bins)
+        .def_property_readonly("frame_size", &signal_processor::IqStft::frame_size)
+        .def_property_readonly("hop_size", &signal_processor::IqStft::hop_size);
+    def_iq_process(iq_stft, iq_stft_process);
+
+    using CfarDetector = Locked<signal_processor::CfarDetector>;
+    py::class_<CfarDetector>(m, "CfarDetector", R"pbdoc(
+        Cell-averaging CFAR detector over STFT power frames
+
+        detect(power) takes a (frames, bins) float64 array of |X|^2 and
+        returns a dict of equal-length arrays: frame, bin, power and noise
+        (the training-cell mean each detection was compared with). Frame
+        numbers continue across calls until reset().
+    )pbdoc")
+        .def(py::init<int, int, double>(), py::arg("guard_cells"), py::arg("training_cells"),
+             py::arg("factor"))
+        .def_static("factor_for_pfa", &signal_processor::CfarDetector::factor_for_pfa,
+                    py::arg("training_cells"), py::arg("pfa"))
+        .def("detect",
+             [](CfarDetector& self, const RealArray& power) {
+                 if (power.ndim() != 2) {
+                     throw py::value_error("power must be a 2-D (frames, bins) array");
+                 }
+                 auto frames = static_cast<std::size_t>(power.shape(0));
+                 auto bins = static_cast<std::size_t>(power.shape(1));
+                 std::vector<signal_processor::CfarDetector::Detection> detections;
+                 const double* input = power.data();
+                 {
+                     auto lock = hold(self);
+                     py::gil_scoped_release release;
+                     self.detect(input, frames, bins, detections);
+                 }
+
+                 std::vector<std::int64_t> frame, bin;
+                 std::vector<double> level, noise;
+                 for (const auto& detection : detections) {
+                     frame.push_back(static_cast<std::int64_t>(detection.frame));
+                     bin.push_back(static_cast<std::int64_t>(detection.bin));
+                     level.push_back(detection.power);
+                     noise.push_back(detection.noise);
+                 }
+                 py::dict result;
+                 result["frame"] = to_ndarray(std::move(frame));
+                 result["bin"] = to_ndarray(std::move(bin));
+                 result["power"] = to_ndarray(std::move(level));
+                 result["noise"] = to_ndarray(std::move(noise));
+                 return result;
+             },
+             py::arg("power"))
+        .def("reset",
+             [](CfarDetector& self) {
+                 auto lock = hold(self);
+                 self.reset();
+             })
+        .def_property_readonly("guard_cells", &signal_processor::CfarDetector::guard_cells)
+        .def_property_readonly("training_cells", &signal_processor::CfarDetector::training_cells)
+        .def_property_readonly("factor", &signal_processor::CfarDetector::factor);
+
+    using Nco = Locked<signal_processor::Nco>;
+    auto nco_process = [](Nco& self, const ComplexArray& block, const py::object& out) {
+        std::size_t length = vector_length(block, "block");
+        auto result = output_array<std::complex<double>>(out, length);
+        const std::complex<double>* input = block.data();
+        std::complex<double>* output = result.mutable_data();
+        auto lock = hold(self);
+        {
+            py::gil_scoped_release release;
+            self.process(input, length, output);
+        }
+        return leading(result, length);
+    };
+    py::class_<Nco> nco(m, "Nco", R"pbdoc(
+        Numerically controlled oscillator / digital mixer
+
+        process(block) multiplies a real or complex block by
+        exp(j*2*pi*frequency*n) with phase continuous across calls.
+        frequency is in cycles per sample (negative shifts down).
+    )pbdoc");
+    nco.def(py::init<double>(), py::arg("frequency"))
+        .def("process",
+             [](Nco& self, const ExactArray<double>& block, const py::object& out) {
+                 std::size_t length = vector_length(block, "block");
+                 auto result = output_array<std::complex<double>>(out, length);
+                 const double* input = block.data();
+                 std::complex<double>* output = result.mutable_data();
+                 auto lock = hold(self);
+                 {
+                     py::gil_scoped_release release;
+                     self.process(input, length, output);
+                 }
+                 return leading(result, length);
+             },
+             py::arg("block"), py::arg("out") = py::none())
+        .def("process", nco_process, py::arg("block"), py::arg("out") = py::none())
+        .def("generate",
+             [](Nco& self, std::size_t length, const py::object& out) {
+                 auto result = output_array<std::complex<double>>(out, length);
+                 std::complex<double>* output = result.mutable_data();
+                 auto lock = hold(self);
+                 self.generate(length, output);
+                 return leading(result, length);
+             },
+             py::arg("length"), py::arg("out") = py::none())
+        .def("reset",
+             [](Nco& self) {
+                 auto lock = hold(self);
+                 self.reset();
+             })
+        .def("snapshot",
+             [](Nco& self) {
+                 auto lock = hold(self);
+                 py::dict state;
+                 state["phase"] = self.snapshot();
+                 return state;
+             })
+        .def("restore",
+             [](Nco& self, const py::dict& state) {
+                 double phase = state["phase"].cast<double>();
+                 auto lock = hold(self);
+                 self.restore(phase);
+             },
+             py::arg("state"))
+        .def_property("frequency",
+                      [](Nco& self) {
+                          auto lock = hold(self);
+                          return self.frequency();
+                      },
+                      [](Nco& self, double frequency) {
+                          auto lock = hold(self);
+                          self.set_frequency(frequency);
+                      });
+    def_iq_process(nco, nco_process);
+
+    // ========================================================================
+    // SAMPLE RINGS
+    // ========================================================================
+
+    bind_sample_ring<double, RealArray>(m, "SampleRing", R"pbdoc(
+        Lock-free ring buffer for handing float64 samples between threads
+
+        write() never blocks: samples that do not fit are dropped and
+        counted in `overruns`, so a capture thread can never be stalled by
+        a slow consumer. Both calls release the GIL while copying.
+
+        huge_pages ("none", "transparent", "2m", "1g") and numa_node place
+        the ring's memory; see set_memory_policy(). Explicit huge pages
+        round the capacity up to a whole huge page.
+
+        Example:
+            >>> ring = SampleRing(1 << 20)
+            >>> # capture thread
+            >>> ring.write(block)
+            >>> # processing thread
+            >>> out = np.empty(4096)
+            >>> ready = ring.read(out=out)   # view into out, len <= 4096
+    )pbdoc");
+
+    bind_sample_ring<std::complex<double>, ComplexArray>(m, "ComplexSampleRing",
+        "SampleRing for complex128 (IQ) streams.");
+
+    using signal_processor::SharedMemoryRing;
+    py::class_<SharedMemoryRing>(m, "SharedMemoryRing", R"pbdoc(
+        Single-producer/single-consumer sample ring in named shared memory
+
+        One process creates the segment (/dev/shm/<name>), another opens
+        it by name, and samples move between them without a socket or a
+        copy: reserve() returns a writable NumPy view of free space to fill
+        in place, peek() a read-only view of the samples ready to process.
+        Views are in the ring's dtype (complex128 for cf64, (N, 2) int16
+        for cs16, ...) and are contiguous even across the wrap.
+
+            # producer process
+            ring = SharedMemoryRing.create("rx0", 1 << 22, format="cf64")
+            free = ring.reserve(4096)
+            fir.process(block, out=free)
+            ring.commit(len(free))
+
+            # consumer process
+            ring = SharedMemoryRing.open("rx0")
+            ready = ring.peek(4096, timeout=0.1)
+            spectrum = compute_fft(ready)
+            ring.consume(len(ready))
+
+        A view must not be used after the matching commit()/consume().
+        Waiting calls release the GIL. The creating handle removes the
+        name when it is destroyed.
+    )pbdoc")
+        .def_static("create",
+             [](const std::string& name, std::size_t capacity, const std::string& format) {
+                 return SharedMemoryRing::create(name, capacity, signal_processor::parse_sample_format(format));
+             },
+             py::arg("name"), py::arg("capacity"), py::arg("format") = "cf64")
+        .def_static("open", &SharedMemoryRing::open, py::arg("name"))
+        .def_static("unlink", &SharedMemoryRing::unlink, py::arg("name"),
+             "Remove a segment name left behind by a crashed producer; False if absent")
+        .def("reserve",
+             [](const py::object& self, const py::object& max_count) {
+                 auto& ring = self.cast<SharedMemoryRing&>();
+                 auto span = max_count.is_none() ? ring.reserve_bytes()
+                                                 : ring.reserve_bytes(max_count.cast<std::size_t>());
+                 return format_view(ring.format(), span.data, span.count, self);
+             },
+             py::arg("max_count") = py::none(),
+             "Writable view of up to max_count free samples (empty if the ring is full)")
+        .def("commit", &SharedMemoryRing::commit, py::arg("count"),
+             "Publish the first count samples of the last reserve()")
+        .def("write",
+             [](SharedMemoryRing& self, const py::object& samples) {
+                 // Exact dtype only, as for ExactArray elsewhere: a cast would
+                 // silently drop the imaginary part or wrap floats into int16
+                 py::module_ numpy = py::module_::import("numpy");
+                 py::array data = numpy.attr("asarray")(samples);
+                 py::dtype expected = format_dtype(self.format());
+                 if (!data.dtype().equal(expected)) {
+                     throw py::value_error("samples must be " + py::str(expected).cast<std::string>() +
+                                           " for a " + signal_processor::sample_format_name(self.format()) +
+                                           " ring, got " + py::str(data.dtype()).cast<std::string>());
+                 }
+                 data = numpy.attr("ascontiguousarray")(data);
+                 auto bytes = static_cast<std::size_t>(data.nbytes());
+                 if (bytes % self.sample_size() != 0) {
+                     throw std::invalid_argument("samples do not match the ring's format");
+                 }
+                 const void* source = data.data();
+                 return without_gil([&] { return self.write(source, bytes / self.sample_size()); });
+             },
+             py::arg("samples"),
+             "Copy in as many samples as fit without blocking; returns how many were accepted")
+        .def("peek",
+             [](const py::object& self, const py::object& max_count, const py::object& timeout) {
+                 auto& ring = self.cast<SharedMemoryRing&>();
+                 std::size_t limit = max_count.is_none() ? ring.capacity() : max_count.cast<std::size_t>();
+                 if (!timeout.is_none()) {
+                     double seconds = timeout_seconds(timeout);
+                     without_gil([&] { ring.wait_readable(limit, seconds); });
+                 }
+                 auto span = ring.peek_bytes(limit);
+                 py::array result = format_view(ring.format(), span.data, span.count, self);
+                 result.attr("setflags")(py::arg("write") = false);
+                 return result;
+             },
+             py::arg("max_count") = py::none(), py::arg("timeout") = py::none(),
+             "Read-only view of up to max_count available samples. With a timeout,\n"
+             "first wait up to that long for max_count samples (or close()).")
+        .def("consume", &SharedMemoryRing::consume, py::arg("count"),
+             "Release the first count samples of the last peek()")
+        .def("read",
+             [](SharedMemoryRing& self, const py::object& max_count) {
+                 std::size_t limit = max_count.is_none() ? self.size() : max_count.cast<std::size_t>();
+                 limit = std::min(limit, self.capacity());
+                 std::vector<char> copy(limit * self.sample_size());
+                 std::size_t count = without_gil([&] { return self.read(copy.data(), limit); });
+                 // format_view without a base copies the samples into a new array
+                 return format_view(self.format(), copy.data(), count, py::handle());
+             },
+             py::arg("max_count") = py::none(),
+             "Copy out up to max_count available samples (an empty array if none)")
+        .def("wait_readable",
+             [](SharedMemoryRing& self, std::size_t min_count, const py::object& timeout) {
+                 double seconds = timeout_seconds(timeout);
+                 return without_gil([&] { return self.wait_readable(min_count, seconds); });
+             },
+             py::arg("min_count") = 1, py::arg("timeout") = py::none(),
+             "Wait for min_count samples or close(); False on timeout")
+        .def("wait_writable",
+             [](SharedMemoryRing& self, std::size_t min_count, const py::object& timeout) {
+                 double seconds = timeout_seconds(timeout);
+                 return without_gil([&] { return self.wait_writable(min_count, seconds); });
+             },
+             py::arg("min_count") = 1, py::arg("timeout") = py::none(),
+             "Wait for min_count free samples; False on timeout")
+        .def("close", &SharedMemoryRing::close, "End of stream: wakes a waiting consumer")
+        .def_property_readonly("closed", &SharedMemoryRing::closed)
+        .def_property_readonly("name", &SharedMemoryRing::name)
+        .def_property_readonly("capacity", &SharedMemoryRing::capacity)
+        .def_property_readonly("format",
+             [](const SharedMemoryRing& self) { return signal_processor::sample_format_name(self.format()); })
+        .def_property_readonly("mirrored", &SharedMemoryRing::mirrored)
+        .def_property_readonly("overruns", &SharedMemoryRing::overruns)
+        .def("__len__", &SharedMemoryRing::size);
+
+    // ========================================================================
+    // VITA-49 INGEST
+    // ========================================================================
+
+    using signal_processor::Vita49Receiver;
+    py::class_<Vita49Receiver>(m, "Vita49Receiver", R"pbdoc(
+        UDP receiver for VITA-49 (VRT) IQ packets
+
+        Datagrams are read in recvmmsg() batches straight into a ring of
+        packet slots and their headers parsed on arrival; gaps in the
+        packet count and in sample-count timestamps are counted in
+        stats(). Context packets are skipped. Either call start() to
+        receive on a native thread, or receive() from your own loop.
+
+            rx = Vita49Receiver(port=50000, format="cs16")
+            rx.start()
+            while True:
+                iq = rx.read(timeout=0.1)      # complex128, scaled to [-1, 1)
+                spectrum = compute_fft(iq)
+
+        Args:
+            port: UDP port (0 = any free port; see .port)
+            address: Local IPv4 address to bind
+            format: Payload format: "cs16", "cs8" or "cf32"
+            big_endian: Payload byte order on the wire (VITA-49 default)
+            ring_packets: Packet slots in the ring
+            max_packet_bytes: Largest datagram accepted
+            batch: Datagrams per recvmmsg() call
+    )pbdoc")
+        .def(py::init([](std::uint16_t port, const std::string& address, const std::string& format,
+                         bool big_endian, std::size_t ring_packets, std::size_t max_packet_bytes,
+                         std::size_t batch) {
+                 signal_processor::Vita49Config config;
+                 config.port = port;
+                 config.address = address;
+                 config.format = signal_processor::parse_sample_format(format);
+                 config.big_endian = big_endian;
+                 config.ring_packets = ring_packets;
+                 config.max_packet_bytes = max_packet_bytes;
+                 config.batch = batch;
+                 return std::make_unique<Vita49Receiver>(config);
+             }),
+             py::arg("port") = 0, py::arg("address") = "0.0.0.0", py::arg("format") = "cs16",
+             py::arg("big_endian") = true, py::arg("ring_packets") = 4096,
+             py::arg("max_packet_bytes") = 9000, py::arg("batch") = 64)
+        .def_property_readonly("port", &Vita49Receiver::port)
+        .def("start", &Vita49Receiver::start, "Receive on a native thread until stop()")
+        .def("stop", &Vita49Receiver::stop, py::call_guard<py::gil_scoped_release>())
+        .def("receive",
+             [](Vita49Receiver& self, const py::object& timeout) {
+                 double seconds = timeout_seconds(timeout);
+                 return without_gil([&] { return self.receive(seconds); });
+             },
+             py::arg("timeout") = 0.0,
+             "One recvmmsg() batch from the calling thread (without start());\n"
+             "returns the number of datagrams read")
+        .def("read",
+             [](Vita49Receiver& self, const py::object& max_packets, const py::object& timeout,
+                const py::object& scale) {
+                 std::size_t limit = max_packets.is_none() ? self.capacity() : max_packets.cast<std::size_t>();
+                 if (!timeout.is_none()) {
+                     double seconds = timeout_seconds(timeout);
+                     without_gil([&] { self.wait_packets(seconds); });
+                 }
+                 auto packets = self.peek(limit);
+                 std::size_t total = 0;
+                 for (std::size_t i = 0; i < packets.count; ++i) {
+                     total += packets.data[i].sample_count();
+                 }
+                 auto result = output_array<std::complex<double>>(py::none(), total);
+                 double* out = reinterpret_cast<double*>(result.mutable_data());
+                 const signal_processor::SampleFormat format = self.config().format;
+                 const double factor = scale_or(scale, 0.0);
+                 without_gil([&] {
+                     for (std::size_t i = 0; i < packets.count; ++i) {
+                         const signal_processor::Vita49Packet& packet = packets.data[i];
+                         std::size_t values = 2 * packet.sample_count();
+                         if (format == signal_processor::SampleFormat::CS16) {
+                             signal_processor::convert_samples(packet.samples<std::int16_t>(), values, out,
+                                                               factor > 0.0 ? factor : signal_processor::kScaleS16);
+                         } else if (format == signal_processor::SampleFormat::CS8) {
+                             signal_processor::convert_samples(packet.samples<std::int8_t>(), values, out,
+                                                               factor > 0.0 ? factor : signal_processor::kScaleS8);
+                         } else {
+                             signal_processor::convert_samples(packet.samples<float>(), values, out,
+                                                               factor > 0.0 ? factor : 1.0);
+                         }
+                         out += values;
+                     }
+                     self.consume(packets.count);
+                 });
+                 return result;
+             },
+             py::arg("max_packets") = py::none(), py::arg("timeout") = py::none(), py::arg("scale") = py::none(),
+             "Payload samples of up to max_packets received packets, as one complex128\n"
+             "array. With a timeout, first wait up to that long for a packet.")
+        .def("stats",
+             [](const Vita49Receiver& self) {
+                 signal_processor::Vita49Stats stats = self.stats();
+                 py::dict d;
+                 d["packets"] = stats.packets;
+                 d["payload_bytes"] = stats.payload_bytes;
+                 d["context_packets"] = stats.context_packets;
+                 d["malformed"] = stats.malformed;
+                 d["lost_packets"] = stats.lost_packets;
+                 d["lost_samples"] = stats.lost_samples;
+                 d["receive_calls"] = stats.receive_calls;
+                 d["ring_full"] = stats.ring_full;
+                 d["streams"] = stats.streams;
+                 return d;
+             })
+        .def("__len__", &Vita49Receiver::size);
+
+    // ========================================================================
+    // CAPTURE FILES
+    // ========================================================================
+
+    py::class_<signal_processor::MappedCapture>(m, "MappedCapture", R"pbdoc(
+        Memory-mapped recording (raw IQ/real file or SigMF dataset)
+
+        block(offset, count) and iteration via stream(block_size) return
+        read-only NumPy views straight into the mapped file, in the file's
+        own dtype (complex64 for cf32, complex128 for cf64, (N, 2) int16
+        for cs16, ...). Nothing is loaded into memory up front, so captures
+        far larger than RAM can be processed block by block. If header_bytes
+        (or a SigMF header) leaves the data misaligned for its dtype, blocks
+        are copies instead (see the `aligned` property). The complex
+        streaming processors take every block as is, widening cs16 / cs8
+        blocks to full-scale complex128:
+
+            cap = MappedCapture.open_sigmf("rec.sigmf-meta")
+            fir = ComplexStreamingFir(0.1, 101)
+            for block in cap.stream(65536):
+                filtered = fir.process(block)
+    )pbdoc")
+        .def(py::init([](const std::string& path, const std::string& format, std::size_t header_bytes) {
+                 return std::make_unique<signal_processor::MappedCapture>(
+                     path, signal_processor::parse_sample_format(format), header_bytes);
+             }),
+             py::arg("path"), py::arg("format") = "cf32", py::arg("header_bytes") = 0)
+        .def_static("open_sigmf", &signal_processor::MappedCapture::open_sigmf, py::arg("path"))
+        .def("__len__", &signal_processor::MappedCapture::size)
+        .def_property_readonly("aligned", &signal_processor::MappedCapture::aligned)
+        .def("block",
+             [](const py::object& self, std::uint64_t offset, std::size_t count) {
+                 const auto& capture = self.cast<const signal_processor::MappedCapture&>();
+                 return capture_view(capture, capture.block(offset, count), self);
+             },
+             py::arg("offset"), py::arg("count"))
+        .def("stream",
+             [](const py::object& self, std::size_t block_size) {
+                 // The stream keeps the capture alive (keep_alive below)
+                 return std::make_unique<signal_processor::CaptureStream>(
+                     self.cast<const signal_processor::MappedCapture&>(), block_size);
+             },
+             py::arg("block_size") = 65536, py::keep_alive<0, 1>())
+        .def_property_readonly("format",
+             [](const signal_processor::MappedCapture& self) {
+                 return signal_processor::sample_format_name(self.format());
+             })
+        .def_property_readonly("sample_rate",
+             [](const signal_processor::MappedCapture& self) { return self.info().sample_rate; })
+        .def_property_readonly("center_frequency",
+             [](const signal_processor::MappedCapture& self) { return self.info().center_frequency; })
+        .def_property_readonly("path",
+             [](const signal_processor::MappedCapture& self) { return self.info().data_path; });
+
+    py::class_<signal_processor::CaptureStream>(m, "CaptureStream", R"pbdoc(
+        Sequential block iterator over a MappedCapture (see MappedCapture.stream)
+
+        Reads ahead of the current block and releases the pages behind it,
+        so resident memory stays at a few blocks. Each yielded view stays
+        valid, but its pages may have to be re-read from disk if kept.
+    )pbdoc")
+        .def("__iter__", [](const py::object& self) { return self; })
+        .def("__next__",
+             [](const py::object& self) {
+                 auto& stream = self.cast<signal_processor::CaptureStream&>();
+                 signal_processor::BlockView view;
+                 if (!stream.next(view)) {
+                     throw py::stop_iteration();
+                 }
+                 return capture_view(stream.capture(), view, self);
+             })
+        .def_property_readonly("position", &signal_processor::CaptureStream::position);
+
+    py::class_<signal_processor::CaptureWriter>(m, "CaptureWriter", R"pbdoc(
+        Background-flushed recorder for processed samples
+
+        write() encodes a block into a large aligned buffer and returns;
+        a native thread writes full buffers to disk (O_DIRECT where the
+        filesystem allows it). With overflow="block" write() waits when all
+        buffers are still being written; with overflow="drop" it returns
+        early and the shortfall is counted in stats()["samples_dropped"].
+        huge_pages and numa_node place the buffers (see set_memory_policy()).
+
+            with CaptureWriter("rec", format="cs16", sigmf=True,
+                               sample_rate=2e6) as out:
+                for block in cap.stream():
+                    out.write(decimator.process(block))
+    )pbdoc")
+        .def(py::init([](const std::string& path, const std::string& format, double sample_rate,
+                         double center_frequency, bool sigmf, const std::string& description,
+                         const py::object& scale, std::size_t buffer_bytes, std::size_t num_buffers,
+                         const std::string& overflow, bool direct_io, const std::string& huge_pages,
+                         const py::object& numa_node) {
+                 signal_processor::CaptureWriterConfig config;
+                 config.format = signal_processor::parse_sample_format(format);
+                 config.sample_rate = sample_rate;
+                 config.center_frequency = center_frequency;
+                 config.sigmf = sigmf;
+                 config.description = description;
+                 config.scale = scale_or(scale, 0.0);
+                 config.buffer_bytes = buffer_bytes;
+                 config.num_buffers = num_buffers;
+                 config.direct_io = direct_io;
+                 config.overflow = overflow_policy(overflow);
+                 config.memory = memory_policy(huge_pages, numa_node);
+                 return std::make_unique<signal_processor::CaptureWriter>(path, config);
+             }),
+             py::arg("path"), py::arg("format") = "cf32", py::arg("sample_rate") = 0.0,
+             py::arg("center_frequency") = 0.0, py::arg("sigmf") = false,
+             py::arg("description") = "", py::arg("scale") = py::none(),
+             py::arg("buffer_bytes") = 4 << 20, py::arg("num_buffers") = 2,
+             py::arg("overflow") = "block", py::arg("direct_io") = true,
+             py::arg("huge_pages") = "transparent", py::arg("numa_node") = py::none())
+        .def("write",
+             [](signal_processor::CaptureWriter& self, const py::object& block) {
+                 // Dispatch on the writer's format, not the array's dtype, so
+                 // a complex block is never silently cast to float64
+                 if (signal_processor::is_complex_format(self.format())) {
+                     ComplexArray samples = ComplexArray::ensure(block);
+                     if (!samples) {
+                         throw py::error_already_set();
+                     }
+                     std::size_t length = vector_length(samples, "block");
+                     const std::complex<double>* data = samples.data();
+                     return without_gil([&] { return self.write(data, length); });
+                 }
+                 if (py::isinstance<py::array>(block) &&
+                     py::reinterpret_borrow<py::array>(block).dtype().kind() == 'c') {
+                     throw std::invalid_argument("Complex samples written to a real capture format");
+                 }
+                 RealArray samples = RealArray::ensure(block);
+                 if (!samples) {
+                     throw py::error_already_set();
+                 }
+                 std::size_t length = vector_length(samples, "block");
+                 const double* data = samples.data();
+                 return without_gil([&] { return self.write(data, length); });
+             },
+             py::arg("block"))
+        .def("flush", [](signal_processor::CaptureWriter& self) { without_gil([&] { self.flush(); }); })
+        .def("close", [](signal_processor::CaptureWriter& self) { without_gil([&] { self.close(); }); })
+        .def("__enter__", [](const py::object& self) { return self; })
+        .def("__exit__",
+             [](signal_processor::CaptureWriter& self, const py::args&) {
+                 without_gil([&] { self.close(); });
+             })
+        .def("stats",
+             [](const signal_processor::CaptureWriter& self) {
+                 signal_processor::CaptureWriterStats stats = self.stats();
+                 py::dict d;
+                 d["samples_written"] = stats.samples_written;
+                 d["samples_dropped"] = stats.samples_dropped;
+                 d["bytes_on_disk"] = stats.bytes_on_disk;
+                 d["backpressure_waits"] = stats.backpressure_waits;
+                 d["backpressure_seconds"] = stats.backpressure_seconds;
+                 d["buffers_pending"] = stats.buffers_pending;
+                 d["direct_io"] = stats.direct_io;
+                 return d;
+             })
+        .def_property_readonly("path", &signal_processor::CaptureWriter::data_path);
+
+    // ========================================================================
+    // FLOWGRAPH
+    // ========================================================================
+
+    using signal_processor::Stage;
+    py::class_<Stage, std::shared_ptr<Stage>>(m, "Stage",
+        "Base class of flowgraph stages (see Flowgraph)")
+        .def_property_readonly("name", &Stage::name);
+    py::class_<signal_processor::SourceStage, Stage, std::shared_ptr<signal_processor::SourceStage>>(
+        m, "SourceStage");
+    py::class_<signal_processor::ProcessStage, Stage, std::shared_ptr<signal_processor::ProcessStage>>(
+        m, "ProcessStage");
+    py::class_<signal_processor::SinkStage, Stage, std::shared_ptr<signal_processor::SinkStage>>(
+        m, "SinkStage");
+
+    py::class_<signal_processor::ToneSource, signal_processor::SourceStage,
+               std::shared_ptr<signal_processor::ToneSource>>(m, "ToneSource",
+        "Real sine plus Gaussian noise, phase-continuous across blocks")
+        .def(py::init<double, double, double, std::uint64_t, unsigned>(),
+             py::arg("frequency"), py::arg("sample_rate"), py::arg("noise_amplitude"),
+             py::arg("num_samples"), py::arg("seed") = 42);
+
+    py::class_<signal_processor::ArraySource, signal_processor::SourceStage,
+               std::shared_ptr<signal_processor::ArraySource>>(m, "ArraySource",
+        "Streams an array (float64 or complex) held in memory")
+        .def(py::init(&array_source), py::arg("samples"));
+
+    py::class_<signal_processor::CaptureSource, signal_processor::SourceStage,
+               std::shared_ptr<signal_processor::CaptureSource>>(m, "CaptureSource",
+        "Streams a raw or SigMF recording through a memory mapping")
+        .def(py::init([](const std::string& path, const std::string& format) {
+                 return std::make_shared<signal_processor::CaptureSource>(
+                     path, signal_processor::parse_sample_format(format));
+             }),
+             py::arg("path"), py::arg("format") = "cf32");
+
+    py::class_<signal_processor::FirStage, signal_processor::ProcessStage,
+               std::shared_ptr<signal_processor::FirStage>>(m, "FirStage",
+        "Streaming FIR filter (real or complex stream)")
+        .def(py::init([](const RealArray& taps) {
+                 return std::make_shared<signal_processor::FirStage>(to_vector(taps, "taps"));
+             }),
+             py::arg("taps"))
+        .def(py::init([](double cutoff_freq, int num_taps) {
+                 return std::make_shared<signal_processor::FirStage>(
+                     signal_processor::design_lowpass_filter(cutoff_freq, num_taps));
+             }),
+             py::arg("cutoff_freq"), py::arg("num_taps"));
+
+    py::class_<signal_processor::DecimatorStage, signal_processor::ProcessStage,
+               std::shared_ptr<signal_processor::DecimatorStage>>(m, "DecimatorStage",
+        "Anti-aliased decimation by an integer factor")
+        .def(py::init<int, int>(), py::arg("factor"), py::arg("num_taps") = 101)
+        .def(py::init([](int factor, const RealArray& taps) {
+                 return std::make_shared<signal_processor::DecimatorStage>(factor, to_vector(taps, "taps"));
+             }),
+             py::arg("factor"), py::arg("taps"));
+
+    py::class_<signal_processor::NcoStage, signal_processor::ProcessStage,
+               std::shared_ptr<signal_processor::NcoStage>>(m, "NcoStage",
+        "Frequency shift by `frequency` cycles per sample (emits complex samples)")
+        .def(py::init<double>(), py::arg("frequency"));
+
+    py::class_<signal_processor::SpectrumStage, signal_processor::ProcessStage,
+               std::shared_ptr<signal_processor::SpectrumStage>>(m, "SpectrumStage",
+        "Power spectrum of consecutive Hann-windowed frames (real input)")
+        .def(py::init<int>(), py::arg("fft_size"));
+
+    py::class_<signal_processor::PeakSink, signal_processor::SinkStage,
+               std::shared_ptr<signal_processor::PeakSink>>(m, "PeakSink",
+        "Collects the strongest frequency (Hz) of every spectrum frame")
+        .def(py::init<double>(), py::arg("sample_rate"))
+        .def_property_readonly("peaks", [](const signal_processor::PeakSink& self) {
+            return to_ndarray(std::vector<double>(self.peaks()));
+        });
+
+    py::class_<signal_processor::CollectSink, signal_processor::SinkStage,
+               std::shared_ptr<signal_processor::CollectSink>>(m, "CollectSink",
+        "Keeps every sample it receives")
+        .def(py::init<>())
+        .def_property_readonly("samples", [](const signal_processor::CollectSink& self) -> py::object {
+            if (self.complex()) {
+                return to_ndarray(std::vector<std::complex<double>>(self.iq()));
+            }
+            return to_ndarray(std::vector<double>(self.real()));
+        });
+
+    py::class_<signal_processor::WriterSink, signal_processor::SinkStage,
+               std::shared_ptr<signal_processor::WriterSink>>(m, "WriterSink",
+        "Records the stream to disk through a CaptureWriter")
+        .def(py::init([](const std::string& path, const std::string& format, double sample_rate,
+                         bool sigmf, const std::string& overflow) {
+                 signal_processor::CaptureWriterConfig config;
+                 config.format = signal_processor::parse_sample_format(format);
+                 config.sample_rate = sample_rate;
+                 config.sigmf = sigmf;
+                 config.overflow = overflow_policy(overflow);
+                 return std::make_shared<signal_processor::WriterSink>(path, config);
+             }),
+             py::arg("path"), py::arg("format") = "cf32", py::arg("sample_rate") = 0.0,
+             py::arg("sigmf") = false, py::arg("overflow") = "block")
+        .def("stats", [](const signal_processor::WriterSink& self) {
+            signal_processor::CaptureWriterStats stats = self.stats();
+            py::dict d;
+            d["samples_written"] = stats.samples_written;
+            d["samples_dropped"] = stats.samples_dropped;
+            d["bytes_on_disk"] = stats.bytes_on_disk;
+            return d;
+        });
+
+    py::class_<signal_processor::Flowgraph>(m, "Flowgraph", R"pbdoc(
+        Pipeline of stages, each on its own native thread
+
+        Stages are connected in list order by lock-free rings of sample
+        blocks: a source, any number of processing stages, then a sink.
+
+            peaks = PeakSink(1e6)
+            graph = Flowgraph([ToneSource(1e3, 1e6, 0.1, 10_000_000),
+                               FirStage(0.01, 101),
+                               SpectrumStage(1024),
+                               peaks], block_size=8192)
+            stats = graph.run()        # GIL released while it runs
+            peaks.peaks                # one frequency per 1024-sample frame
+
+        cpus optionally pins stage i to CPU cpus[i] (-1 = unpinned).
+        priority (1-99) runs every stage thread under SCHED_FIFO, and
+        lock_memory pre-faults the block rings and mlockall()s the process
+        with MCL_ONFAULT: pages are locked as they are touched, so a
+        CaptureSource's file is not read into locked RAM up front, and its
+        stream unlocks and drops the pages behind it as usual.
+        Whatever the system refuses is listed in the run's
+        stats["realtime_failures"]; the graph runs regardless.
+    )pbdoc")
+        .def(py::init([](const py::list& stages, std::size_t block_size, std::size_t queue_depth,
+                         const py::object& cpus, int priority, bool lock_memory) {
+                 std::vector<std::shared_ptr<Stage>> chain;
+                 for (const py::handle& stage : stages) {
+                     chain.push_back(stage.cast<std::shared_ptr<Stage>>());
+                 }
+                 signal_processor::FlowgraphConfig config;
+                 config.block_size = block_size;
+                 config.queue_depth = queue_depth;
+                 config.cpus = cpu_list(cpus);
+                 config.priority = priority;
+                 config.lock_memory = lock_memory;
+                 return std::make_unique<signal_processor::Flowgraph>(std::move(chain), config);
+             }),
+             py::arg("stages"), py::arg("block_size") = 8192, py::arg("queue_depth") = 8,
+             py::arg("cpus") = py::none(), py::arg("priority") = 0, py::arg("lock_memory") = false)
+        .def("run",
+             [](signal_processor::Flowgraph& self) {
+                 return flowgraph_stats(without_gil([&] { return self.run(); }));
+             })
+        .def("start", &signal_processor::Flowgraph::start)
+        .def("wait",
+             [](signal_processor::Flowgraph& self) {
+                 return flowgraph_stats(without_gil([&] { return self.wait(); }));
+             })
+        .def("stop", &signal_processor::Flowgraph::stop)
+        .def_property_readonly("stages", [](const signal_processor::Flowgraph& self) {
+            py::list result;
+            for (const auto& stage : self.stages()) {
+                result.append(py::cast(stage));
+            }
+            return result;
+        });
+
+    // ========================================================================
+    // ASYNC API
+    // ========================================================================
+
+    // Future type returned by submit_*(): a concurrent.futures.Future that
+    // can also be awaited directly from asyncio code.
+    py::dict scope;
+    scope["__builtins__"] = py::module_::import("builtins");
+    scope["__name__"] = "signal_processor_cpp";
+    py::exec(R"(
+import concurrent.futures
+
+class NativeFuture(concurrent.futures.Future):
+    """Result of a submit_*() call.
+
+    A regular concurrent.futures.Future (result(), add_done_callback(),
+    concurrent.futures.wait() all work) that is also awaitable:
+
+        spectrum = await sp.submit_fft(frame)
+    """
+
+    def __await__(self):
+        import asyncio
+        return asyncio.wrap_future(self).__await__()
+)", scope);
+    py::object future_class = scope["NativeFuture"];
+    native_future_type = future_class.inc_ref();
+    m.attr("NativeFuture") = future_class;
+
+    // Join the workers before the interpreter starts tearing down
+    py::module_::import("atexit").attr("register")(py::cpp_function(&shutdown_executor));
+
+    m.def("submit_filter",
+          [](const RealArray& input, double cutoff_freq, int num_taps, bool block) {
+              return submit_filter(input, cutoff_freq, num_taps, block);
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          py::arg("block") = true,
+          R"pbdoc(
+              Queue apply_lowpass_filter() on the native thread pool
+
+              Returns immediately with a NativeFuture; the filter runs
+              without the GIL. Small jobs queued back-to-back are picked up
+              in batches by the workers.
+
+              Args:
+                  input (array_like[float]): Input signal (float32 stays float32)
+                  cutoff_freq (float): Normalized cutoff frequency (0-1)
+                  num_taps (int): Number of filter coefficients
+                  block (bool): If the queue is full, wait for space (True)
+                                or raise queue.Full immediately (False)
+
+              Returns:
+                  NativeFuture: resolves to the filtered numpy.ndarray
+
+              Example:
+                  >>> fut = submit_filter(signal, 0.1, 51)
+                  >>> filtered = fut.result()          # threads
+                  >>> filtered = await submit_filter(signal, 0.1, 51)  # asyncio
+          )pbdoc");
+
+    m.def("submit_filter",
+          [](const Float32Array& input, double cutoff_freq, int num_taps, bool block) {
+              return submit_filter(input, cutoff_freq, num_taps, block);
+          },
+          py::arg("input"),
+          py::arg("cutoff_freq"),
+          py::arg("num_taps"),
+          py::arg("block") = true,
+          "Single-precision overload: resolves to a float32 array.");
+
+    m.def("submit_fft",
+          [](const RealArray& input, bool block) {
+              return submit_fft(input, block);
+          },
+          py::arg("input"),
+          py::arg("block") = true,
+          R"pbdoc(
+              Queue compute_fft() on the native thread pool
+
+              Args:
+                  input (array_like[float]): Real-valued signal samples.
+                                      int16/int8 arrays are scaled to full
+                                      scale (1/32768, 1/128) unless `scale`
+                                      is given, as for apply_lowpass_filter
+                  block (bool): Wait for queue space (True) or raise
+                                queue.Full when full (False)
+
+              Returns:
+                  NativeFuture: resolves to the complex numpy.ndarray spectrum
+          )pbdoc");
+
+    m.def("submit_fft",
+          [](const Float32Array& input, bool block) {
+              return submit_fft(input, block);
+          },
+          py::arg("input"),
+          py::arg("block") = true,
+          "Single-precision overload: resolves to a complex64 array.");
+
+    m.def("submit_snr",
+          [](const RealArray& signal, const RealArray& noisy, bool block) {
+              std::size_t length = vector_length(signal, "signal");
+              if (vector_length(noisy, "noisy") != length) {
+                  throw py::value_error("Signal and noisy vectors must have same size");
+              }
+              const double* clean = signal.data();
+              const double* received = noisy.data();
+              return submit_native(py::make_tuple(signal, noisy), length, block, [=] {
+                  return signal_processor::calculate_snr(clean, received, length);
+              });
+          },
+          py::arg("signal"),
+          py::arg("noisy"),
+          py::arg("block") = true,
+          R"pbdoc(
+              Queue calculate_snr() on the native thread pool
+
+              Returns:
+                  NativeFuture: resolves to the SNR in dB (float)
+          )pbdoc");
+
+    m.def("configure_executor",
+          [](std::size_t num_threads, std::size_t max_queue_depth, std::size_t batch_samples) {
+              auto previous = std::make_unique<signal_processor::AsyncExecutor>(
+                  num_threads, max_queue_depth, batch_samples);
+              std::swap(previous, executor_slot());
+              retire_executor(std::move(previous));
+          },
+          py::arg("num_threads") = 0,
+          py::arg("max_queue_depth") = 1024,
+          py::arg("batch_samples") = 65536,
+          R"pbdoc(
+              Replace the native thread pool used by submit_*()
+
+              Jobs already queued on the old pool are completed first.
+
+              Args:
+                  num_threads (int): Worker threads (0 = one per core)
+                  max_queue_depth (int): Queued jobs allowed before submit_*()
+                                         blocks (or raises with block=False)
+                  batch_samples (int): Queued jobs are batched together while
+                                       their total sample count stays below this
+          )pbdoc");
+
+    m.def("executor_stats",
+          []() {
+              signal_processor::AsyncExecutorStats stats = default_executor().stats();
+              py::dict d;
+              d["num_threads"] = stats.num_threads;
+              d["queue_depth"] = stats.queue_depth;
+              d["max_queue_depth"] = stats.max_queue_depth;
+              d["jobs_completed"] = stats.jobs_completed;
+              d["batches_run"] = stats.batches_run;
+              d["jobs_rejected"] = stats.jobs_rejected;
+              return d;
+          },
+          "Counters of the native thread pool (queue depth, jobs, batches, rejections).");
+
+    // ========================================================================
+    // INSTRUMENTATION (builds with -DSIGNAL_PROCESSOR_INSTRUMENTATION=ON)
+    // ========================================================================
+
+    m.def("instrumentation_enabled", &signal_processor::instrumentation_enabled,
+          "True when the library was built with stage instrumentation probes.");
+
+    m.def("instrumentation_snapshot",
+          [] {
+              signal_processor::InstrumentationSnapshot snapshot = signal_processor::instrumentation_snapshot();
+              constexpr double kSeconds = 1e-9;
+              py::dict probes;
+              for (const signal_processor::ProbeSnapshot& probe : snapshot.probes) {
+                  py::list histogram;
+                  for (const auto& [upper, count] : probe.histogram) {
+                      histogram.append(py::make_tuple(upper * kSeconds, count));
+                  }
+                  py::dict d;
+                  d["calls"] = probe.calls;
+                  d["samples"] = probe.samples;
+                  d["allocations"] = probe.allocations;
+                  d["total_seconds"] = probe.total_ns * kSeconds;
+                  d["mean"] = probe.mean_ns() * kSeconds;
+                  d["min"] = probe.min_ns * kSeconds;
+                  d["max"] = probe.max_ns * kSeconds;
+                  d["p50"] = probe.percentile_ns(0.50) * kSeconds;
+                  d["p90"] = probe.percentile_ns(0.90) * kSeconds;
+                  d["p99"] = probe.percentile_ns(0.99) * kSeconds;
+                  d["p999"] = probe.percentile_ns(0.999) * kSeconds;
+                  d["budget"] = probe.budget_ns > 0 ? py::object(py::float_(probe.budget_ns * kSeconds))
+                                                    : py::object(py::none());
+                  d["budget_violations"] = probe.budget_violations;
+                  d["histogram"] = histogram;
+                  py::dict hardware;
+                  for (std::size_t i = 0; i < signal_processor::kPerfEventCount; ++i) {
+                      auto event = static_cast<signal_processor::PerfEvent>(i);
+                      if (probe.hardware.has(event)) {
+                          hardware[signal_processor::perf_event_name(event)] = probe.hardware[event];
+                      }
+                  }
+                  d["hardware_calls"] = probe.hardware_calls;
+                  d["hardware"] = hardware;
+                  probes[py::str(probe.name)] = d;
+              }
+              py::dict d;
+              d["enabled"] = snapshot.enabled;
+              d["threads"] = snapshot.threads;
+              d["probes"] = probes;
+              return d;
+          },
+          R"pbdoc(
+            Counters of every instrumentation probe, summed over all threads.
+
+            Returns:
+                {"enabled": bool, "threads": int, "probes": {name: probe}} where
+                each probe has calls, samples, allocations, total_seconds,
+                mean/min/max/p50/p90/p99/p999 latencies in seconds, budget
+                (seconds or None), budget_violations, histogram - a list
+                of (upper bound in seconds, calls) per non-empty bucket - and
+                hardware: {"cycles": n, "llc_misses": n, ...} summed over the
+                hardware_calls made with set_probe_hardware_counters(True).
+                Kernels are probed by function name ("compute_fft",
+                "streaming_fir", ...) and flowgraph stages as
+                "flowgraph.<index>.<name>". Empty when not enabled.
+          )pbdoc");
+
+    m.def("set_probe_hardware_counters",
+          [](bool enabled) { return string_list(signal_processor::set_probe_hardware_counters(enabled)); },
+          py::arg("enabled"),
+          R"pbdoc(
+            Count cycles, instructions, cache misses and branch mispredicts in
+            every probe (perf_event_open). Costs ~1-2 µs per probed call.
+
+            Returns:
+                list[str]: counters this thread could not open and why (no
+                PMU in a VM, perf_event_paranoid, ...); empty when all opened
+          )pbdoc");
+
+    m.def("reset_instrumentation", &signal_processor::reset_instrumentation,
+          "Zero every instrumentation counter.");
+
+    m.def("set_latency_budget",
+          [](const std::string& name, const py::object& seconds) {
+              double budget = seconds.is_none() ? 0.0 : seconds.cast<double>();
+              if (!(budget >= 0.0) || !std::isfinite(budget)) {
+                  throw std::invalid_argument("Latency budget must be a finite, non-negative number of seconds");
+              }
+              // 0 ns means "no budget", so a positive budget must not round to it
+              long long nanoseconds = std::llround(budget * 1e9);
+              if (budget > 0.0 && nanoseconds == 0) {
+                  throw std::invalid_argument("Latency budget must be at least 1 ns (use None to remove it)");
+              }
+              signal_processor::set_latency_budget(name, static_cast<std::uint64_t>(nanoseconds));
+          },
+          py::arg("name"),
+          py::arg("seconds"),
+          "Count calls of probe `name` slower than `seconds` as budget_violations (None removes the budget).");
+
+    // ========================================================================
+    // TIMELINE TRACING (Chrome trace JSON, viewable in ui.perfetto.dev)
+    // ========================================================================
+
+    m.def("start_tracing", &signal_processor::start_tracing,
+          py::arg("events_per_thread") = 1 << 16,
+          R"pbdoc(
+            Record flowgraph stage and kernel spans, block sequence numbers and
+            queue depths on every thread, discarding any earlier trace.
+
+            Args:
+                events_per_thread (int): Ring size per thread; once full the
+                                         oldest events are overwritten
+          )pbdoc");
+
+    m.def("stop_tracing", &signal_processor::stop_tracing,
+          "Stop recording; the events stay available for trace_json()/write_trace().");
+
+    m.def("tracing_enabled", &signal_processor::tracing_enabled,
+          "True between start_tracing() and stop_tracing().");
+
+    m.def("clear_trace", &signal_processor::clear_trace, "Drop every recorded trace event.");
+
+    m.def("trace_json", &signal_processor::trace_json,
+          "The recorded events as a Chrome trace JSON document (str).");
+
+    m.def("write_trace",
+          [](const std::string& path) {
+              py::gil_scoped_release release;
+              signal_processor::write_trace(path);
+          },
+          py::arg("path"),
+          "Write trace_json() to `path` - open it in ui.perfetto.dev or chrome://tracing.");
+
     // Version information
     #ifdef VERSION_INFO
         m.attr("__version__") = VERSION_INFO;
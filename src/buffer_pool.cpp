@@ -0,0 +1,402 @@
+#include "buffer_pool.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace signal_processor {
+
+namespace {
+
+constexpr std::size_t kMinClassShift = 6;        // 64 bytes
+constexpr std::size_t kNumClasses = 42;          // Up to 2^47 bytes
+constexpr std::size_t kHugePage = 2 << 20;
+
+std::size_t class_index(std::size_t bytes) {
+    std::size_t shift = kMinClassShift;
+    while ((std::size_t{1} << shift) < bytes) {
+        ++shift;
+    }
+    if (shift - kMinClassShift >= kNumClasses) {
+        throw std::bad_alloc();
+    }
+    return shift - kMinClassShift;
+}
+
+std::size_t index_size(std::size_t index) {
+    return std::size_t{1} << (index + kMinClassShift);
+}
+
+} // namespace
+
+// ============================================================================
+// SHARED STATE
+// ============================================================================
+
+struct BufferPool::Core {
+    struct SizeClass {
+        std::mutex mutex;
+        std::vector<void*> free;
+    };
+
+    explicit Core(const BufferPoolConfig& pool_config) : config(pool_config), policy(pool_config.memory) {}
+
+    ~Core() {
+        for (std::size_t i = 0; i < kNumClasses; ++i) {
+            for (void* buffer : classes[i].free) {
+                system_free(buffer, index_size(i));
+            }
+        }
+    }
+
+    MemoryPolicy memory_policy() const {
+        std::lock_guard<std::mutex> lock(mappings_mutex);
+        return policy;
+    }
+
+    static bool mapped(std::size_t class_bytes) {
+        return class_bytes >= kHugePage;
+    }
+
+    void* system_allocate(std::size_t class_bytes) {
+        void* buffer = nullptr;
+        if (mapped(class_bytes)) {
+            // Large buffers are mapped per the memory policy; the mapping
+            // is remembered so system_free() can undo exactly what was done
+            MemoryPolicy current = memory_policy();
+            MappedMemory memory(class_bytes, current);
+            if (detail::huge_page_size(current.huge_pages, class_bytes) != 0) {
+                if (memory.huge_pages() == HugePages::Huge2M || memory.huge_pages() == HugePages::Huge1G) {
+                    huge_page_bytes.fetch_add(memory.size(), std::memory_order_relaxed);
+                } else {
+                    huge_page_fallbacks.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (current.numa_node >= 0 && !memory.numa_bound()) {
+                numa_bind_failures.fetch_add(1, std::memory_order_relaxed);
+            }
+            buffer = memory.data();
+            std::lock_guard<std::mutex> lock(mappings_mutex);
+            mappings.emplace(buffer, std::move(memory));
+        } else {
+            buffer = std::aligned_alloc(kAlignment, class_bytes);
+            if (buffer == nullptr) {
+                throw std::bad_alloc();
+            }
+        }
+        system_allocations.fetch_add(1, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    void system_free(void* buffer, std::size_t class_bytes) {
+        if (mapped(class_bytes)) {
+            std::lock_guard<std::mutex> lock(mappings_mutex);
+            auto it = mappings.find(buffer);
+            HugePages pages = it->second.huge_pages();
+            if (pages == HugePages::Huge2M || pages == HugePages::Huge1G) {
+                huge_page_bytes.fetch_sub(it->second.size(), std::memory_order_relaxed);
+            }
+            mappings.erase(it);
+        } else {
+            std::free(buffer);
+        }
+        system_frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Back into the shared list, or to the system if the pool holds enough
+    void give_back(void* buffer, std::size_t index) {
+        std::size_t bytes = index_size(index);
+        if (!orphaned.load(std::memory_order_acquire) &&
+            bytes_cached.load(std::memory_order_relaxed) + bytes <= config.max_cached_bytes) {
+            SizeClass& size_class = classes[index];
+            std::lock_guard<std::mutex> lock(size_class.mutex);
+            size_class.free.push_back(buffer);
+            bytes_cached.fetch_add(bytes, std::memory_order_relaxed);
+            return;
+        }
+        system_free(buffer, bytes);
+    }
+
+    void trim() {
+        for (std::size_t i = 0; i < kNumClasses; ++i) {
+            std::vector<void*> buffers;
+            {
+                std::lock_guard<std::mutex> lock(classes[i].mutex);
+                buffers.swap(classes[i].free);
+            }
+            for (void* buffer : buffers) {
+                bytes_cached.fetch_sub(index_size(i), std::memory_order_relaxed);
+                system_free(buffer, index_size(i));
+            }
+        }
+    }
+
+    const BufferPoolConfig config;
+    std::array<SizeClass, kNumClasses> classes;
+
+    mutable std::mutex mappings_mutex;    // Guards policy and mappings
+    MemoryPolicy policy;
+    std::unordered_map<void*, MappedMemory> mappings;
+    std::atomic<bool> orphaned{false};    // The BufferPool object is gone
+
+    std::atomic<std::uint64_t> acquires{0};
+    std::atomic<std::uint64_t> thread_cache_hits{0};
+    std::atomic<std::uint64_t> shared_hits{0};
+    std::atomic<std::uint64_t> system_allocations{0};
+    std::atomic<std::uint64_t> system_frees{0};
+    std::atomic<std::size_t> bytes_in_use{0};
+    std::atomic<std::size_t> bytes_cached{0};
+    std::atomic<std::size_t> huge_page_bytes{0};
+    std::atomic<std::uint64_t> huge_page_fallbacks{0};
+    std::atomic<std::uint64_t> numa_bind_failures{0};
+};
+
+// ============================================================================
+// PER-THREAD CACHES
+// ============================================================================
+
+/**
+ * A thread's private free lists for one pool. Holding the Core keeps it
+ * alive after the pool object is destroyed; the lists are handed back
+ * (or freed) when the thread exits.
+ */
+struct BufferPool::ThreadCache {
+    explicit ThreadCache(std::shared_ptr<Core> pool_core) : core(std::move(pool_core)) {}
+
+    ~ThreadCache() {
+        for (std::size_t i = 0; i < kNumClasses; ++i) {
+            for (void* buffer : lists[i]) {
+                core->bytes_cached.fetch_sub(index_size(i), std::memory_order_relaxed);
+                core->give_back(buffer, i);
+            }
+        }
+    }
+
+    std::shared_ptr<Core> core;
+    std::array<std::vector<void*>, kNumClasses> lists;
+};
+
+namespace {
+
+// Set once the thread's caches are gone. Plain bool, so it stays readable
+// while later thread_local destructors (e.g. a FrameArena) still release.
+thread_local bool thread_caches_destroyed = false;
+
+} // namespace
+
+BufferPool::ThreadCache* BufferPool::thread_cache(const std::shared_ptr<Core>& core) {
+    struct Caches {
+        std::vector<std::unique_ptr<ThreadCache>> list;
+        ~Caches() {
+            list.clear();
+            thread_caches_destroyed = true;
+        }
+    };
+    if (thread_caches_destroyed) {
+        return nullptr;
+    }
+    thread_local Caches caches;
+    for (auto& cache : caches.list) {
+        if (cache->core == core) {
+            return cache.get();
+        }
+    }
+    caches.list.push_back(std::make_unique<ThreadCache>(core));
+    return caches.list.back().get();
+}
+
+// ============================================================================
+// BUFFER POOL
+// ============================================================================
+
+BufferPool::BufferPool(const BufferPoolConfig& config) : core_(std::make_shared<Core>(config)) {}
+
+BufferPool::~BufferPool() {
+    core_->orphaned.store(true, std::memory_order_release);
+    core_->trim();
+}
+
+std::size_t BufferPool::class_size(std::size_t bytes) {
+    return index_size(class_index(bytes));
+}
+
+void* BufferPool::acquire(std::size_t bytes) {
+    Core& core = *core_;
+    std::size_t index = class_index(bytes);
+    std::size_t size = index_size(index);
+    core.acquires.fetch_add(1, std::memory_order_relaxed);
+    core.bytes_in_use.fetch_add(size, std::memory_order_relaxed);
+
+    ThreadCache* cache = size <= core.config.thread_cache_max_bytes && core.config.thread_cache_buffers > 0
+                             ? thread_cache(core_)
+                             : nullptr;
+    if (cache != nullptr) {
+        std::vector<void*>& list = cache->lists[index];
+        if (!list.empty()) {
+            void* buffer = list.back();
+            list.pop_back();
+            core.bytes_cached.fetch_sub(size, std::memory_order_relaxed);
+            core.thread_cache_hits.fetch_add(1, std::memory_order_relaxed);
+            return buffer;
+        }
+    }
+
+    {
+        Core::SizeClass& size_class = core.classes[index];
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!size_class.free.empty()) {
+            void* buffer = size_class.free.back();
+            size_class.free.pop_back();
+            core.bytes_cached.fetch_sub(size, std::memory_order_relaxed);
+            core.shared_hits.fetch_add(1, std::memory_order_relaxed);
+            return buffer;
+        }
+    }
+
+    try {
+        return core.system_allocate(size);
+    } catch (...) {
+        core.bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+        throw;
+    }
+}
+
+void BufferPool::release(void* buffer, std::size_t bytes) {
+    if (buffer == nullptr) {
+        return;
+    }
+    Core& core = *core_;
+    std::size_t index = class_index(bytes);
+    std::size_t size = index_size(index);
+    core.bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+
+    ThreadCache* cache = size <= core.config.thread_cache_max_bytes && core.config.thread_cache_buffers > 0
+                             ? thread_cache(core_)
+                             : nullptr;
+    if (cache != nullptr) {
+        std::vector<void*>& list = cache->lists[index];
+        if (list.size() < core.config.thread_cache_buffers) {
+            list.push_back(buffer);
+            core.bytes_cached.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+    }
+    core.give_back(buffer, index);
+}
+
+void BufferPool::trim() {
+    core_->trim();
+}
+
+void BufferPool::set_memory_policy(const MemoryPolicy& policy) {
+    {
+        std::lock_guard<std::mutex> lock(core_->mappings_mutex);
+        core_->policy = policy;
+    }
+    core_->trim();
+}
+
+MemoryPolicy BufferPool::memory_policy() const {
+    return core_->memory_policy();
+}
+
+BufferPoolStats BufferPool::stats() const {
+    const Core& core = *core_;
+    BufferPoolStats result;
+    result.acquires = core.acquires.load(std::memory_order_relaxed);
+    result.thread_cache_hits = core.thread_cache_hits.load(std::memory_order_relaxed);
+    result.shared_hits = core.shared_hits.load(std::memory_order_relaxed);
+    result.system_allocations = core.system_allocations.load(std::memory_order_relaxed);
+    result.system_frees = core.system_frees.load(std::memory_order_relaxed);
+    result.bytes_in_use = core.bytes_in_use.load(std::memory_order_relaxed);
+    result.bytes_cached = core.bytes_cached.load(std::memory_order_relaxed);
+    result.huge_page_bytes = core.huge_page_bytes.load(std::memory_order_relaxed);
+    result.huge_page_fallbacks = core.huge_page_fallbacks.load(std::memory_order_relaxed);
+    result.numa_bind_failures = core.numa_bind_failures.load(std::memory_order_relaxed);
+    return result;
+}
+
+BufferPool& default_buffer_pool() {
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+// ============================================================================
+// FRAME ARENA
+// ============================================================================
+
+FrameArena::FrameArena(BufferPool& pool, std::size_t block_bytes, std::size_t retain_bytes)
+    : pool_(pool), block_bytes_(std::max(block_bytes, BufferPool::kAlignment)),
+      retain_bytes_(retain_bytes) {}
+
+FrameArena::~FrameArena() {
+    for (const Block& block : blocks_) {
+        pool_.release(block.data, block.size);
+    }
+}
+
+void* FrameArena::allocate_bytes(std::size_t bytes) {
+    // Keep every allocation aligned for SIMD
+    bytes = (bytes + BufferPool::kAlignment - 1) & ~(BufferPool::kAlignment - 1);
+    bytes = std::max(bytes, BufferPool::kAlignment);
+
+    if (current_ < blocks_.size() && offset_ + bytes > blocks_[current_].size) {
+        // Move on; the rest of this block stays unused until the rewind
+        ++current_;
+        offset_ = 0;
+    }
+    if (current_ == blocks_.size() || blocks_[current_].size < bytes) {
+        std::size_t size = BufferPool::class_size(std::max(block_bytes_, bytes));
+        blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(current_),
+                       Block{pool_.acquire(size), size});
+        offset_ = 0;
+    }
+
+    void* result = static_cast<char*>(blocks_[current_].data) + offset_;
+    offset_ += bytes;
+    return result;
+}
+
+void FrameArena::rewind(const Mark& mark) {
+    current_ = mark.block;
+    offset_ = mark.offset;
+    if (current_ != 0 || offset_ != 0) {
+        return;
+    }
+    // Empty again: drop blocks beyond the retention limit, largest last
+    std::size_t kept = 0;
+    std::size_t i = 0;
+    for (; i < blocks_.size() && kept + blocks_[i].size <= retain_bytes_; ++i) {
+        kept += blocks_[i].size;
+    }
+    for (std::size_t j = i; j < blocks_.size(); ++j) {
+        pool_.release(blocks_[j].data, blocks_[j].size);
+    }
+    blocks_.resize(i);
+}
+
+std::size_t FrameArena::bytes_used() const {
+    std::size_t used = offset_;
+    for (std::size_t i = 0; i < current_ && i < blocks_.size(); ++i) {
+        used += blocks_[i].size;
+    }
+    return used;
+}
+
+std::size_t FrameArena::capacity() const {
+    std::size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+FrameArena& thread_frame_arena() {
+    thread_local FrameArena arena(default_buffer_pool());
+    return arena;
+}
+
+} // namespace signal_processor
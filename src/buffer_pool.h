@@ -0,0 +1,273 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include "memory_policy.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Pooled Buffers and Per-Frame Arenas
+ *
+ * A filter or FFT call needs scratch space: FFTW input/output arrays, a
+ * conversion work buffer, rounded taps. Taking each from malloc costs a
+ * lock or a system call, and large buffers come back as fresh, unmapped
+ * pages whose first touch page-faults. Processing the same frame size over
+ * and over should reuse the same memory instead:
+ *
+ * 1. BufferPool keeps released buffers in power-of-two size classes and
+ *    hands them out again. Every buffer is 64-byte aligned (cache line,
+ *    AVX-512 vector)
+ * 2. Each thread keeps a few small buffers per class in a private cache,
+ *    so the common acquire/release pair takes no lock at all
+ * 3. Buffers of 2 MiB and up are mapped according to a MemoryPolicy
+ *    (see memory_policy.h): by default 2 MiB-aligned and marked for
+ *    transparent huge pages - one TLB entry covers 512x more memory, which
+ *    matters for multi-megabyte FFT frames - or from explicit 2 MiB/1 GiB
+ *    huge pages, bound to a NUMA node
+ * 4. FrameArena carves a frame's temporaries out of a few pooled blocks
+ *    with a pointer bump, and frees all of them at once at the end of the
+ *    frame
+ *
+ * After the first frame of a given size, steady-state processing takes
+ * every temporary from the pool and performs no malloc.
+ *
+ *   FrameArena& arena = thread_frame_arena();
+ *   ArenaScope frame(arena);                     // rewinds on scope exit
+ *   double* work = frame.allocate<double>(n);
+ *   std::complex<double>* bins = frame.allocate<std::complex<double>>(n / 2 + 1);
+ */
+
+namespace signal_processor {
+
+struct BufferPoolConfig {
+    MemoryPolicy memory;                          // Placement of buffers >= 2 MiB
+    std::size_t thread_cache_buffers = 4;         // Per size class, per thread
+    std::size_t thread_cache_max_bytes = 1 << 20; // Larger classes skip the thread caches
+    std::size_t max_cached_bytes = 256 << 20;     // Shared free lists beyond this go back to the OS
+};
+
+struct BufferPoolStats {
+    std::uint64_t acquires = 0;
+    std::uint64_t thread_cache_hits = 0;     // Served without a lock
+    std::uint64_t shared_hits = 0;           // Served from the shared free lists
+    std::uint64_t system_allocations = 0;    // Had to ask the OS / malloc
+    std::uint64_t system_frees = 0;
+    std::size_t bytes_in_use = 0;            // Handed out and not yet released
+    std::size_t bytes_cached = 0;            // Held in free lists (shared and per-thread)
+    std::size_t huge_page_bytes = 0;         // Mapped from explicit huge pages (2 MiB / 1 GiB)
+    std::uint64_t huge_page_fallbacks = 0;   // Explicit huge pages requested but unavailable
+    std::uint64_t numa_bind_failures = 0;    // NUMA binding requested but refused
+};
+
+class BufferPool {
+public:
+    // Alignment of every buffer
+    static constexpr std::size_t kAlignment = 64;
+
+    explicit BufferPool(const BufferPoolConfig& config = {});
+
+    // Frees every cached buffer. Buffers still in use must not be released
+    // afterwards; thread caches drop theirs when their threads exit.
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * A buffer of at least `bytes` bytes (uninitialized)
+     *
+     * @throws std::bad_alloc if the system is out of memory
+     */
+    void* acquire(std::size_t bytes);
+
+    // Give back a buffer from acquire(); `bytes` must be the size requested
+    void release(void* buffer, std::size_t bytes);
+
+    // Return every buffer in the shared free lists to the system
+    void trim();
+
+    /**
+     * Placement of buffers >= 2 MiB allocated from now on
+     *
+     * Trims the shared free lists, so cached large buffers are not handed
+     * out again under the old policy. Buffers in use keep their placement.
+     */
+    void set_memory_policy(const MemoryPolicy& policy);
+    MemoryPolicy memory_policy() const;
+
+    // Size actually reserved for a request of `bytes` (its size class)
+    static std::size_t class_size(std::size_t bytes);
+
+    BufferPoolStats stats() const;
+
+private:
+    struct Core;
+    struct ThreadCache;
+    static ThreadCache* thread_cache(const std::shared_ptr<Core>& core);
+
+    // Shared with the thread caches, which may outlive the pool object
+    std::shared_ptr<Core> core_;
+};
+
+/**
+ * Process-wide pool, used wherever no pool is passed explicitly. Never
+ * destroyed, so it is safe to use from static destructors and thread exit.
+ */
+BufferPool& default_buffer_pool();
+
+/**
+ * RAII handle to `count` uninitialized T from a BufferPool
+ *
+ * Move-only. The pool must outlive the buffer.
+ */
+template <typename T>
+class PooledBuffer {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "PooledBuffer holds raw memory; T must be a plain sample type");
+
+public:
+    PooledBuffer() = default;
+    PooledBuffer(BufferPool& pool, std::size_t count)
+        : pool_(&pool), data_(static_cast<T*>(pool.acquire(count * sizeof(T)))), count_(count) {}
+
+    ~PooledBuffer() { reset(); }
+
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : pool_(other.pool_), data_(other.data_), count_(other.count_) {
+        other.data_ = nullptr;
+        other.count_ = 0;
+    }
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            pool_ = other.pool_;
+            data_ = std::exchange(other.data_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+        }
+        return *this;
+    }
+
+    T* data() const { return data_; }
+    std::size_t size() const { return count_; }
+    T& operator[](std::size_t i) const { return data_[i]; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + count_; }
+
+    // Return the memory to the pool now
+    void reset() {
+        if (data_ != nullptr) {
+            pool_->release(data_, count_ * sizeof(T));
+            data_ = nullptr;
+            count_ = 0;
+        }
+    }
+
+private:
+    BufferPool* pool_ = nullptr;
+    T* data_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+// ============================================================================
+// PER-FRAME ARENA
+// ============================================================================
+
+/**
+ * Bump allocator for the temporaries of one frame
+ *
+ * allocate() is a pointer increment inside a pooled block; rewind()/reset()
+ * frees everything allocated since a mark in O(1). Blocks are kept between
+ * frames (up to `retain_bytes`), so once the arena has grown to the
+ * largest frame it never touches the pool again. Not thread-safe: use one
+ * arena per thread (see thread_frame_arena()).
+ */
+class FrameArena {
+public:
+    struct Mark {
+        std::size_t block = 0;
+        std::size_t offset = 0;
+    };
+
+    /**
+     * @param pool Source of the arena's blocks
+     * @param block_bytes Minimum block size
+     * @param retain_bytes Blocks beyond this are released when the arena
+     *                     is rewound to empty
+     */
+    explicit FrameArena(BufferPool& pool = default_buffer_pool(),
+                        std::size_t block_bytes = 256 << 10,
+                        std::size_t retain_bytes = 32 << 20);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // `count` uninitialized T, aligned to BufferPool::kAlignment
+    template <typename T>
+    T* allocate(std::size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena memory is never destroyed element by element");
+        return static_cast<T*>(allocate_bytes(count * sizeof(T)));
+    }
+
+    Mark mark() const { return {current_, offset_}; }
+
+    // Free everything allocated after `mark`
+    void rewind(const Mark& mark);
+
+    // Free everything
+    void reset() { rewind(Mark{}); }
+
+    std::size_t bytes_used() const;
+    std::size_t capacity() const;
+
+private:
+    struct Block {
+        void* data;
+        std::size_t size;
+    };
+
+    void* allocate_bytes(std::size_t bytes);
+
+    BufferPool& pool_;
+    std::size_t block_bytes_;
+    std::size_t retain_bytes_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;     // Block being carved
+    std::size_t offset_ = 0;      // Bytes used in it
+};
+
+/**
+ * Allocations that end with the enclosing C++ scope
+ *
+ * Scopes nest: an inner scope only frees what was allocated inside it.
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(FrameArena& arena) : arena_(arena), mark_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(mark_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    template <typename T>
+    T* allocate(std::size_t count) {
+        return arena_.allocate<T>(count);
+    }
+
+private:
+    FrameArena& arena_;
+    FrameArena::Mark mark_;
+};
+
+// The calling thread's arena (backed by default_buffer_pool())
+FrameArena& thread_frame_arena();
+
+} // namespace signal_processor
+
+#endif // BUFFER_POOL_H
@@ -0,0 +1,498 @@
+#include "capture_reader.h"
+#include "sample_convert.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace signal_processor {
+
+// ============================================================================
+// SAMPLE FORMATS
+// ============================================================================
+
+namespace {
+
+struct FormatInfo {
+    SampleFormat format;
+    const char* name;
+    const char* sigmf_name;  // core:datatype without the endianness suffix
+    bool complex;
+    std::size_t size;
+};
+
+constexpr FormatInfo kFormats[] = {
+    {SampleFormat::F32, "f32", "rf32", false, 4},
+    {SampleFormat::F64, "f64", "rf64", false, 8},
+    {SampleFormat::S16, "s16", "ri16", false, 2},
+    {SampleFormat::S8, "s8", "ri8", false, 1},
+    {SampleFormat::CF32, "cf32", "cf32", true, 8},
+    {SampleFormat::CF64, "cf64", "cf64", true, 16},
+    {SampleFormat::CS16, "cs16", "ci16", true, 4},
+    {SampleFormat::CS8, "cs8", "ci8", true, 2},
+};
+
+const FormatInfo& format_info(SampleFormat format) {
+    for (const auto& info : kFormats) {
+        if (info.format == format) {
+            return info;
+        }
+    }
+    throw std::invalid_argument("Unknown sample format");
+}
+
+} // namespace
+
+SampleFormat parse_sample_format(const std::string& name) {
+    for (const auto& info : kFormats) {
+        if (name == info.name) {
+            return info.format;
+        }
+    }
+    throw std::invalid_argument("Unknown sample format '" + name +
+                                "' (expected f32, f64, s16, s8, cf32, cf64, cs16 or cs8)");
+}
+
+const char* sample_format_name(SampleFormat format) {
+    return format_info(format).name;
+}
+
+bool is_complex_format(SampleFormat format) {
+    return format_info(format).complex;
+}
+
+std::size_t sample_format_size(SampleFormat format) {
+    return format_info(format).size;
+}
+
+SampleFormat parse_sigmf_datatype(const std::string& datatype) {
+    /**
+     * SigMF datatypes are <c|r><f|i|u><bits>[_le|_be]. The suffix is
+     * mandatory for multi-byte types; single-byte types omit it.
+     */
+    std::string base = datatype;
+    if (base.size() > 3 && base.compare(base.size() - 3, 3, "_be") == 0) {
+        throw std::invalid_argument("Big-endian SigMF datatype '" + datatype + "' is not supported");
+    }
+    if (base.size() > 3 && base.compare(base.size() - 3, 3, "_le") == 0) {
+        base.resize(base.size() - 3);
+    }
+    for (const auto& info : kFormats) {
+        if (base == info.sigmf_name) {
+            return info.format;
+        }
+    }
+    throw std::invalid_argument("Unsupported SigMF datatype '" + datatype + "'");
+}
+
+std::string sigmf_datatype(SampleFormat format) {
+    const FormatInfo& info = format_info(format);
+    std::string name = info.sigmf_name;
+    // Byte order is only meaningful (and only written) for multi-byte types
+    bool single_byte = info.size / (info.complex ? 2 : 1) == 1;
+    return single_byte ? name : name + "_le";
+}
+
+// ============================================================================
+// SIGMF METADATA
+// ============================================================================
+
+namespace {
+
+/**
+ * Minimal JSON reader for .sigmf-meta files
+ *
+ * Only the handful of core fields we need are extracted; everything else
+ * (annotations, extensions) is parsed for well-formedness and skipped.
+ */
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : text_(text) {}
+
+    // Calls on_field(path, value) for every string/number leaf, where path
+    // is "global.core:datatype", "captures.0.core:frequency", ...
+    template <typename Callback>
+    void parse(Callback&& on_field) {
+        skip_space();
+        value("", on_field);
+        skip_space();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+    }
+
+private:
+    template <typename Callback>
+    void value(const std::string& path, Callback& on_field) {
+        skip_space();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+        char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            skip_space();
+            if (consume('}')) {
+                return;
+            }
+            do {
+                skip_space();
+                std::string key = string();
+                skip_space();
+                expect(':');
+                value(path.empty() ? key : path + "." + key, on_field);
+                skip_space();
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            ++pos_;
+            skip_space();
+            if (consume(']')) {
+                return;
+            }
+            std::size_t index = 0;
+            do {
+                value(path + "." + std::to_string(index++), on_field);
+                skip_space();
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            on_field(path, string());
+        } else if (text_.compare(pos_, 4, "true") == 0 || text_.compare(pos_, 4, "null") == 0) {
+            pos_ += 4;
+        } else if (text_.compare(pos_, 5, "false") == 0) {
+            pos_ += 5;
+        } else {
+            std::size_t start = pos_;
+            while (pos_ < text_.size() && std::strchr("+-.0123456789eE", text_[pos_]) != nullptr) {
+                ++pos_;
+            }
+            if (start == pos_) {
+                fail("unexpected character");
+            }
+            on_field(path, text_.substr(start, pos_ - start));
+        }
+    }
+
+    std::string string() {
+        expect('"');
+        std::string result;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\' && pos_ < text_.size()) {
+                char escaped = text_[pos_++];
+                switch (escaped) {
+                    case 'n': result += '\n'; break;
+                    case 't': result += '\t'; break;
+                    case 'r': result += '\r'; break;
+                    case 'b': result += '\b'; break;
+                    case 'f': result += '\f'; break;
+                    case 'u': pos_ = std::min(pos_ + 4, text_.size()); result += '?'; break;
+                    default: result += escaped; break;
+                }
+            } else {
+                result += c;
+            }
+        }
+        expect('"');
+        return result;
+    }
+
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::invalid_argument("Malformed SigMF metadata at offset " +
+                                    std::to_string(pos_) + ": " + what);
+    }
+
+    const std::string& text_;
+    std::size_t pos_ = 0;
+};
+
+double parse_double(const std::string& path, const std::string& text) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0') {
+        throw std::invalid_argument("SigMF field " + path + " is not a number");
+    }
+    return value;
+}
+
+bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+// ============================================================================
+// MAPPED CAPTURE
+// ============================================================================
+
+MappedCapture::MappedCapture(const std::string& path, SampleFormat format, std::size_t header_bytes) {
+    info_.format = format;
+    info_.header_bytes = header_bytes;
+    map(path);
+}
+
+MappedCapture MappedCapture::open_sigmf(const std::string& path) {
+    std::string base = path;
+    if (ends_with(base, ".sigmf-meta") || ends_with(base, ".sigmf-data")) {
+        base.resize(base.size() - 11);
+    }
+
+    std::ifstream meta_file(base + ".sigmf-meta");
+    if (!meta_file) {
+        throw std::runtime_error(base + ".sigmf-meta: " + std::strerror(errno));
+    }
+    std::stringstream text;
+    text << meta_file.rdbuf();
+    const std::string json = text.str();
+
+    MappedCapture capture;
+    std::string datatype;
+    JsonReader(json).parse([&](const std::string& field, const std::string& value) {
+        if (field == "global.core:datatype") {
+            datatype = value;
+        } else if (field == "global.core:sample_rate") {
+            capture.info_.sample_rate = parse_double(field, value);
+        } else if (field == "captures.0.core:frequency") {
+            capture.info_.center_frequency = parse_double(field, value);
+        } else if (field == "captures.0.core:header_bytes") {
+            capture.info_.header_bytes = static_cast<std::size_t>(parse_double(field, value));
+        }
+    });
+
+    if (datatype.empty()) {
+        throw std::invalid_argument(base + ".sigmf-meta: missing global core:datatype");
+    }
+    capture.info_.format = parse_sigmf_datatype(datatype);
+    capture.map(base + ".sigmf-data");
+    return capture;
+}
+
+bool MappedCapture::is_sigmf_path(const std::string& path) {
+    return ends_with(path, ".sigmf-meta") || ends_with(path, ".sigmf-data");
+}
+
+void MappedCapture::map(const std::string& path) {
+    info_.data_path = path;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error(path + ": " + std::strerror(error));
+    }
+
+    std::size_t file_size = static_cast<std::size_t>(st.st_size);
+    std::size_t data_size = file_size > info_.header_bytes ? file_size - info_.header_bytes : 0;
+    info_.num_samples = data_size / sample_format_size(info_.format);
+
+    // mmap() rejects zero-length mappings; an empty capture simply has no data
+    if (file_size > 0) {
+        void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error(path + ": mmap failed: " + std::strerror(error));
+        }
+        mapping_ = mapping;
+        mapping_size_ = file_size;
+#ifdef MADV_SEQUENTIAL
+        // Default policy: aggressive read-ahead, early reclaim behind us
+        ::madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+#endif
+    }
+    ::close(fd);  // The mapping keeps the file referenced
+}
+
+MappedCapture::~MappedCapture() {
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_size_);
+    }
+}
+
+MappedCapture::MappedCapture(MappedCapture&& other) noexcept
+    : info_(std::move(other.info_)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)) {}
+
+MappedCapture& MappedCapture::operator=(MappedCapture&& other) noexcept {
+    if (this != &other) {
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, mapping_size_);
+        }
+        info_ = std::move(other.info_);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapping_size_ = std::exchange(other.mapping_size_, 0);
+    }
+    return *this;
+}
+
+BlockView MappedCapture::block(std::uint64_t offset, std::size_t count) const {
+    BlockView view;
+    view.offset = std::min(offset, info_.num_samples);
+    view.count = static_cast<std::size_t>(std::min<std::uint64_t>(count, info_.num_samples - view.offset));
+    if (view.count > 0) {
+        view.data = static_cast<const char*>(mapping_) + info_.header_bytes +
+                    view.offset * sample_format_size(info_.format);
+    }
+    return view;
+}
+
+bool MappedCapture::aligned() const {
+    std::size_t component = sample_format_size(info_.format) / (is_complex_format(info_.format) ? 2 : 1);
+    return info_.header_bytes % component == 0;
+}
+
+namespace {
+
+// Convert `count` values of type T from a possibly misaligned address:
+// aligned input is converted in place, otherwise it is copied out in
+// cache-sized chunks first (reading a misaligned T* is undefined behaviour)
+template <typename T, typename Scale>
+void convert_from(const void* data, std::size_t count, double* output, bool aligned, Scale scale) {
+    if (aligned) {
+        convert_samples(static_cast<const T*>(data), count, output, scale);
+        return;
+    }
+    constexpr std::size_t kChunk = 1024;
+    T chunk[kChunk];
+    const char* bytes = static_cast<const char*>(data);
+    for (std::size_t done = 0; done < count; done += kChunk) {
+        std::size_t n = std::min(kChunk, count - done);
+        std::memcpy(chunk, bytes + done * sizeof(T), n * sizeof(T));
+        convert_samples(chunk, n, output + done, scale);
+    }
+}
+
+} // namespace
+
+void MappedCapture::convert(const BlockView& view, double* output, double scale) const {
+    // Counts are in scalar components (2 per IQ sample), so the same
+    // converters serve real and interleaved complex formats
+    const std::size_t count = view.count * (is_complex_format(info_.format) ? 2 : 1);
+    const bool in_place = aligned();
+    switch (info_.format) {
+        case SampleFormat::F32:
+        case SampleFormat::CF32:
+            convert_from<float>(view.data, count, output, in_place, 1.0);
+            break;
+        case SampleFormat::F64:
+        case SampleFormat::CF64:
+            // memcpy has no alignment requirement
+            if (count > 0) {
+                std::memcpy(output, view.data, count * sizeof(double));
+            }
+            break;
+        case SampleFormat::S16:
+        case SampleFormat::CS16:
+            convert_from<std::int16_t>(view.data, count, output, in_place,
+                                       scale > 0.0 ? scale : kScaleS16);
+            break;
+        case SampleFormat::S8:
+        case SampleFormat::CS8:
+            convert_from<std::int8_t>(view.data, count, output, in_place,
+                                      scale > 0.0 ? scale : kScaleS8);
+            break;
+    }
+}
+
+void MappedCapture::prefetch(std::uint64_t offset, std::uint64_t count) const {
+#ifdef MADV_WILLNEED
+    // madvise() works on whole pages: round the start down and the end up
+    static const std::uint64_t page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    const std::uint64_t sample_bytes = sample_format_size(info_.format);
+    offset = std::min(offset, info_.num_samples);
+    std::uint64_t begin = info_.header_bytes + offset * sample_bytes;
+    std::uint64_t end = info_.header_bytes + std::min(offset + count, info_.num_samples) * sample_bytes;
+    begin = begin / page * page;
+    end = std::min<std::uint64_t>((end + page - 1) / page * page, mapping_size_);
+    if (mapping_ != nullptr && end > begin) {
+        ::madvise(static_cast<char*>(mapping_) + begin, end - begin, MADV_WILLNEED);
+    }
+#endif
+}
+
+void MappedCapture::release(std::uint64_t offset, std::uint64_t count) const {
+#ifdef MADV_DONTNEED
+    // Only whole pages inside the range may be dropped, or we would also
+    // discard the start of the next block; shrink the range inwards
+    static const std::uint64_t page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    const std::uint64_t sample_bytes = sample_format_size(info_.format);
+    std::uint64_t begin = info_.header_bytes + offset * sample_bytes;
+    std::uint64_t end = info_.header_bytes + std::min(offset + count, info_.num_samples) * sample_bytes;
+    begin = (begin + page - 1) / page * page;
+    end = end / page * page;
+    if (mapping_ != nullptr && end > begin) {
+        // Under mlockall() (lock_memory) the pages were locked as they were
+        // touched, and MADV_DONTNEED refuses locked pages: unlock them first
+        ::munlock(static_cast<char*>(mapping_) + begin, end - begin);
+        ::madvise(static_cast<char*>(mapping_) + begin, end - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+// ============================================================================
+// CAPTURE STREAM
+// ============================================================================
+
+CaptureStream::CaptureStream(const MappedCapture& capture, std::size_t block_size)
+    : capture_(capture), block_size_(block_size) {
+    if (block_size == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    capture_.prefetch(0, block_size_);
+}
+
+bool CaptureStream::next(BlockView& view) {
+    if (position_ >= capture_.size()) {
+        return false;
+    }
+    view = capture_.block(position_, block_size_);
+
+    // The caller is done with the block before this one; the one after is
+    // needed next, so let the kernel start reading it now
+    if (position_ >= block_size_) {
+        capture_.release(position_ - block_size_, block_size_);
+    }
+    capture_.prefetch(position_ + view.count, block_size_);
+
+    position_ += view.count;
+    return true;
+}
+
+} // namespace signal_processor
@@ -0,0 +1,215 @@
+#ifndef CAPTURE_READER_H
+#define CAPTURE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Memory-Mapped Capture Files
+ *
+ * Recordings are often far larger than RAM. Reading one into a
+ * std::vector<double> costs 8-16 bytes per sample on top of the file itself,
+ * and every conversion step adds another copy. Instead, MappedCapture maps
+ * the file read-only and hands out block views that point straight into the
+ * page cache:
+ *
+ * 1. No read() copies - the kernel pages data in as the views are touched
+ * 2. cf64 / f64 blocks are already double / complex<double> and can be fed
+ *    to the streaming processors with no conversion at all
+ * 3. CaptureStream walks the file front to back, asking the kernel to read
+ *    ahead of the current block (MADV_WILLNEED) and to drop pages behind it
+ *    (MADV_DONTNEED), so resident memory stays at a few blocks regardless
+ *    of file size
+ *
+ * Besides raw headerless files, SigMF recordings are supported: the
+ * .sigmf-meta JSON sidecar supplies the sample format, sample rate and
+ * center frequency of the .sigmf-data file.
+ */
+
+namespace signal_processor {
+
+/**
+ * On-disk sample formats (little-endian)
+ *
+ * Names follow the common SDR convention: "c" = interleaved complex IQ,
+ * then the component type (f = float, s = signed integer) and bit width.
+ */
+enum class SampleFormat {
+    F32,   // real float32
+    F64,   // real float64
+    S16,   // real int16
+    S8,    // real int8
+    CF32,  // complex float32 (I, Q)
+    CF64,  // complex float64
+    CS16,  // complex int16 (the usual ADC format)
+    CS8    // complex int8
+};
+
+/**
+ * Parse a format name ("cf32", "cs16", "f64", ...)
+ *
+ * @throws std::invalid_argument for unknown names
+ */
+SampleFormat parse_sample_format(const std::string& name);
+
+const char* sample_format_name(SampleFormat format);
+
+// True for the interleaved IQ formats
+bool is_complex_format(SampleFormat format);
+
+// Bytes per sample (per IQ pair for complex formats)
+std::size_t sample_format_size(SampleFormat format);
+
+/**
+ * Map a SigMF core:datatype ("cf32_le", "ri16_le", "ci8", ...) to a format
+ *
+ * @throws std::invalid_argument for big-endian, unsigned or unsupported types
+ */
+SampleFormat parse_sigmf_datatype(const std::string& datatype);
+
+// The SigMF core:datatype for a format ("cf32_le", "ci16_le", "ri8", ...)
+std::string sigmf_datatype(SampleFormat format);
+
+/**
+ * What is known about a capture
+ */
+struct CaptureInfo {
+    SampleFormat format = SampleFormat::CF32;
+    std::uint64_t num_samples = 0;
+    std::size_t header_bytes = 0;     // Skipped at the start of the file
+    double sample_rate = 0.0;         // Hz, 0 if unknown (raw files)
+    double center_frequency = 0.0;    // Hz, 0 if unknown
+    std::string data_path;
+};
+
+/**
+ * A window of samples inside a mapped capture
+ *
+ * `data` points into the mapping, in the capture's on-disk format. The view
+ * is valid as long as the MappedCapture it came from. It may only be read
+ * as the format's element type when MappedCapture::aligned() is true;
+ * MappedCapture::convert() works either way.
+ */
+struct BlockView {
+    const void* data = nullptr;
+    std::size_t count = 0;        // Samples (IQ pairs for complex formats)
+    std::uint64_t offset = 0;     // Index of the first sample in the file
+};
+
+/**
+ * Read-only memory mapping of a capture file
+ *
+ * Move-only; the mapping is released by the destructor. Thread-safe for
+ * concurrent reads (nothing in it is mutable), so several threads may
+ * process different ranges of one capture.
+ */
+class MappedCapture {
+public:
+    /**
+     * Map a raw, headerless capture
+     *
+     * Trailing bytes that do not form a whole sample are ignored.
+     *
+     * @param path File to map
+     * @param format On-disk sample format
+     * @param header_bytes Bytes to skip at the start of the file
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    MappedCapture(const std::string& path, SampleFormat format, std::size_t header_bytes = 0);
+
+    /**
+     * Map a SigMF recording
+     *
+     * @param path The .sigmf-meta file, the .sigmf-data file, or their
+     *             common base name
+     * @throws std::invalid_argument for malformed or unsupported metadata
+     * @throws std::runtime_error if either file cannot be opened
+     */
+    static MappedCapture open_sigmf(const std::string& path);
+
+    // True if the path names a SigMF recording (.sigmf-meta / .sigmf-data)
+    static bool is_sigmf_path(const std::string& path);
+
+    ~MappedCapture();
+
+    MappedCapture(MappedCapture&& other) noexcept;
+    MappedCapture& operator=(MappedCapture&& other) noexcept;
+    MappedCapture(const MappedCapture&) = delete;
+    MappedCapture& operator=(const MappedCapture&) = delete;
+
+    const CaptureInfo& info() const { return info_; }
+    SampleFormat format() const { return info_.format; }
+    std::uint64_t size() const { return info_.num_samples; }
+
+    /**
+     * True when the sample data starts on a multiple of the component size
+     * (the mapping itself is page-aligned), so views can be read in place
+     * as float / double / int16. A header of any other length is valid, but
+     * its views must go through convert(), which then copies byte-wise.
+     */
+    bool aligned() const;
+
+    /**
+     * Zero-copy view of samples [offset, offset + count), clamped to the
+     * end of the capture
+     */
+    BlockView block(std::uint64_t offset, std::size_t count) const;
+
+    /**
+     * Convert a block to doubles
+     *
+     * Real formats produce view.count values, complex formats 2 * view.count
+     * interleaved values (i.e. std::complex<double> layout). Integer formats
+     * are scaled by `scale` (0 = full scale maps to ±1.0).
+     */
+    void convert(const BlockView& view, double* output, double scale = 0.0) const;
+
+    /**
+     * Kernel paging hints for a sample range (no-ops where unsupported)
+     *
+     * prefetch() starts reading the range in the background; release()
+     * drops its pages from this process (they are re-read from the page
+     * cache or disk if touched again).
+     */
+    void prefetch(std::uint64_t offset, std::uint64_t count) const;
+    void release(std::uint64_t offset, std::uint64_t count) const;
+
+private:
+    MappedCapture() = default;
+    void map(const std::string& path);
+
+    CaptureInfo info_;
+    void* mapping_ = nullptr;
+    std::size_t mapping_size_ = 0;
+};
+
+/**
+ * Sequential block iterator with read-ahead and release-behind
+ *
+ *   CaptureStream stream(capture, 65536);
+ *   BlockView view;
+ *   while (stream.next(view)) { ... }
+ *
+ * Each next() prefetches the block after the one returned and releases the
+ * block before it, so at most ~3 blocks of the file are resident.
+ */
+class CaptureStream {
+public:
+    CaptureStream(const MappedCapture& capture, std::size_t block_size);
+
+    // Fill `view` with the next block; false once the capture is exhausted
+    bool next(BlockView& view);
+
+    std::uint64_t position() const { return position_; }
+    const MappedCapture& capture() const { return capture_; }
+
+private:
+    const MappedCapture& capture_;
+    std::size_t block_size_;
+    std::uint64_t position_ = 0;
+};
+
+} // namespace signal_processor
+
+#endif // CAPTURE_READER_H
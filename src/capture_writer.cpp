@@ -0,0 +1,399 @@
+#include "capture_writer.h"
+#include "sample_convert.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace signal_processor {
+
+namespace {
+
+// Direct I/O needs buffer addresses, lengths and file offsets aligned to
+// the device's logical block size; 4 KiB covers every current SSD/NVMe
+constexpr std::size_t kAlignment = 4096;
+
+bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string json_escape(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    result += escaped;
+                } else {
+                    result += c;
+                }
+        }
+    }
+    return result;
+}
+
+std::string json_number(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+}
+
+int open_output(const std::string& path, bool try_direct, bool& direct) {
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    direct = false;
+#ifdef O_DIRECT
+    if (try_direct) {
+        int fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            direct = true;
+            return fd;
+        }
+        if (errno != EINVAL) {
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        }
+        // EINVAL: this filesystem (tmpfs, some network mounts) has no
+        // direct I/O - fall through to a buffered open
+    }
+#else
+    (void)try_direct;
+#endif
+    int fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+} // namespace
+
+// ============================================================================
+// SETUP AND TEARDOWN
+// ============================================================================
+
+CaptureWriter::CaptureWriter(const std::string& path, const CaptureWriterConfig& config)
+    : config_(config),
+      sample_bytes_(sample_format_size(config.format)) {
+    if (config_.num_buffers < 2) {
+        throw std::invalid_argument("CaptureWriter needs at least 2 buffers");
+    }
+    if (config_.buffer_bytes == 0) {
+        throw std::invalid_argument("Buffer size must be positive");
+    }
+    if (config_.scale < 0.0) {
+        throw std::invalid_argument("Scale must not be negative");
+    }
+    // Sample sizes (1-16 bytes) all divide 4 KiB, so no sample ever
+    // straddles two buffers
+    config_.buffer_bytes = (config_.buffer_bytes + kAlignment - 1) / kAlignment * kAlignment;
+
+    data_path_ = path;
+    if (config_.sigmf) {
+        std::string base = path;
+        if (ends_with(base, ".sigmf-data") || ends_with(base, ".sigmf-meta")) {
+            base.resize(base.size() - 11);
+        }
+        data_path_ = base + ".sigmf-data";
+        meta_path_ = base + ".sigmf-meta";
+    }
+
+    buffers_.resize(config_.num_buffers);
+    for (Buffer& buffer : buffers_) {
+        // Page-aligned, which satisfies kAlignment
+        buffer.memory = MappedMemory(config_.buffer_bytes, config_.memory);
+        free_.push_back(&buffer);
+    }
+
+    bool direct = false;
+    fd_ = open_output(data_path_, config_.direct_io, direct);
+    direct_ = direct;
+    thread_ = std::thread([this] { writer_loop(); });
+}
+
+CaptureWriter::~CaptureWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Errors are reported by an explicit close()
+    }
+}
+
+void CaptureWriter::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+
+    if (current_ != nullptr && current_->used > 0) {
+        submit_current();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    buffer_full_.notify_all();
+    thread_.join();
+
+    // The last buffer may have been padded to the direct I/O block size
+    if (::ftruncate(fd_, static_cast<off_t>(file_bytes_)) != 0 && error_.empty()) {
+        error_ = std::string("truncate failed: ") + std::strerror(errno);
+    }
+    if (::close(fd_) != 0 && error_.empty()) {
+        error_ = std::string("close failed: ") + std::strerror(errno);
+    }
+    fd_ = -1;
+
+    check_error();
+    if (config_.sigmf) {
+        write_metadata();
+    }
+}
+
+// ============================================================================
+// PRODUCER SIDE
+// ============================================================================
+
+std::size_t CaptureWriter::write(const double* samples, std::size_t count) {
+    if (is_complex_format(config_.format)) {
+        throw std::invalid_argument("Real samples written to a complex capture format");
+    }
+    return write_values(samples, count);
+}
+
+std::size_t CaptureWriter::write(const std::complex<double>* samples, std::size_t count) {
+    if (!is_complex_format(config_.format)) {
+        throw std::invalid_argument("Complex samples written to a real capture format");
+    }
+    return write_values(reinterpret_cast<const double*>(samples), 2 * count) / 2;
+}
+
+std::size_t CaptureWriter::write_values(const double* values, std::size_t count) {
+    /**
+     * `count` is in scalar values (2 per IQ sample). Buffers hold a whole
+     * number of samples, so `accepted` always ends on a sample boundary.
+     */
+    if (closed_) {
+        throw std::runtime_error(data_path_ + ": write after close");
+    }
+    check_error();
+
+    const std::size_t components = is_complex_format(config_.format) ? 2 : 1;
+    const std::size_t value_bytes = sample_bytes_ / components;
+
+    std::size_t accepted = 0;
+    while (accepted < count) {
+        if (current_ == nullptr) {
+            current_ = acquire_buffer();
+            if (current_ == nullptr) {
+                break;  // OverflowPolicy::Drop and every buffer is busy
+            }
+        }
+
+        std::size_t space = (config_.buffer_bytes - current_->used) / value_bytes;
+        std::size_t n = std::min(count - accepted, space);
+        char* dest = current_->data() + current_->used;
+        const double* src = values + accepted;
+
+        switch (config_.format) {
+            case SampleFormat::F32:
+            case SampleFormat::CF32:
+                encode_samples(src, n, reinterpret_cast<float*>(dest));
+                break;
+            case SampleFormat::F64:
+            case SampleFormat::CF64:
+                std::memcpy(dest, src, n * sizeof(double));
+                break;
+            case SampleFormat::S16:
+            case SampleFormat::CS16:
+                encode_samples(src, n, reinterpret_cast<std::int16_t*>(dest),
+                               config_.scale > 0.0 ? config_.scale : kScaleS16);
+                break;
+            case SampleFormat::S8:
+            case SampleFormat::CS8:
+                encode_samples(src, n, reinterpret_cast<std::int8_t*>(dest),
+                               config_.scale > 0.0 ? config_.scale : kScaleS8);
+                break;
+        }
+
+        current_->used += n * value_bytes;
+        accepted += n;
+        if (current_->used == config_.buffer_bytes) {
+            submit_current();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.samples_written += accepted / components;
+    stats_.samples_dropped += (count - accepted) / components;
+    return accepted;
+}
+
+CaptureWriter::Buffer* CaptureWriter::acquire_buffer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        if (config_.overflow == OverflowPolicy::Drop) {
+            return nullptr;
+        }
+        auto start = std::chrono::steady_clock::now();
+        buffer_free_.wait(lock, [this] { return !free_.empty(); });
+        stats_.backpressure_waits++;
+        stats_.backpressure_seconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    Buffer* buffer = free_.back();
+    free_.pop_back();
+    buffer->used = 0;
+    return buffer;
+}
+
+void CaptureWriter::submit_current() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        full_.push_back(current_);
+    }
+    current_ = nullptr;
+    buffer_full_.notify_one();
+}
+
+void CaptureWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    buffer_free_.wait(lock, [this] { return full_.empty() && !writing_; });
+    lock.unlock();
+    check_error();
+}
+
+CaptureWriterStats CaptureWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CaptureWriterStats s = stats_;
+    s.buffers_pending = full_.size() + (writing_ ? 1 : 0);
+    s.direct_io = direct_;
+    return s;
+}
+
+void CaptureWriter::check_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_.empty()) {
+        throw std::runtime_error(data_path_ + ": " + error_);
+    }
+}
+
+// ============================================================================
+// BACKGROUND WRITER
+// ============================================================================
+
+void CaptureWriter::writer_loop() {
+    for (;;) {
+        Buffer* buffer = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            buffer_full_.wait(lock, [this] { return stopping_ || !full_.empty(); });
+            if (full_.empty()) {
+                return;  // Stopping and fully drained
+            }
+            buffer = full_.front();
+            full_.pop_front();
+            writing_ = true;
+        }
+
+        std::string failure;
+        try {
+            write_buffer(*buffer);
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            writing_ = false;
+            if (failure.empty()) {
+                stats_.bytes_on_disk += buffer->used;
+            } else if (error_.empty()) {
+                error_ = failure;  // Keep the first error; later ones are consequences
+            }
+            free_.push_back(buffer);
+        }
+        buffer_free_.notify_all();
+    }
+}
+
+void CaptureWriter::write_buffer(const Buffer& buffer) {
+    /**
+     * Every buffer but the last is full, so with direct I/O each write
+     * starts on an aligned file offset. The last one is zero-padded to the
+     * block size here and close() truncates the padding away.
+     */
+    std::size_t length = buffer.used;
+    if (direct_ && length % kAlignment != 0) {
+        std::size_t padded = (length + kAlignment - 1) / kAlignment * kAlignment;
+        std::memset(buffer.data() + length, 0, padded - length);
+        length = padded;
+    }
+
+    const char* data = buffer.data();
+    std::size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::write(fd_, data + done, length - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+#ifdef O_DIRECT
+            if (errno == EINVAL && direct_ && done == 0) {
+                // Some filesystems accept O_DIRECT at open() but reject the
+                // writes; carry on with buffered I/O
+                ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                std::lock_guard<std::mutex> lock(mutex_);
+                direct_ = false;
+                continue;
+            }
+#endif
+            throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    file_bytes_ += buffer.used;
+}
+
+void CaptureWriter::write_metadata() {
+    std::ofstream meta(meta_path_);
+    meta << "{\n"
+         << "  \"global\": {\n"
+         << "    \"core:datatype\": \"" << sigmf_datatype(config_.format) << "\",\n";
+    if (config_.sample_rate > 0.0) {
+        meta << "    \"core:sample_rate\": " << json_number(config_.sample_rate) << ",\n";
+    }
+    if (!config_.description.empty()) {
+        meta << "    \"core:description\": \"" << json_escape(config_.description) << "\",\n";
+    }
+    meta << "    \"core:recorder\": \"signal_processor\",\n"
+         << "    \"core:version\": \"1.0.0\"\n"
+         << "  },\n"
+         << "  \"captures\": [\n"
+         << "    {\n"
+         << "      \"core:sample_start\": 0";
+    if (config_.center_frequency != 0.0) {
+        meta << ",\n      \"core:frequency\": " << json_number(config_.center_frequency);
+    }
+    meta << "\n    }\n"
+         << "  ],\n"
+         << "  \"annotations\": []\n"
+         << "}\n";
+    if (!meta.flush()) {
+        throw std::runtime_error(meta_path_ + ": write failed");
+    }
+}
+
+} // namespace signal_processor
@@ -0,0 +1,171 @@
+#ifndef CAPTURE_WRITER_H
+#define CAPTURE_WRITER_H
+
+#include "capture_reader.h"
+#include "memory_policy.h"
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Asynchronous Capture Recording
+ *
+ * Writing to disk from the processing thread makes filter latency depend
+ * on the storage stack: a single slow write() (page-cache writeback, a busy
+ * SSD) stalls the whole receive chain. CaptureWriter decouples the two:
+ *
+ * 1. write() only encodes samples (cf32, cs16, ...) into a large aligned
+ *    buffer - a memcpy-speed operation on the caller's thread
+ * 2. Full buffers go to a background thread that writes them out while the
+ *    caller fills the next one (double buffering; more buffers absorb
+ *    longer storage hiccups)
+ * 3. With direct I/O (O_DIRECT on Linux) the data bypasses the page cache,
+ *    so recording does not evict the working set or trigger writeback
+ *    storms; filesystems that refuse O_DIRECT fall back to buffered I/O
+ *
+ * When every buffer is waiting for the disk, the overflow policy decides:
+ * Block (backpressure - write() waits, no data lost) or Drop (write()
+ * returns immediately and the samples are counted as dropped - the right
+ * choice when the processing chain must never stall). stats() exposes
+ * both counters.
+ *
+ * Recordings can be written as SigMF (data + .sigmf-meta sidecar), which
+ * MappedCapture::open_sigmf() reads back.
+ */
+
+namespace signal_processor {
+
+enum class OverflowPolicy {
+    Block,  // Wait for a free buffer (backpressure)
+    Drop    // Discard the samples and count them
+};
+
+struct CaptureWriterConfig {
+    SampleFormat format = SampleFormat::CF32;   // On-disk format
+    double scale = 0.0;                         // Integer formats: 0 = ±1.0 is full scale
+
+    std::size_t buffer_bytes = 4 << 20;         // Per buffer (rounded up to 4 KiB)
+    std::size_t num_buffers = 2;                // At least 2
+    OverflowPolicy overflow = OverflowPolicy::Block;
+    bool direct_io = true;                      // Try O_DIRECT (Linux)
+    MemoryPolicy memory;                        // Huge pages / NUMA node of the buffers
+
+    // SigMF output: `path` is the base name and <path>.sigmf-data and
+    // <path>.sigmf-meta are written. Otherwise `path` is a raw file.
+    bool sigmf = false;
+    double sample_rate = 0.0;                   // Hz, recorded in the metadata
+    double center_frequency = 0.0;              // Hz, recorded if non-zero
+    std::string description;
+};
+
+struct CaptureWriterStats {
+    std::uint64_t samples_written = 0;      // Accepted by write()
+    std::uint64_t samples_dropped = 0;      // Refused under OverflowPolicy::Drop
+    std::uint64_t bytes_on_disk = 0;        // Completed by the background thread
+    std::uint64_t backpressure_waits = 0;   // write() calls that waited for a buffer
+    double backpressure_seconds = 0.0;      // Total time spent waiting
+    std::size_t buffers_pending = 0;        // Full buffers not yet on disk
+    bool direct_io = false;                 // O_DIRECT actually in use
+};
+
+class CaptureWriter {
+public:
+    /**
+     * Open the output file(s) and start the background writer
+     *
+     * @throws std::invalid_argument for a bad configuration
+     * @throws std::runtime_error if the file cannot be created
+     */
+    CaptureWriter(const std::string& path, const CaptureWriterConfig& config = {});
+
+    // Calls close(); errors are swallowed - call close() to see them
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * Queue samples for writing
+     *
+     * The real overload requires a real format, the complex one an IQ
+     * format. Not thread-safe: one producer thread per writer.
+     *
+     * @return Samples accepted; less than `count` only under
+     *         OverflowPolicy::Drop when no buffer was free
+     * @throws std::runtime_error if the background writer has failed
+     */
+    std::size_t write(const double* samples, std::size_t count);
+    std::size_t write(const std::complex<double>* samples, std::size_t count);
+
+    /**
+     * Wait until every full buffer is on disk
+     *
+     * The partially filled current buffer stays in memory (direct I/O
+     * can only write whole blocks); close() writes it.
+     */
+    void flush();
+
+    /**
+     * Write out everything, stop the background thread, trim the file to
+     * its exact length and write the SigMF metadata. Idempotent.
+     *
+     * @throws std::runtime_error if any write failed
+     */
+    void close();
+
+    CaptureWriterStats stats() const;
+
+    SampleFormat format() const { return config_.format; }
+    const std::string& data_path() const { return data_path_; }
+
+private:
+    struct Buffer {
+        MappedMemory memory;
+        std::size_t used = 0;
+
+        char* data() const { return static_cast<char*>(memory.data()); }
+    };
+
+    std::size_t write_values(const double* values, std::size_t count);
+    Buffer* acquire_buffer();
+    void submit_current();
+    void writer_loop();
+    void write_buffer(const Buffer& buffer);
+    void write_metadata();
+    void check_error() const;
+
+    CaptureWriterConfig config_;
+    std::string data_path_;
+    std::string meta_path_;
+    std::size_t sample_bytes_;
+    int fd_ = -1;
+    bool direct_ = false;
+    bool closed_ = false;
+
+    std::vector<Buffer> buffers_;
+    Buffer* current_ = nullptr;              // Being filled by write()
+    std::uint64_t file_bytes_ = 0;           // Logical length (excludes padding)
+
+    mutable std::mutex mutex_;
+    std::condition_variable buffer_free_;
+    std::condition_variable buffer_full_;
+    std::vector<Buffer*> free_;
+    std::deque<Buffer*> full_;
+    bool writing_ = false;                   // Background thread holds a buffer
+    bool stopping_ = false;
+    std::string error_;
+
+    CaptureWriterStats stats_;
+    std::thread thread_;
+};
+
+} // namespace signal_processor
+
+#endif // CAPTURE_WRITER_H
@@ -0,0 +1,161 @@
+#include "coroutine_stages.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace signal_processor {
+
+// ============================================================================
+// BLOCK STREAMS
+// ============================================================================
+
+namespace {
+
+// Coroutine bodies only start on the first next(), so the public functions
+// below validate their arguments eagerly and then hand over to these
+
+BlockStream source_blocks(std::shared_ptr<SourceStage> source, std::size_t block_size) {
+    SampleBlock block;
+    for (std::uint64_t sequence = 0; source->produce(block, block_size); ++sequence) {
+        block.sequence = sequence;
+        co_yield block;
+    }
+}
+
+BlockStream rechunk_blocks(BlockStream input, std::size_t block_size) {
+    SampleBlock out;
+    std::vector<double> pending;     // Interleaved I/Q when complex
+    std::size_t start = 0;           // First unconsumed value in `pending`
+    bool complex = false;
+    std::uint64_t sequence = 0;
+
+    auto emit = [&](std::size_t samples) {
+        out.resize(samples, complex);
+        std::size_t values = samples * (complex ? 2 : 1);
+        std::copy_n(pending.data() + start, values, out.values.data());
+        out.sequence = sequence++;
+        start += values;
+    };
+
+    while (const SampleBlock* in = input.next()) {
+        if (in->frame_length != 0) {
+            throw std::invalid_argument("rechunk() needs time-domain samples, not spectrum frames");
+        }
+        if (pending.size() == start) {
+            complex = in->complex;
+        } else if (in->complex != complex) {
+            throw std::invalid_argument("rechunk() input switched between real and complex");
+        }
+        // Drop what has been emitted, then append the new samples
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(start));
+        start = 0;
+        pending.insert(pending.end(), in->values.begin(),
+                       in->values.begin() + static_cast<std::ptrdiff_t>(in->count * (complex ? 2 : 1)));
+
+        std::size_t per_block = block_size * (complex ? 2 : 1);
+        while (pending.size() - start >= per_block) {
+            emit(block_size);
+            co_yield out;
+        }
+    }
+    if (pending.size() > start) {
+        emit((pending.size() - start) / (complex ? 2 : 1));
+        co_yield out;
+    }
+}
+
+} // namespace
+
+BlockStream source_stream(std::shared_ptr<SourceStage> source, std::size_t block_size) {
+    if (block_size == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    return source_blocks(std::move(source), block_size);
+}
+
+BlockStream through(BlockStream input, std::shared_ptr<ProcessStage> stage) {
+    SampleBlock out;
+    while (const SampleBlock* in = input.next()) {
+        stage->process(*in, out);
+        if (out.count > 0) {
+            out.sequence = in->sequence;
+            co_yield out;
+        }
+    }
+}
+
+BlockStream rechunk(BlockStream input, std::size_t block_size) {
+    if (block_size == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+    return rechunk_blocks(std::move(input), block_size);
+}
+
+// ============================================================================
+// TASKS
+// ============================================================================
+
+StreamTask drain(BlockStream input, std::shared_ptr<SinkStage> sink) {
+    while (const SampleBlock* block = input.next()) {
+        sink->consume(*block);
+    }
+    co_return;
+}
+
+void StreamTask::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+    StreamScheduler* scheduler = handle.promise().scheduler;
+    std::exception_ptr error = handle.promise().error;
+    // Free the frame (and the chain it owns) before wait() can return
+    handle.destroy();
+    scheduler->finished(error);
+}
+
+void yield_now::await_suspend(std::coroutine_handle<StreamTask::promise_type> handle) const {
+    handle.promise().scheduler->resume_on_pool(handle);
+}
+
+// ============================================================================
+// SCHEDULER
+// ============================================================================
+
+StreamScheduler::~StreamScheduler() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+}
+
+void StreamScheduler::spawn(StreamTask task) {
+    std::coroutine_handle<StreamTask::promise_type> handle = std::exchange(task.handle_, {});
+    handle.promise().scheduler = this;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++running_;
+    }
+    resume_on_pool(handle);
+}
+
+void StreamScheduler::resume_on_pool(std::coroutine_handle<> handle) {
+    // resume() cannot throw: task bodies' exceptions end up in the promise
+    pool_.submit([handle] { handle.resume(); });
+}
+
+void StreamScheduler::finished(std::exception_ptr error) {
+    // Notify under the lock: once it is released, wait() may return and
+    // the scheduler may be gone
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error && !error_) {
+        error_ = error;
+    }
+    --running_;
+    done_.notify_all();
+}
+
+void StreamScheduler::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+} // namespace signal_processor
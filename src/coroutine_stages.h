@@ -0,0 +1,264 @@
+#ifndef COROUTINE_STAGES_H
+#define COROUTINE_STAGES_H
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#error "coroutine_stages.h needs C++20 coroutines (configure with -DSIGNAL_PROCESSOR_COROUTINES=ON)"
+#endif
+
+#include "flowgraph.h"
+#include "thread_pool.h"
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * Coroutine Streaming Stages
+ *
+ * A Flowgraph stage is a callback: process(in, out) is handed exactly one
+ * block and must produce exactly one. That is awkward as soon as rates
+ * differ - a stage that needs 4096 samples per FFT frame after a 1:10
+ * decimator has to keep its own partial-frame buffer and cannot say "wait
+ * for more input" - and every stage costs a thread and a ring handoff per
+ * block.
+ *
+ * Here a stage is a coroutine that pulls blocks from its input and yields
+ * blocks to its consumer, holding its state in ordinary local variables:
+ *
+ *   BlockStream frames(BlockStream input, std::size_t size) {
+ *       SampleBlock out;
+ *       std::vector<double> pending;
+ *       while (const SampleBlock* block = input.next()) {
+ *           pending.insert(pending.end(), block->real(), block->real() + block->count);
+ *           while (pending.size() >= size) { ...fill out...; co_yield out; }
+ *       }
+ *   }
+ *
+ * 1. A chain of BlockStreams runs on one thread: pulling from the last
+ *    stage resumes the one before it, and so on, down to the source. A
+ *    block travels the whole chain while it is hot in cache, with no
+ *    queue, no lock and no thread handoff
+ * 2. Each stage yields as many blocks as it likes per input block (or
+ *    none), so multi-rate chains need no extra plumbing
+ * 3. Existing stages plug in unchanged: source_stream(), through() and
+ *    drain() wrap the Flowgraph SourceStage/ProcessStage/SinkStage classes
+ * 4. StreamScheduler runs many independent chains (one per channel, say)
+ *    as StreamTasks on a ThreadPool; co_await yield_now() inside a task
+ *    hands its worker to another task for fairness
+ *
+ *   StreamScheduler scheduler(default_thread_pool());
+ *   for (int ch = 0; ch < 8; ++ch) {
+ *       auto chain = through(through(source_stream(sources[ch], 8192), decimators[ch]),
+ *                            firs[ch]);
+ *       scheduler.spawn(drain(std::move(chain), sinks[ch]));
+ *   }
+ *   scheduler.wait();
+ *
+ * Built only with -DSIGNAL_PROCESSOR_COROUTINES=ON (C++20).
+ */
+
+namespace signal_processor {
+
+// ============================================================================
+// BLOCK STREAMS
+// ============================================================================
+
+/**
+ * Pull-based stream of sample blocks (a generator coroutine)
+ *
+ * The coroutine body runs only while the consumer is inside next(). Move-
+ * only; destroying the stream destroys the coroutine and everything it
+ * owns (including its own input streams).
+ */
+class BlockStream {
+public:
+    struct promise_type {
+        const SampleBlock* current = nullptr;
+        std::exception_ptr error;
+
+        BlockStream get_return_object() {
+            return BlockStream(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const SampleBlock& block) noexcept {
+            current = &block;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    BlockStream() = default;
+    BlockStream(BlockStream&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    BlockStream& operator=(BlockStream&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    BlockStream(const BlockStream&) = delete;
+    BlockStream& operator=(const BlockStream&) = delete;
+    ~BlockStream() { reset(); }
+
+    /**
+     * Run the stage until it yields its next block
+     *
+     * @return The block (valid until the next call), or nullptr at the end
+     *         of the stream
+     * @throws whatever the stage (or a stage upstream of it) threw
+     */
+    const SampleBlock* next() {
+        if (!handle_ || handle_.done()) {
+            return nullptr;
+        }
+        handle_.promise().current = nullptr;
+        handle_.resume();
+        if (handle_.promise().error) {
+            std::rethrow_exception(std::exchange(handle_.promise().error, nullptr));
+        }
+        return handle_.done() ? nullptr : handle_.promise().current;
+    }
+
+private:
+    explicit BlockStream(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void reset() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Blocks of up to `block_size` samples from a Flowgraph source
+// (throws std::invalid_argument right away if block_size is 0)
+BlockStream source_stream(std::shared_ptr<SourceStage> source, std::size_t block_size);
+
+// Every block of `input` passed through a Flowgraph processing stage
+// (blocks the stage leaves empty, e.g. a decimator's, are skipped)
+BlockStream through(BlockStream input, std::shared_ptr<ProcessStage> stage);
+
+/**
+ * Regroup a real or complex stream into blocks of exactly `block_size`
+ * samples (the last one may be shorter) - e.g. FFT frames after a decimator
+ *
+ * @throws std::invalid_argument if block_size is 0 (from the call itself,
+ *         not the first next())
+ */
+BlockStream rechunk(BlockStream input, std::size_t block_size);
+
+// ============================================================================
+// TASKS AND SCHEDULING
+// ============================================================================
+
+class StreamScheduler;
+
+/**
+ * A coroutine that consumes streams to completion (typically one chain)
+ *
+ * Lazy: nothing runs until it is spawned on a StreamScheduler.
+ */
+class StreamTask {
+public:
+    struct promise_type {
+        StreamScheduler* scheduler = nullptr;
+        std::exception_ptr error;
+
+        StreamTask get_return_object() {
+            return StreamTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Report completion and free the frame
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    StreamTask(StreamTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    StreamTask& operator=(StreamTask&&) = delete;
+    StreamTask(const StreamTask&) = delete;
+    StreamTask& operator=(const StreamTask&) = delete;
+    ~StreamTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+private:
+    friend class StreamScheduler;
+    explicit StreamTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Pull `input` to its end, handing every block to a Flowgraph sink
+StreamTask drain(BlockStream input, std::shared_ptr<SinkStage> sink);
+
+/**
+ * co_await yield_now() inside a StreamTask: requeue the task on its pool
+ * so other tasks get the worker (e.g. every few dozen blocks)
+ */
+struct yield_now {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<StreamTask::promise_type> handle) const;
+    void await_resume() const noexcept {}
+};
+
+/**
+ * Runs StreamTasks on a ThreadPool
+ *
+ * Each task runs on one worker at a time (a chain never migrates mid-block)
+ * but may continue on another after a yield_now().
+ */
+class StreamScheduler {
+public:
+    explicit StreamScheduler(ThreadPool& pool = default_thread_pool()) : pool_(pool) {}
+
+    // Waits for every spawned task
+    ~StreamScheduler();
+
+    StreamScheduler(const StreamScheduler&) = delete;
+    StreamScheduler& operator=(const StreamScheduler&) = delete;
+
+    // Start `task` on the pool
+    void spawn(StreamTask task);
+
+    /**
+     * Block until every spawned task has finished. Call from outside the
+     * pool (a worker waiting here cannot run the tasks it waits for).
+     *
+     * @throws the first exception a task threw (the others still finish)
+     */
+    void wait();
+
+private:
+    friend struct yield_now;
+    friend struct StreamTask::promise_type::FinalAwaiter;
+
+    void resume_on_pool(std::coroutine_handle<> handle);
+    // Called by a finishing task, after its frame is destroyed
+    void finished(std::exception_ptr error);
+
+    ThreadPool& pool_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::size_t running_ = 0;
+    std::exception_ptr error_;
+};
+
+} // namespace signal_processor
+
+#endif // COROUTINE_STAGES_H
@@ -0,0 +1,30 @@
+#ifndef FFTW_PLANNER_H
+#define FFTW_PLANNER_H
+
+#include <mutex>
+
+namespace signal_processor {
+
+/**
+ * Process-wide lock for the FFTW planner
+ *
+ * FFTW guarantees only that fftw_execute*() is thread-safe. Every other
+ * call that touches the planner - fftw_plan_*(), fftw_destroy_plan() and
+ * their fftwf_* twins - must be serialized across the whole process.
+ * Anything in the library that creates or destroys a plan holds this
+ * mutex for the duration of that call (and only that call), so transforms
+ * themselves still run in parallel on as many threads as the caller likes.
+ *
+ * Usage:
+ *   fftw_plan plan;
+ *   {
+ *       std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+ *       plan = fftw_plan_dft_r2c_1d(N, in, out, FFTW_ESTIMATE);
+ *   }
+ *   fftw_execute(plan);
+ */
+std::mutex& fftw_planner_mutex();
+
+} // namespace signal_processor
+
+#endif // FFTW_PLANNER_H
@@ -0,0 +1,539 @@
+#include "flowgraph.h"
+#include "signal_processor.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace signal_processor {
+
+// ============================================================================
+// SOURCES
+// ============================================================================
+
+ToneSource::ToneSource(double frequency, double sample_rate, double noise_amplitude,
+                       std::uint64_t num_samples, unsigned seed)
+    : noise_amplitude_(noise_amplitude),
+      remaining_(num_samples),
+      rng_(seed) {
+    if (sample_rate <= 0.0) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    step_ = frequency / sample_rate;
+}
+
+bool ToneSource::produce(SampleBlock& out, std::size_t block_size) {
+    if (remaining_ == 0) {
+        return false;
+    }
+    std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(block_size, remaining_));
+    out.resize(n, false);
+    double* samples = out.real();
+    for (std::size_t i = 0; i < n; ++i) {
+        // Phase from the absolute sample index (reduced to one cycle), so
+        // there is no drift however long the stream runs
+        double cycles = step_ * static_cast<double>(position_ + i);
+        samples[i] = std::sin(2.0 * M_PI * (cycles - std::floor(cycles)));
+        if (noise_amplitude_ > 0.0) {
+            samples[i] += noise_amplitude_ * noise_(rng_);
+        }
+    }
+    position_ += n;
+    remaining_ -= n;
+    return true;
+}
+
+ArraySource::ArraySource(std::vector<double> samples)
+    : real_(std::move(samples)), complex_(false) {}
+
+ArraySource::ArraySource(std::vector<std::complex<double>> samples)
+    : iq_(std::move(samples)), complex_(true) {}
+
+bool ArraySource::produce(SampleBlock& out, std::size_t block_size) {
+    std::size_t total = complex_ ? iq_.size() : real_.size();
+    if (position_ >= total) {
+        return false;
+    }
+    std::size_t n = std::min(block_size, total - position_);
+    out.resize(n, complex_);
+    if (complex_) {
+        std::copy_n(iq_.data() + position_, n, out.iq());
+    } else {
+        std::copy_n(real_.data() + position_, n, out.real());
+    }
+    position_ += n;
+    return true;
+}
+
+CaptureSource::CaptureSource(const std::string& path, SampleFormat format)
+    : capture_(MappedCapture::is_sigmf_path(path) ? MappedCapture::open_sigmf(path)
+                                                  : MappedCapture(path, format)) {}
+
+bool CaptureSource::produce(SampleBlock& out, std::size_t block_size) {
+    BlockView view = capture_.block(position_, block_size);
+    if (view.count == 0) {
+        return false;
+    }
+    out.resize(view.count, is_complex_format(capture_.format()));
+    capture_.convert(view, out.real());
+
+    // Sequential access: drop what is behind, read ahead of what is next
+    if (position_ >= block_size) {
+        capture_.release(position_ - block_size, block_size);
+    }
+    position_ += view.count;
+    capture_.prefetch(position_, block_size);
+    return true;
+}
+
+// ============================================================================
+// PROCESSING STAGES
+// ============================================================================
+
+FirStage::FirStage(std::vector<double> taps)
+    : taps_(std::move(taps)) {
+    if (taps_.empty()) {
+        throw std::invalid_argument("FIR needs at least one tap");
+    }
+}
+
+void FirStage::process(const SampleBlock& in, SampleBlock& out) {
+    out.resize(in.count, in.complex);
+    if (in.complex) {
+        if (!iq_) {
+            iq_.emplace(taps_);
+        }
+        iq_->process(in.iq(), in.count, out.iq());
+    } else {
+        if (!real_) {
+            real_.emplace(taps_);
+        }
+        real_->process(in.real(), in.count, out.real());
+    }
+}
+
+DecimatorStage::DecimatorStage(int factor, std::vector<double> taps)
+    : factor_(factor), taps_(std::move(taps)) {
+    if (factor_ < 1) {
+        throw std::invalid_argument("Decimation factor must be at least 1");
+    }
+}
+
+DecimatorStage::DecimatorStage(int factor, int num_taps)
+    : DecimatorStage(factor, design_lowpass_filter(0.4 / std::max(factor, 1), num_taps)) {}
+
+void DecimatorStage::process(const SampleBlock& in, SampleBlock& out) {
+    std::size_t produced = 0;
+    if (in.complex) {
+        if (!iq_) {
+            iq_.emplace(factor_, taps_);
+        }
+        out.resize(iq_->max_output(in.count), true);
+        produced = iq_->process(in.iq(), in.count, out.iq());
+    } else {
+        if (!real_) {
+            real_.emplace(factor_, taps_);
+        }
+        out.resize(real_->max_output(in.count), false);
+        produced = real_->process(in.real(), in.count, out.real());
+    }
+    out.count = produced;
+}
+
+NcoStage::NcoStage(double frequency)
+    : nco_(frequency) {}
+
+void NcoStage::process(const SampleBlock& in, SampleBlock& out) {
+    out.resize(in.count, true);
+    if (in.complex) {
+        nco_.process(in.iq(), in.count, out.iq());
+    } else {
+        nco_.process(in.real(), in.count, out.iq());
+    }
+}
+
+SpectrumStage::SpectrumStage(int fft_size)
+    : stft_(fft_size, fft_size) {}
+
+void SpectrumStage::process(const SampleBlock& in, SampleBlock& out) {
+    if (in.complex) {
+        throw std::invalid_argument("SpectrumStage needs real samples");
+    }
+    const std::size_t bins = stft_.bins();
+    frames_.resize(stft_.max_frames(in.count) * bins);
+    std::size_t frames = stft_.process(in.real(), in.count, frames_.data());
+
+    out.resize(frames * bins, false);
+    double* power = out.real();
+    for (std::size_t i = 0; i < frames * bins; ++i) {
+        power[i] = std::norm(frames_[i]);
+    }
+    out.frame_length = bins;
+    out.transform_size = static_cast<std::size_t>(stft_.frame_size());
+}
+
+// ============================================================================
+// SINKS
+// ============================================================================
+
+PeakSink::PeakSink(double sample_rate)
+    : sample_rate_(sample_rate) {}
+
+void PeakSink::consume(const SampleBlock& in) {
+    if (in.frame_length == 0) {
+        throw std::invalid_argument("PeakSink needs spectrum frames (put a SpectrumStage before it)");
+    }
+    for (std::size_t start = 0; start + in.frame_length <= in.count; start += in.frame_length) {
+        const double* frame = in.real() + start;
+        std::size_t peak = std::max_element(frame, frame + in.frame_length) - frame;
+        peaks_.push_back(peak * sample_rate_ / in.transform_size);
+    }
+}
+
+void CollectSink::consume(const SampleBlock& in) {
+    complex_ = in.complex;
+    if (in.complex) {
+        iq_.insert(iq_.end(), in.iq(), in.iq() + in.count);
+    } else {
+        real_.insert(real_.end(), in.real(), in.real() + in.count);
+    }
+}
+
+WriterSink::WriterSink(const std::string& path, const CaptureWriterConfig& config)
+    : writer_(path, config) {}
+
+void WriterSink::consume(const SampleBlock& in) {
+    if (in.complex) {
+        writer_.write(in.iq(), in.count);
+    } else {
+        writer_.write(in.real(), in.count);
+    }
+}
+
+void WriterSink::finish() {
+    writer_.close();
+}
+
+// ============================================================================
+// BLOCK RINGS
+// ============================================================================
+
+namespace {
+
+// The one-block spans a BlockRing hands out, as pointers (nullptr = none)
+SampleBlock* reserve_block(SpscRing<SampleBlock>& ring) {
+    RingSpan<SampleBlock> span = ring.reserve(1);
+    return span.empty() ? nullptr : span.data;
+}
+
+const SampleBlock* front_block(SpscRing<SampleBlock>& ring) {
+    RingSpan<const SampleBlock> span = ring.peek(1);
+    return span.empty() ? nullptr : span.data;
+}
+
+} // namespace
+
+// ============================================================================
+// FLOWGRAPH
+// ============================================================================
+
+namespace {
+
+// Seconds spent in `fn`, added to `busy`
+template <typename Fn>
+auto timed(double& busy, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    struct Accumulate {
+        double& busy;
+        std::chrono::steady_clock::time_point start;
+        ~Accumulate() {
+            busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    } accumulate{busy, start};
+    return fn();
+}
+
+} // namespace
+
+Flowgraph::Flowgraph(std::vector<std::shared_ptr<Stage>> stages, const FlowgraphConfig& config)
+    : stages_(std::move(stages)), config_(config) {
+    if (stages_.size() < 2) {
+        throw std::invalid_argument("A flowgraph needs at least a source and a sink");
+    }
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        const Stage* stage = stages_[i].get();
+        bool ok = stage != nullptr &&
+                  (i == 0 ? dynamic_cast<const SourceStage*>(stage) != nullptr
+                   : i + 1 == stages_.size() ? dynamic_cast<const SinkStage*>(stage) != nullptr
+                   : dynamic_cast<const ProcessStage*>(stage) != nullptr);
+        if (!ok) {
+            throw std::invalid_argument(
+                "Stage " + std::to_string(i) +
+                (i == 0 ? " must be a source" : i + 1 == stages_.size() ? " must be a sink"
+                                                                        : " must be a processing stage"));
+        }
+    }
+    if (config_.block_size == 0 || config_.queue_depth == 0) {
+        throw std::invalid_argument("Block size and queue depth must be positive");
+    }
+    validate_realtime_priority(config_.priority);
+
+    for (std::size_t i = 0; i + 1 < stages_.size(); ++i) {
+        rings_.push_back(std::make_unique<BlockRing>(config_.queue_depth));
+    }
+    stats_.resize(stages_.size());
+    realtime_errors_.resize(stages_.size());
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        stats_[i].name = stages_[i]->name();
+        std::string probe = "flowgraph." + std::to_string(i) + "." + stats_[i].name;
+        probes_.push_back(register_probe(probe));
+        trace_names_.push_back(intern_trace_name(probe));
+    }
+    for (std::size_t i = 0; i + 1 < stages_.size(); ++i) {
+        queue_names_.push_back(intern_trace_name("queue " + std::to_string(i) + " (" + stats_[i].name +
+                                                 " -> " + stats_[i + 1].name + ")"));
+    }
+}
+
+Flowgraph::~Flowgraph() {
+    if (started_ && !joined_) {
+        stop();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+}
+
+void Flowgraph::start() {
+    if (started_) {
+        throw std::runtime_error("A flowgraph can only be run once");
+    }
+    started_ = true;
+    if (config_.lock_memory) {
+        // Size (and so fault in) every slot for a full complex block now,
+        // so stages do not grow them mid-stream; then lock it all in
+        for (auto& ring : rings_) {
+            RingSpan<SampleBlock> slots = ring->reserve();
+            for (std::size_t i = 0; i < slots.count; ++i) {
+                slots.data[i].resize(config_.block_size, true);
+            }
+        }
+        std::string error = lock_process_memory();
+        memory_report_.memory_locked = error.empty();
+        if (!error.empty()) {
+            memory_report_.failures.push_back(error);
+        }
+    }
+    start_time_ = std::chrono::steady_clock::now();
+    threads_.reserve(stages_.size());
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        threads_.emplace_back([this, i] { run_stage(i); });
+    }
+}
+
+FlowgraphStats Flowgraph::wait() {
+    if (!started_) {
+        throw std::runtime_error("Flowgraph has not been started");
+    }
+    if (!joined_) {
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+        joined_ = true;
+        seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    }
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    FlowgraphStats result;
+    result.stages = stats_;
+    result.seconds = seconds_;
+    result.memory_locked = memory_report_.memory_locked;
+    result.realtime_failures = memory_report_.failures;
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        if (!realtime_errors_[i].empty()) {
+            result.realtime_failures.push_back("stage " + std::to_string(i) + " (" + stats_[i].name +
+                                               "): " + realtime_errors_[i]);
+        }
+    }
+    return result;
+}
+
+FlowgraphStats Flowgraph::run() {
+    start();
+    return wait();
+}
+
+void Flowgraph::stop() {
+    stop_.store(true, std::memory_order_release);
+}
+
+void Flowgraph::fail(std::exception_ptr error) {
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) {
+            error_ = error;
+        }
+    }
+    stop();
+}
+
+void Flowgraph::run_stage(std::size_t index) {
+    StageStats& stats = stats_[index];
+    set_trace_thread_name(trace_names_[index]);
+    std::string& errors = realtime_errors_[index];
+    if (index < config_.cpus.size() && config_.cpus[index] >= 0) {
+        stats.cpu = config_.cpus[index];
+        errors = pin_thread(current_thread_handle(), stats.cpu);
+        stats.pin_failed = !errors.empty();
+    }
+    if (config_.priority > 0) {
+        std::string error = set_fifo_priority(current_thread_handle(), config_.priority);
+        stats.priority_failed = !error.empty();
+        stats.priority = error.empty() ? config_.priority : 0;
+        errors += (errors.empty() || error.empty() ? "" : "; ") + error;
+    }
+
+    try {
+        if (index == 0) {
+            run_source(index);
+        } else if (index + 1 == stages_.size()) {
+            run_sink(index);
+        } else {
+            run_process(index);
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    // End of stream (or failure): let the next stage drain and finish
+    if (index < rings_.size()) {
+        rings_[index]->close();
+    }
+}
+
+void Flowgraph::run_source(std::size_t index) {
+    auto& source = static_cast<SourceStage&>(*stages_[index]);
+    BlockRing& out = *rings_[index];
+    StageStats& stats = stats_[index];
+
+    for (std::uint64_t sequence = 0; !stop_.load(std::memory_order_acquire); ++sequence) {
+        SampleBlock* block = reserve_block(out);
+        if (block == nullptr) {
+            stats.output_waits++;
+            Backoff backoff;
+            while ((block = reserve_block(out)) == nullptr) {
+                if (stop_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                backoff.pause();
+            }
+        }
+
+        {
+            ProbeScope probe(probes_[index]);
+            TraceScope trace(trace_names_[index], static_cast<std::int64_t>(sequence));
+            if (!timed(stats.busy_seconds, [&] { return source.produce(*block, config_.block_size); })) {
+                return;
+            }
+            probe.add_samples(block->count);
+        }
+        block->sequence = sequence;
+        stats.blocks++;
+        stats.samples += block->count;
+        out.commit(1);
+        trace_counter(queue_names_[index], static_cast<std::int64_t>(out.size()));
+    }
+}
+
+namespace {
+
+/**
+ * Next input block, or nullptr at end of stream / on stop. The closed flag
+ * is checked before the final look at the ring: a producer commits its last
+ * block before closing, so that block cannot be missed.
+ */
+template <typename Ring>
+const SampleBlock* next_input(Ring& in, const std::atomic<bool>& stop, std::uint64_t& waits) {
+    const SampleBlock* block = front_block(in);
+    if (block != nullptr) {
+        return block;
+    }
+    waits++;
+    Backoff backoff;
+    for (;;) {
+        if (stop.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        bool closed = in.closed();
+        if ((block = front_block(in)) != nullptr) {
+            return block;
+        }
+        if (closed) {
+            return nullptr;
+        }
+        backoff.pause();
+    }
+}
+
+} // namespace
+
+void Flowgraph::run_process(std::size_t index) {
+    auto& stage = static_cast<ProcessStage&>(*stages_[index]);
+    BlockRing& in = *rings_[index - 1];
+    BlockRing& out = *rings_[index];
+    StageStats& stats = stats_[index];
+
+    while (const SampleBlock* input = next_input(in, stop_, stats.input_waits)) {
+        SampleBlock* output = reserve_block(out);
+        if (output == nullptr) {
+            stats.output_waits++;
+            Backoff backoff;
+            while ((output = reserve_block(out)) == nullptr) {
+                if (stop_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                backoff.pause();
+            }
+        }
+
+        {
+            ProbeScope probe(probes_[index], input->count);
+            TraceScope trace(trace_names_[index], static_cast<std::int64_t>(input->sequence));
+            timed(stats.busy_seconds, [&] { stage.process(*input, *output); });
+        }
+        output->sequence = input->sequence;
+        stats.blocks++;
+        stats.samples += input->count;
+        in.consume(1);
+        trace_counter(queue_names_[index - 1], static_cast<std::int64_t>(in.size()));
+
+        // Decimators and spectrum stages may have nothing to pass on yet
+        if (output->count > 0) {
+            out.commit(1);
+            trace_counter(queue_names_[index], static_cast<std::int64_t>(out.size()));
+        }
+    }
+}
+
+void Flowgraph::run_sink(std::size_t index) {
+    auto& sink = static_cast<SinkStage&>(*stages_[index]);
+    BlockRing& in = *rings_[index - 1];
+    StageStats& stats = stats_[index];
+
+    while (const SampleBlock* input = next_input(in, stop_, stats.input_waits)) {
+        {
+            ProbeScope probe(probes_[index], input->count);
+            TraceScope trace(trace_names_[index], static_cast<std::int64_t>(input->sequence));
+            timed(stats.busy_seconds, [&] { sink.consume(*input); });
+        }
+        stats.blocks++;
+        stats.samples += input->count;
+        in.consume(1);
+        trace_counter(queue_names_[index - 1], static_cast<std::int64_t>(in.size()));
+    }
+    if (!stop_.load(std::memory_order_acquire)) {
+        timed(stats.busy_seconds, [&] { sink.finish(); });
+    }
+}
+
+} // namespace signal_processor
@@ -0,0 +1,391 @@
+#ifndef FLOWGRAPH_H
+#define FLOWGRAPH_H
+
+#include "capture_reader.h"
+#include "capture_writer.h"
+#include "instrumentation.h"
+#include "realtime.h"
+#include "ring_buffer.h"
+#include "stream_processors.h"
+#include "trace.h"
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Flowgraph Pipeline Engine
+ *
+ * Calling generate → filter → FFT → peak one after another on one thread
+ * uses one core, however many the machine has. A flowgraph runs every
+ * stage on its own thread instead, connected by lock-free single-producer
+ * single-consumer rings of sample blocks:
+ *
+ *   [source] ──ring──► [stage] ──ring──► [stage] ──ring──► [sink]
+ *    thread 0           thread 1          thread 2          thread 3
+ *
+ * While the sink handles block n, the FFT works on block n+1 and the
+ * filter on block n+2, so throughput is set by the slowest stage rather
+ * than the sum of all of them.
+ *
+ * Blocks are preallocated ring slots that each stage writes in place, so
+ * in steady state nothing is allocated or copied between stages. When a
+ * ring is full its producer waits (backpressure); when the source runs
+ * dry the end of stream propagates down the chain and run() returns.
+ *
+ * For bounded worst-case latency, FlowgraphConfig can pin each stage to a
+ * core, run the stage threads under SCHED_FIFO and lock the process's
+ * memory (see realtime.h); whatever the system refuses is listed in
+ * FlowgraphStats::realtime_failures.
+ *
+ * Declaring a graph:
+ *
+ *   auto peaks = std::make_shared<PeakSink>(1e6);
+ *   Flowgraph graph({
+ *       std::make_shared<ToneSource>(1e3, 1e6, 0.1, 10'000'000),
+ *       std::make_shared<FirStage>(design_lowpass_filter(0.01, 101)),
+ *       std::make_shared<SpectrumStage>(1024),
+ *       peaks,
+ *   });
+ *   FlowgraphStats stats = graph.run();
+ *   // peaks->peaks(): strongest frequency of every 1024-sample frame
+ */
+
+namespace signal_processor {
+
+// ============================================================================
+// SAMPLE BLOCKS
+// ============================================================================
+
+/**
+ * One unit of work flowing between stages
+ *
+ * Holds `count` real samples or `count` complex samples (interleaved in
+ * `values`). Spectrum stages emit frames: `frame_length` values per frame
+ * computed with a `transform_size`-point FFT.
+ */
+struct SampleBlock {
+    std::vector<double> values;
+    std::size_t count = 0;
+    bool complex = false;
+    std::uint64_t sequence = 0;        // Block number from the source
+    std::size_t frame_length = 0;      // 0 = time-domain samples
+    std::size_t transform_size = 0;
+
+    // Size for `n` samples; keeps capacity, so steady state never allocates
+    void resize(std::size_t n, bool is_complex) {
+        count = n;
+        complex = is_complex;
+        frame_length = 0;
+        transform_size = 0;
+        std::size_t needed = n * (is_complex ? 2 : 1);
+        if (values.size() < needed) {
+            values.resize(needed);
+        }
+    }
+
+    double* real() { return values.data(); }
+    const double* real() const { return values.data(); }
+    std::complex<double>* iq() { return reinterpret_cast<std::complex<double>*>(values.data()); }
+    const std::complex<double>* iq() const {
+        return reinterpret_cast<const std::complex<double>*>(values.data());
+    }
+};
+
+// ============================================================================
+// STAGES
+// ============================================================================
+
+/**
+ * Base of every stage. Each stage instance is driven by exactly one thread,
+ * so implementations need no locking of their own.
+ */
+class Stage {
+public:
+    virtual ~Stage() = default;
+    virtual std::string name() const = 0;
+};
+
+// First stage: fills blocks until the stream ends
+class SourceStage : public Stage {
+public:
+    // Fill `out` with up to `block_size` samples; false = end of stream
+    virtual bool produce(SampleBlock& out, std::size_t block_size) = 0;
+};
+
+// Middle stages: one input block → one output block (possibly empty)
+class ProcessStage : public Stage {
+public:
+    // Write the result into `out` (out.count = 0 forwards nothing)
+    virtual void process(const SampleBlock& in, SampleBlock& out) = 0;
+};
+
+// Last stage: consumes blocks
+class SinkStage : public Stage {
+public:
+    virtual void consume(const SampleBlock& in) = 0;
+    // Called once after the last block
+    virtual void finish() {}
+};
+
+/**
+ * Real sine wave plus Gaussian noise, phase-continuous across blocks
+ * (the streaming counterpart of generate_test_signal)
+ */
+class ToneSource : public SourceStage {
+public:
+    ToneSource(double frequency, double sample_rate, double noise_amplitude,
+               std::uint64_t num_samples, unsigned seed = 42);
+    std::string name() const override { return "tone"; }
+    bool produce(SampleBlock& out, std::size_t block_size) override;
+
+private:
+    double step_;           // Cycles per sample
+    double noise_amplitude_;
+    std::uint64_t remaining_;
+    std::uint64_t position_ = 0;
+    std::mt19937 rng_;
+    std::normal_distribution<double> noise_{0.0, 1.0};
+};
+
+// Samples held in memory (real or complex)
+class ArraySource : public SourceStage {
+public:
+    explicit ArraySource(std::vector<double> samples);
+    explicit ArraySource(std::vector<std::complex<double>> samples);
+    std::string name() const override { return "array"; }
+    bool produce(SampleBlock& out, std::size_t block_size) override;
+
+private:
+    std::vector<double> real_;
+    std::vector<std::complex<double>> iq_;
+    bool complex_;
+    std::size_t position_ = 0;
+};
+
+// A recording on disk, streamed through a memory mapping
+class CaptureSource : public SourceStage {
+public:
+    // `format` is ignored for SigMF paths (the metadata decides)
+    CaptureSource(const std::string& path, SampleFormat format);
+    std::string name() const override { return "capture"; }
+    bool produce(SampleBlock& out, std::size_t block_size) override;
+
+    const CaptureInfo& info() const { return capture_.info(); }
+
+private:
+    MappedCapture capture_;
+    std::uint64_t position_ = 0;
+};
+
+// Streaming FIR; real or complex, decided by the first block
+class FirStage : public ProcessStage {
+public:
+    explicit FirStage(std::vector<double> taps);
+    std::string name() const override { return "fir"; }
+    void process(const SampleBlock& in, SampleBlock& out) override;
+
+private:
+    std::vector<double> taps_;
+    std::optional<StreamingFir<double>> real_;
+    std::optional<StreamingFir<std::complex<double>>> iq_;
+};
+
+// Anti-aliased decimation by an integer factor
+class DecimatorStage : public ProcessStage {
+public:
+    DecimatorStage(int factor, std::vector<double> taps);
+    DecimatorStage(int factor, int num_taps);
+    std::string name() const override { return "decimator"; }
+    void process(const SampleBlock& in, SampleBlock& out) override;
+
+private:
+    int factor_;
+    std::vector<double> taps_;
+    std::optional<Decimator<double>> real_;
+    std::optional<Decimator<std::complex<double>>> iq_;
+};
+
+// Frequency shift (digital mixer); always emits complex samples
+class NcoStage : public ProcessStage {
+public:
+    explicit NcoStage(double frequency);
+    std::string name() const override { return "nco"; }
+    void process(const SampleBlock& in, SampleBlock& out) override;
+
+private:
+    Nco nco_;
+};
+
+/**
+ * Power spectrum |X[k]|² of consecutive, non-overlapping Hann-windowed
+ * frames (real input; fft_size / 2 + 1 bins per frame)
+ */
+class SpectrumStage : public ProcessStage {
+public:
+    explicit SpectrumStage(int fft_size);
+    std::string name() const override { return "spectrum"; }
+    void process(const SampleBlock& in, SampleBlock& out) override;
+
+private:
+    Stft stft_;
+    std::vector<std::complex<double>> frames_;
+};
+
+// Strongest bin of every spectrum frame, as a frequency in Hz
+class PeakSink : public SinkStage {
+public:
+    explicit PeakSink(double sample_rate);
+    std::string name() const override { return "peak"; }
+    void consume(const SampleBlock& in) override;
+
+    // Safe to read after the graph has finished
+    const std::vector<double>& peaks() const { return peaks_; }
+
+private:
+    double sample_rate_;
+    std::vector<double> peaks_;
+};
+
+// Keeps every sample it receives (tests, short captures)
+class CollectSink : public SinkStage {
+public:
+    std::string name() const override { return "collect"; }
+    void consume(const SampleBlock& in) override;
+
+    bool complex() const { return complex_; }
+    const std::vector<double>& real() const { return real_; }
+    const std::vector<std::complex<double>>& iq() const { return iq_; }
+
+private:
+    bool complex_ = false;
+    std::vector<double> real_;
+    std::vector<std::complex<double>> iq_;
+};
+
+// Records the stream to disk through a CaptureWriter
+class WriterSink : public SinkStage {
+public:
+    WriterSink(const std::string& path, const CaptureWriterConfig& config);
+    std::string name() const override { return "writer"; }
+    void consume(const SampleBlock& in) override;
+    void finish() override;
+
+    CaptureWriterStats stats() const { return writer_.stats(); }
+
+private:
+    CaptureWriter writer_;
+};
+
+// ============================================================================
+// FLOWGRAPH
+// ============================================================================
+
+struct FlowgraphConfig {
+    std::size_t block_size = 8192;    // Samples per source block
+    std::size_t queue_depth = 8;      // Blocks per ring (rounded up to a power of 2)
+    // CPU for each stage's thread, in stage order (-1 = not pinned);
+    // empty = no pinning at all
+    std::vector<int> cpus;
+    // SCHED_FIFO priority for every stage thread (1-99); 0 = normal scheduling
+    int priority = 0;
+    // Size every ring slot for a full block and mlockall() the process
+    // before the threads start, so streaming never page-faults
+    bool lock_memory = false;
+};
+
+struct StageStats {
+    std::string name;
+    std::uint64_t blocks = 0;          // Blocks handled
+    std::uint64_t samples = 0;         // Input samples (source: output)
+    double busy_seconds = 0.0;         // Time inside the stage's own code
+    std::uint64_t input_waits = 0;     // Times the input ring was empty
+    std::uint64_t output_waits = 0;    // Times the output ring was full
+    int cpu = -1;                      // Pinned CPU, -1 if not pinned
+    bool pin_failed = false;           // Pinning was requested but refused
+    int priority = 0;                  // SCHED_FIFO priority obtained, 0 if none
+    bool priority_failed = false;      // SCHED_FIFO was requested but refused
+};
+
+struct FlowgraphStats {
+    std::vector<StageStats> stages;
+    double seconds = 0.0;              // Wall-clock time of the run
+    bool memory_locked = false;        // lock_memory was requested and granted
+    // Real-time guarantees requested but not obtained, one line each
+    std::vector<std::string> realtime_failures;
+};
+
+class Flowgraph {
+public:
+    /**
+     * @param stages Source, zero or more process stages, then a sink
+     * @throws std::invalid_argument if the chain is not source → ... → sink
+     */
+    explicit Flowgraph(std::vector<std::shared_ptr<Stage>> stages,
+                       const FlowgraphConfig& config = {});
+
+    // Stops (if running) and joins every thread
+    ~Flowgraph();
+
+    Flowgraph(const Flowgraph&) = delete;
+    Flowgraph& operator=(const Flowgraph&) = delete;
+
+    // Launch one thread per stage; a graph runs once
+    void start();
+
+    /**
+     * Wait for the end of stream to reach the sink
+     *
+     * @throws whatever a stage threw (the graph stops at the first error)
+     */
+    FlowgraphStats wait();
+
+    // start() + wait()
+    FlowgraphStats run();
+
+    // Ask every stage to finish early; wait() still has to be called
+    void stop();
+
+    const std::vector<std::shared_ptr<Stage>>& stages() const { return stages_; }
+
+private:
+    using BlockRing = SpscRing<SampleBlock>;
+
+    void run_source(std::size_t index);
+    void run_process(std::size_t index);
+    void run_sink(std::size_t index);
+    void run_stage(std::size_t index);
+    void fail(std::exception_ptr error);
+
+    std::vector<std::shared_ptr<Stage>> stages_;
+    FlowgraphConfig config_;
+    std::vector<std::unique_ptr<BlockRing>> rings_;   // rings_[i]: stage i → i+1
+    std::vector<StageStats> stats_;
+    std::vector<ProbeId> probes_;                     // Per stage: "flowgraph.<index>.<name>"
+    std::vector<const char*> trace_names_;            // Same names, for trace spans
+    std::vector<const char*> queue_names_;            // Per ring: "queue <i> (<from> -> <to>)"
+    std::vector<std::string> realtime_errors_;        // Per stage, written by its thread
+    RealtimeReport memory_report_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stop_{false};
+    bool started_ = false;
+    bool joined_ = false;
+    double seconds_ = 0.0;
+    std::chrono::steady_clock::time_point start_time_;
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+} // namespace signal_processor
+
+#endif // FLOWGRAPH_H
@@ -0,0 +1,507 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <cmath>
+
+#if SIGNAL_PROCESSOR_INSTRUMENTATION
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#endif
+
+namespace signal_processor {
+
+std::uint64_t ProbeSnapshot::percentile_ns(double fraction) const {
+    if (calls == 0 || histogram.empty()) {
+        return 0;
+    }
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    auto target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(calls)));
+    std::uint64_t seen = 0;
+    for (const auto& [upper, count] : histogram) {
+        seen += count;
+        if (seen >= target) {
+            return std::min(upper, max_ns);
+        }
+    }
+    return max_ns;
+}
+
+bool instrumentation_enabled() {
+    return SIGNAL_PROCESSOR_INSTRUMENTATION != 0;
+}
+
+#if SIGNAL_PROCESSOR_INSTRUMENTATION
+
+namespace {
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+
+// Below 16 ns every value has its own bucket; above, each power of two
+// [2^e, 2^(e+1)) is split into 16 equal buckets, up to 2^40 ns (~18 min)
+constexpr unsigned kSubBucketBits = 4;
+constexpr std::uint64_t kSubBuckets = 1u << kSubBucketBits;
+constexpr unsigned kMaxExponent = 40;
+constexpr std::size_t kBuckets = kSubBuckets + (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+std::size_t bucket_of(std::uint64_t ns) {
+    if (ns < kSubBuckets) {
+        return static_cast<std::size_t>(ns);
+    }
+    unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+    if (exponent > kMaxExponent) {
+        return kBuckets - 1;
+    }
+    unsigned shift = exponent - kSubBucketBits;
+    return kSubBuckets + shift * kSubBuckets + static_cast<std::size_t>((ns >> shift) & (kSubBuckets - 1));
+}
+
+// Largest latency that falls into `bucket`
+std::uint64_t bucket_upper(std::size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    std::size_t shift = (bucket - kSubBuckets) / kSubBuckets;
+    std::uint64_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+}
+
+// ============================================================================
+// PER-THREAD COUNTERS
+// ============================================================================
+
+// Only the owning thread writes; snapshots read concurrently. Relaxed
+// load + store (rather than fetch_add) keeps the write path free of locked
+// instructions
+inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct alignas(64) ProbeCounters {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> samples{0};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> min_ns{std::numeric_limits<std::uint64_t>::max()};
+    std::atomic<std::uint64_t> max_ns{0};
+    std::atomic<std::uint64_t> violations{0};
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};
+    std::atomic<std::uint64_t> hardware_calls{0};
+    std::atomic<std::uint32_t> hardware_valid{0};
+    std::array<std::atomic<std::uint64_t>, kPerfEventCount> hardware{};
+
+    void clear() {
+        for (auto* counter : {&calls, &samples, &allocations, &total_ns, &max_ns, &violations}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        min_ns.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        hardware_calls.store(0, std::memory_order_relaxed);
+        hardware_valid.store(0, std::memory_order_relaxed);
+        for (auto& count : hardware) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct ThreadCounters {
+    std::atomic<std::uint64_t> epoch{0};
+    std::array<std::atomic<ProbeCounters*>, kMaxProbes> probes{};
+
+    ~ThreadCounters() {
+        for (auto& probe : probes) {
+            delete probe.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Plain totals: counters of exited threads, only touched under the lock
+struct ProbeTotals {
+    std::uint64_t calls = 0;
+    std::uint64_t samples = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t min_ns = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t max_ns = 0;
+    std::uint64_t violations = 0;
+    std::array<std::uint64_t, kBuckets> buckets{};
+    std::uint64_t hardware_calls = 0;
+    PerfSample hardware;
+
+    void add(const ProbeCounters& counters) {
+        calls += counters.calls.load(std::memory_order_relaxed);
+        samples += counters.samples.load(std::memory_order_relaxed);
+        allocations += counters.allocations.load(std::memory_order_relaxed);
+        total_ns += counters.total_ns.load(std::memory_order_relaxed);
+        min_ns = std::min(min_ns, counters.min_ns.load(std::memory_order_relaxed));
+        max_ns = std::max(max_ns, counters.max_ns.load(std::memory_order_relaxed));
+        violations += counters.violations.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+        }
+        hardware_calls += counters.hardware_calls.load(std::memory_order_relaxed);
+        hardware.valid |= counters.hardware_valid.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+            hardware.counts[i] += counters.hardware[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    void add(const ProbeTotals& other) {
+        calls += other.calls;
+        samples += other.samples;
+        allocations += other.allocations;
+        total_ns += other.total_ns;
+        min_ns = std::min(min_ns, other.min_ns);
+        max_ns = std::max(max_ns, other.max_ns);
+        violations += other.violations;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        hardware_calls += other.hardware_calls;
+        hardware.valid |= other.hardware.valid;
+        for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+            hardware.counts[i] += other.hardware.counts[i];
+        }
+    }
+};
+
+// ============================================================================
+// REGISTRY
+// ============================================================================
+
+// The lock guards probe registration, thread arrival/exit and snapshots -
+// never the recording path
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, ProbeId> ids;
+    std::array<std::atomic<std::uint64_t>, kMaxProbes> budgets{};
+    std::vector<ThreadCounters*> threads;
+    std::array<std::unique_ptr<ProbeTotals>, kMaxProbes> retired;
+    std::atomic<std::uint64_t> epoch{1};
+
+    ProbeId id_locked(const std::string& name) {
+        auto found = ids.find(name);
+        if (found != ids.end()) {
+            return found->second;
+        }
+        // The last id is kept for the names that no longer fit
+        bool full = names.size() + 1 >= kMaxProbes;
+        const std::string& key = full ? std::string("(overflow)") : name;
+        if (full && (found = ids.find(key)) != ids.end()) {
+            return found->second;
+        }
+        auto id = static_cast<ProbeId>(names.size());
+        names.push_back(key);
+        ids.emplace(key, id);
+        return id;
+    }
+
+    // A thread's counters outlive the thread: fold them into `retired`
+    void retire(ThreadCounters* counters) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.erase(std::find(threads.begin(), threads.end(), counters));
+        if (counters->epoch.load(std::memory_order_relaxed) == epoch.load(std::memory_order_relaxed)) {
+            for (std::size_t id = 0; id < kMaxProbes; ++id) {
+                if (const ProbeCounters* probe = counters->probes[id].load(std::memory_order_relaxed)) {
+                    if (!retired[id]) {
+                        retired[id] = std::make_unique<ProbeTotals>();
+                    }
+                    retired[id]->add(*probe);
+                }
+            }
+        }
+        delete counters;
+    }
+};
+
+// Never destroyed: threads may still exit (and retire) during static destruction
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+// Registers the calling thread on its first record and retires it on exit
+struct ThreadSlot {
+    ThreadCounters* counters = nullptr;
+
+    ~ThreadSlot() {
+        if (counters != nullptr) {
+            registry().retire(counters);
+        }
+    }
+
+    ThreadCounters& get() {
+        if (counters == nullptr) {
+            auto fresh = std::make_unique<ThreadCounters>();
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            fresh->epoch.store(reg.epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            reg.threads.push_back(fresh.get());
+            counters = fresh.release();
+        }
+        return *counters;
+    }
+};
+
+thread_local ThreadSlot thread_slot;
+thread_local std::uint64_t allocation_count = 0;
+
+// Hardware counters: switched on process-wide, opened per thread on first use
+std::atomic<bool> hardware_counters_enabled{false};
+thread_local std::unique_ptr<PerfCounters> thread_hardware_counters;
+
+PerfCounters& hardware_counters() {
+    if (!thread_hardware_counters) {
+        thread_hardware_counters = std::make_unique<PerfCounters>();
+    }
+    return *thread_hardware_counters;
+}
+
+} // namespace
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+ProbeId register_probe(const std::string& name) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.id_locked(name);
+}
+
+std::uint64_t thread_allocations() {
+    return allocation_count;
+}
+
+void record_probe(ProbeId id, std::uint64_t nanoseconds, std::uint64_t samples,
+                  std::uint64_t allocations, const PerfSample* hardware) {
+    // The first record on a thread / of a probe allocates its counters;
+    // keep those allocations out of any enclosing probe's count
+    const std::uint64_t allocations_before = allocation_count;
+    Registry& reg = registry();
+    ThreadCounters& thread = thread_slot.get();
+
+    // A reset since this thread last recorded: start its counters over
+    std::uint64_t epoch = reg.epoch.load(std::memory_order_relaxed);
+    if (thread.epoch.load(std::memory_order_relaxed) != epoch) {
+        for (auto& probe : thread.probes) {
+            if (ProbeCounters* counters = probe.load(std::memory_order_relaxed)) {
+                counters->clear();
+            }
+        }
+        thread.epoch.store(epoch, std::memory_order_relaxed);
+    }
+
+    ProbeCounters* counters = thread.probes[id].load(std::memory_order_relaxed);
+    if (counters == nullptr) {
+        counters = new ProbeCounters();
+        thread.probes[id].store(counters, std::memory_order_release);
+    }
+
+    bump(counters->calls, 1);
+    bump(counters->samples, samples);
+    bump(counters->allocations, allocations);
+    bump(counters->total_ns, nanoseconds);
+    bump(counters->buckets[bucket_of(nanoseconds)], 1);
+    if (nanoseconds < counters->min_ns.load(std::memory_order_relaxed)) {
+        counters->min_ns.store(nanoseconds, std::memory_order_relaxed);
+    }
+    if (nanoseconds > counters->max_ns.load(std::memory_order_relaxed)) {
+        counters->max_ns.store(nanoseconds, std::memory_order_relaxed);
+    }
+    std::uint64_t budget = reg.budgets[id].load(std::memory_order_relaxed);
+    if (budget != 0 && nanoseconds > budget) {
+        bump(counters->violations, 1);
+    }
+    if (hardware != nullptr && hardware->valid != 0) {
+        bump(counters->hardware_calls, 1);
+        counters->hardware_valid.store(counters->hardware_valid.load(std::memory_order_relaxed) | hardware->valid,
+                                       std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+            bump(counters->hardware[i], hardware->counts[i]);
+        }
+    }
+    allocation_count = allocations_before;
+}
+
+bool begin_probe_counters(PerfSample& start) {
+    if (!hardware_counters_enabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    start = hardware_counters().read();
+    return true;
+}
+
+void end_probe_counters(PerfSample& start) {
+    start = hardware_counters().read() - start;
+}
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+InstrumentationSnapshot instrumentation_snapshot() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::uint64_t epoch = reg.epoch.load(std::memory_order_relaxed);
+
+    InstrumentationSnapshot snapshot;
+    snapshot.enabled = true;
+    std::vector<ProbeTotals> totals(reg.names.size());
+    for (std::size_t id = 0; id < totals.size(); ++id) {
+        if (reg.retired[id]) {
+            totals[id].add(*reg.retired[id]);
+        }
+    }
+    for (const ThreadCounters* thread : reg.threads) {
+        if (thread->epoch.load(std::memory_order_relaxed) != epoch) {
+            continue;
+        }
+        bool recorded = false;
+        for (std::size_t id = 0; id < totals.size(); ++id) {
+            if (const ProbeCounters* probe = thread->probes[id].load(std::memory_order_acquire)) {
+                totals[id].add(*probe);
+                recorded = true;
+            }
+        }
+        snapshot.threads += recorded ? 1 : 0;
+    }
+
+    for (std::size_t id = 0; id < totals.size(); ++id) {
+        const ProbeTotals& total = totals[id];
+        if (total.calls == 0) {
+            continue;
+        }
+        ProbeSnapshot probe;
+        probe.name = reg.names[id];
+        probe.calls = total.calls;
+        probe.samples = total.samples;
+        probe.allocations = total.allocations;
+        probe.total_ns = total.total_ns;
+        probe.min_ns = total.min_ns;
+        probe.max_ns = total.max_ns;
+        probe.budget_ns = reg.budgets[id].load(std::memory_order_relaxed);
+        probe.budget_violations = total.violations;
+        probe.hardware_calls = total.hardware_calls;
+        probe.hardware = total.hardware;
+        for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+            if (total.buckets[bucket] != 0) {
+                probe.histogram.emplace_back(bucket_upper(bucket), total.buckets[bucket]);
+            }
+        }
+        snapshot.probes.push_back(std::move(probe));
+    }
+    std::sort(snapshot.probes.begin(), snapshot.probes.end(),
+              [](const ProbeSnapshot& a, const ProbeSnapshot& b) { return a.name < b.name; });
+    return snapshot;
+}
+
+void reset_instrumentation() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.epoch.fetch_add(1, std::memory_order_relaxed);
+    for (auto& totals : reg.retired) {
+        totals.reset();
+    }
+}
+
+void set_latency_budget(const std::string& name, std::uint64_t budget_ns) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.budgets[reg.id_locked(name)].store(budget_ns, std::memory_order_relaxed);
+}
+
+std::vector<std::string> set_probe_hardware_counters(bool enabled) {
+    hardware_counters_enabled.store(enabled, std::memory_order_relaxed);
+    return enabled ? hardware_counters().errors() : std::vector<std::string>{};
+}
+
+#else
+
+InstrumentationSnapshot instrumentation_snapshot() {
+    return {};
+}
+
+void reset_instrumentation() {}
+
+void set_latency_budget(const std::string&, std::uint64_t) {}
+
+std::vector<std::string> set_probe_hardware_counters(bool enabled) {
+    if (!enabled) {
+        return {};
+    }
+    return {"instrumentation is compiled out (build with -DSIGNAL_PROCESSOR_INSTRUMENTATION=ON)"};
+}
+
+#endif
+
+} // namespace signal_processor
+
+#if SIGNAL_PROCESSOR_INSTRUMENTATION
+
+// ============================================================================
+// ALLOCATION COUNTING
+// ============================================================================
+//
+// Instrumented builds replace the global allocation functions so a probe can
+// tell how many allocations its scope made. The array, nothrow and sized
+// forms fall back to these in the standard library.
+
+namespace {
+
+void* counted_allocate(std::size_t size, std::size_t alignment) {
+    ++signal_processor::allocation_count;
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void* memory = alignment > alignof(std::max_align_t)
+                           ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                           : std::malloc(size);
+        if (memory != nullptr) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return counted_allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "perf_counters.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Stage Instrumentation
+ *
+ * FlowgraphStats says how busy each stage was on average; it cannot say
+ * whether the FFT stage misses its deadline once every ten thousand blocks,
+ * or whether a filter allocates on every call. Probes placed around each
+ * processing stage and kernel record, per call:
+ *
+ *   calls, samples     how often the probe ran and how much data it saw
+ *   latency histogram  HDR-style log-linear buckets: 16 per power of two,
+ *                      so every percentile is exact to within ~6%, from
+ *                      nanoseconds up to minutes, in a fixed 5 KB per probe
+ *   allocations        operator new calls made inside the probe
+ *   budget violations  calls slower than the probe's latency budget
+ *   hardware counters  cycles, instructions, cache misses and branch
+ *                      mispredicts (perf_counters.h), once switched on with
+ *                      set_probe_hardware_counters(true)
+ *
+ * Recording never locks or shares a cache line between threads: each
+ * thread owns its counters and is the only writer, so a probe costs two
+ * clock reads and a few uncontended stores. A snapshot sums every thread's
+ * counters (plus those of threads that have exited) while they keep
+ * running; it is consistent per counter, not across counters.
+ *
+ * Everything is compiled out unless the library is built with
+ * -DSIGNAL_PROCESSOR_INSTRUMENTATION=ON: the probes become empty inline
+ * functions, and snapshots are empty. Instrumented builds also replace
+ * the global operator new/delete to count allocations.
+ *
+ *   void process(const double* input, std::size_t length) {
+ *       SP_INSTRUMENT("my_stage", length);
+ *       ...
+ *   }
+ *
+ *   set_latency_budget("my_stage", 50000);   // 50 µs
+ *   for (const ProbeSnapshot& probe : instrumentation_snapshot().probes) ...
+ */
+
+namespace signal_processor {
+
+using ProbeId = std::uint32_t;
+
+// Distinct probe names per process; further names share an "(overflow)" probe
+constexpr std::size_t kMaxProbes = 256;
+
+struct ProbeSnapshot {
+    std::string name;
+    std::uint64_t calls = 0;
+    std::uint64_t samples = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t min_ns = 0;
+    std::uint64_t max_ns = 0;
+    std::uint64_t budget_ns = 0;           // 0 = no budget
+    std::uint64_t budget_violations = 0;
+    // (upper bound in ns, calls) for every non-empty histogram bucket
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> histogram;
+    // Counter totals over the calls made while hardware counters were on
+    std::uint64_t hardware_calls = 0;
+    PerfSample hardware;
+
+    // Latency below which `fraction` (0-1) of the calls completed
+    std::uint64_t percentile_ns(double fraction) const;
+    double mean_ns() const { return calls > 0 ? static_cast<double>(total_ns) / calls : 0.0; }
+};
+
+struct InstrumentationSnapshot {
+    bool enabled = false;
+    std::size_t threads = 0;               // Running threads that have recorded since the last reset
+    std::vector<ProbeSnapshot> probes;     // Probes called since the last reset, by name
+};
+
+// True when the library was built with SIGNAL_PROCESSOR_INSTRUMENTATION
+bool instrumentation_enabled();
+
+// Sum of every thread's counters
+InstrumentationSnapshot instrumentation_snapshot();
+
+// Zero every counter (each thread clears its own on its next record)
+void reset_instrumentation();
+
+/**
+ * Count calls to `name` slower than `budget_ns` (0 removes the budget).
+ * The probe need not have run yet.
+ */
+void set_latency_budget(const std::string& name, std::uint64_t budget_ns);
+
+/**
+ * Also count cycles, cache misses and branch mispredicts in every probe.
+ * Each probed call then costs two extra read() system calls (~1-2 µs), so
+ * this is for profiling runs, not for leaving on.
+ *
+ * @return Counters the calling thread could not open (see PerfCounters);
+ *         other threads open theirs on their next probe
+ */
+std::vector<std::string> set_probe_hardware_counters(bool enabled);
+
+#if SIGNAL_PROCESSOR_INSTRUMENTATION
+
+// Id for `name`, registered on first use (takes a lock: call once per site)
+ProbeId register_probe(const std::string& name);
+
+// Record one call on the calling thread (`hardware`: its counter deltas, or null)
+void record_probe(ProbeId id, std::uint64_t nanoseconds, std::uint64_t samples,
+                  std::uint64_t allocations, const PerfSample* hardware);
+
+// When hardware counters are on, the calling thread's totals into `start`
+bool begin_probe_counters(PerfSample& start);
+
+// Turn `start` into the counts since begin_probe_counters()
+void end_probe_counters(PerfSample& start);
+
+// operator new calls made by the calling thread so far
+std::uint64_t thread_allocations();
+
+// Times its own lifetime and records it as one call of a probe
+class ProbeScope {
+public:
+    explicit ProbeScope(ProbeId id, std::uint64_t samples = 0)
+        : id_(id), samples_(samples), counting_(begin_probe_counters(hardware_)),
+          allocations_(thread_allocations()), start_(std::chrono::steady_clock::now()) {}
+
+    ~ProbeScope() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        std::uint64_t allocations = thread_allocations() - allocations_;
+        if (counting_) {
+            end_probe_counters(hardware_);
+        }
+        record_probe(id_,
+                     static_cast<std::uint64_t>(
+                         std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                     samples_, allocations, counting_ ? &hardware_ : nullptr);
+    }
+
+    ProbeScope(const ProbeScope&) = delete;
+    ProbeScope& operator=(const ProbeScope&) = delete;
+
+    // For stages that only learn their sample count once they have run
+    void add_samples(std::uint64_t samples) { samples_ += samples; }
+
+private:
+    ProbeId id_;
+    std::uint64_t samples_;
+    PerfSample hardware_;
+    bool counting_;
+    std::uint64_t allocations_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define SP_INSTRUMENT_CONCAT_(a, b) a##b
+#define SP_INSTRUMENT_CONCAT(a, b) SP_INSTRUMENT_CONCAT_(a, b)
+
+// Probe the rest of the enclosing scope as one call of `name`
+#define SP_INSTRUMENT(name, samples)                                                        \
+    static const ::signal_processor::ProbeId SP_INSTRUMENT_CONCAT(sp_probe_id_, __LINE__) = \
+        ::signal_processor::register_probe(name);                                           \
+    ::signal_processor::ProbeScope SP_INSTRUMENT_CONCAT(sp_probe_, __LINE__)(              \
+        SP_INSTRUMENT_CONCAT(sp_probe_id_, __LINE__), static_cast<std::uint64_t>(samples))
+
+#else
+
+// Instrumentation compiled out: the same interface, doing nothing
+
+inline ProbeId register_probe(const std::string&) { return 0; }
+
+class ProbeScope {
+public:
+    explicit ProbeScope(ProbeId, std::uint64_t = 0) {}
+    void add_samples(std::uint64_t) {}
+};
+
+#define SP_INSTRUMENT(name, samples) ((void)0)
+
+#endif
+
+} // namespace signal_processor
+
+#endif // INSTRUMENTATION_H
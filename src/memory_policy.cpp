@@ -0,0 +1,295 @@
+#include "memory_policy.h"
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace signal_processor {
+
+namespace {
+
+constexpr std::size_t k2M = std::size_t{2} << 20;
+constexpr std::size_t k1G = std::size_t{1} << 30;
+
+// Not in every libc's headers
+constexpr int kMapHugeShift = 26;
+constexpr int kMpolBind = 2;
+constexpr unsigned kMpolMfMove = 1u << 1;
+
+std::size_t base_page_size() {
+    static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+}
+
+std::size_t round_up(std::size_t bytes, std::size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+int log2_size(std::size_t bytes) {
+    int shift = 0;
+    while ((std::size_t{1} << shift) < bytes) {
+        ++shift;
+    }
+    return shift;
+}
+
+// Map `bytes` (a multiple of `page`) from the explicit huge-page pool
+void* map_hugetlb(std::size_t bytes, std::size_t page) {
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2_size(page) << kMapHugeShift);
+    void* region = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return region == MAP_FAILED ? nullptr : region;
+#else
+    (void)bytes;
+    (void)page;
+    return nullptr;
+#endif
+}
+
+// Map `bytes` of regular pages starting on an `alignment` boundary
+void* map_aligned(std::size_t bytes, std::size_t alignment) {
+    std::size_t span = alignment > base_page_size() ? bytes + alignment : bytes;
+    void* region = ::mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        return nullptr;
+    }
+    if (span == bytes) {
+        return region;
+    }
+    // Over-mapped by one alignment unit: trim both ends
+    auto start = reinterpret_cast<std::uintptr_t>(region);
+    auto aligned = (start + alignment - 1) & ~(std::uintptr_t{alignment} - 1);
+    if (aligned > start) {
+        ::munmap(region, aligned - start);
+    }
+    std::size_t tail = (start + span) - (aligned + bytes);
+    if (tail > 0) {
+        ::munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace
+
+// ============================================================================
+// POLICY NAMES
+// ============================================================================
+
+HugePages parse_huge_pages(const std::string& name) {
+    if (name == "none") {
+        return HugePages::None;
+    }
+    if (name == "transparent" || name == "thp") {
+        return HugePages::Transparent;
+    }
+    if (name == "2m" || name == "2M") {
+        return HugePages::Huge2M;
+    }
+    if (name == "1g" || name == "1G") {
+        return HugePages::Huge1G;
+    }
+    throw std::invalid_argument("Unknown huge page setting '" + name +
+                                "' (expected 'none', 'transparent', '2m' or '1g')");
+}
+
+const char* huge_pages_name(HugePages huge_pages) {
+    switch (huge_pages) {
+        case HugePages::None: return "none";
+        case HugePages::Transparent: return "transparent";
+        case HugePages::Huge2M: return "2m";
+        case HugePages::Huge1G: return "1g";
+    }
+    return "none";
+}
+
+// ============================================================================
+// NUMA TOPOLOGY
+// ============================================================================
+
+int numa_node_count() {
+    // "0", "0-1", "0-3,6-7": the highest listed node + 1
+    static const int count = [] {
+        std::ifstream file("/sys/devices/system/node/online");
+        std::string list;
+        if (!(file >> list)) {
+            return 1;
+        }
+        int highest = 0;
+        int value = 0;
+        bool in_number = false;
+        for (char c : list) {
+            if (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                in_number = true;
+            } else {
+                if (in_number && value > highest) {
+                    highest = value;
+                }
+                value = 0;
+                in_number = false;
+            }
+        }
+        if (in_number && value > highest) {
+            highest = value;
+        }
+        return highest + 1;
+    }();
+    return count;
+}
+
+int current_numa_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return 0;
+}
+
+int numa_node_of(const void* address) {
+#if defined(__linux__) && defined(SYS_move_pages)
+    // move_pages() with no target nodes only reports where pages live
+    auto page = reinterpret_cast<std::uintptr_t>(address) & ~(std::uintptr_t{base_page_size()} - 1);
+    void* pages[1] = {reinterpret_cast<void*>(page)};
+    int status[1] = {-1};
+    if (::syscall(SYS_move_pages, 0, 1ul, pages, nullptr, status, 0) == 0 && status[0] >= 0) {
+        return status[0];
+    }
+#else
+    (void)address;
+#endif
+    return -1;
+}
+
+namespace detail {
+
+std::size_t huge_page_size(HugePages huge_pages, std::size_t bytes) {
+    switch (huge_pages) {
+        case HugePages::Huge1G: return bytes >= k1G ? k1G : k2M;
+        case HugePages::Huge2M: return k2M;
+        default: return 0;
+    }
+}
+
+bool bind_to_node(void* address, std::size_t bytes, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0 || node >= numa_node_count()) {
+        return false;
+    }
+    constexpr std::size_t kBits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(static_cast<std::size_t>(node) / kBits + 1, 0);
+    mask[static_cast<std::size_t>(node) / kBits] = 1ul << (static_cast<std::size_t>(node) % kBits);
+    // MPOL_MF_MOVE also migrates pages that were already faulted in
+    return ::syscall(SYS_mbind, address, bytes, kMpolBind, mask.data(),
+                     mask.size() * kBits + 1, kMpolMfMove) == 0;
+#else
+    (void)address;
+    (void)bytes;
+    (void)node;
+    return false;
+#endif
+}
+
+void touch_pages(void* address, std::size_t bytes) {
+    // Read-modify-write so contents survive and the page is faulted in
+    // writable (a plain read would map the shared zero page)
+    volatile char* bytes_ptr = static_cast<volatile char*>(address);
+    std::size_t page = base_page_size();
+    for (std::size_t offset = 0; offset < bytes; offset += page) {
+        bytes_ptr[offset] = bytes_ptr[offset];
+    }
+}
+
+} // namespace detail
+
+// ============================================================================
+// MAPPED MEMORY
+// ============================================================================
+
+MappedMemory::MappedMemory(std::size_t bytes, const MemoryPolicy& policy) {
+    if (bytes == 0) {
+        return;
+    }
+
+    // Explicit huge pages: 1 GiB, then 2 MiB, if the pool has them
+    std::size_t huge = detail::huge_page_size(policy.huge_pages, bytes);
+    while (huge != 0 && data_ == nullptr) {
+        std::size_t size = round_up(bytes, huge);
+        data_ = map_hugetlb(size, huge);
+        if (data_ != nullptr) {
+            size_ = size;
+            huge_pages_ = huge == k1G ? HugePages::Huge1G : HugePages::Huge2M;
+        }
+        huge = huge == k1G ? k2M : 0;
+    }
+
+    // Regular pages, 2 MiB-aligned when the kernel may promote them
+    if (data_ == nullptr) {
+        bool transparent = policy.huge_pages != HugePages::None && bytes >= k2M;
+        size_ = round_up(bytes, base_page_size());
+        data_ = map_aligned(size_, transparent ? k2M : base_page_size());
+        if (data_ == nullptr) {
+            size_ = 0;
+            throw std::bad_alloc();
+        }
+        huge_pages_ = HugePages::None;
+#ifdef MADV_HUGEPAGE
+        if (transparent && ::madvise(data_, size_, MADV_HUGEPAGE) == 0) {
+            huge_pages_ = HugePages::Transparent;
+        }
+#endif
+    }
+
+    // Bind before the first fault so every page is allocated on the node
+    if (policy.numa_node >= 0) {
+        numa_bound_ = detail::bind_to_node(data_, size_, policy.numa_node);
+    }
+    if (policy.prefault) {
+        first_touch();
+    }
+}
+
+MappedMemory::~MappedMemory() {
+    release();
+}
+
+MappedMemory::MappedMemory(MappedMemory&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+      huge_pages_(other.huge_pages_), numa_bound_(other.numa_bound_) {}
+
+MappedMemory& MappedMemory::operator=(MappedMemory&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        huge_pages_ = other.huge_pages_;
+        numa_bound_ = other.numa_bound_;
+    }
+    return *this;
+}
+
+void MappedMemory::first_touch() {
+    if (data_ != nullptr) {
+        detail::touch_pages(data_, size_);
+    }
+}
+
+void MappedMemory::release() {
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+} // namespace signal_processor
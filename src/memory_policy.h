@@ -0,0 +1,127 @@
+#ifndef MEMORY_POLICY_H
+#define MEMORY_POLICY_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Huge-Page and NUMA Placement for Large Buffers
+ *
+ * Two properties of a buffer's physical memory decide how fast a filter
+ * can stream through it, and malloc controls neither:
+ *
+ * 1. Page size. With 4 KiB pages a 64 MiB FFT workspace needs 16384 TLB
+ *    entries - far more than the CPU has - so a streaming pass misses the
+ *    TLB every 4 KiB. 2 MiB pages cut that 512-fold, 1 GiB pages make it
+ *    vanish. Explicit huge pages (MAP_HUGETLB) come from the pool the
+ *    administrator reserved (vm.nr_hugepages / hugepagesz=1G); transparent
+ *    huge pages are a best-effort hint that needs no setup
+ * 2. NUMA node. On a dual-socket server every access to memory attached
+ *    to the other socket crosses the interconnect at a fraction of local
+ *    bandwidth. Linux places a page on the node of the thread that first
+ *    touches it, so a buffer allocated and zeroed by a control thread on
+ *    socket 0 stays remote for a DSP thread on socket 1 forever
+ *
+ * A MemoryPolicy says what a buffer should get: a page size, optionally a
+ * NUMA node to bind it to, and whether to pre-fault it at allocation.
+ * Without a binding, leave prefault off and let the consuming thread touch
+ * the buffer first (first_touch()), so first-touch placement puts it on
+ * that thread's node.
+ *
+ * Requests degrade gracefully: if the huge-page pool is empty or the
+ * kernel has no NUMA support, the memory is allocated anyway and
+ * MappedMemory reports what was actually obtained.
+ */
+
+namespace signal_processor {
+
+enum class HugePages {
+    None,          // Regular 4 KiB pages
+    Transparent,   // madvise(MADV_HUGEPAGE): kernel promotes when it can
+    Huge2M,        // MAP_HUGETLB, 2 MiB pages (falls back to Transparent)
+    Huge1G         // MAP_HUGETLB, 1 GiB pages (falls back to 2 MiB, then Transparent)
+};
+
+struct MemoryPolicy {
+    HugePages huge_pages = HugePages::Transparent;
+    int numa_node = -1;        // Bind to this node; -1 = first-touch placement
+    bool prefault = false;     // Touch every page during allocation
+};
+
+/**
+ * Parse "none", "transparent", "2m" or "1g"
+ *
+ * @throws std::invalid_argument for other names
+ */
+HugePages parse_huge_pages(const std::string& name);
+const char* huge_pages_name(HugePages huge_pages);
+
+// Number of NUMA nodes (1 on non-NUMA machines and non-Linux systems)
+int numa_node_count();
+
+// Node of the CPU the calling thread runs on (0 if unknown)
+int current_numa_node();
+
+// Node holding the page at `address` (-1 if unknown or not yet faulted in)
+int numa_node_of(const void* address);
+
+/**
+ * Anonymous memory mapped according to a MemoryPolicy
+ *
+ * Move-only; unmapped by the destructor. The size is rounded up to the
+ * page size actually used.
+ */
+class MappedMemory {
+public:
+    MappedMemory() = default;
+
+    /**
+     * @throws std::bad_alloc if no memory at all could be mapped
+     */
+    MappedMemory(std::size_t bytes, const MemoryPolicy& policy);
+    ~MappedMemory();
+
+    MappedMemory(MappedMemory&& other) noexcept;
+    MappedMemory& operator=(MappedMemory&& other) noexcept;
+    MappedMemory(const MappedMemory&) = delete;
+    MappedMemory& operator=(const MappedMemory&) = delete;
+
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // What the kernel granted: HugePages::Huge2M / Huge1G only if the
+    // explicit huge-page request succeeded
+    HugePages huge_pages() const { return huge_pages_; }
+    // True if the NUMA binding requested by the policy took effect
+    bool numa_bound() const { return numa_bound_; }
+
+    // Write every page from the calling thread (first-touch placement)
+    void first_touch();
+
+private:
+    void release();
+
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    HugePages huge_pages_ = HugePages::None;
+    bool numa_bound_ = false;
+};
+
+namespace detail {
+
+// Explicit huge-page size used for a `bytes` request (0 = none). 1 GiB
+// pages are only used for buffers of at least 1 GiB; smaller Huge1G
+// requests get 2 MiB pages rather than a mostly empty 1 GiB page.
+std::size_t huge_page_size(HugePages huge_pages, std::size_t bytes);
+
+// mbind() a page-aligned range to one node; false if unsupported/refused
+bool bind_to_node(void* address, std::size_t bytes, int node);
+
+// Write one byte per page (keeps existing contents)
+void touch_pages(void* address, std::size_t bytes);
+
+} // namespace detail
+
+} // namespace signal_processor
+
+#endif // MEMORY_POLICY_H
@@ -0,0 +1,174 @@
+#include "perf_counters.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace signal_processor {
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1dMisses: return "l1d_misses";
+        case PerfEvent::LlcMisses: return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::TaskClock: return "task_clock_ns";
+    }
+    return "unknown";
+}
+
+PerfSample PerfSample::operator-(const PerfSample& earlier) const {
+    PerfSample difference;
+    difference.valid = valid & earlier.valid;
+    for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+        if ((difference.valid >> i) & 1u) {
+            // Scaled counts of a multiplexed group can step back slightly
+            difference.counts[i] = counts[i] > earlier.counts[i] ? counts[i] - earlier.counts[i] : 0;
+        }
+    }
+    return difference;
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct EventCode {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+EventCode event_code(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+        case PerfEvent::Instructions:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+        case PerfEvent::L1dMisses:
+            return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        case PerfEvent::LlcMisses:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+        case PerfEvent::BranchMisses:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+        case PerfEvent::TaskClock:
+            return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK};
+    }
+    return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK};
+}
+
+int open_event(PerfEvent event, int group) {
+    EventCode code = event_code(event);
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = code.type;
+    attr.config = code.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // User space only: allowed at perf_event_paranoid 2, and kernel time is
+    // not the kernels' cost anyway
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // The leader starts disabled so the whole group is enabled at once
+    attr.disabled = group == -1 ? 1 : 0;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+std::string open_error(PerfEvent event, int error) {
+    std::string reason = std::strerror(error);
+    if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV) {
+        reason += " (no such counter on this CPU, or the PMU is hidden by a VM/container)";
+    } else if (error == EACCES || error == EPERM) {
+        reason += " (needs kernel.perf_event_paranoid <= 2 or CAP_PERFMON)";
+    }
+    return std::string(perf_event_name(event)) + " counter unavailable: " + reason;
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+        auto event = static_cast<PerfEvent>(i);
+        int fd = open_event(event, leader_);
+        if (fd < 0) {
+            errors_.push_back(open_error(event, errno));
+            continue;
+        }
+        if (leader_ == -1) {
+            leader_ = fd;
+        }
+        fds_.push_back(fd);
+        events_.push_back(event);
+    }
+    if (leader_ != -1) {
+        ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        ::close(fd);
+    }
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+    if (leader_ == -1) {
+        return sample;
+    }
+    // { nr, time_enabled, time_running, value[nr] }
+    std::uint64_t buffer[3 + kPerfEventCount] = {};
+    ssize_t bytes = ::read(leader_, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) {
+        return sample;
+    }
+    std::uint64_t count = std::min<std::uint64_t>(buffer[0], events_.size());
+    double enabled = static_cast<double>(buffer[1]);
+    double running = static_cast<double>(buffer[2]);
+    if (running <= 0.0) {
+        return sample;   // Never scheduled on the PMU: nothing measured
+    }
+    double scale = enabled / running;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto slot = static_cast<std::size_t>(events_[i]);
+        sample.counts[slot] = static_cast<std::uint64_t>(static_cast<double>(buffer[3 + i]) * scale);
+        sample.valid |= 1u << slot;
+    }
+    return sample;
+}
+
+bool PerfCounters::hardware_available() const {
+    for (PerfEvent event : events_) {
+        if (event != PerfEvent::TaskClock) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    errors_.push_back("performance counters are not supported on this platform");
+}
+
+PerfCounters::~PerfCounters() = default;
+
+PerfSample PerfCounters::read() const {
+    return {};
+}
+
+bool PerfCounters::hardware_available() const {
+    return false;
+}
+
+#endif
+
+} // namespace signal_processor
@@ -0,0 +1,99 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Hardware Performance Counters
+ *
+ * Wall-clock time says a kernel got slower, not why. The CPU's own counters
+ * tell the cases apart:
+ *
+ *   cycles / sample         the cost that matters, independent of clock speed
+ *   instructions / cycle    < 1: stalled (memory, dependencies);
+ *                           3-4: compute-bound, only fewer instructions
+ *                           (wider SIMD, less work) will help
+ *   L1D / LLC misses        data not in cache: a memory-bound kernel
+ *   branch mispredicts      data-dependent branches (e.g. edge checks in
+ *                           an inner loop) flushing the pipeline
+ *
+ * PerfCounters opens these through Linux perf_event_open(2) for the calling
+ * thread, user-space only, as one group so all of them cover exactly the
+ * same instructions. Counting starts at construction; read() returns the
+ * running totals and the difference of two reads is the cost of the code
+ * in between:
+ *
+ *   PerfCounters counters;
+ *   PerfSample before = counters.read();
+ *   compute_fft(input, length);
+ *   PerfSample cost = counters.read() - before;
+ *   double cycles_per_sample = cost[PerfEvent::Cycles] / double(length);
+ *
+ * Counters need kernel.perf_event_paranoid <= 2 (the default on most
+ * distributions) and a CPU whose PMU is visible - many virtual machines
+ * and containers hide it. Like the real-time settings, nothing here throws
+ * when a counter is refused: it is left out of every sample (has() is
+ * false) and the reason is listed in errors().
+ */
+
+namespace signal_processor {
+
+enum class PerfEvent : int {
+    Cycles = 0,
+    Instructions,
+    L1dMisses,       // L1 data cache read misses
+    LlcMisses,       // Last-level cache misses
+    BranchMisses,
+    TaskClock,       // Nanoseconds on the CPU (software counter, always available)
+};
+
+constexpr std::size_t kPerfEventCount = 6;
+
+// "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "task_clock_ns"
+const char* perf_event_name(PerfEvent event);
+
+struct PerfSample {
+    std::array<std::uint64_t, kPerfEventCount> counts{};
+    std::uint32_t valid = 0;   // Bit i set: counts[i] was measured
+
+    bool has(PerfEvent event) const { return (valid >> static_cast<int>(event)) & 1u; }
+    std::uint64_t operator[](PerfEvent event) const { return counts[static_cast<int>(event)]; }
+
+    // Counts between an earlier sample and this one (events measured in both)
+    PerfSample operator-(const PerfSample& earlier) const;
+};
+
+class PerfCounters {
+public:
+    // Open and start every counter the kernel allows for the calling thread
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Totals since construction. When the PMU has fewer counters than were
+    // requested the kernel time-shares them, and counts are scaled up by
+    // the fraction of time they ran
+    PerfSample read() const;
+
+    // At least one hardware counter opened
+    bool hardware_available() const;
+
+    // Why each missing counter could not be opened
+    const std::vector<std::string>& errors() const { return errors_; }
+
+private:
+    int leader_ = -1;
+    std::vector<int> fds_;
+    std::vector<PerfEvent> events_;   // events_[i] is read from group slot i
+    std::vector<std::string> errors_;
+};
+
+} // namespace signal_processor
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,101 @@
+#include "realtime.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace signal_processor {
+
+namespace {
+
+std::string error_text(int error) {
+    return std::strerror(error);
+}
+
+} // namespace
+
+void validate_realtime_priority(int priority) {
+    if (priority < 0 || priority > 99) {
+        throw std::invalid_argument("Real-time priority must be 1-99 (0 = normal scheduling)");
+    }
+}
+
+std::thread::native_handle_type current_thread_handle() {
+#ifdef __linux__
+    return pthread_self();
+#else
+    return {};
+#endif
+}
+
+std::string pin_thread(std::thread::native_handle_type thread, int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return "CPU " + std::to_string(cpu) + " does not exist";
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int error = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (error != 0) {
+        return "pinning to CPU " + std::to_string(cpu) + " refused: " + error_text(error) +
+               (error == EINVAL ? " (CPU offline or outside the allowed cpuset)" : "");
+    }
+    return {};
+#else
+    (void)thread;
+    return "pinning to CPU " + std::to_string(cpu) + " is not supported on this platform";
+#endif
+}
+
+std::string set_fifo_priority(std::thread::native_handle_type thread, int priority) {
+    validate_realtime_priority(priority);
+    if (priority == 0) {
+        return {};
+    }
+#ifdef __linux__
+    sched_param param{};
+    param.sched_priority = priority;
+    int error = pthread_setschedparam(thread, SCHED_FIFO, &param);
+    if (error != 0) {
+        return "SCHED_FIFO priority " + std::to_string(priority) + " refused: " + error_text(error) +
+               (error == EPERM ? " (needs CAP_SYS_NICE or an RLIMIT_RTPRIO limit)" : "");
+    }
+    return {};
+#else
+    (void)thread;
+    return "SCHED_FIFO is not supported on this platform";
+#endif
+}
+
+std::string lock_process_memory() {
+#ifdef __linux__
+#ifdef MCL_ONFAULT
+    // Lock pages as they are touched instead of faulting in every mapping
+    // now: a memory-mapped capture must not be read into locked RAM whole
+    int result = ::mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT);
+    if (result != 0 && errno == EINVAL) {
+        // Kernel without MCL_ONFAULT (before 4.4)
+        result = ::mlockall(MCL_CURRENT | MCL_FUTURE);
+    }
+#else
+    int result = ::mlockall(MCL_CURRENT | MCL_FUTURE);
+#endif
+    if (result != 0) {
+        int error = errno;
+        return "mlockall refused: " + error_text(error) +
+               (error == ENOMEM || error == EPERM ? " (needs CAP_IPC_LOCK or a larger RLIMIT_MEMLOCK)"
+                                                  : "");
+    }
+    return {};
+#else
+    return "locking memory is not supported on this platform";
+#endif
+}
+
+} // namespace signal_processor
@@ -0,0 +1,89 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Real-Time Scheduling
+ *
+ * A receive loop that averages 50 µs per block can still miss its deadline
+ * once a minute, and the cause is rarely the arithmetic:
+ *
+ * 1. Migration and preemption: the scheduler moves the thread to another
+ *    core (cold caches) or runs a batch job in its place. Pinning each
+ *    thread to its own core and running it under SCHED_FIFO means only a
+ *    higher-priority real-time thread can take the core away
+ * 2. Page faults: the first touch of a fresh buffer page, or of a page the
+ *    kernel swapped or reclaimed, costs microseconds to milliseconds.
+ *    mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT) locks every page the
+ *    process has touched and each page it touches later, so none can be
+ *    reclaimed and fault again. Buffers on the real-time path should be
+ *    pre-faulted (Flowgraph does this for its rings) before locking.
+ *    MCL_ONFAULT matters for file mappings: plain MCL_CURRENT would read a
+ *    whole MappedCapture into locked RAM (failing past RLIMIT_MEMLOCK).
+ *    With it only the pages a stream touches are locked, and CaptureStream
+ *    unlocks the pages behind it as it drops them
+ *
+ * Each guarantee needs privileges (CAP_SYS_NICE / an RLIMIT_RTPRIO limit
+ * for SCHED_FIFO, CAP_IPC_LOCK / RLIMIT_MEMLOCK for mlockall) that a
+ * development box may not grant. Nothing here throws when one is refused:
+ * the failure is reported as a readable message and the thread carries on
+ * with ordinary scheduling, so a deployment can decide whether running
+ * without the guarantee is acceptable.
+ *
+ *   ThreadPool pool(4);
+ *   RealtimeConfig realtime;
+ *   realtime.cpus = {2, 3, 4, 5};
+ *   realtime.priority = 80;
+ *   realtime.lock_memory = true;
+ *   RealtimeReport report = pool.set_realtime(realtime);
+ *   for (const std::string& failure : report.failures) log(failure);
+ */
+
+namespace signal_processor {
+
+struct RealtimeConfig {
+    // CPU for thread i (-1 = not pinned); empty = no pinning
+    std::vector<int> cpus;
+    // SCHED_FIFO priority, 1 (lowest) to 99; 0 = normal scheduling
+    int priority = 0;
+    // mlockall() every page the process touches (see lock_process_memory)
+    bool lock_memory = false;
+};
+
+struct RealtimeReport {
+    bool memory_locked = false;
+    std::vector<std::string> failures;   // One line per guarantee not obtained
+
+    bool ok() const { return failures.empty(); }
+};
+
+// The functions below return an empty string on success and a description
+// of the failure (including the likely missing privilege) otherwise.
+
+// Restrict `thread` to one CPU
+std::string pin_thread(std::thread::native_handle_type thread, int cpu);
+
+/**
+ * Run `thread` under SCHED_FIFO at `priority`
+ *
+ * @throws std::invalid_argument if priority is outside 1-99
+ */
+std::string set_fifo_priority(std::thread::native_handle_type thread, int priority);
+
+// mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT); without MCL_ONFAULT
+// (before Linux 4.4) every mapping, capture files included, is faulted in
+std::string lock_process_memory();
+
+// Handle of the calling thread, for the functions above
+std::thread::native_handle_type current_thread_handle();
+
+// Check a RealtimeConfig's priority (1-99 or 0); throws std::invalid_argument
+void validate_realtime_priority(int priority);
+
+} // namespace signal_processor
+
+#endif // REALTIME_H
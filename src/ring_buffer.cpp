@@ -0,0 +1,113 @@
+#include "ring_buffer.h"
+#include <cstdint>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace signal_processor {
+
+// ============================================================================
+// MIRRORED MEMORY
+// ============================================================================
+
+std::size_t MirroredBuffer::page_size() {
+    static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+}
+
+MirroredBuffer::MirroredBuffer(std::size_t bytes, const MemoryPolicy& policy) : size_(bytes) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+    if (bytes == 0 || bytes % page_size() != 0) {
+        return;
+    }
+
+    // Explicit huge pages need the object size and both views aligned to
+    // the huge page size (MFD_HUGETLB | log2(page) << MFD_HUGE_SHIFT)
+    std::size_t huge = detail::huge_page_size(policy.huge_pages, bytes);
+    if (huge != 0 && bytes % huge == 0) {
+        unsigned shift = huge == (std::size_t{1} << 30) ? 30u : 21u;
+        if (map(huge, 4u /* MFD_HUGETLB */ | (shift << 26))) {
+            huge_pages_ = shift == 30u ? HugePages::Huge1G : HugePages::Huge2M;
+        }
+    }
+    if (!mirrored_ && !map(page_size(), 0u)) {
+        return;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages_ == HugePages::None && policy.huge_pages != HugePages::None &&
+        ::madvise(data_, 2 * size_, MADV_HUGEPAGE) == 0) {
+        // Honoured for shared memory when shmem_enabled allows it
+        huge_pages_ = HugePages::Transparent;
+    }
+#endif
+    // The memory policy belongs to the shared object, so binding one view
+    // covers both
+    if (policy.numa_node >= 0) {
+        numa_bound_ = detail::bind_to_node(data_, size_, policy.numa_node);
+    }
+    if (policy.prefault) {
+        detail::touch_pages(data_, size_);
+    }
+#else
+    (void)policy;
+#endif
+}
+
+bool MirroredBuffer::map(std::size_t alignment, unsigned memfd_flags) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+    // Anonymous shared memory object to map twice (syscall() rather than
+    // memfd_create() so older C libraries build too)
+    int fd = static_cast<int>(::syscall(SYS_memfd_create, "signal_processor_ring",
+                                        1u /* MFD_CLOEXEC */ | memfd_flags));
+    if (fd < 0) {
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Reserve 2x the address space (plus slack to align it), then map the
+    // object over each half
+    std::size_t span = 2 * size_ + (alignment > page_size() ? alignment : 0);
+    void* region = ::mmap(nullptr, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    auto start = reinterpret_cast<std::uintptr_t>(region);
+    char* base = reinterpret_cast<char*>((start + alignment - 1) & ~(std::uintptr_t{alignment} - 1));
+    bool mapped =
+        ::mmap(base, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+        ::mmap(base + size_, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+    // The mappings keep the memory object alive
+    ::close(fd);
+    if (!mapped) {
+        ::munmap(region, span);
+        return false;
+    }
+
+    data_ = base;
+    reserved_ = span;
+    region_ = region;
+    mirrored_ = true;
+    return true;
+#else
+    (void)alignment;
+    (void)memfd_flags;
+    return false;
+#endif
+}
+
+MirroredBuffer::~MirroredBuffer() {
+#ifdef __linux__
+    if (region_ != nullptr) {
+        ::munmap(region_, reserved_);
+    }
+#endif
+}
+
+} // namespace signal_processor
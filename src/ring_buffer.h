@@ -0,0 +1,522 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "memory_policy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Lock-Free Sample Rings
+ *
+ * A capture thread that hands samples to the processing chain through a
+ * mutex-protected queue pays for a lock, an allocation and a copy per
+ * block, and stalls whenever the consumer holds the lock. The rings here
+ * avoid all three:
+ *
+ * 1. Lock-free: producer and consumer only exchange two indices through
+ *    atomics. Each index sits on its own cache line (no false sharing) and
+ *    each side caches the other's index, touching the shared line only when
+ *    the ring looks full or empty
+ * 2. Zero-copy: reserve() hands the producer a span of free ring memory to
+ *    fill in place (e.g. straight from a driver or a converter), and peek()
+ *    hands the consumer a span of samples to process in place
+ * 3. Contiguous: the storage is mapped twice, back to back in virtual
+ *    memory, so a span that wraps past the end of the ring continues into
+ *    the second mapping - every span is one plain array, whatever its
+ *    position. Where double mapping is unavailable, spans stop at the wrap
+ *    and a second call returns the rest
+ * 4. Overruns are counted: write() never blocks, so a producer that must
+ *    not stall (a real-time capture thread) drops what does not fit and
+ *    overruns() tells the consumer how much it lost
+ * 5. Placement: a MemoryPolicy puts the ring on explicit huge pages and/or
+ *    a NUMA node; without a binding, call first_touch() from the consumer
+ *    thread before streaming so the pages land on its node
+ *
+ * SpscRing is for exactly one producer and one consumer thread; MpmcRing
+ * allows any number of each at the cost of compare-and-swap claims.
+ *
+ * Spans are plain Sample arrays, so they feed the streaming processors
+ * directly:
+ *
+ *   SpscRing<std::complex<double>> ring(1 << 20);
+ *   // capture thread
+ *   RingSpan<std::complex<double>> free = ring.reserve(4096);
+ *   size_t n = fill_from_device(free.data, free.count);
+ *   ring.commit(n);
+ *   // processing thread
+ *   RingSpan<const std::complex<double>> ready = ring.peek();
+ *   fir.process(ready.data, ready.count, output);
+ *   ring.consume(ready.count);
+ */
+
+namespace signal_processor {
+
+// Keeps independently written atomics on separate cache lines
+constexpr std::size_t kCacheLine = 64;
+
+/**
+ * Contiguous window into a ring
+ *
+ * `position` is the stream index of data[0] (samples written before it
+ * since the ring was created).
+ */
+template <typename T>
+struct RingSpan {
+    T* data = nullptr;
+    std::size_t count = 0;
+    std::uint64_t position = 0;
+
+    bool empty() const { return count == 0; }
+};
+
+/**
+ * Waiting for the other side of a ring: spin briefly (it is usually only
+ * a few microseconds away), then yield, then sleep, so an idle consumer
+ * does not burn the core it runs on.
+ */
+class Backoff {
+public:
+    void pause() {
+        if (spins_ < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        } else if (spins_ < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        ++spins_;
+    }
+
+private:
+    int spins_ = 0;
+};
+
+/**
+ * `bytes` of memory mapped twice in a row: data()[i] and
+ * data()[i + size()] are the same byte
+ *
+ * Linux only (memfd + two fixed shared mappings); elsewhere, or if the
+ * kernel refuses, mirrored() is false and nothing is allocated. Explicit
+ * huge pages are used when `bytes` is a multiple of the huge page size and
+ * the pool has enough; otherwise regular pages.
+ */
+class MirroredBuffer {
+public:
+    // `bytes` must be a multiple of the page size to be mirrored
+    explicit MirroredBuffer(std::size_t bytes, const MemoryPolicy& policy = {});
+    ~MirroredBuffer();
+
+    MirroredBuffer(const MirroredBuffer&) = delete;
+    MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool mirrored() const { return mirrored_; }
+    HugePages huge_pages() const { return huge_pages_; }
+    bool numa_bound() const { return numa_bound_; }
+
+    static std::size_t page_size();
+
+private:
+    bool map(std::size_t alignment, unsigned memfd_flags);
+
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    void* region_ = nullptr;      // Reserved address space (data_ may be aligned within)
+    std::size_t reserved_ = 0;
+    bool mirrored_ = false;
+    HugePages huge_pages_ = HugePages::None;
+    bool numa_bound_ = false;
+};
+
+namespace detail {
+
+inline std::size_t ring_capacity(std::size_t min_capacity) {
+    if (min_capacity == 0 || min_capacity > (std::numeric_limits<std::size_t>::max() >> 2)) {
+        throw std::invalid_argument("Ring capacity must be positive");
+    }
+    std::size_t capacity = 2;
+    while (capacity < min_capacity) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/**
+ * Ring storage: a MirroredBuffer for plain sample types, otherwise (or if
+ * mirroring failed) an ordinary array
+ */
+template <typename T>
+class RingStorage {
+public:
+    // Sample types of power-of-two size tile a page exactly
+    static constexpr bool kMirrorable =
+        std::is_trivially_copyable<T>::value && (sizeof(T) & (sizeof(T) - 1)) == 0;
+
+    RingStorage(std::size_t min_capacity, [[maybe_unused]] const MemoryPolicy& policy)
+        : capacity_(ring_capacity(min_capacity)) {
+        if constexpr (kMirrorable) {
+            // A whole number of pages, so the second mapping lines up
+            std::size_t page = std::max(MirroredBuffer::page_size(),
+                                        huge_page_size(policy.huge_pages, capacity_ * sizeof(T)));
+            capacity_ = std::max(capacity_, page / sizeof(T));
+            mirror_ = std::make_unique<MirroredBuffer>(capacity_ * sizeof(T), policy);
+            if (mirror_->mirrored()) {
+                data_ = static_cast<T*>(mirror_->data());
+                return;
+            }
+            mirror_.reset();
+        }
+        fallback_.resize(capacity_);
+        data_ = fallback_.data();
+    }
+
+    T* data() const { return data_; }
+    std::size_t capacity() const { return capacity_; }
+    std::size_t mask() const { return capacity_ - 1; }
+    bool mirrored() const { return mirror_ != nullptr; }
+    HugePages huge_pages() const { return mirror_ ? mirror_->huge_pages() : HugePages::None; }
+    bool numa_bound() const { return mirror_ && mirror_->numa_bound(); }
+
+    // Unmirrored storage was already touched by the constructing thread
+    void first_touch() {
+        if (mirrored()) {
+            touch_pages(data_, capacity_ * sizeof(T));
+        }
+    }
+
+    // Longest span starting at stream index `position` with at most `limit` samples
+    std::size_t contiguous(std::uint64_t position, std::size_t limit) const {
+        if (mirrored()) {
+            return limit;
+        }
+        return std::min<std::size_t>(limit, capacity_ - (position & mask()));
+    }
+
+private:
+    std::size_t capacity_;
+    std::unique_ptr<MirroredBuffer> mirror_;
+    std::vector<T> fallback_;
+    T* data_ = nullptr;
+};
+
+} // namespace detail
+
+// ============================================================================
+// SINGLE PRODUCER / SINGLE CONSUMER
+// ============================================================================
+
+/**
+ * Lock-free ring for one producer thread and one consumer thread
+ *
+ * Producer: reserve() → fill → commit(n), or write(). Consumer: peek() →
+ * process → consume(n), or read(). Any sample type works; non-trivial
+ * types (e.g. blocks owning vectors) are never copied, only filled and
+ * read in place, and use unmirrored storage.
+ */
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two (and to a whole page when mirrored)
+    explicit SpscRing(std::size_t min_capacity, const MemoryPolicy& policy = {})
+        : storage_(min_capacity, policy) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return storage_.capacity(); }
+    bool mirrored() const { return storage_.mirrored(); }
+    HugePages huge_pages() const { return storage_.huge_pages(); }
+    bool numa_bound() const { return storage_.numa_bound(); }
+
+    // Fault the storage in from the calling thread (first-touch NUMA
+    // placement); call from the consumer before the ring carries data
+    void first_touch() { storage_.first_touch(); }
+
+    // ------------------------------------------------------------ producer
+
+    // Free space to fill in place (empty when the ring is full)
+    RingSpan<T> reserve(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+        std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t space = capacity() - static_cast<std::size_t>(tail - head_cache_);
+        if (space < std::min(max_count, capacity())) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            space = capacity() - static_cast<std::size_t>(tail - head_cache_);
+        }
+        std::size_t count = storage_.contiguous(tail, std::min(space, max_count));
+        return {storage_.data() + (tail & storage_.mask()), count, tail};
+    }
+
+    // Publish the first `count` samples of the last reservation
+    void commit(std::size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    /**
+     * Copy in as many samples as fit, never blocking
+     *
+     * @return Samples accepted; the rest are counted in overruns()
+     */
+    std::size_t write(const T* samples, std::size_t count) {
+        std::size_t written = 0;
+        while (written < count) {
+            RingSpan<T> span = reserve(count - written);
+            if (span.empty()) {
+                break;
+            }
+            std::copy(samples + written, samples + written + span.count, span.data);
+            commit(span.count);
+            written += span.count;
+        }
+        if (written < count) {
+            overruns_.fetch_add(count - written, std::memory_order_relaxed);
+        }
+        return written;
+    }
+
+    // End of stream: nothing more will be committed
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // ------------------------------------------------------------ consumer
+
+    // Committed samples to read in place (empty when the ring is empty)
+    RingSpan<const T> peek(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+        std::uint64_t head = head_.load(std::memory_order_relaxed);
+        std::size_t ready = static_cast<std::size_t>(tail_cache_ - head);
+        if (ready < std::min(max_count, capacity())) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            ready = static_cast<std::size_t>(tail_cache_ - head);
+        }
+        std::size_t count = storage_.contiguous(head, std::min(ready, max_count));
+        return {storage_.data() + (head & storage_.mask()), count, head};
+    }
+
+    // Hand the first `count` peeked samples back to the producer
+    void consume(std::size_t count) {
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Copy out up to `count` samples; returns how many were available
+    std::size_t read(T* output, std::size_t count) {
+        std::size_t done = 0;
+        while (done < count) {
+            RingSpan<const T> span = peek(count - done);
+            if (span.empty()) {
+                break;
+            }
+            std::copy(span.data, span.data + span.count, output + done);
+            consume(span.count);
+            done += span.count;
+        }
+        return done;
+    }
+
+    /**
+     * True once close() was called. Check it *before* a final peek():
+     * samples committed ahead of close() are then guaranteed to be seen.
+     */
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // ------------------------------------------------------------ either side
+
+    // Samples committed but not yet consumed (a snapshot). The consumer
+    // index is read first so it cannot overtake the producer index read
+    // after it; from a third thread the producer may lap ahead in between,
+    // hence the clamp.
+    std::size_t size() const {
+        std::uint64_t head = head_.load(std::memory_order_acquire);
+        std::uint64_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? std::min(static_cast<std::size_t>(tail - head), capacity()) : 0;
+    }
+
+    // Samples refused by write() because the ring was full
+    std::uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+private:
+    detail::RingStorage<T> storage_;
+
+    alignas(kCacheLine) std::atomic<std::uint64_t> head_{0};   // Written by the consumer
+    std::uint64_t tail_cache_ = 0;                             // Consumer's view of tail_
+    alignas(kCacheLine) std::atomic<std::uint64_t> tail_{0};   // Written by the producer
+    std::uint64_t head_cache_ = 0;                             // Producer's view of head_
+    alignas(kCacheLine) std::atomic<std::uint64_t> overruns_{0};
+    std::atomic<bool> closed_{false};
+};
+
+// ============================================================================
+// MULTIPLE PRODUCERS / MULTIPLE CONSUMERS
+// ============================================================================
+
+/**
+ * Lock-free ring for any number of producer and consumer threads
+ *
+ * Each side has a claim index and a publish index. A producer claims a
+ * range by compare-and-swap on the claim index, fills it, then publishes
+ * it - in claim order, so it waits for producers that claimed earlier
+ * ranges to publish first. Consumers claim and release ranges the same
+ * way. Ranges are therefore delivered whole and in order, but which
+ * consumer gets which range is up to the scheduler.
+ *
+ * Every reservation must be committed (every acquisition released), even
+ * if nothing was written into it: later claims wait for it.
+ */
+template <typename T>
+class MpmcRing {
+public:
+    explicit MpmcRing(std::size_t min_capacity, const MemoryPolicy& policy = {})
+        : storage_(min_capacity, policy) {}
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    std::size_t capacity() const { return storage_.capacity(); }
+    bool mirrored() const { return storage_.mirrored(); }
+    HugePages huge_pages() const { return storage_.huge_pages(); }
+    bool numa_bound() const { return storage_.numa_bound(); }
+
+    // Fault the storage in from the calling thread (first-touch NUMA
+    // placement); call from the consumer before the ring carries data
+    void first_touch() { storage_.first_touch(); }
+
+    // ------------------------------------------------------------ producers
+
+    // Claim up to `max_count` free samples (empty when the ring is full)
+    RingSpan<T> reserve(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+        std::uint64_t claim = producer_claim_.load(std::memory_order_relaxed);
+        for (;;) {
+            std::uint64_t released = consumer_release_.load(std::memory_order_acquire);
+            if (released > claim) {
+                // Our claim index is stale (consumers moved past it)
+                claim = producer_claim_.load(std::memory_order_relaxed);
+                continue;
+            }
+            std::size_t space = capacity() - static_cast<std::size_t>(claim - released);
+            std::size_t count = storage_.contiguous(claim, std::min(space, max_count));
+            if (count == 0) {
+                return {nullptr, 0, claim};
+            }
+            if (producer_claim_.compare_exchange_weak(claim, claim + count,
+                                                      std::memory_order_relaxed)) {
+                return {storage_.data() + (claim & storage_.mask()), count, claim};
+            }
+        }
+    }
+
+    // Publish a whole reservation
+    void commit(const RingSpan<T>& span) {
+        publish(producer_publish_, span.position, span.count);
+    }
+
+    // Copy in as many samples as fit; the rest are counted in overruns()
+    std::size_t write(const T* samples, std::size_t count) {
+        std::size_t written = 0;
+        while (written < count) {
+            RingSpan<T> span = reserve(count - written);
+            if (span.empty()) {
+                break;
+            }
+            std::copy(samples + written, samples + written + span.count, span.data);
+            commit(span);
+            written += span.count;
+        }
+        if (written < count) {
+            overruns_.fetch_add(count - written, std::memory_order_relaxed);
+        }
+        return written;
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // ------------------------------------------------------------ consumers
+
+    // Claim up to `max_count` published samples (empty when none are ready)
+    RingSpan<const T> acquire(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+        std::uint64_t claim = consumer_claim_.load(std::memory_order_relaxed);
+        for (;;) {
+            std::uint64_t published = producer_publish_.load(std::memory_order_acquire);
+            std::size_t ready = static_cast<std::size_t>(published - claim);
+            std::size_t count = storage_.contiguous(claim, std::min(ready, max_count));
+            if (count == 0) {
+                return {nullptr, 0, claim};
+            }
+            if (consumer_claim_.compare_exchange_weak(claim, claim + count,
+                                                      std::memory_order_relaxed)) {
+                return {storage_.data() + (claim & storage_.mask()), count, claim};
+            }
+        }
+    }
+
+    // Return a whole acquisition to the producers
+    void release(const RingSpan<const T>& span) {
+        publish(consumer_release_, span.position, span.count);
+    }
+
+    std::size_t read(T* output, std::size_t count) {
+        std::size_t done = 0;
+        while (done < count) {
+            RingSpan<const T> span = acquire(count - done);
+            if (span.empty()) {
+                break;
+            }
+            std::copy(span.data, span.data + span.count, output + done);
+            release(span);
+            done += span.count;
+        }
+        return done;
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // ------------------------------------------------------------ either side
+
+    // Published but unclaimed samples; same read order and clamp as SpscRing
+    std::size_t size() const {
+        std::uint64_t claimed = consumer_claim_.load(std::memory_order_acquire);
+        std::uint64_t published = producer_publish_.load(std::memory_order_acquire);
+        return published > claimed
+            ? std::min(static_cast<std::size_t>(published - claimed), capacity())
+            : 0;
+    }
+
+    std::uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+private:
+    // Ranges become visible strictly in claim order
+    static void publish(std::atomic<std::uint64_t>& index, std::uint64_t position,
+                        std::size_t count) {
+        Backoff backoff;
+        while (index.load(std::memory_order_acquire) != position) {
+            backoff.pause();
+        }
+        index.store(position + count, std::memory_order_release);
+    }
+
+    detail::RingStorage<T> storage_;
+
+    alignas(kCacheLine) std::atomic<std::uint64_t> producer_claim_{0};
+    alignas(kCacheLine) std::atomic<std::uint64_t> producer_publish_{0};
+    alignas(kCacheLine) std::atomic<std::uint64_t> consumer_claim_{0};
+    alignas(kCacheLine) std::atomic<std::uint64_t> consumer_release_{0};
+    alignas(kCacheLine) std::atomic<std::uint64_t> overruns_{0};
+    std::atomic<bool> closed_{false};
+};
+
+} // namespace signal_processor
+
+#endif // RING_BUFFER_H
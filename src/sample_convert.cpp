@@ -0,0 +1,149 @@
+#include "sample_convert.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace signal_processor {
+
+namespace {
+
+// Scalar loop: handles the tail after the SIMD body, and the whole buffer
+// on targets without AVX2
+template <typename In, typename Out>
+void convert_scalar(const In* input, std::size_t count, Out* output, Out scale) {
+    for (std::size_t i = 0; i < count; ++i) {
+        output[i] = static_cast<Out>(input[i]) * scale;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// TO FLOAT64
+// ============================================================================
+
+void convert_samples(const std::int16_t* input, std::size_t count, double* output, double scale) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    // 8 x int16 -> 2 x (4 x int32) -> 2 x (4 x double)
+    const __m256d vscale = _mm256_set1_pd(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m256i wide = _mm256_cvtepi16_epi32(raw);
+        __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(wide));
+        __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(wide, 1));
+        _mm256_storeu_pd(output + i, _mm256_mul_pd(lo, vscale));
+        _mm256_storeu_pd(output + i + 4, _mm256_mul_pd(hi, vscale));
+    }
+#endif
+    convert_scalar(input + i, count - i, output + i, scale);
+}
+
+void convert_samples(const std::int8_t* input, std::size_t count, double* output, double scale) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    // 8 x int8 -> 8 x int32 -> 2 x (4 x double)
+    const __m256d vscale = _mm256_set1_pd(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i));
+        __m256i wide = _mm256_cvtepi8_epi32(raw);
+        __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(wide));
+        __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(wide, 1));
+        _mm256_storeu_pd(output + i, _mm256_mul_pd(lo, vscale));
+        _mm256_storeu_pd(output + i + 4, _mm256_mul_pd(hi, vscale));
+    }
+#endif
+    convert_scalar(input + i, count - i, output + i, scale);
+}
+
+void convert_samples(const float* input, std::size_t count, double* output, double scale) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d vscale = _mm256_set1_pd(scale);
+    for (; i + 4 <= count; i += 4) {
+        __m256d wide = _mm256_cvtps_pd(_mm_loadu_ps(input + i));
+        _mm256_storeu_pd(output + i, _mm256_mul_pd(wide, vscale));
+    }
+#endif
+    convert_scalar(input + i, count - i, output + i, scale);
+}
+
+void convert_samples(const double* input, std::size_t count, double* output, double scale) {
+    // Plain multiply: auto-vectorizes without help
+    convert_scalar(input, count, output, scale);
+}
+
+// ============================================================================
+// TO FLOAT32
+// ============================================================================
+
+void convert_samples(const std::int16_t* input, std::size_t count, float* output, float scale) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    // 8 x int16 -> 8 x int32 -> 8 x float
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m256 wide = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(raw));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(wide, vscale));
+    }
+#endif
+    convert_scalar(input + i, count - i, output + i, scale);
+}
+
+void convert_samples(const std::int8_t* input, std::size_t count, float* output, float scale) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    // 16 x int8 -> 2 x (8 x int32) -> 2 x (8 x float)
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (; i + 16 <= count; i += 16) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(raw));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(raw, 8)));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(lo, vscale));
+        _mm256_storeu_ps(output + i + 8, _mm256_mul_ps(hi, vscale));
+    }
+#endif
+    convert_scalar(input + i, count - i, output + i, scale);
+}
+
+// ============================================================================
+// FROM FLOAT64
+// ============================================================================
+
+namespace {
+
+// Clamp, then round: branch-free, so the loop auto-vectorizes
+template <typename Int>
+void encode_integer(const double* input, std::size_t count, Int* output, double scale) {
+    const double inverse = 1.0 / scale;
+    const double lo = static_cast<double>(std::numeric_limits<Int>::min());
+    const double hi = static_cast<double>(std::numeric_limits<Int>::max());
+    for (std::size_t i = 0; i < count; ++i) {
+        double value = std::min(std::max(input[i] * inverse, lo), hi);
+        output[i] = static_cast<Int>(std::nearbyint(value));
+    }
+}
+
+} // namespace
+
+void encode_samples(const double* input, std::size_t count, float* output, double scale) {
+    const double inverse = 1.0 / scale;
+    for (std::size_t i = 0; i < count; ++i) {
+        output[i] = static_cast<float>(input[i] * inverse);
+    }
+}
+
+void encode_samples(const double* input, std::size_t count, std::int16_t* output, double scale) {
+    encode_integer(input, count, output, scale);
+}
+
+void encode_samples(const double* input, std::size_t count, std::int8_t* output, double scale) {
+    encode_integer(input, count, output, scale);
+}
+
+} // namespace signal_processor
@@ -0,0 +1,71 @@
+#ifndef SAMPLE_CONVERT_H
+#define SAMPLE_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Sample Format Conversion
+ *
+ * SDR front ends deliver fixed-point samples - typically "sc16" (complex
+ * int16, interleaved I,Q,I,Q...) or "sc8" (complex int8) - while the DSP
+ * kernels work in floating point. These converters widen and scale in one
+ * pass using AVX2 where the build enables it (-march=native on x86) and a
+ * plain loop elsewhere (which compilers auto-vectorize for SSE2/NEON).
+ *
+ * Interleaved complex data needs no separate entry point: N complex
+ * samples are 2N raw values, and std::complex<double>[N] has the same
+ * layout as double[2N], so
+ *
+ *   convert_samples(sc16, 2 * N, reinterpret_cast<double*>(iq), kScaleS16);
+ *
+ * converts a whole sc16 buffer into complex128.
+ *
+ * Scaling: the default factors map full-scale integers to [-1, 1).
+ */
+
+namespace signal_processor {
+
+constexpr double kScaleS16 = 1.0 / 32768.0;
+constexpr double kScaleS8 = 1.0 / 128.0;
+
+/**
+ * output[i] = input[i] * scale  for i in [0, count)
+ *
+ * @param input Raw samples (int16, int8, float32 or float64)
+ * @param count Number of values (2x the sample count for interleaved IQ)
+ * @param output Destination; must not overlap input
+ * @param scale Multiplier applied during conversion
+ */
+void convert_samples(const std::int16_t* input, std::size_t count, double* output,
+                     double scale = kScaleS16);
+void convert_samples(const std::int8_t* input, std::size_t count, double* output,
+                     double scale = kScaleS8);
+void convert_samples(const float* input, std::size_t count, double* output,
+                     double scale = 1.0);
+void convert_samples(const double* input, std::size_t count, double* output,
+                     double scale = 1.0);
+
+// Single-precision outputs, for the float32 kernels
+void convert_samples(const std::int16_t* input, std::size_t count, float* output,
+                     float scale = static_cast<float>(kScaleS16));
+void convert_samples(const std::int8_t* input, std::size_t count, float* output,
+                     float scale = static_cast<float>(kScaleS8));
+
+/**
+ * The reverse direction, for recording: output[i] = input[i] / scale
+ *
+ * Integer outputs are rounded to nearest and saturate at the type's range
+ * (a clipped sample is far less harmful than a wrapped one). Using the
+ * same `scale` as convert_samples() round-trips exactly.
+ */
+void encode_samples(const double* input, std::size_t count, float* output,
+                    double scale = 1.0);
+void encode_samples(const double* input, std::size_t count, std::int16_t* output,
+                    double scale = kScaleS16);
+void encode_samples(const double* input, std::size_t count, std::int8_t* output,
+                    double scale = kScaleS8);
+
+} // namespace signal_processor
+
+#endif // SAMPLE_CONVERT_H
@@ -0,0 +1,446 @@
+#include "shm_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace signal_processor {
+
+namespace {
+
+constexpr std::uint64_t kMagic = 0x53505348524e4731ull;   // "SPSHRNG1"
+constexpr std::uint32_t kVersion = 1;
+
+std::string segment_name(const std::string& name) {
+    std::string result = !name.empty() && name[0] == '/' ? name : "/" + name;
+    if (result.size() < 2 || result.find('/', 1) != std::string::npos) {
+        throw std::invalid_argument("Shared-memory ring name must be non-empty and contain no '/'");
+    }
+    return result;
+}
+
+std::runtime_error system_error(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " '" + name + "': " + std::strerror(errno));
+}
+
+// Futex wait/wake on a word in shared memory (not FUTEX_PRIVATE: the
+// other side is another process)
+void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected, double timeout_seconds) {
+#ifdef __linux__
+    timespec timeout{};
+    timespec* limit = nullptr;
+    if (timeout_seconds >= 0.0) {
+        timeout.tv_sec = static_cast<time_t>(timeout_seconds);
+        timeout.tv_nsec = static_cast<long>((timeout_seconds - static_cast<double>(timeout.tv_sec)) * 1e9);
+        limit = &timeout;
+    }
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, limit, nullptr, 0);
+#else
+    (void)word;
+    (void)expected;
+    std::this_thread::sleep_for(std::chrono::duration<double>(std::min(std::max(timeout_seconds, 0.0), 1e-3)));
+#endif
+}
+
+void futex_wake(std::atomic<std::uint32_t>& word) {
+#ifdef __linux__
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+} // namespace
+
+// ============================================================================
+// SEGMENT LAYOUT
+// ============================================================================
+
+/**
+ * First page of the segment; the samples follow on the next page. Every
+ * field the two sides write sits on its own cache line.
+ */
+struct SharedMemoryRing::Header {
+    std::atomic<std::uint64_t> magic;     // Set last, once the rest is valid
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint64_t capacity;
+
+    // Producer side
+    alignas(kCacheLine) std::atomic<std::uint64_t> tail;
+    std::atomic<std::uint32_t> data_seq;          // Bumped on every commit/close
+    std::atomic<std::uint32_t> producer_waiting;
+    std::atomic<std::uint64_t> overruns;
+
+    // Consumer side
+    alignas(kCacheLine) std::atomic<std::uint64_t> head;
+    std::atomic<std::uint32_t> space_seq;         // Bumped on every consume
+    std::atomic<std::uint32_t> consumer_waiting;
+
+    alignas(kCacheLine) std::atomic<std::uint32_t> closed;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "Shared-memory rings need address-free (lock-free) atomics");
+
+// ============================================================================
+// LIFECYCLE
+// ============================================================================
+
+SharedMemoryRing SharedMemoryRing::create(const std::string& name, std::size_t min_capacity,
+                                          SampleFormat format) {
+    std::string segment = segment_name(name);
+    std::size_t sample = sample_format_size(format);
+    std::size_t capacity = detail::ring_capacity(min_capacity);
+    // A whole number of pages, so the second data mapping lines up
+    capacity = std::max(capacity, MirroredBuffer::page_size() / sample);
+
+    // Replace a stale segment left by a previous run
+    ::shm_unlink(segment.c_str());
+    int fd = ::shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw system_error("Cannot create shared-memory ring", segment);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(MirroredBuffer::page_size() + capacity * sample)) != 0) {
+        std::runtime_error error = system_error("Cannot size shared-memory ring", segment);
+        ::close(fd);
+        ::shm_unlink(segment.c_str());
+        throw error;
+    }
+
+    SharedMemoryRing ring;
+    ring.name_ = segment;
+    ring.owner_ = true;
+    try {
+        ring.map(fd, true, capacity, format);
+    } catch (...) {
+        ::close(fd);
+        ::shm_unlink(segment.c_str());
+        throw;
+    }
+    ::close(fd);
+    return ring;
+}
+
+SharedMemoryRing SharedMemoryRing::open(const std::string& name) {
+    std::string segment = segment_name(name);
+    int fd = ::shm_open(segment.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw system_error("Cannot open shared-memory ring", segment);
+    }
+    SharedMemoryRing ring;
+    ring.name_ = segment;
+    try {
+        ring.map(fd, false, 0, SampleFormat::CF64);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    return ring;
+}
+
+bool SharedMemoryRing::unlink(const std::string& name) {
+    return ::shm_unlink(segment_name(name).c_str()) == 0;
+}
+
+void SharedMemoryRing::map(int fd, bool initialize, std::size_t capacity, SampleFormat format) {
+    const std::size_t page = MirroredBuffer::page_size();
+
+    if (!initialize) {
+        // Learn the geometry from the header before mapping the samples
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < 2 * page) {
+            throw std::runtime_error("'" + name_ + "' is not a shared-memory ring");
+        }
+        void* first = ::mmap(nullptr, page, PROT_READ, MAP_SHARED, fd, 0);
+        if (first == MAP_FAILED) {
+            throw system_error("Cannot map shared-memory ring", name_);
+        }
+        const auto* header = static_cast<const Header*>(first);
+        bool valid = header->magic.load(std::memory_order_acquire) == kMagic &&
+                     header->version == kVersion &&
+                     header->format <= static_cast<std::uint32_t>(SampleFormat::CS8);
+        capacity = static_cast<std::size_t>(header->capacity);
+        format = static_cast<SampleFormat>(header->format);
+        ::munmap(first, page);
+        if (!valid) {
+            throw std::runtime_error("'" + name_ + "' is not an initialized shared-memory ring");
+        }
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+            page + capacity * sample_format_size(format) != static_cast<std::size_t>(info.st_size)) {
+            throw std::runtime_error("'" + name_ + "' is not an initialized shared-memory ring");
+        }
+    }
+
+    format_ = format;
+    sample_size_ = sample_format_size(format);
+    capacity_ = capacity;
+    const std::size_t data_bytes = capacity * sample_size_;
+
+    // Header + data, then the data a second time right behind it
+    region_bytes_ = page + 2 * data_bytes;
+    region_ = ::mmap(nullptr, region_bytes_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region_ == MAP_FAILED) {
+        region_ = nullptr;
+        throw system_error("Cannot reserve address space for shared-memory ring", name_);
+    }
+    char* base = static_cast<char*>(region_);
+    if (::mmap(base, page + data_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        std::runtime_error error = system_error("Cannot map shared-memory ring", name_);
+        release();
+        throw error;
+    }
+    mirrored_ = ::mmap(base + page + data_bytes, data_bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED, fd, static_cast<off_t>(page)) != MAP_FAILED;
+
+    header_ = reinterpret_cast<Header*>(base);
+    data_ = base + page;
+    if (initialize) {
+        header_ = new (base) Header{};
+        header_->version = kVersion;
+        header_->format = static_cast<std::uint32_t>(format);
+        header_->capacity = capacity;
+        header_->magic.store(kMagic, std::memory_order_release);
+    }
+    head_cache_ = header_->head.load(std::memory_order_acquire);
+    tail_cache_ = header_->tail.load(std::memory_order_acquire);
+}
+
+SharedMemoryRing::~SharedMemoryRing() {
+    release();
+}
+
+SharedMemoryRing::SharedMemoryRing(SharedMemoryRing&& other) noexcept {
+    *this = std::move(other);
+}
+
+SharedMemoryRing& SharedMemoryRing::operator=(SharedMemoryRing&& other) noexcept {
+    if (this != &other) {
+        release();
+        name_ = std::move(other.name_);
+        header_ = std::exchange(other.header_, nullptr);
+        data_ = std::exchange(other.data_, nullptr);
+        region_ = std::exchange(other.region_, nullptr);
+        region_bytes_ = std::exchange(other.region_bytes_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+        sample_size_ = other.sample_size_;
+        format_ = other.format_;
+        mirrored_ = other.mirrored_;
+        owner_ = std::exchange(other.owner_, false);
+        head_cache_ = other.head_cache_;
+        tail_cache_ = other.tail_cache_;
+    }
+    return *this;
+}
+
+void SharedMemoryRing::release() {
+    if (region_ != nullptr) {
+        ::munmap(region_, region_bytes_);
+        region_ = nullptr;
+        header_ = nullptr;
+        data_ = nullptr;
+    }
+    if (owner_) {
+        ::shm_unlink(name_.c_str());
+        owner_ = false;
+    }
+}
+
+std::size_t SharedMemoryRing::contiguous(std::uint64_t position, std::size_t limit) const {
+    if (mirrored_) {
+        return limit;
+    }
+    return std::min<std::size_t>(limit, capacity_ - (position & (capacity_ - 1)));
+}
+
+// ============================================================================
+// PRODUCER
+// ============================================================================
+
+RingSpan<char> SharedMemoryRing::reserve_bytes(std::size_t max_count) {
+    std::uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    std::size_t space = capacity_ - static_cast<std::size_t>(tail - head_cache_);
+    if (space < std::min(max_count, capacity_)) {
+        head_cache_ = header_->head.load(std::memory_order_acquire);
+        space = capacity_ - static_cast<std::size_t>(tail - head_cache_);
+    }
+    return {slot(tail), contiguous(tail, std::min(space, max_count)), tail};
+}
+
+void SharedMemoryRing::commit(std::size_t count) {
+    // The indices are shared with another process: a bad count here would
+    // leave tail - head past the capacity and corrupt both sides' views
+    std::uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    auto free_space = [&] { return capacity_ - static_cast<std::size_t>(tail - head_cache_); };
+    if (count > free_space()) {
+        head_cache_ = header_->head.load(std::memory_order_acquire);
+        if (count > free_space()) {
+            throw std::invalid_argument("commit(" + std::to_string(count) + ") exceeds the " +
+                                        std::to_string(free_space()) + " free samples");
+        }
+    }
+    header_->tail.store(tail + count, std::memory_order_release);
+    header_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->consumer_waiting.load(std::memory_order_seq_cst) != 0) {
+        futex_wake(header_->data_seq);
+    }
+}
+
+std::size_t SharedMemoryRing::write(const void* samples, std::size_t count) {
+    const char* source = static_cast<const char*>(samples);
+    std::size_t written = 0;
+    while (written < count) {
+        RingSpan<char> span = reserve_bytes(count - written);
+        if (span.count == 0) {
+            break;
+        }
+        std::memcpy(span.data, source + written * sample_size_, span.count * sample_size_);
+        commit(span.count);
+        written += span.count;
+    }
+    if (written < count) {
+        header_->overruns.fetch_add(count - written, std::memory_order_relaxed);
+    }
+    return written;
+}
+
+bool SharedMemoryRing::wait_writable(std::size_t min_count, double timeout_seconds) {
+    min_count = std::min(min_count, capacity_);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_seconds);
+    auto free_space = [this] {
+        return capacity_ - static_cast<std::size_t>(header_->tail.load(std::memory_order_relaxed) -
+                                                    header_->head.load(std::memory_order_acquire));
+    };
+    for (;;) {
+        std::uint32_t seq = header_->space_seq.load(std::memory_order_acquire);
+        if (free_space() >= min_count) {
+            return true;
+        }
+        double remaining = -1.0;
+        if (timeout_seconds >= 0.0) {
+            remaining = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0.0) {
+                return false;
+            }
+        }
+        header_->producer_waiting.store(1, std::memory_order_seq_cst);
+        if (free_space() < min_count) {
+            futex_wait(header_->space_seq, seq, remaining);
+        }
+        header_->producer_waiting.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SharedMemoryRing::close() {
+    header_->closed.store(1, std::memory_order_release);
+    header_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    futex_wake(header_->data_seq);
+}
+
+// ============================================================================
+// CONSUMER
+// ============================================================================
+
+RingSpan<const char> SharedMemoryRing::peek_bytes(std::size_t max_count) {
+    std::uint64_t head = header_->head.load(std::memory_order_relaxed);
+    std::size_t available = static_cast<std::size_t>(tail_cache_ - head);
+    if (available < std::min(max_count, capacity_)) {
+        tail_cache_ = header_->tail.load(std::memory_order_acquire);
+        available = static_cast<std::size_t>(tail_cache_ - head);
+    }
+    return {slot(head), contiguous(head, std::min(available, max_count)), head};
+}
+
+void SharedMemoryRing::consume(std::size_t count) {
+    std::uint64_t head = header_->head.load(std::memory_order_relaxed);
+    auto available = [&] { return static_cast<std::size_t>(tail_cache_ - head); };
+    if (count > available()) {
+        tail_cache_ = header_->tail.load(std::memory_order_acquire);
+        if (count > available()) {
+            throw std::invalid_argument("consume(" + std::to_string(count) + ") exceeds the " +
+                                        std::to_string(available()) + " available samples");
+        }
+    }
+    header_->head.store(head + count, std::memory_order_release);
+    header_->space_seq.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->producer_waiting.load(std::memory_order_seq_cst) != 0) {
+        futex_wake(header_->space_seq);
+    }
+}
+
+std::size_t SharedMemoryRing::read(void* samples, std::size_t max_count) {
+    char* dest = static_cast<char*>(samples);
+    std::size_t done = 0;
+    while (done < max_count) {
+        RingSpan<const char> span = peek_bytes(max_count - done);
+        if (span.count == 0) {
+            break;
+        }
+        std::memcpy(dest + done * sample_size_, span.data, span.count * sample_size_);
+        consume(span.count);
+        done += span.count;
+    }
+    return done;
+}
+
+bool SharedMemoryRing::wait_readable(std::size_t min_count, double timeout_seconds) {
+    min_count = std::min(min_count, capacity_);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_seconds);
+    for (;;) {
+        std::uint32_t seq = header_->data_seq.load(std::memory_order_acquire);
+        if (size() >= min_count || closed()) {
+            return true;
+        }
+        double remaining = -1.0;
+        if (timeout_seconds >= 0.0) {
+            remaining = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0.0) {
+                return false;
+            }
+        }
+        header_->consumer_waiting.store(1, std::memory_order_seq_cst);
+        if (size() < min_count && !closed()) {
+            futex_wait(header_->data_seq, seq, remaining);
+        }
+        header_->consumer_waiting.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ============================================================================
+// EITHER SIDE
+// ============================================================================
+
+bool SharedMemoryRing::closed() const {
+    return header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+std::size_t SharedMemoryRing::size() const {
+    // Consumer index first, so a concurrent consumer cannot make the
+    // difference negative; the clamp covers a producer lapping in between
+    std::uint64_t head = header_->head.load(std::memory_order_acquire);
+    std::uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    return tail > head ? std::min(static_cast<std::size_t>(tail - head), capacity_) : 0;
+}
+
+std::uint64_t SharedMemoryRing::overruns() const {
+    return header_->overruns.load(std::memory_order_relaxed);
+}
+
+} // namespace signal_processor
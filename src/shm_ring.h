@@ -0,0 +1,200 @@
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include "capture_reader.h"
+#include "ring_buffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Shared-Memory Sample Rings Between Processes
+ *
+ * Running acquisition and analysis as separate processes isolates faults -
+ * a crash in a detector cannot take the capture down with it - but a
+ * socket between them costs two copies and at least two system calls per
+ * block. A SharedMemoryRing is a single-producer/single-consumer ring in a
+ * named POSIX shared-memory segment (/dev/shm/<name>) that both processes
+ * map:
+ *
+ * 1. Zero-copy: the producer reserves a span of the segment and fills it
+ *    in place (e.g. with StreamingFir::process output); the consumer peeks
+ *    a span and processes it in place. Samples are never copied through
+ *    the kernel
+ * 2. Contiguous: like SpscRing, the data area is mapped twice back to
+ *    back, so every span is one plain array even across the wrap
+ * 3. Lock-free: the two indices are atomics in the segment on separate
+ *    cache lines. The fast path makes no system call at all; a side that
+ *    has to wait sleeps on a futex in the segment, and the other side only
+ *    issues the wake-up when somebody is actually asleep
+ *
+ * The segment records the sample format, so the consumer attaches by name
+ * alone. Overruns (write() on a full ring) are counted in the segment.
+ *
+ *   // acquisition process
+ *   auto ring = SharedMemoryRing::create("rx0", 1 << 22, SampleFormat::CF64);
+ *   RingSpan<std::complex<double>> free = ring.reserve<std::complex<double>>(4096);
+ *   fir.process(adc_block, free.count, free.data);
+ *   ring.commit(free.count);
+ *
+ *   // analysis process
+ *   auto ring = SharedMemoryRing::open("rx0");
+ *   ring.wait_readable(4096, 0.1);
+ *   RingSpan<const std::complex<double>> ready = ring.peek<std::complex<double>>();
+ *   detector.process(ready.data, ready.count);
+ *   ring.consume(ready.count);
+ *
+ * Linux only (futex wake-ups); the segment is removed when the creating
+ * ring is destroyed, while processes that have it mapped keep using it.
+ */
+
+namespace signal_processor {
+
+class SharedMemoryRing {
+public:
+    /**
+     * Create (or replace) the named segment
+     *
+     * @param name Segment name ("rx0" or "/rx0")
+     * @param min_capacity Samples; rounded up to a power of two and a whole page
+     * @throws std::invalid_argument for an empty name or zero capacity
+     * @throws std::runtime_error if the segment cannot be created or mapped
+     */
+    static SharedMemoryRing create(const std::string& name, std::size_t min_capacity, SampleFormat format);
+
+    /**
+     * Attach to a segment created by another ring (any process)
+     *
+     * @throws std::runtime_error if it does not exist or is not a ring
+     */
+    static SharedMemoryRing open(const std::string& name);
+
+    // Remove a segment name (mappings stay valid); false if it did not exist
+    static bool unlink(const std::string& name);
+
+    ~SharedMemoryRing();
+
+    SharedMemoryRing(SharedMemoryRing&& other) noexcept;
+    SharedMemoryRing& operator=(SharedMemoryRing&& other) noexcept;
+    SharedMemoryRing(const SharedMemoryRing&) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+    const std::string& name() const { return name_; }
+    SampleFormat format() const { return format_; }
+    std::size_t sample_size() const { return sample_size_; }
+    std::size_t capacity() const { return capacity_; }
+    bool mirrored() const { return mirrored_; }
+    bool owner() const { return owner_; }
+
+    // ------------------------------------------------------------ producer
+
+    /**
+     * Free space for up to `max_count` samples, as raw bytes
+     * (RingSpan::count is in samples)
+     */
+    RingSpan<char> reserve_bytes(std::size_t max_count = std::numeric_limits<std::size_t>::max());
+
+    // Typed reserve(); T must have the segment's sample size
+    template <typename T>
+    RingSpan<T> reserve(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+        check_sample_type(sizeof(T));
+        RingSpan<char> span = reserve_bytes(max_count);
+        return {reinterpret_cast<T*>(span.data), span.count, span.position};
+    }
+
+    /**
+     * Publish the first `count` samples of the last reservation
+     *
+     * @throws std::invalid_argument if `count` exceeds the free space, which
+     *         would hand the consumer slots it has not released yet
+     */
+    void commit(std::size_t count);
+
+    // Copy in as many of `count` samples as fit; the rest count as overruns
+    std::size_t write(const void* samples, std::size_t count);
+
+    /**
+     * Sleep until at least `min_count` samples are free
+     *
+     * @param timeout_seconds Negative = no limit
+     * @return false on timeout
+     */
+    bool wait_writable(std::size_t min_count, double timeout_seconds = -1.0);
+
+    // End of stream: wakes the consumer, which drains what is left once
+    // it sees closed()
+    void close();
+
+    // ------------------------------------------------------------ consumer
+
+    // Up to `max_count` available samples, as raw bytes
+    RingSpan<const char> peek_bytes(std::size_t max_count = std::numeric_limits<std::size_t>::max());
+
+    template <typename T>
+    RingSpan<const T> peek(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+        check_sample_type(sizeof(T));
+        RingSpan<const char> span = peek_bytes(max_count);
+        return {reinterpret_cast<const T*>(span.data), span.count, span.position};
+    }
+
+    /**
+     * Release the first `count` samples of the last peek
+     *
+     * @throws std::invalid_argument if fewer than `count` samples are
+     *         available, which would hand the producer unread slots
+     */
+    void consume(std::size_t count);
+
+    // Copy out up to `max_count` samples
+    std::size_t read(void* samples, std::size_t max_count);
+
+    /**
+     * Sleep until at least `min_count` samples are available or the ring is
+     * closed
+     *
+     * @param timeout_seconds Negative = no limit
+     * @return false on timeout
+     */
+    bool wait_readable(std::size_t min_count, double timeout_seconds = -1.0);
+
+    // ------------------------------------------------------------ either side
+
+    bool closed() const;
+    std::size_t size() const;          // Samples available to the consumer
+    std::uint64_t overruns() const;
+
+private:
+    struct Header;
+
+    SharedMemoryRing() = default;
+    void map(int fd, bool initialize, std::size_t capacity, SampleFormat format);
+    void release();
+    void check_sample_type(std::size_t size) const {
+        if (size != sample_size_) {
+            throw std::invalid_argument("Sample type does not match the ring's format");
+        }
+    }
+    char* slot(std::uint64_t position) const {
+        return data_ + (position & (capacity_ - 1)) * sample_size_;
+    }
+    std::size_t contiguous(std::uint64_t position, std::size_t limit) const;
+
+    std::string name_;
+    Header* header_ = nullptr;
+    char* data_ = nullptr;
+    void* region_ = nullptr;
+    std::size_t region_bytes_ = 0;
+    std::size_t capacity_ = 0;
+    std::size_t sample_size_ = 0;
+    SampleFormat format_ = SampleFormat::CF64;
+    bool mirrored_ = false;
+    bool owner_ = false;
+    std::uint64_t head_cache_ = 0;    // Producer's last view of the consumer index
+    std::uint64_t tail_cache_ = 0;    // Consumer's last view of the producer index
+};
+
+} // namespace signal_processor
+
+#endif // SHM_RING_H
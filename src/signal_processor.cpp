@@ -1,4 +1,10 @@
 #include "signal_processor.h"
+#include "buffer_pool.h"
+#include "fftw_planner.h"
+#include "instrumentation.h"
+#include "sample_convert.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include <cmath>
 #include <random>
 #include <stdexcept>
@@ -7,11 +13,19 @@
 
 namespace signal_processor {
 
+std::mutex& fftw_planner_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
 // ============================================================================
 // SIGNAL GENERATION
 // ============================================================================
 
-std::vector<double> generate_test_signal(
+namespace {
+
+template <typename T>
+std::vector<T> generate_test_signal_impl(
     double frequency,
     double sample_rate,
     double duration,
@@ -35,7 +49,7 @@ std::vector<double> generate_test_signal(
      */
 
     int num_samples = static_cast<int>(sample_rate * duration);
-    std::vector<double> signal(num_samples);
+    std::vector<T> signal(num_samples);
 
     // Random number generator for Gaussian noise
     std::random_device rd;
@@ -52,41 +66,40 @@ std::vector<double> generate_test_signal(
         // Add noise (this is interference we want to remove)
         double noise = noise_dist(gen);
 
-        signal[i] = sine_value + noise;
+        signal[i] = static_cast<T>(sine_value + noise);
     }
 
     return signal;
 }
 
+} // namespace
+
+std::vector<double> generate_test_signal(
+    double frequency,
+    double sample_rate,
+    double duration,
+    double noise_amplitude
+) {
+    return generate_test_signal_impl<double>(frequency, sample_rate, duration, noise_amplitude);
+}
+
+std::vector<float> generate_test_signal_f32(
+    double frequency,
+    double sample_rate,
+    double duration,
+    double noise_amplitude
+) {
+    return generate_test_signal_impl<float>(frequency, sample_rate, duration, noise_amplitude);
+}
+
 // ============================================================================
 // LOW-PASS FILTER (Removes High Frequencies)
 // ============================================================================
 
-std::vector<double> apply_lowpass_filter(
-    const std::vector<double>& input,
+std::vector<double> design_lowpass_filter(
     double cutoff_freq,
     int num_taps
 ) {
-    /**
-     * FIR (Finite Impulse Response) Low-Pass Filter
-     * Uses the "windowed-sinc" method - industry standard
-     *
-     * How filtering works:
-     * 1. Design filter coefficients (the "weights")
-     * 2. Slide filter across signal (convolution)
-     * 3. Each output is weighted average of nearby inputs
-     *
-     * Example with 3-tap filter [0.25, 0.5, 0.25]:
-     *   Input:  [5, 10, 6, 12, 7, ...]
-     *   Output: [-, 7.5, 9, 9.25, ...] (reduced variation)
-     *
-     * Tactical radio use case:
-     * - Voice signal: 0-4 kHz (low frequency)
-     * - Noise: 10+ kHz (high frequency)
-     * - Filter keeps voice, removes noise
-     */
-
-    // Step 1: Design the filter coefficients using windowed-sinc method
     std::vector<double> filter_coeffs(num_taps);
 
     // Calculate the center of the filter
@@ -123,13 +136,26 @@ std::vector<double> apply_lowpass_filter(
         coeff /= sum;
     }
 
-    // Step 2: Apply filter via convolution
+    return filter_coeffs;
+}
+
+namespace {
+
+/**
+ * Centered convolution for outputs [begin, end) of a `length`-sample input
+ * (zero-padded at the edges). Each output depends only on the input, so
+ * disjoint ranges can be computed independently - and in parallel.
+ */
+template <typename T>
+void convolve_range(const T* input, std::size_t length, const std::vector<T>& taps,
+                    std::size_t begin, std::size_t end, T* output) {
     // Convolution = sliding weighted average
-    int input_size = input.size();
-    std::vector<double> output(input_size, 0.0);
+    int input_size = static_cast<int>(length);
+    int num_taps = static_cast<int>(taps.size());
+    int center = num_taps / 2;
 
-    for (int i = 0; i < input_size; ++i) {
-        double sum = 0.0;
+    for (int i = static_cast<int>(begin); i < static_cast<int>(end); ++i) {
+        T sum = 0;
 
         // Multiply and accumulate (MAC) operation
         // This is the core of digital filtering
@@ -138,22 +164,98 @@ std::vector<double> apply_lowpass_filter(
 
             // Handle edges by zero-padding
             if (input_idx >= 0 && input_idx < input_size) {
-                sum += input[input_idx] * filter_coeffs[j];
+                sum += input[input_idx] * taps[j];
             }
         }
 
         output[i] = sum;
     }
+}
 
+template <typename T>
+std::vector<T> apply_lowpass_filter_impl(
+    const T* input,
+    std::size_t length,
+    double cutoff_freq,
+    int num_taps
+) {
+    /**
+     * FIR (Finite Impulse Response) Low-Pass Filter
+     * Uses the "windowed-sinc" method - industry standard
+     *
+     * How filtering works:
+     * 1. Design filter coefficients (the "weights")
+     * 2. Slide filter across signal (convolution)
+     * 3. Each output is weighted average of nearby inputs
+     *
+     * Example with 3-tap filter [0.25, 0.5, 0.25]:
+     *   Input:  [5, 10, 6, 12, 7, ...]
+     *   Output: [-, 7.5, 9, 9.25, ...] (reduced variation)
+     *
+     * Tactical radio use case:
+     * - Voice signal: 0-4 kHz (low frequency)
+     * - Noise: 10+ kHz (high frequency)
+     * - Filter keeps voice, removes noise
+     */
+
+    // Step 1: Design the filter coefficients using windowed-sinc method
+    std::vector<double> filter_coeffs = design_lowpass_filter(cutoff_freq, num_taps);
+
+    // Coefficients are designed in double precision and then rounded once
+    // to the sample type, so float32 filtering runs entirely in float32
+    std::vector<T> taps(filter_coeffs.begin(), filter_coeffs.end());
+
+    // Step 2: Apply filter via convolution
+    std::vector<T> output(length, T(0));
+    convolve_range(input, length, taps, 0, length, output.data());
     return output;
 }
 
+} // namespace
+
+std::vector<double> apply_lowpass_filter(
+    const std::vector<double>& input,
+    double cutoff_freq,
+    int num_taps
+) {
+    return apply_lowpass_filter(input.data(), input.size(), cutoff_freq, num_taps);
+}
+
+std::vector<double> apply_lowpass_filter(
+    const double* input,
+    std::size_t length,
+    double cutoff_freq,
+    int num_taps
+) {
+    SP_INSTRUMENT("apply_lowpass_filter", length);
+    SP_TRACE("apply_lowpass_filter");
+    return apply_lowpass_filter_impl(input, length, cutoff_freq, num_taps);
+}
+
+std::vector<float> apply_lowpass_filter(
+    const float* input,
+    std::size_t length,
+    double cutoff_freq,
+    int num_taps
+) {
+    SP_INSTRUMENT("apply_lowpass_filter_f32", length);
+    SP_TRACE("apply_lowpass_filter_f32");
+    return apply_lowpass_filter_impl(input, length, cutoff_freq, num_taps);
+}
+
 // ============================================================================
 // FFT (Fast Fourier Transform)
 // ============================================================================
 
 std::vector<std::complex<double>> compute_fft(
     const std::vector<double>& input
+) {
+    return compute_fft(input.data(), input.size());
+}
+
+std::vector<std::complex<double>> compute_fft(
+    const double* input,
+    std::size_t length
 ) {
     /**
      * Converts signal from time-domain to frequency-domain
@@ -174,11 +276,16 @@ std::vector<std::complex<double>> compute_fft(
      * - Tactical radio picks empty channel
      */
 
-    int N = input.size();
+    SP_INSTRUMENT("compute_fft", length);
+    SP_TRACE("compute_fft");
+
+    int N = static_cast<int>(length);
 
-    // Allocate aligned memory for FFTW (faster performance)
-    double* in = fftw_alloc_real(N);
-    fftw_complex* out = fftw_alloc_complex(N);
+    // Aligned scratch memory for FFTW (faster performance), reused from
+    // one call to the next instead of allocated each time
+    ArenaScope frame(thread_frame_arena());
+    double* in = frame.allocate<double>(N);
+    fftw_complex* out = frame.allocate<fftw_complex>(N / 2 + 1);
 
     // Copy input data
     for (int i = 0; i < N; ++i) {
@@ -188,12 +295,18 @@ std::vector<std::complex<double>> compute_fft(
     // Create FFTW plan (this analyzes best algorithm for this size)
     // FFTW_ESTIMATE is fast planning, good for one-time use
     // Production code might use FFTW_MEASURE for repeated FFTs
-    fftw_plan plan = fftw_plan_dft_r2c_1d(
-        N,
-        in,
-        out,
-        FFTW_ESTIMATE
-    );
+    // The planner is not thread-safe, so creation is serialized; the
+    // transform itself runs outside the lock.
+    fftw_plan plan;
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        plan = fftw_plan_dft_r2c_1d(
+            N,
+            in,
+            out,
+            FFTW_ESTIMATE
+        );
+    }
 
     // Execute the FFT (this is the actual transform)
     fftw_execute(plan);
@@ -205,10 +318,47 @@ std::vector<std::complex<double>> compute_fft(
         result[i] = std::complex<double>(out[i][0], out[i][1]);
     }
 
-    // Clean up FFTW resources
-    fftw_destroy_plan(plan);
-    fftw_free(in);
-    fftw_free(out);
+    // Clean up FFTW resources (the buffers go back with the arena scope)
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        fftw_destroy_plan(plan);
+    }
+
+    return result;
+}
+
+std::vector<std::complex<float>> compute_fft(
+    const float* input,
+    std::size_t length
+) {
+    // Single-precision twin of the double version above, using the
+    // fftwf_* API (libfftw3f). Halves memory traffic for large frames.
+    SP_INSTRUMENT("compute_fft_f32", length);
+    SP_TRACE("compute_fft_f32");
+    int N = static_cast<int>(length);
+
+    ArenaScope frame(thread_frame_arena());
+    float* in = frame.allocate<float>(N);
+    fftwf_complex* out = frame.allocate<fftwf_complex>(N / 2 + 1);
+
+    std::copy(input, input + N, in);
+
+    fftwf_plan plan;
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        plan = fftwf_plan_dft_r2c_1d(N, in, out, FFTW_ESTIMATE);
+    }
+    fftwf_execute(plan);
+
+    std::vector<std::complex<float>> result(N / 2 + 1);
+    for (int i = 0; i < N / 2 + 1; ++i) {
+        result[i] = std::complex<float>(out[i][0], out[i][1]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        fftwf_destroy_plan(plan);
+    }
 
     return result;
 }
@@ -220,6 +370,18 @@ std::vector<std::complex<double>> compute_fft(
 double calculate_snr(
     const std::vector<double>& signal,
     const std::vector<double>& noisy
+) {
+    if (signal.size() != noisy.size()) {
+        throw std::invalid_argument("Signal and noisy vectors must have same size");
+    }
+
+    return calculate_snr(signal.data(), noisy.data(), signal.size());
+}
+
+double calculate_snr(
+    const double* signal,
+    const double* noisy,
+    std::size_t length
 ) {
     /**
      * Measures signal quality in decibels (dB)
@@ -239,11 +401,10 @@ double calculate_snr(
      * Tactical radio specifications typically require operation at -3 dB or lower.
      */
 
-    if (signal.size() != noisy.size()) {
-        throw std::invalid_argument("Signal and noisy vectors must have same size");
-    }
+    SP_INSTRUMENT("calculate_snr", length);
+    SP_TRACE("calculate_snr");
 
-    int N = signal.size();
+    int N = static_cast<int>(length);
 
     // Calculate signal power: P_signal = Σ(signal[i]²)
     double signal_power = 0.0;
@@ -276,6 +437,14 @@ double calculate_snr(
 double find_peak_frequency(
     const std::vector<std::complex<double>>& fft_output,
     double sample_rate
+) {
+    return find_peak_frequency(fft_output.data(), fft_output.size(), sample_rate);
+}
+
+double find_peak_frequency(
+    const std::complex<double>* fft_output,
+    std::size_t length,
+    double sample_rate
 ) {
     /**
      * Finds the dominant frequency in FFT output
@@ -296,7 +465,10 @@ double find_peak_frequency(
      * - Essential for frequency-hopping radio systems
      */
 
-    if (fft_output.empty()) {
+    SP_INSTRUMENT("find_peak_frequency", length);
+    SP_TRACE("find_peak_frequency");
+
+    if (length == 0) {
         return 0.0;
     }
 
@@ -304,7 +476,7 @@ double find_peak_frequency(
     int max_bin = 0;
     double max_magnitude = 0.0;
 
-    for (size_t i = 0; i < fft_output.size(); ++i) {
+    for (size_t i = 0; i < length; ++i) {
         // Magnitude = sqrt(real² + imaginary²)
         double magnitude = std::abs(fft_output[i]);
 
@@ -316,10 +488,308 @@ double find_peak_frequency(
 
     // Convert bin number to actual frequency
     // Each bin represents (sample_rate / total_bins) Hz
-    int total_bins = (fft_output.size() - 1) * 2;  // Account for real FFT
+    int total_bins = (static_cast<int>(length) - 1) * 2;  // Account for real FFT
     double frequency = max_bin * sample_rate / total_bins;
 
     return frequency;
 }
 
+// ============================================================================
+// FIXED-POINT AND INTERLEAVED IQ INPUT
+// ============================================================================
+
+namespace {
+
+/**
+ * Raw samples are converted in chunks of this many samples into a small
+ * work buffer that stays in cache, instead of materializing a full
+ * float64 copy of the input first (which costs an extra pass over memory
+ * and 4-8x the input's footprint).
+ */
+constexpr std::size_t kConvertChunk = 4096;
+
+/**
+ * Centered, zero-padded FIR over raw input - the same result as
+ * apply_lowpass_filter() on the converted signal.
+ *
+ * Sample is double (real input) or std::complex<double> (interleaved IQ,
+ * two raw values per sample). For each chunk the work buffer holds the
+ * converted samples [start - center, start + n - center + num_taps - 1),
+ * with zeros outside the signal, so the inner MAC loop needs no edge checks.
+ */
+template <typename Sample, typename Raw>
+std::vector<Sample> filter_converted(
+    const Raw* input,
+    std::size_t length,
+    double scale,
+    double cutoff_freq,
+    int num_taps
+) {
+    constexpr std::size_t values_per_sample = sizeof(Sample) / sizeof(double);
+    const std::vector<double> taps = design_lowpass_filter(cutoff_freq, num_taps);
+    const std::ptrdiff_t center = num_taps / 2;
+    const std::ptrdiff_t signal_end = static_cast<std::ptrdiff_t>(length);
+
+    std::vector<Sample> output(length);
+    ArenaScope frame(thread_frame_arena());
+    Sample* work = frame.allocate<Sample>(kConvertChunk + num_taps - 1);
+    Sample* work_end = work + kConvertChunk + num_taps - 1;
+
+    for (std::size_t start = 0; start < length; start += kConvertChunk) {
+        const std::size_t n = std::min(kConvertChunk, length - start);
+        const std::ptrdiff_t lo = static_cast<std::ptrdiff_t>(start) - center;
+        const std::ptrdiff_t hi = lo + static_cast<std::ptrdiff_t>(n) + num_taps - 1;
+        const std::ptrdiff_t valid_lo = std::max<std::ptrdiff_t>(lo, 0);
+        const std::ptrdiff_t valid_hi = std::min(hi, signal_end);
+
+        std::fill(work, work_end, Sample(0));
+        if (valid_hi > valid_lo) {
+            convert_samples(input + valid_lo * values_per_sample,
+                            static_cast<std::size_t>(valid_hi - valid_lo) * values_per_sample,
+                            reinterpret_cast<double*>(work + (valid_lo - lo)),
+                            scale);
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            Sample sum = Sample(0);
+            for (int j = 0; j < num_taps; ++j) {
+                sum += work[i + j] * taps[j];
+            }
+            output[start + i] = sum;
+        }
+    }
+
+    return output;
+}
+
+// Real-to-complex FFT whose input buffer is filled by converting raw samples
+// directly into FFTW's aligned array (the copy compute_fft() makes anyway)
+template <typename Raw>
+std::vector<std::complex<double>> real_fft_converted(
+    const Raw* input,
+    std::size_t length,
+    double scale
+) {
+    int N = static_cast<int>(length);
+    ArenaScope frame(thread_frame_arena());
+    double* in = frame.allocate<double>(N);
+    fftw_complex* out = frame.allocate<fftw_complex>(N / 2 + 1);
+
+    convert_samples(input, length, in, scale);
+
+    fftw_plan plan;
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        plan = fftw_plan_dft_r2c_1d(N, in, out, FFTW_ESTIMATE);
+    }
+    fftw_execute(plan);
+
+    std::vector<std::complex<double>> result(N / 2 + 1);
+    for (int i = 0; i < N / 2 + 1; ++i) {
+        result[i] = std::complex<double>(out[i][0], out[i][1]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        fftw_destroy_plan(plan);
+    }
+    return result;
+}
+
+// Complex-to-complex FFT over interleaved IQ (2 raw values per sample).
+// All N bins are returned: for complex input negative frequencies differ
+// from positive ones (bins N/2+1 .. N-1 are the negative half).
+template <typename Raw>
+std::vector<std::complex<double>> complex_fft_converted(
+    const Raw* interleaved,
+    std::size_t num_samples,
+    double scale
+) {
+    int N = static_cast<int>(num_samples);
+    ArenaScope frame(thread_frame_arena());
+    fftw_complex* in = frame.allocate<fftw_complex>(N);
+    fftw_complex* out = frame.allocate<fftw_complex>(N);
+
+    convert_samples(interleaved, 2 * num_samples, reinterpret_cast<double*>(in), scale);
+
+    fftw_plan plan;
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        plan = fftw_plan_dft_1d(N, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
+    }
+    fftw_execute(plan);
+
+    std::vector<std::complex<double>> result(N);
+    for (int i = 0; i < N; ++i) {
+        result[i] = std::complex<double>(out[i][0], out[i][1]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        fftw_destroy_plan(plan);
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<double> apply_lowpass_filter(
+    const std::int16_t* input, std::size_t length,
+    double cutoff_freq, int num_taps, double scale
+) {
+    return filter_converted<double>(input, length, scale, cutoff_freq, num_taps);
+}
+
+std::vector<double> apply_lowpass_filter(
+    const std::int8_t* input, std::size_t length,
+    double cutoff_freq, int num_taps, double scale
+) {
+    return filter_converted<double>(input, length, scale, cutoff_freq, num_taps);
+}
+
+std::vector<std::complex<double>> compute_fft(
+    const std::int16_t* input, std::size_t length, double scale
+) {
+    return real_fft_converted(input, length, scale);
+}
+
+std::vector<std::complex<double>> compute_fft(
+    const std::int8_t* input, std::size_t length, double scale
+) {
+    return real_fft_converted(input, length, scale);
+}
+
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const double* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale
+) {
+    return filter_converted<std::complex<double>>(interleaved, num_samples, scale, cutoff_freq, num_taps);
+}
+
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const float* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale
+) {
+    return filter_converted<std::complex<double>>(interleaved, num_samples, scale, cutoff_freq, num_taps);
+}
+
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const std::int16_t* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale
+) {
+    return filter_converted<std::complex<double>>(interleaved, num_samples, scale, cutoff_freq, num_taps);
+}
+
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const std::int8_t* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale
+) {
+    return filter_converted<std::complex<double>>(interleaved, num_samples, scale, cutoff_freq, num_taps);
+}
+
+std::vector<std::complex<double>> compute_fft_iq(
+    const double* interleaved, std::size_t num_samples, double scale
+) {
+    return complex_fft_converted(interleaved, num_samples, scale);
+}
+
+std::vector<std::complex<double>> compute_fft_iq(
+    const float* interleaved, std::size_t num_samples, double scale
+) {
+    return complex_fft_converted(interleaved, num_samples, scale);
+}
+
+std::vector<std::complex<double>> compute_fft_iq(
+    const std::int16_t* interleaved, std::size_t num_samples, double scale
+) {
+    return complex_fft_converted(interleaved, num_samples, scale);
+}
+
+std::vector<std::complex<double>> compute_fft_iq(
+    const std::int8_t* interleaved, std::size_t num_samples, double scale
+) {
+    return complex_fft_converted(interleaved, num_samples, scale);
+}
+
+// ============================================================================
+// MULTI-CHANNEL BATCHES
+// ============================================================================
+
+namespace {
+
+// Outputs per filter task: large enough to amortize scheduling, small
+// enough that a long channel splits into many stealable pieces
+constexpr std::size_t kFilterGrain = 16384;
+
+ThreadPool& pool_or_default(ThreadPool* pool) {
+    return pool != nullptr ? *pool : default_thread_pool();
+}
+
+} // namespace
+
+std::vector<std::vector<double>> apply_lowpass_filter_batch(
+    const std::vector<ChannelView>& channels,
+    double cutoff_freq,
+    int num_taps,
+    ThreadPool* pool
+) {
+    std::vector<double> taps = design_lowpass_filter(cutoff_freq, num_taps);
+
+    // One task per (channel, output range), so uneven channel lengths
+    // still split into similar-sized pieces of work
+    struct Piece {
+        std::size_t channel;
+        std::size_t begin;
+        std::size_t end;
+    };
+    std::vector<std::vector<double>> outputs(channels.size());
+    std::vector<Piece> pieces;
+    for (std::size_t ch = 0; ch < channels.size(); ++ch) {
+        outputs[ch].assign(channels[ch].length, 0.0);
+        for (std::size_t begin = 0; begin < channels[ch].length; begin += kFilterGrain) {
+            pieces.push_back({ch, begin, std::min(begin + kFilterGrain, channels[ch].length)});
+        }
+    }
+
+    pool_or_default(pool).parallel_batch(pieces.size(), [&](std::size_t i) {
+        const Piece& piece = pieces[i];
+        const ChannelView& channel = channels[piece.channel];
+        convolve_range(channel.data, channel.length, taps, piece.begin, piece.end,
+                       outputs[piece.channel].data());
+    });
+    return outputs;
+}
+
+std::vector<std::vector<std::complex<double>>> compute_fft_batch(
+    const std::vector<ChannelView>& channels,
+    ThreadPool* pool
+) {
+    std::vector<std::vector<std::complex<double>>> outputs(channels.size());
+    pool_or_default(pool).parallel_batch(channels.size(), [&](std::size_t ch) {
+        outputs[ch] = compute_fft(channels[ch].data, channels[ch].length);
+    });
+    return outputs;
+}
+
+std::vector<double> calculate_snr_batch(
+    const std::vector<ChannelView>& signals,
+    const std::vector<ChannelView>& noisy,
+    ThreadPool* pool
+) {
+    if (signals.size() != noisy.size()) {
+        throw std::invalid_argument("Signal and noisy lists must have same size");
+    }
+    for (std::size_t ch = 0; ch < signals.size(); ++ch) {
+        if (signals[ch].length != noisy[ch].length) {
+            throw std::invalid_argument("Signal and noisy vectors must have same size");
+        }
+    }
+
+    std::vector<double> snr(signals.size());
+    pool_or_default(pool).parallel_batch(signals.size(), [&](std::size_t ch) {
+        snr[ch] = calculate_snr(signals[ch].data, noisy[ch].data, signals[ch].length);
+    });
+    return snr;
+}
+
 } // namespace signal_processor
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <complex>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * Signal Processing Library for Tactical Radio Applications
@@ -43,6 +45,32 @@ std::vector<double> generate_test_signal(
     double noise_amplitude
 );
 
+/**
+ * Single-precision (float32) variant of generate_test_signal()
+ */
+std::vector<float> generate_test_signal_f32(
+    double frequency,
+    double sample_rate,
+    double duration,
+    double noise_amplitude
+);
+
+/**
+ * Design windowed-sinc low-pass FIR coefficients
+ *
+ * The coefficient design step of apply_lowpass_filter(), exposed so that
+ * streaming filters and decimators (stream_processors.h) can design their
+ * taps once and reuse them for every block.
+ *
+ * @param cutoff_freq Normalized cutoff frequency (same units as apply_lowpass_filter)
+ * @param num_taps Number of coefficients (odd numbers give a symmetric filter)
+ * @return Hamming-windowed sinc coefficients normalized to unity DC gain
+ */
+std::vector<double> design_lowpass_filter(
+    double cutoff_freq,
+    int num_taps
+);
+
 /**
  * Apply a low-pass filter to remove high-frequency noise
  *
@@ -72,6 +100,35 @@ std::vector<double> apply_lowpass_filter(
     int num_taps
 );
 
+/**
+ * Zero-copy overload of apply_lowpass_filter()
+ *
+ * Operates directly on caller-owned memory, such as the buffer behind a
+ * NumPy array, so no intermediate std::vector is built for the input.
+ *
+ * @param input Pointer to `length` contiguous samples
+ * @param length Number of samples
+ */
+std::vector<double> apply_lowpass_filter(
+    const double* input,
+    std::size_t length,
+    double cutoff_freq,
+    int num_taps
+);
+
+/**
+ * Single-precision overload of apply_lowpass_filter()
+ *
+ * Coefficients are designed in double precision, then the convolution
+ * runs in float32 (twice the SIMD width of the double path).
+ */
+std::vector<float> apply_lowpass_filter(
+    const float* input,
+    std::size_t length,
+    double cutoff_freq,
+    int num_taps
+);
+
 /**
  * Compute Fast Fourier Transform (FFT)
  *
@@ -99,6 +156,27 @@ std::vector<std::complex<double>> compute_fft(
     const std::vector<double>& input
 );
 
+/**
+ * Zero-copy overload of compute_fft()
+ *
+ * @param input Pointer to `length` contiguous real samples
+ * @param length Number of samples (FFT size)
+ */
+std::vector<std::complex<double>> compute_fft(
+    const double* input,
+    std::size_t length
+);
+
+/**
+ * Single-precision overload of compute_fft() (uses libfftw3f)
+ *
+ * @return N/2 + 1 complex64 frequency bins
+ */
+std::vector<std::complex<float>> compute_fft(
+    const float* input,
+    std::size_t length
+);
+
 /**
  * Calculate Signal-to-Noise Ratio (SNR)
  *
@@ -122,6 +200,19 @@ double calculate_snr(
     const std::vector<double>& noisy
 );
 
+/**
+ * Zero-copy overload of calculate_snr()
+ *
+ * @param signal Pointer to `length` reference samples
+ * @param noisy Pointer to `length` received samples
+ * @param length Number of samples in each buffer
+ */
+double calculate_snr(
+    const double* signal,
+    const double* noisy,
+    std::size_t length
+);
+
 /**
  * Find the frequency with maximum power in FFT output
  *
@@ -143,6 +234,149 @@ double find_peak_frequency(
     double sample_rate
 );
 
+/**
+ * Zero-copy overload of find_peak_frequency()
+ *
+ * @param fft_output Pointer to `length` FFT bins
+ * @param length Number of bins (N/2 + 1 for a real FFT of size N)
+ */
+double find_peak_frequency(
+    const std::complex<double>* fft_output,
+    std::size_t length,
+    double sample_rate
+);
+
+// ============================================================================
+// Fixed-point and interleaved IQ input
+// ============================================================================
+
+/**
+ * Filter/FFT entry points for raw SDR sample formats
+ *
+ * SDR hardware delivers int16/int8 samples, usually as interleaved complex
+ * pairs (I0, Q0, I1, Q1, ...): "sc16" and "sc8". These overloads accept
+ * those buffers directly and convert (with scaling, SIMD - see
+ * sample_convert.h) on the way into the kernel:
+ * - filters convert a few thousand samples at a time into a cache-resident
+ *   work buffer, so no full-size float64 copy of the input is ever made
+ * - FFTs convert straight into FFTW's input array
+ *
+ * Results are float64 / complex128 and match running the float64 kernels
+ * on `input * scale`.
+ *
+ * @param scale Multiplier applied during conversion. Defaults map full
+ *              scale to [-1, 1): 1/32768 for int16, 1/128 for int8, and 1
+ *              for floating-point input.
+ */
+
+// Real int16 / int8 input
+std::vector<double> apply_lowpass_filter(
+    const std::int16_t* input, std::size_t length,
+    double cutoff_freq, int num_taps, double scale = 1.0 / 32768.0
+);
+std::vector<double> apply_lowpass_filter(
+    const std::int8_t* input, std::size_t length,
+    double cutoff_freq, int num_taps, double scale = 1.0 / 128.0
+);
+std::vector<std::complex<double>> compute_fft(
+    const std::int16_t* input, std::size_t length, double scale = 1.0 / 32768.0
+);
+std::vector<std::complex<double>> compute_fft(
+    const std::int8_t* input, std::size_t length, double scale = 1.0 / 128.0
+);
+
+/**
+ * Low-pass filter complex baseband given as 2 * num_samples interleaved
+ * values (complex128, complex64, sc16 or sc8). Real taps are applied to
+ * I and Q alike.
+ *
+ * @return num_samples complex samples
+ */
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const double* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale = 1.0
+);
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const float* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale = 1.0
+);
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const std::int16_t* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale = 1.0 / 32768.0
+);
+std::vector<std::complex<double>> apply_lowpass_filter_iq(
+    const std::int8_t* interleaved, std::size_t num_samples,
+    double cutoff_freq, int num_taps, double scale = 1.0 / 128.0
+);
+
+/**
+ * Complex-to-complex FFT of interleaved IQ
+ *
+ * @return All num_samples bins in FFTW order: 0 .. N/2 are the
+ *         non-negative frequencies, N/2+1 .. N-1 the negative ones
+ */
+std::vector<std::complex<double>> compute_fft_iq(
+    const double* interleaved, std::size_t num_samples, double scale = 1.0
+);
+std::vector<std::complex<double>> compute_fft_iq(
+    const float* interleaved, std::size_t num_samples, double scale = 1.0
+);
+std::vector<std::complex<double>> compute_fft_iq(
+    const std::int16_t* interleaved, std::size_t num_samples, double scale = 1.0 / 32768.0
+);
+std::vector<std::complex<double>> compute_fft_iq(
+    const std::int8_t* interleaved, std::size_t num_samples, double scale = 1.0 / 128.0
+);
+
+// ============================================================================
+// Multi-channel batches
+// ============================================================================
+
+class ThreadPool;
+
+/**
+ * One channel of a batch, in caller-owned memory
+ */
+struct ChannelView {
+    const double* data = nullptr;
+    std::size_t length = 0;
+};
+
+/**
+ * Batched entry points: the single-channel function applied to every
+ * channel, spread over a work-stealing ThreadPool (see thread_pool.h)
+ *
+ * Results are identical to calling the single-channel function on each
+ * channel in turn. Channels may have different lengths: long channels are
+ * filtered in independent output ranges, so one long channel does not
+ * leave the other cores idle at the end of the batch.
+ *
+ * @param pool Pool to run on; nullptr = default_thread_pool()
+ */
+std::vector<std::vector<double>> apply_lowpass_filter_batch(
+    const std::vector<ChannelView>& channels,
+    double cutoff_freq,
+    int num_taps,
+    ThreadPool* pool = nullptr
+);
+
+// compute_fft() of every channel (each channel's length is its FFT size)
+std::vector<std::vector<std::complex<double>>> compute_fft_batch(
+    const std::vector<ChannelView>& channels,
+    ThreadPool* pool = nullptr
+);
+
+/**
+ * calculate_snr() of every (signal, noisy) pair
+ *
+ * @throws std::invalid_argument if the lists or any pair differ in length
+ */
+std::vector<double> calculate_snr_batch(
+    const std::vector<ChannelView>& signals,
+    const std::vector<ChannelView>& noisy,
+    ThreadPool* pool = nullptr
+);
+
 } // namespace signal_processor
 
 #endif // SIGNAL_PROCESSOR_H
@@ -0,0 +1,259 @@
+/**
+ * signal_processor_bench - native kernel microbenchmarks
+ *
+ * benchmark.py times the Python entry points, so its numbers include
+ * argument conversion and the GIL, and ten time.time() samples are too few
+ * to separate a real change from noise. This suite calls the C++ kernels
+ * directly under Google Benchmark, which warms each kernel up, repeats it
+ * until the timing is stable and reports throughput:
+ *
+ *   items_per_second   samples (or FFT bins, for the peak search) per second
+ *   bytes_per_second   input bytes consumed per second
+ *
+ * Where the CPU's performance counters are accessible (perf_counters.h),
+ * each kernel also reports per sample (per bin, for the peak search):
+ *
+ *   cycles/item, IPC, l1d_miss/item, llc_miss/item, branch_miss/item
+ *
+ * which tells a compute-bound kernel (high IPC) from a memory-bound one
+ * (cache misses) or one losing time to mispredicted branches.
+ *
+ * Usage:
+ *   signal_processor_bench                          # every kernel
+ *   signal_processor_bench --benchmark_filter=Fir   # a subset
+ *   signal_processor_bench --benchmark_repetitions=10 \
+ *       --benchmark_format=json > results.json      # for comparisons
+ *
+ * Built when CMake finds Google Benchmark (find_package(benchmark)).
+ */
+
+#include "perf_counters.h"
+#include "sample_convert.h"
+#include "signal_processor.h"
+#include "stream_processors.h"
+#include <benchmark/benchmark.h>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace signal_processor;
+
+constexpr double kSampleRate = 1e6;
+constexpr double kWarmupSeconds = 0.2;
+
+// Tone plus noise, so the kernels see realistic (non-denormal) data
+std::vector<double> test_signal(std::size_t length) {
+    return generate_test_signal(50e3, kSampleRate, static_cast<double>(length) / kSampleRate, 0.3);
+}
+
+// Hardware counters over a benchmark's timed loop: construct just before it
+class KernelCounters {
+public:
+    KernelCounters() : start_(counters_.read()) {}
+
+    // Counts per item, for the counters this machine has
+    void report(benchmark::State& state, std::size_t items) const {
+        PerfSample cost = counters_.read() - start_;
+        double total = static_cast<double>(state.iterations()) * static_cast<double>(items);
+        if (total <= 0.0) {
+            return;
+        }
+        auto per_item = [&](const char* name, PerfEvent event) {
+            if (cost.has(event)) {
+                state.counters[name] = static_cast<double>(cost[event]) / total;
+            }
+        };
+        per_item("cycles/item", PerfEvent::Cycles);
+        per_item("l1d_miss/item", PerfEvent::L1dMisses);
+        per_item("llc_miss/item", PerfEvent::LlcMisses);
+        per_item("branch_miss/item", PerfEvent::BranchMisses);
+        if (cost.has(PerfEvent::Cycles) && cost.has(PerfEvent::Instructions) && cost[PerfEvent::Cycles] > 0) {
+            state.counters["IPC"] = static_cast<double>(cost[PerfEvent::Instructions]) /
+                                    static_cast<double>(cost[PerfEvent::Cycles]);
+        }
+    }
+
+private:
+    PerfCounters counters_;
+    PerfSample start_;
+};
+
+// Per-iteration work → the items_per_second / bytes_per_second columns,
+// plus the hardware counters per item
+void set_throughput(benchmark::State& state, const KernelCounters& counters, std::size_t items,
+                    std::size_t bytes) {
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(items));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bytes));
+    counters.report(state, items);
+}
+
+// ============================================================================
+// FILTERING
+// ============================================================================
+
+// Args: {taps, block length}
+void BM_LowpassFilter(benchmark::State& state) {
+    const int taps = static_cast<int>(state.range(0));
+    const auto length = static_cast<std::size_t>(state.range(1));
+    std::vector<double> input = test_signal(length);
+    KernelCounters counters;
+    for (auto _ : state) {
+        std::vector<double> output = apply_lowpass_filter(input.data(), length, 0.1, taps);
+        benchmark::DoNotOptimize(output.data());
+    }
+    set_throughput(state, counters, length, length * sizeof(double));
+}
+BENCHMARK(BM_LowpassFilter)
+    ->ArgsProduct({{31, 101, 255}, {4096, 65536}})
+    ->ArgNames({"taps", "length"})
+    ->MinWarmUpTime(kWarmupSeconds);
+
+void BM_LowpassFilterF32(benchmark::State& state) {
+    const int taps = static_cast<int>(state.range(0));
+    const auto length = static_cast<std::size_t>(state.range(1));
+    std::vector<double> signal = test_signal(length);
+    std::vector<float> input(signal.begin(), signal.end());
+    KernelCounters counters;
+    for (auto _ : state) {
+        std::vector<float> output = apply_lowpass_filter(input.data(), length, 0.1, taps);
+        benchmark::DoNotOptimize(output.data());
+    }
+    set_throughput(state, counters, length, length * sizeof(float));
+}
+BENCHMARK(BM_LowpassFilterF32)
+    ->ArgsProduct({{31, 101, 255}, {65536}})
+    ->ArgNames({"taps", "length"})
+    ->MinWarmUpTime(kWarmupSeconds);
+
+// Streaming FIR on complex baseband: the per-block cost with state carried
+// over, and no output allocation (the steady state of a receive chain)
+void BM_StreamingFirIq(benchmark::State& state) {
+    const auto taps = static_cast<int>(state.range(0));
+    const std::size_t length = 8192;
+    StreamingFir<std::complex<double>> fir(design_lowpass_filter(0.1, taps));
+    std::vector<double> signal = test_signal(2 * length);
+    std::vector<std::complex<double>> input(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        input[i] = {signal[2 * i], signal[2 * i + 1]};
+    }
+    std::vector<std::complex<double>> output(length);
+    KernelCounters counters;
+    for (auto _ : state) {
+        fir.process(input.data(), length, output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+    set_throughput(state, counters, length, length * sizeof(std::complex<double>));
+}
+BENCHMARK(BM_StreamingFirIq)->Arg(31)->Arg(101)->ArgName("taps")->MinWarmUpTime(kWarmupSeconds);
+
+// ============================================================================
+// FFT AND SPECTRUM
+// ============================================================================
+
+void BM_Fft(benchmark::State& state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    std::vector<double> input = test_signal(length);
+    KernelCounters counters;
+    for (auto _ : state) {
+        std::vector<std::complex<double>> spectrum = compute_fft(input.data(), length);
+        benchmark::DoNotOptimize(spectrum.data());
+    }
+    set_throughput(state, counters, length, length * sizeof(double));
+}
+BENCHMARK(BM_Fft)->RangeMultiplier(4)->Range(256, 65536)->ArgName("size")->MinWarmUpTime(kWarmupSeconds);
+
+void BM_FftF32(benchmark::State& state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    std::vector<double> signal = test_signal(length);
+    std::vector<float> input(signal.begin(), signal.end());
+    KernelCounters counters;
+    for (auto _ : state) {
+        std::vector<std::complex<float>> spectrum = compute_fft(input.data(), length);
+        benchmark::DoNotOptimize(spectrum.data());
+    }
+    set_throughput(state, counters, length, length * sizeof(float));
+}
+BENCHMARK(BM_FftF32)->Arg(1024)->Arg(65536)->ArgName("size")->MinWarmUpTime(kWarmupSeconds);
+
+// Items are FFT bins searched
+void BM_PeakSearch(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    std::vector<std::complex<double>> spectrum = compute_fft(test_signal(size));
+    KernelCounters counters;
+    for (auto _ : state) {
+        double peak = find_peak_frequency(spectrum.data(), spectrum.size(), kSampleRate);
+        benchmark::DoNotOptimize(peak);
+    }
+    set_throughput(state, counters, spectrum.size(), spectrum.size() * sizeof(std::complex<double>));
+}
+BENCHMARK(BM_PeakSearch)->Arg(1024)->Arg(65536)->ArgName("size")->MinWarmUpTime(kWarmupSeconds);
+
+// ============================================================================
+// MEASUREMENT AND GENERATION
+// ============================================================================
+
+// Bytes count both buffers
+void BM_Snr(benchmark::State& state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    std::vector<double> clean = generate_test_signal(50e3, kSampleRate, static_cast<double>(length) / kSampleRate, 0.0);
+    std::vector<double> noisy = test_signal(length);
+    KernelCounters counters;
+    for (auto _ : state) {
+        double snr = calculate_snr(clean.data(), noisy.data(), length);
+        benchmark::DoNotOptimize(snr);
+    }
+    set_throughput(state, counters, length, 2 * length * sizeof(double));
+}
+BENCHMARK(BM_Snr)->Arg(4096)->Arg(1 << 20)->ArgName("length")->MinWarmUpTime(kWarmupSeconds);
+
+// Bytes are the samples produced
+void BM_GenerateSignal(benchmark::State& state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    KernelCounters counters;
+    for (auto _ : state) {
+        std::vector<double> signal =
+            generate_test_signal(50e3, kSampleRate, static_cast<double>(length) / kSampleRate, 0.3);
+        benchmark::DoNotOptimize(signal.data());
+    }
+    set_throughput(state, counters, length, length * sizeof(double));
+}
+BENCHMARK(BM_GenerateSignal)->Arg(4096)->Arg(1 << 20)->ArgName("length")->MinWarmUpTime(kWarmupSeconds);
+
+// sc16 → complex128: the first step of every fixed-point receive chain
+void BM_ConvertSc16(benchmark::State& state) {
+    const auto samples = static_cast<std::size_t>(state.range(0));
+    std::vector<std::int16_t> input(2 * samples);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> value(-32768, 32767);
+    for (auto& v : input) {
+        v = static_cast<std::int16_t>(value(rng));
+    }
+    std::vector<std::complex<double>> output(samples);
+    KernelCounters counters;
+    for (auto _ : state) {
+        convert_samples(input.data(), input.size(), reinterpret_cast<double*>(output.data()));
+        benchmark::DoNotOptimize(output.data());
+    }
+    set_throughput(state, counters, samples, input.size() * sizeof(std::int16_t));
+}
+BENCHMARK(BM_ConvertSc16)->Arg(65536)->ArgName("samples")->MinWarmUpTime(kWarmupSeconds);
+
+} // namespace
+
+// BENCHMARK_MAIN(), plus a context line saying whether the hardware
+// counters columns can appear on this machine
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    PerfCounters counters;
+    benchmark::AddCustomContext("hardware_counters",
+                                counters.hardware_available() ? "on" : counters.errors().front());
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,448 @@
+#include "signal_processor_c.h"
+#include "signal_processor.h"
+#include "stream_processors.h"
+#include <algorithm>
+#include <complex>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+using signal_processor::Decimator;
+using signal_processor::Nco;
+using signal_processor::Stft;
+using signal_processor::StreamingFir;
+
+using Complex = std::complex<double>;
+
+// Opaque handle definitions: each wraps the real- or complex-sample
+// instantiation chosen at creation time
+struct sp_fir {
+    std::unique_ptr<StreamingFir<double>> real;
+    std::unique_ptr<StreamingFir<Complex>> complex;
+};
+
+struct sp_decimator {
+    std::unique_ptr<Decimator<double>> real;
+    std::unique_ptr<Decimator<Complex>> complex;
+};
+
+struct sp_stft {
+    explicit sp_stft(int frame_size, int hop_size) : stft(frame_size, hop_size) {}
+    Stft stft;
+};
+
+struct sp_nco {
+    explicit sp_nco(double frequency) : nco(frequency) {}
+    Nco nco;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+struct BufferTooSmall : std::length_error {
+    using std::length_error::length_error;
+};
+
+// Exceptions must never cross the C boundary: translate them to status
+// codes and keep the message for sp_last_error()
+template <typename Fn>
+sp_status guarded(Fn&& fn) {
+    try {
+        fn();
+        return SP_OK;
+    } catch (const BufferTooSmall& e) {
+        last_error = e.what();
+        return SP_ERROR_BUFFER_TOO_SMALL;
+    } catch (const std::invalid_argument& e) {
+        last_error = e.what();
+        return SP_ERROR_INVALID_ARGUMENT;
+    } catch (const std::bad_alloc&) {
+        last_error = "out of memory";
+        return SP_ERROR_OUT_OF_MEMORY;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return SP_ERROR_INTERNAL;
+    } catch (...) {
+        last_error = "unknown error";
+        return SP_ERROR_INTERNAL;
+    }
+}
+
+void require(bool condition, const char* message) {
+    if (!condition) {
+        throw std::invalid_argument(message);
+    }
+}
+
+Complex* as_complex(double* interleaved) {
+    return reinterpret_cast<Complex*>(interleaved);
+}
+
+const Complex* as_complex(const double* interleaved) {
+    return reinterpret_cast<const Complex*>(interleaved);
+}
+
+sp_fir* make_fir(std::vector<double> taps, int complex_samples) {
+    auto handle = std::make_unique<sp_fir>();
+    if (complex_samples) {
+        handle->complex = std::make_unique<StreamingFir<Complex>>(std::move(taps));
+    } else {
+        handle->real = std::make_unique<StreamingFir<double>>(std::move(taps));
+    }
+    return handle.release();
+}
+
+template <typename T>
+void copy_complex(const std::vector<std::complex<T>>& values, double* output_iq) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        output_iq[2 * i] = values[i].real();
+        output_iq[2 * i + 1] = values[i].imag();
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+// ============================================================================
+// LIBRARY INFORMATION
+// ============================================================================
+
+const char* sp_version(void) {
+#ifdef VERSION_INFO
+    return VERSION_INFO;
+#else
+    return "dev";
+#endif
+}
+
+const char* sp_status_string(sp_status status) {
+    switch (status) {
+        case SP_OK: return "ok";
+        case SP_ERROR_INVALID_ARGUMENT: return "invalid argument";
+        case SP_ERROR_BUFFER_TOO_SMALL: return "buffer too small";
+        case SP_ERROR_OUT_OF_MEMORY: return "out of memory";
+        case SP_ERROR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+const char* sp_last_error(void) {
+    return last_error.c_str();
+}
+
+// ============================================================================
+// ONE-SHOT KERNELS
+// ============================================================================
+
+sp_status sp_generate_test_signal(double frequency, double sample_rate, double duration,
+                                  double noise_amplitude, double* output, size_t capacity,
+                                  size_t* written) {
+    return guarded([&] {
+        require(output && written, "output and written must not be null");
+        require(sample_rate > 0.0 && duration >= 0.0, "sample_rate must be > 0 and duration >= 0");
+        std::size_t needed = static_cast<std::size_t>(sample_rate * duration);
+        if (needed > capacity) {
+            throw BufferTooSmall("output capacity below sample_rate * duration");
+        }
+        std::vector<double> signal = signal_processor::generate_test_signal(
+            frequency, sample_rate, duration, noise_amplitude);
+        std::copy(signal.begin(), signal.end(), output);
+        *written = signal.size();
+    });
+}
+
+sp_status sp_design_lowpass(double cutoff_freq, int num_taps, double* taps) {
+    return guarded([&] {
+        require(taps != nullptr, "taps must not be null");
+        require(num_taps > 0, "num_taps must be positive");
+        std::vector<double> coeffs = signal_processor::design_lowpass_filter(cutoff_freq, num_taps);
+        std::copy(coeffs.begin(), coeffs.end(), taps);
+    });
+}
+
+sp_status sp_lowpass_filter(const double* input, size_t length, double cutoff_freq,
+                            int num_taps, double* output) {
+    return guarded([&] {
+        require(input && output, "input and output must not be null");
+        require(num_taps > 0, "num_taps must be positive");
+        std::vector<double> filtered =
+            signal_processor::apply_lowpass_filter(input, length, cutoff_freq, num_taps);
+        std::copy(filtered.begin(), filtered.end(), output);
+    });
+}
+
+sp_status sp_lowpass_filter_f32(const float* input, size_t length, double cutoff_freq,
+                                int num_taps, float* output) {
+    return guarded([&] {
+        require(input && output, "input and output must not be null");
+        require(num_taps > 0, "num_taps must be positive");
+        std::vector<float> filtered =
+            signal_processor::apply_lowpass_filter(input, length, cutoff_freq, num_taps);
+        std::copy(filtered.begin(), filtered.end(), output);
+    });
+}
+
+sp_status sp_lowpass_filter_sc16(const int16_t* interleaved, size_t num_samples,
+                                 double cutoff_freq, int num_taps, double scale,
+                                 double* output_iq) {
+    return guarded([&] {
+        require(interleaved && output_iq, "input and output must not be null");
+        require(num_taps > 0, "num_taps must be positive");
+        copy_complex(signal_processor::apply_lowpass_filter_iq(
+                         interleaved, num_samples, cutoff_freq, num_taps, scale),
+                     output_iq);
+    });
+}
+
+sp_status sp_fft(const double* input, size_t length, double* output_iq) {
+    return guarded([&] {
+        require(input && output_iq, "input and output must not be null");
+        require(length > 0, "length must be positive");
+        copy_complex(signal_processor::compute_fft(input, length), output_iq);
+    });
+}
+
+sp_status sp_fft_iq(const double* input_iq, size_t num_samples, double* output_iq) {
+    return guarded([&] {
+        require(input_iq && output_iq, "input and output must not be null");
+        require(num_samples > 0, "num_samples must be positive");
+        copy_complex(signal_processor::compute_fft_iq(input_iq, num_samples), output_iq);
+    });
+}
+
+sp_status sp_snr(const double* signal, const double* noisy, size_t length, double* snr_db) {
+    return guarded([&] {
+        require(signal && noisy && snr_db, "arguments must not be null");
+        *snr_db = signal_processor::calculate_snr(signal, noisy, length);
+    });
+}
+
+sp_status sp_peak_frequency(const double* fft_iq, size_t bins, double sample_rate,
+                            double* frequency) {
+    return guarded([&] {
+        require(fft_iq && frequency, "arguments must not be null");
+        require(bins != 1, "need at least 2 bins");
+        *frequency = signal_processor::find_peak_frequency(as_complex(fft_iq), bins, sample_rate);
+    });
+}
+
+// ============================================================================
+// STREAMING FIR
+// ============================================================================
+
+sp_status sp_fir_create(const double* taps, size_t num_taps, int complex_samples, sp_fir** fir) {
+    return guarded([&] {
+        require(taps && fir, "taps and fir must not be null");
+        *fir = make_fir(std::vector<double>(taps, taps + num_taps), complex_samples);
+    });
+}
+
+sp_status sp_fir_create_lowpass(double cutoff_freq, int num_taps, int complex_samples, sp_fir** fir) {
+    return guarded([&] {
+        require(fir != nullptr, "fir must not be null");
+        require(num_taps > 0, "num_taps must be positive");
+        *fir = make_fir(signal_processor::design_lowpass_filter(cutoff_freq, num_taps),
+                        complex_samples);
+    });
+}
+
+sp_status sp_fir_process(sp_fir* fir, const double* input, size_t length, double* output) {
+    return guarded([&] {
+        require(fir && input && output, "arguments must not be null");
+        if (fir->complex) {
+            fir->complex->process(as_complex(input), length, as_complex(output));
+        } else {
+            fir->real->process(input, length, output);
+        }
+    });
+}
+
+sp_status sp_fir_reset(sp_fir* fir) {
+    return guarded([&] {
+        require(fir != nullptr, "fir must not be null");
+        if (fir->complex) {
+            fir->complex->reset();
+        } else {
+            fir->real->reset();
+        }
+    });
+}
+
+void sp_fir_destroy(sp_fir* fir) {
+    delete fir;
+}
+
+// ============================================================================
+// DECIMATOR
+// ============================================================================
+
+sp_status sp_decimator_create(int factor, const double* taps, size_t num_taps,
+                              int complex_samples, sp_decimator** decimator) {
+    return guarded([&] {
+        require(taps && decimator, "taps and decimator must not be null");
+        std::vector<double> coeffs(taps, taps + num_taps);
+        auto handle = std::make_unique<sp_decimator>();
+        if (complex_samples) {
+            handle->complex = std::make_unique<Decimator<Complex>>(factor, std::move(coeffs));
+        } else {
+            handle->real = std::make_unique<Decimator<double>>(factor, std::move(coeffs));
+        }
+        *decimator = handle.release();
+    });
+}
+
+sp_status sp_decimator_create_lowpass(int factor, int num_taps, int complex_samples,
+                                      sp_decimator** decimator) {
+    return guarded([&] {
+        require(decimator != nullptr, "decimator must not be null");
+        require(num_taps > 0, "num_taps must be positive");
+        auto handle = std::make_unique<sp_decimator>();
+        if (complex_samples) {
+            handle->complex = std::make_unique<Decimator<Complex>>(factor, num_taps);
+        } else {
+            handle->real = std::make_unique<Decimator<double>>(factor, num_taps);
+        }
+        *decimator = handle.release();
+    });
+}
+
+size_t sp_decimator_max_output(const sp_decimator* decimator, size_t length) {
+    if (!decimator) {
+        return 0;
+    }
+    return decimator->complex ? decimator->complex->max_output(length)
+                              : decimator->real->max_output(length);
+}
+
+sp_status sp_decimator_process(sp_decimator* decimator, const double* input, size_t length,
+                               double* output, size_t capacity, size_t* produced) {
+    return guarded([&] {
+        require(decimator && input && output && produced, "arguments must not be null");
+        if (capacity < sp_decimator_max_output(decimator, length)) {
+            throw BufferTooSmall("capacity below sp_decimator_max_output()");
+        }
+        if (decimator->complex) {
+            *produced = decimator->complex->process(as_complex(input), length, as_complex(output));
+        } else {
+            *produced = decimator->real->process(input, length, output);
+        }
+    });
+}
+
+sp_status sp_decimator_reset(sp_decimator* decimator) {
+    return guarded([&] {
+        require(decimator != nullptr, "decimator must not be null");
+        if (decimator->complex) {
+            decimator->complex->reset();
+        } else {
+            decimator->real->reset();
+        }
+    });
+}
+
+void sp_decimator_destroy(sp_decimator* decimator) {
+    delete decimator;
+}
+
+// ============================================================================
+// STFT
+// ============================================================================
+
+sp_status sp_stft_create(int frame_size, int hop_size, sp_stft** stft) {
+    return guarded([&] {
+        require(stft != nullptr, "stft must not be null");
+        *stft = new sp_stft(frame_size, hop_size);
+    });
+}
+
+size_t sp_stft_bins(const sp_stft* stft) {
+    return stft ? stft->stft.bins() : 0;
+}
+
+size_t sp_stft_max_frames(const sp_stft* stft, size_t length) {
+    return stft ? stft->stft.max_frames(length) : 0;
+}
+
+sp_status sp_stft_process(sp_stft* stft, const double* input, size_t length,
+                          double* output_iq, size_t capacity_frames, size_t* frames) {
+    return guarded([&] {
+        require(stft && input && output_iq && frames, "arguments must not be null");
+        if (capacity_frames < stft->stft.max_frames(length)) {
+            throw BufferTooSmall("capacity below sp_stft_max_frames()");
+        }
+        *frames = stft->stft.process(input, length, as_complex(output_iq));
+    });
+}
+
+sp_status sp_stft_reset(sp_stft* stft) {
+    return guarded([&] {
+        require(stft != nullptr, "stft must not be null");
+        stft->stft.reset();
+    });
+}
+
+void sp_stft_destroy(sp_stft* stft) {
+    delete stft;
+}
+
+// ============================================================================
+// NCO
+// ============================================================================
+
+sp_status sp_nco_create(double frequency, sp_nco** nco) {
+    return guarded([&] {
+        require(nco != nullptr, "nco must not be null");
+        *nco = new sp_nco(frequency);
+    });
+}
+
+sp_status sp_nco_set_frequency(sp_nco* nco, double frequency) {
+    return guarded([&] {
+        require(nco != nullptr, "nco must not be null");
+        nco->nco.set_frequency(frequency);
+    });
+}
+
+sp_status sp_nco_process(sp_nco* nco, const double* input, size_t length, double* output_iq) {
+    return guarded([&] {
+        require(nco && input && output_iq, "arguments must not be null");
+        nco->nco.process(input, length, as_complex(output_iq));
+    });
+}
+
+sp_status sp_nco_process_iq(sp_nco* nco, const double* input_iq, size_t length, double* output_iq) {
+    return guarded([&] {
+        require(nco && input_iq && output_iq, "arguments must not be null");
+        nco->nco.process(as_complex(input_iq), length, as_complex(output_iq));
+    });
+}
+
+sp_status sp_nco_generate(sp_nco* nco, size_t length, double* output_iq) {
+    return guarded([&] {
+        require(nco && output_iq, "arguments must not be null");
+        nco->nco.generate(length, as_complex(output_iq));
+    });
+}
+
+sp_status sp_nco_get_phase(const sp_nco* nco, double* phase) {
+    return guarded([&] {
+        require(nco && phase, "arguments must not be null");
+        *phase = nco->nco.snapshot();
+    });
+}
+
+sp_status sp_nco_set_phase(sp_nco* nco, double phase) {
+    return guarded([&] {
+        require(nco != nullptr, "nco must not be null");
+        nco->nco.restore(phase);
+    });
+}
+
+void sp_nco_destroy(sp_nco* nco) {
+    delete nco;
+}
+
+} // extern "C"
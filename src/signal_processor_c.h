@@ -0,0 +1,146 @@
+#ifndef SIGNAL_PROCESSOR_C_H
+#define SIGNAL_PROCESSOR_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * C API for the Signal Processing Library
+ *
+ * A stable C ABI over the C++ core so that real-time services, embedded
+ * targets and other languages can link the DSP code without C++ name
+ * mangling, exceptions or STL types crossing the boundary - and without a
+ * Python interpreter anywhere in the process.
+ *
+ * Conventions:
+ * - Every function returns an sp_status; results go to out-parameters
+ * - Callers own all sample buffers; the library never keeps a pointer to
+ *   them after a call returns
+ * - Complex samples are interleaved doubles: re0, im0, re1, im1, ...
+ *   (bit-compatible with C99 `double complex` and std::complex<double>)
+ * - Stateful processors are opaque handles: create, process, destroy.
+ *   A handle must not be used from two threads at once; different handles
+ *   are independent
+ * - On failure, sp_last_error() describes the most recent error raised on
+ *   the calling thread
+ *
+ * Example:
+ *   sp_fir* fir = NULL;
+ *   if (sp_fir_create_lowpass(0.1, 51, 0, &fir) != SP_OK) { ... }
+ *   while (read_block(in, n)) {
+ *       sp_fir_process(fir, in, n, out);
+ *   }
+ *   sp_fir_destroy(fir);
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum sp_status {
+    SP_OK = 0,
+    SP_ERROR_INVALID_ARGUMENT = 1,   /* Bad size, null pointer, out-of-range parameter */
+    SP_ERROR_BUFFER_TOO_SMALL = 2,   /* Output capacity below what the call produces */
+    SP_ERROR_OUT_OF_MEMORY = 3,
+    SP_ERROR_INTERNAL = 4
+} sp_status;
+
+/* Library version string, e.g. "1.0.0" */
+const char* sp_version(void);
+
+/* Static description of a status code */
+const char* sp_status_string(sp_status status);
+
+/* Detail message for the last failure on this thread ("" if none) */
+const char* sp_last_error(void);
+
+/* ------------------------------------------------------------------------
+ * One-shot kernels (see signal_processor.h for the algorithms)
+ * ------------------------------------------------------------------------ */
+
+/* Writes floor(sample_rate * duration) samples; fails if capacity is smaller */
+sp_status sp_generate_test_signal(double frequency, double sample_rate, double duration,
+                                  double noise_amplitude, double* output, size_t capacity,
+                                  size_t* written);
+
+/* num_taps coefficients into `taps` */
+sp_status sp_design_lowpass(double cutoff_freq, int num_taps, double* taps);
+
+/* `length` samples in, `length` samples out (centered, zero-padded edges) */
+sp_status sp_lowpass_filter(const double* input, size_t length, double cutoff_freq,
+                            int num_taps, double* output);
+sp_status sp_lowpass_filter_f32(const float* input, size_t length, double cutoff_freq,
+                                int num_taps, float* output);
+
+/* Interleaved sc16 I/Q in (2 * num_samples int16), interleaved complex out */
+sp_status sp_lowpass_filter_sc16(const int16_t* interleaved, size_t num_samples,
+                                 double cutoff_freq, int num_taps, double scale,
+                                 double* output_iq);
+
+/* Real FFT: `length` samples in, length / 2 + 1 interleaved complex bins out */
+sp_status sp_fft(const double* input, size_t length, double* output_iq);
+
+/* Complex FFT: num_samples interleaved complex in, num_samples bins out */
+sp_status sp_fft_iq(const double* input_iq, size_t num_samples, double* output_iq);
+
+sp_status sp_snr(const double* signal, const double* noisy, size_t length, double* snr_db);
+
+/* bins = length / 2 + 1 of the real FFT that produced fft_iq */
+sp_status sp_peak_frequency(const double* fft_iq, size_t bins, double sample_rate,
+                            double* frequency);
+
+/* ------------------------------------------------------------------------
+ * Stateful streaming processors (see stream_processors.h)
+ *
+ * `complex_samples` selects real (0) or interleaved complex (1) streams;
+ * lengths are always counted in samples, not doubles.
+ * ------------------------------------------------------------------------ */
+
+typedef struct sp_fir sp_fir;
+
+sp_status sp_fir_create(const double* taps, size_t num_taps, int complex_samples, sp_fir** fir);
+sp_status sp_fir_create_lowpass(double cutoff_freq, int num_taps, int complex_samples, sp_fir** fir);
+sp_status sp_fir_process(sp_fir* fir, const double* input, size_t length, double* output);
+sp_status sp_fir_reset(sp_fir* fir);
+void sp_fir_destroy(sp_fir* fir);
+
+typedef struct sp_decimator sp_decimator;
+
+sp_status sp_decimator_create(int factor, const double* taps, size_t num_taps,
+                              int complex_samples, sp_decimator** decimator);
+sp_status sp_decimator_create_lowpass(int factor, int num_taps, int complex_samples,
+                                      sp_decimator** decimator);
+/* Upper bound on outputs for a block of `length` samples */
+size_t sp_decimator_max_output(const sp_decimator* decimator, size_t length);
+sp_status sp_decimator_process(sp_decimator* decimator, const double* input, size_t length,
+                               double* output, size_t capacity, size_t* produced);
+sp_status sp_decimator_reset(sp_decimator* decimator);
+void sp_decimator_destroy(sp_decimator* decimator);
+
+typedef struct sp_stft sp_stft;
+
+sp_status sp_stft_create(int frame_size, int hop_size, sp_stft** stft);
+size_t sp_stft_bins(const sp_stft* stft);
+size_t sp_stft_max_frames(const sp_stft* stft, size_t length);
+/* Output: frames x bins interleaved complex, row-major; capacity in frames */
+sp_status sp_stft_process(sp_stft* stft, const double* input, size_t length,
+                          double* output_iq, size_t capacity_frames, size_t* frames);
+sp_status sp_stft_reset(sp_stft* stft);
+void sp_stft_destroy(sp_stft* stft);
+
+typedef struct sp_nco sp_nco;
+
+sp_status sp_nco_create(double frequency, sp_nco** nco);
+sp_status sp_nco_set_frequency(sp_nco* nco, double frequency);
+sp_status sp_nco_process(sp_nco* nco, const double* input, size_t length, double* output_iq);
+sp_status sp_nco_process_iq(sp_nco* nco, const double* input_iq, size_t length, double* output_iq);
+sp_status sp_nco_generate(sp_nco* nco, size_t length, double* output_iq);
+sp_status sp_nco_get_phase(const sp_nco* nco, double* phase);
+sp_status sp_nco_set_phase(sp_nco* nco, double phase);
+void sp_nco_destroy(sp_nco* nco);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIGNAL_PROCESSOR_C_H */
@@ -0,0 +1,234 @@
+/**
+ * sp_batch - offline batch processor for recorded captures
+ *
+ * Runs the native processing chain (batch_processor.h) over any number of
+ * raw capture files, several files at a time, without Python in the loop:
+ *
+ *   sp_batch -f cs16 -r 2e6 --decimate 8 --fft 4096 -o results/ day1.cs16 day2.cs16
+ *
+ * One line per file is printed to stdout (tab-separated, in input order):
+ *
+ *   file  samples_in  samples_out  peak_hz  peak_db  seconds  msps
+ *
+ * Files are independent, so they are processed in parallel on an
+ * AsyncExecutor (one file per job); each job streams its file in blocks,
+ * keeping memory use per thread bounded by --block.
+ */
+
+#include "async_executor.h"
+#include "batch_processor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sp = signal_processor;
+namespace fs = std::filesystem;
+
+namespace {
+
+void print_usage(std::FILE* out) {
+    std::fprintf(out,
+        "Usage: sp_batch [options] FILE...\n"
+        "\n"
+        "FILE is a raw capture or a SigMF recording (.sigmf-meta / .sigmf-data),\n"
+        "whose metadata supplies the format and sample rate.\n"
+        "\n"
+        "Input:\n"
+        "  -f, --format FMT     f32 f64 s16 s8 cf32 cf64 cs16 cs8 (default cf32)\n"
+        "  -r, --rate HZ        Sample rate of the input files (default 1)\n"
+        "      --scale S        Integer-to-float scale (default: full scale = 1.0)\n"
+        "\n"
+        "Chain (every stage optional):\n"
+        "      --cutoff HZ      Low-pass cutoff\n"
+        "      --taps N         Filter length (default 101)\n"
+        "      --decimate M     Decimate by M (the low-pass becomes its anti-alias filter)\n"
+        "      --fft N          Welch PSD with N-point FFTs and peak detection\n"
+        "\n"
+        "Output:\n"
+        "  -o, --output-dir DIR Write <name>.f32/.cf32 (processed samples) and\n"
+        "                       <name>.psd.csv (with --fft) for every input\n"
+        "\n"
+        "Execution:\n"
+        "  -j, --threads N      Files processed in parallel (default: all cores)\n"
+        "      --block N        Samples per read (default 65536)\n"
+        "  -h, --help           Show this help\n");
+}
+
+// Numeric options parse strictly: trailing garbage is an error, not zero
+double parse_number(const std::string& option, const std::string& value) {
+    std::size_t used = 0;
+    double result = 0.0;
+    try {
+        result = std::stod(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) {
+        throw std::invalid_argument(option + ": expected a number, got '" + value + "'");
+    }
+    return result;
+}
+
+long parse_integer(const std::string& option, const std::string& value) {
+    double result = parse_number(option, value);
+    if (result != static_cast<double>(static_cast<long>(result))) {
+        throw std::invalid_argument(option + ": expected an integer, got '" + value + "'");
+    }
+    return static_cast<long>(result);
+}
+
+struct Options {
+    sp::BatchConfig config;
+    std::string output_dir;
+    std::size_t threads = 0;
+    std::vector<std::string> inputs;
+};
+
+Options parse_arguments(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + ": missing value");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(stdout);
+            std::exit(0);
+        } else if (arg == "-f" || arg == "--format") {
+            options.config.format = sp::parse_sample_format(value());
+        } else if (arg == "-r" || arg == "--rate") {
+            options.config.sample_rate = parse_number(arg, value());
+        } else if (arg == "--scale") {
+            options.config.scale = parse_number(arg, value());
+        } else if (arg == "--cutoff") {
+            options.config.cutoff_hz = parse_number(arg, value());
+        } else if (arg == "--taps") {
+            options.config.num_taps = static_cast<int>(parse_integer(arg, value()));
+        } else if (arg == "--decimate") {
+            options.config.decimation = static_cast<int>(parse_integer(arg, value()));
+        } else if (arg == "--fft") {
+            options.config.fft_size = static_cast<int>(parse_integer(arg, value()));
+        } else if (arg == "--block") {
+            long block = parse_integer(arg, value());
+            if (block <= 0) {
+                throw std::invalid_argument("--block must be positive");
+            }
+            options.config.block_size = static_cast<std::size_t>(block);
+        } else if (arg == "-o" || arg == "--output-dir") {
+            options.output_dir = value();
+        } else if (arg == "-j" || arg == "--threads") {
+            long threads = parse_integer(arg, value());
+            if (threads < 0) {
+                throw std::invalid_argument("--threads must not be negative");
+            }
+            options.threads = static_cast<std::size_t>(threads);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw std::invalid_argument("Unknown option " + arg);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.inputs.empty()) {
+        throw std::invalid_argument("No input files");
+    }
+    return options;
+}
+
+// Per-file configuration: output paths derive from the input's file name
+// (and, for SigMF, its metadata decides between real and complex output)
+sp::BatchConfig config_for(const Options& options, const std::string& input) {
+    sp::BatchConfig config = options.config;
+    if (!options.output_dir.empty()) {
+        fs::path stem = fs::path(options.output_dir) / fs::path(input).stem();
+        bool complex = sp::is_complex_format(config.format);
+        if (sp::MappedCapture::is_sigmf_path(input)) {
+            complex = sp::is_complex_format(sp::MappedCapture::open_sigmf(input).format());
+        }
+        config.samples_path = stem.string() + (complex ? ".cf32" : ".f32");
+        if (config.fft_size > 0) {
+            config.psd_path = stem.string() + ".psd.csv";
+        }
+    }
+    return config;
+}
+
+// Outputs are named after the input's stem alone, so two inputs with the
+// same stem (a/x.cs16, b/x.cf32) would overwrite each other's results
+void check_output_names(const Options& options) {
+    if (options.output_dir.empty()) {
+        return;
+    }
+    std::map<std::string, std::string> owners;
+    for (const auto& input : options.inputs) {
+        std::string stem = fs::path(input).stem().string();
+        auto [owner, added] = owners.emplace(stem, input);
+        if (!added) {
+            throw std::invalid_argument(owner->second + " and " + input + " would both write " +
+                                        (fs::path(options.output_dir) / stem).string() +
+                                        ".*; rename one or use separate --output-dir runs");
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_arguments(argc, argv);
+        check_output_names(options);
+        if (!options.output_dir.empty()) {
+            fs::create_directories(options.output_dir);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "sp_batch: %s\n\n", e.what());
+        print_usage(stderr);
+        return 2;
+    }
+
+    // One job per file. The queue is as deep as the file list so submission
+    // never blocks, and max_batch_jobs = 1 stops a worker from claiming
+    // several files at once while other workers sit idle.
+    sp::AsyncExecutor executor(options.threads, options.inputs.size(),
+                               /*batch_cost_limit=*/0, /*max_batch_jobs=*/1);
+    std::vector<std::future<sp::BatchResult>> results;
+    results.reserve(options.inputs.size());
+    for (const auto& input : options.inputs) {
+        results.push_back(executor.async([&options, input] {
+            return sp::process_file(input, config_for(options, input));
+        }));
+    }
+
+    std::printf("file\tsamples_in\tsamples_out\tpeak_hz\tpeak_db\tseconds\tmsps\n");
+    int failures = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        try {
+            sp::BatchResult r = results[i].get();
+            double msps = r.seconds > 0.0 ? r.samples_in / r.seconds / 1e6 : 0.0;
+            std::printf("%s\t%llu\t%llu\t", options.inputs[i].c_str(),
+                        static_cast<unsigned long long>(r.samples_in),
+                        static_cast<unsigned long long>(r.samples_out));
+            if (r.psd_frames > 0) {
+                std::printf("%.3f\t%.2f\t", r.peak_frequency, r.peak_power_db);
+            } else {
+                std::printf("-\t-\t");  // No PSD: --fft off or file shorter than a frame
+            }
+            std::printf("%.3f\t%.2f\n", r.seconds, msps);
+            std::fflush(stdout);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "sp_batch: %s\n", e.what());
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,609 @@
+/**
+ * sp_receiver_bench - end-to-end receiver throughput for capacity planning
+ *
+ * signal_processor_bench times each kernel alone, on data that stays in
+ * cache. A deployed receiver runs them back to back on a stream, one
+ * channel per core, all sharing memory bandwidth and the last-level cache.
+ * This tool runs that workload:
+ *
+ *   sc16 capture ─► convert ─► NCO ─► decimate ─► ... ─► IQ STFT ─► CA-CFAR
+ *
+ * over a synthetic multi-emitter capture (continuous carriers and bursty
+ * QPSK transmitters at random frequencies and SNRs, over a Gaussian noise
+ * floor, quantized to sc16). Each worker thread is one receiver channel
+ * tuned to a different emitter and loops over the shared capture.
+ *
+ * For each thread count it reports the sustained input rate:
+ *
+ *   threads  MS/s  MS/s/core  speedup  efficiency
+ *
+ * MS/s/core at 1 thread is the capacity of one core; efficiency below 1
+ * at higher counts is what shared caches, memory bandwidth and frequency
+ * scaling take away. A per-stage time breakdown of the single-thread run
+ * shows where the cycles go.
+ *
+ * Usage:
+ *   sp_receiver_bench                          # 1, 2, 4, ... all cores
+ *   sp_receiver_bench -j 1,8 --seconds 10 --pin
+ *   sp_receiver_bench --decimate 8,4 --fft 512 --json receiver.json
+ */
+
+#include "realtime.h"
+#include "sample_convert.h"
+#include "signal_processor.h"
+#include "stream_processors.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sp = signal_processor;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void print_usage(std::FILE* out) {
+    std::fprintf(out,
+        "Usage: sp_receiver_bench [options]\n"
+        "\n"
+        "Capture:\n"
+        "      --emitters K     Emitters in the synthetic capture (default 8)\n"
+        "      --samples N      Capture length in complex samples (default 2097152)\n"
+        "      --seed S         Random seed (default 1)\n"
+        "\n"
+        "Chain:\n"
+        "      --block N        Samples per block (default 16384)\n"
+        "      --decimate M,... Decimation stages (default 4,4)\n"
+        "      --taps N         Filter taps per decimation stage (default 63)\n"
+        "      --fft N          STFT frame size (default 256; hop is half)\n"
+        "      --guard N        CFAR guard cells per side (default 2)\n"
+        "      --train N        CFAR training cells per side (default 12)\n"
+        "      --pfa P          CFAR false-alarm probability per bin (default 1e-4)\n"
+        "\n"
+        "Measurement:\n"
+        "  -j, --threads N,...  Thread counts to measure (default 1, 2, 4, ... all cores)\n"
+        "      --seconds S      Measured time per thread count (default 3)\n"
+        "      --warmup S       Unmeasured time before each measurement (default 0.5)\n"
+        "      --pin            Pin worker i to CPU i\n"
+        "      --json FILE      Also write the results as JSON\n"
+        "  -h, --help           Show this help\n");
+}
+
+// Numeric options parse strictly: trailing garbage is an error, not zero
+double parse_number(const std::string& option, const std::string& value) {
+    std::size_t used = 0;
+    double result = 0.0;
+    try {
+        result = std::stod(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) {
+        throw std::invalid_argument(option + ": expected a number, got '" + value + "'");
+    }
+    return result;
+}
+
+long parse_positive(const std::string& option, const std::string& value) {
+    double result = parse_number(option, value);
+    if (result != static_cast<double>(static_cast<long>(result)) || result < 1) {
+        throw std::invalid_argument(option + ": expected a positive integer, got '" + value + "'");
+    }
+    return static_cast<long>(result);
+}
+
+std::vector<int> parse_list(const std::string& option, const std::string& value) {
+    std::vector<int> list;
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        std::size_t comma = value.find(',', start);
+        std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        list.push_back(static_cast<int>(parse_positive(option, item)));
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return list;
+}
+
+struct Options {
+    int emitters = 8;
+    std::size_t samples = 1 << 21;
+    unsigned seed = 1;
+    std::size_t block = 16384;
+    std::vector<int> decimation{4, 4};
+    int taps = 63;
+    int fft = 256;
+    int guard = 2;
+    int train = 12;
+    double pfa = 1e-4;
+    std::vector<int> threads;
+    double seconds = 3.0;
+    double warmup = 0.5;
+    bool pin = false;
+    std::string json;
+};
+
+Options parse_arguments(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + ": missing value");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(stdout);
+            std::exit(0);
+        } else if (arg == "--emitters") {
+            options.emitters = static_cast<int>(parse_positive(arg, value()));
+        } else if (arg == "--samples") {
+            options.samples = static_cast<std::size_t>(parse_positive(arg, value()));
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned>(parse_positive(arg, value()));
+        } else if (arg == "--block") {
+            options.block = static_cast<std::size_t>(parse_positive(arg, value()));
+        } else if (arg == "--decimate") {
+            options.decimation = parse_list(arg, value());
+        } else if (arg == "--taps") {
+            options.taps = static_cast<int>(parse_positive(arg, value()));
+        } else if (arg == "--fft") {
+            options.fft = static_cast<int>(parse_positive(arg, value()));
+        } else if (arg == "--guard") {
+            double guard = parse_number(arg, value());
+            if (guard < 0 || guard != std::floor(guard)) {
+                throw std::invalid_argument("--guard must be a non-negative integer");
+            }
+            options.guard = static_cast<int>(guard);
+        } else if (arg == "--train") {
+            options.train = static_cast<int>(parse_positive(arg, value()));
+        } else if (arg == "--pfa") {
+            options.pfa = parse_number(arg, value());
+        } else if (arg == "-j" || arg == "--threads") {
+            options.threads = parse_list(arg, value());
+        } else if (arg == "--seconds") {
+            options.seconds = parse_number(arg, value());
+            if (!(options.seconds > 0.0)) {
+                throw std::invalid_argument("--seconds must be positive");
+            }
+        } else if (arg == "--warmup") {
+            options.warmup = parse_number(arg, value());
+            if (options.warmup < 0.0) {
+                throw std::invalid_argument("--warmup must not be negative");
+            }
+        } else if (arg == "--pin") {
+            options.pin = true;
+        } else if (arg == "--json") {
+            options.json = value();
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (options.samples < options.block) {
+        throw std::invalid_argument("--samples must be at least one --block");
+    }
+    if (options.fft < 2) {
+        throw std::invalid_argument("--fft must be at least 2");
+    }
+    if (2 * (options.guard + options.train) + 1 > options.fft) {
+        throw std::invalid_argument("CFAR window (2 * (guard + train) + 1 = " +
+                                    std::to_string(2 * (options.guard + options.train) + 1) +
+                                    " bins) is wider than --fft " + std::to_string(options.fft));
+    }
+    if (options.threads.empty()) {
+        int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int t = 1; t < cores; t *= 2) {
+            options.threads.push_back(t);
+        }
+        options.threads.push_back(cores);
+    }
+    return options;
+}
+
+// ============================================================================
+// SYNTHETIC CAPTURE
+// ============================================================================
+
+struct Emitter {
+    double frequency;   // Cycles per sample
+    double snr_db;      // Per-sample SNR against the noise floor
+    bool bursty;        // QPSK bursts (30% duty) instead of a steady carrier
+};
+
+/**
+ * Emitters spread over ±0.45 of the band at 6-30 dB SNR; odd-numbered ones
+ * transmit QPSK bursts (8 samples per symbol, 4096-sample bursts). Scaled
+ * so the sum peaks well inside int16 range, then quantized to sc16.
+ */
+std::vector<std::int16_t> synthesize_capture(const Options& options, std::vector<Emitter>& emitters) {
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<double> frequency(-0.45, 0.45);
+    std::uniform_real_distribution<double> snr(6.0, 30.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+
+    emitters.clear();
+    for (int k = 0; k < options.emitters; ++k) {
+        emitters.push_back({frequency(rng), snr(rng), k % 2 == 1});
+    }
+
+    const std::size_t n = options.samples;
+    const double noise_sigma = std::sqrt(0.5);   // Unit noise power per complex sample
+    std::vector<std::complex<double>> signal(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        signal[i] = {noise_sigma * gaussian(rng), noise_sigma * gaussian(rng)};
+    }
+
+    constexpr std::size_t kSamplesPerSymbol = 8;
+    constexpr std::size_t kBurst = 4096;
+    for (const Emitter& emitter : emitters) {
+        const double amplitude = std::pow(10.0, emitter.snr_db / 20.0);
+        const std::complex<double> step = std::polar(1.0, 2.0 * M_PI * emitter.frequency);
+        std::complex<double> phasor = std::polar(1.0, 2.0 * M_PI * unit(rng));
+        std::complex<double> symbol(1.0, 0.0);
+        bool on = true;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (emitter.bursty) {
+                if (i % kBurst == 0) {
+                    on = unit(rng) < 0.3;
+                }
+                if (i % kSamplesPerSymbol == 0) {
+                    int quadrant = static_cast<int>(unit(rng) * 4.0) & 3;
+                    symbol = std::polar(1.0, M_PI / 4.0 + quadrant * M_PI / 2.0);
+                }
+            }
+            if (on) {
+                signal[i] += amplitude * phasor * symbol;
+            }
+            phasor *= step;
+        }
+    }
+
+    double peak = 0.0;
+    for (const auto& s : signal) {
+        peak = std::max({peak, std::abs(s.real()), std::abs(s.imag())});
+    }
+    std::vector<std::int16_t> capture(2 * n);
+    sp::encode_samples(reinterpret_cast<const double*>(signal.data()), 2 * n, capture.data(),
+                       sp::kScaleS16 * peak / 0.7);
+    return capture;
+}
+
+// ============================================================================
+// RECEIVER CHANNEL
+// ============================================================================
+
+enum Stage { kConvert, kNco, kDecimate, kStft, kCfar, kStages };
+const char* const kStageNames[kStages] = {"sc16 convert", "NCO mix", "decimation", "IQ STFT", "CA-CFAR"};
+
+// One receiver: the whole chain with its state and preallocated buffers
+class Channel {
+public:
+    Channel(const Options& options, double tune)
+        : block_(options.block),
+          nco_(-tune),
+          stft_(options.fft, options.fft / 2),
+          cfar_(options.guard, options.train, sp::CfarDetector::factor_for_pfa(options.train, options.pfa)),
+          iq_(options.block) {
+        std::size_t decimated = options.block;
+        for (int factor : options.decimation) {
+            decimators_.emplace_back(factor, options.taps);
+            decimated = decimators_.back().max_output(decimated);
+        }
+        // Worst case: frame_size - 1 samples still pending from the last block
+        std::size_t frame = stft_.bins();
+        std::size_t available = frame - 1 + decimated;
+        std::size_t frames = available < frame ? 0 : (available - frame) / stft_.hop_size() + 1;
+        spectrum_.resize(frames * stft_.bins());
+        power_.resize(spectrum_.size());
+    }
+
+    // One block of sc16 samples from `capture`; per-stage seconds are
+    // added to `stage_seconds` when it is not null
+    void process(const std::int16_t* capture, double* stage_seconds) {
+        Clock::time_point marks[kStages + 1];
+        auto mark = [&](int stage) {
+            if (stage_seconds != nullptr) {
+                marks[stage] = Clock::now();
+            }
+        };
+
+        mark(kConvert);
+        sp::convert_samples(capture, 2 * block_, reinterpret_cast<double*>(iq_.data()));
+        mark(kNco);
+        nco_.process(iq_.data(), block_, iq_.data());
+        mark(kDecimate);
+        std::size_t n = block_;
+        for (auto& decimator : decimators_) {
+            n = decimator.process(iq_.data(), n, iq_.data());
+        }
+        mark(kStft);
+        std::size_t frames = stft_.process(iq_.data(), n, spectrum_.data());
+        mark(kCfar);
+        std::size_t cells = frames * stft_.bins();
+        for (std::size_t i = 0; i < cells; ++i) {
+            power_[i] = std::norm(spectrum_[i]);
+        }
+        detections_.clear();
+        cfar_.detect(power_.data(), frames, stft_.bins(), detections_);
+        frames_ += frames;
+        detections_total_ += detections_.size();
+        mark(kStages);
+
+        if (stage_seconds != nullptr) {
+            for (int s = 0; s < kStages; ++s) {
+                stage_seconds[s] += std::chrono::duration<double>(marks[s + 1] - marks[s]).count();
+            }
+        }
+    }
+
+    std::uint64_t frames() const { return frames_; }
+    std::uint64_t detections() const { return detections_total_; }
+
+private:
+    std::size_t block_;
+    sp::Nco nco_;
+    std::vector<sp::Decimator<std::complex<double>>> decimators_;
+    sp::IqStft stft_;
+    sp::CfarDetector cfar_;
+    std::vector<std::complex<double>> iq_;
+    std::vector<std::complex<double>> spectrum_;
+    std::vector<double> power_;
+    std::vector<sp::CfarDetector::Detection> detections_;
+    std::uint64_t frames_ = 0;
+    std::uint64_t detections_total_ = 0;
+};
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+struct Result {
+    int threads = 0;
+    double seconds = 0.0;
+    std::uint64_t samples = 0;
+    double msps = 0.0;
+    std::vector<std::string> pin_failures;
+};
+
+struct Breakdown {
+    double stage_seconds[kStages] = {};
+    std::uint64_t frames = 0;
+    std::uint64_t detections = 0;
+};
+
+/**
+ * Run `threads` channels over the capture for options.seconds after a
+ * warm-up; only blocks finished inside the measured window count.
+ * With `breakdown`, the single channel also times each stage.
+ */
+Result measure(const Options& options, const std::vector<std::int16_t>& capture,
+               const std::vector<Emitter>& emitters, int threads, Breakdown* breakdown) {
+    const std::size_t blocks = capture.size() / 2 / options.block;
+    std::vector<std::uint64_t> samples(threads, 0);
+    std::vector<std::string> pin_errors(threads);
+    std::vector<std::exception_ptr> failures(threads);
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    Clock::time_point measure_start;
+    Clock::time_point measure_end;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            bool counted = false;
+            try {
+                if (options.pin) {
+                    pin_errors[t] = sp::pin_thread(sp::current_thread_handle(), t);
+                }
+                Channel channel(options, emitters[t % emitters.size()].frequency);
+                // Channels start at different points so they do not read the
+                // same cache lines in lockstep
+                std::size_t block = (static_cast<std::size_t>(t) * 7919) % blocks;
+                ready.fetch_add(1);
+                counted = true;
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+
+                double* stage_seconds = nullptr;
+                double warmup_stages[kStages] = {};
+                std::uint64_t count = 0;
+                for (;;) {
+                    Clock::time_point now = Clock::now();
+                    if (now >= measure_end) {
+                        break;
+                    }
+                    bool measured = now >= measure_start;
+                    if (breakdown != nullptr) {
+                        stage_seconds = measured ? breakdown->stage_seconds : warmup_stages;
+                    }
+                    channel.process(capture.data() + 2 * block * options.block, stage_seconds);
+                    if (measured && Clock::now() <= measure_end) {
+                        count += options.block;
+                    }
+                    block = (block + 1) % blocks;
+                }
+                samples[t] = count;
+                if (breakdown != nullptr) {
+                    breakdown->frames = channel.frames();
+                    breakdown->detections = channel.detections();
+                }
+            } catch (...) {
+                // Rethrown in the calling thread once every worker is joined
+                failures[t] = std::current_exception();
+                if (!counted) {
+                    ready.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    measure_start = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                       std::chrono::duration<double>(options.warmup));
+    measure_end = measure_start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(options.seconds));
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (const std::exception_ptr& failure : failures) {
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    Result result;
+    result.threads = threads;
+    result.seconds = options.seconds;
+    for (int t = 0; t < threads; ++t) {
+        result.samples += samples[t];
+        if (!pin_errors[t].empty()) {
+            result.pin_failures.push_back("thread " + std::to_string(t) + ": " + pin_errors[t]);
+        }
+    }
+    result.msps = static_cast<double>(result.samples) / options.seconds / 1e6;
+    return result;
+}
+
+std::string chain_description(const Options& options) {
+    std::string decimation;
+    int total = 1;
+    for (int factor : options.decimation) {
+        decimation += (decimation.empty() ? "" : "x") + std::to_string(factor);
+        total *= factor;
+    }
+    char text[256];
+    std::snprintf(text, sizeof(text),
+                  "sc16 -> NCO -> decimate %s (/%d, %d taps) -> IQ STFT %d/%d -> CA-CFAR (guard %d, train %d, Pfa %g)",
+                  decimation.c_str(), total, options.taps, options.fft, options.fft / 2, options.guard,
+                  options.train, options.pfa);
+    return text;
+}
+
+void write_json(const Options& options, const std::vector<Result>& results, const Breakdown& breakdown) {
+    std::ofstream out(options.json);
+    if (!out) {
+        throw std::runtime_error("Cannot write " + options.json);
+    }
+    double per_core = results.empty() ? 0.0 : results.front().msps / results.front().threads;
+    out << "{\n  \"chain\": \"" << chain_description(options) << "\",\n"
+        << "  \"emitters\": " << options.emitters << ",\n"
+        << "  \"block\": " << options.block << ",\n"
+        << "  \"stage_seconds\": {";
+    for (int s = 0; s < kStages; ++s) {
+        out << (s ? ", " : "") << "\"" << kStageNames[s] << "\": " << breakdown.stage_seconds[s];
+    }
+    out << "},\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double core = r.msps / r.threads;
+        out << "    {\"threads\": " << r.threads << ", \"samples\": " << r.samples
+            << ", \"seconds\": " << r.seconds << ", \"msps\": " << r.msps
+            << ", \"msps_per_core\": " << core
+            << ", \"efficiency\": " << (per_core > 0.0 ? core / per_core : 0.0) << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    if (!out.flush()) {
+        throw std::runtime_error("Cannot write " + options.json);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_arguments(argc, argv);
+        // Running one block through a channel validates the chain up front
+        Channel check(options, 0.0);
+        std::vector<std::int16_t> silence(2 * options.block, 0);
+        check.process(silence.data(), nullptr);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "sp_receiver_bench: %s\n\n", e.what());
+        print_usage(stderr);
+        return 2;
+    }
+
+    std::vector<Emitter> emitters;
+    std::vector<std::int16_t> capture = synthesize_capture(options, emitters);
+    std::printf("Capture: %zu sc16 samples, %d emitters\n", options.samples, options.emitters);
+    std::printf("Chain:   %s\n", chain_description(options).c_str());
+    std::printf("Block:   %zu samples; %.1f s per thread count after %.1f s warm-up\n\n", options.block,
+                options.seconds, options.warmup);
+
+    // The single-channel run is timed per stage as well; its clock reads
+    // cost well under 0.1% at the default block size
+    Breakdown breakdown;
+    std::vector<Result> results;
+    try {
+        for (int threads : options.threads) {
+            results.push_back(measure(options, capture, emitters, threads,
+                                      threads == 1 && results.empty() ? &breakdown : nullptr));
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "sp_receiver_bench: %s\n", e.what());
+        return 1;
+    }
+
+    double stage_total = 0.0;
+    for (double seconds : breakdown.stage_seconds) {
+        stage_total += seconds;
+    }
+    if (stage_total > 0.0) {
+        std::printf("Single-channel time per stage:\n");
+        for (int s = 0; s < kStages; ++s) {
+            std::printf("  %-14s %5.1f%%\n", kStageNames[s], 100.0 * breakdown.stage_seconds[s] / stage_total);
+        }
+        if (breakdown.frames > 0) {
+            std::printf("  (%.2f CFAR detections per STFT frame)\n",
+                        static_cast<double>(breakdown.detections) / breakdown.frames);
+        }
+        std::printf("\n");
+    }
+
+    // Efficiency is relative to the first row's per-core rate
+    double base = results.front().msps / results.front().threads;
+    std::printf("threads\tMS/s\tMS/s/core\tspeedup\tefficiency\n");
+    for (const Result& r : results) {
+        double core = r.msps / r.threads;
+        std::printf("%d\t%.2f\t%.2f\t\t%.2fx\t%.0f%%\n", r.threads, r.msps, core,
+                    base > 0.0 ? r.msps / base : 0.0, base > 0.0 ? 100.0 * core / base : 0.0);
+        for (const std::string& failure : r.pin_failures) {
+            std::fprintf(stderr, "sp_receiver_bench: pinning failed, %s\n", failure.c_str());
+        }
+    }
+    if (static_cast<unsigned>(options.threads.back()) > std::thread::hardware_concurrency()) {
+        std::fprintf(stderr, "sp_receiver_bench: more threads than cores; per-core figures are not meaningful\n");
+    }
+
+    if (!options.json.empty()) {
+        try {
+            write_json(options, results, breakdown);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "sp_receiver_bench: %s\n", e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
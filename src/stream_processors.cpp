@@ -0,0 +1,445 @@
+#include "stream_processors.h"
+#include "signal_processor.h"
+#include "fftw_planner.h"
+#include "instrumentation.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <fftw3.h>
+
+namespace signal_processor {
+
+namespace {
+
+std::vector<double> reversed(const std::vector<double>& taps) {
+    return std::vector<double>(taps.rbegin(), taps.rend());
+}
+
+// One causal FIR output: Σ reversed_taps[k] * window[k]
+template <typename Sample>
+inline Sample dot(const double* reversed_taps, const Sample* window, std::size_t num_taps) {
+    Sample sum = Sample(0);
+    for (std::size_t k = 0; k < num_taps; ++k) {
+        sum += window[k] * reversed_taps[k];
+    }
+    return sum;
+}
+
+} // namespace
+
+// ============================================================================
+// STREAMING FIR
+// ============================================================================
+
+template <typename Sample>
+StreamingFir<Sample>::StreamingFir(std::vector<double> taps)
+    : taps_(std::move(taps)) {
+    if (taps_.empty()) {
+        throw std::invalid_argument("StreamingFir needs at least one tap");
+    }
+    reversed_taps_ = reversed(taps_);
+    reset();
+}
+
+template <typename Sample>
+void StreamingFir<Sample>::process(const Sample* input, std::size_t length, Sample* output) {
+    /**
+     * Work buffer layout:  [ history (taps-1) | new block (length) ]
+     *
+     * Output i is the dot product of the taps with buffer_[i .. i+taps-1],
+     * which always lies entirely inside the buffer - no edge checks in the
+     * inner loop. Afterwards the last (taps-1) samples become the history
+     * for the next block.
+     */
+    SP_INSTRUMENT("streaming_fir", length);
+    SP_TRACE("streaming_fir");
+
+    const std::size_t num_taps = taps_.size();
+    const std::size_t history = num_taps - 1;
+
+    buffer_.resize(history + length);
+    std::copy(input, input + length, buffer_.begin() + history);
+
+    for (std::size_t i = 0; i < length; ++i) {
+        output[i] = dot(reversed_taps_.data(), buffer_.data() + i, num_taps);
+    }
+
+    std::copy(buffer_.end() - history, buffer_.end(), buffer_.begin());
+    buffer_.resize(history);
+}
+
+template <typename Sample>
+void StreamingFir<Sample>::reset() {
+    buffer_.assign(taps_.size() - 1, Sample(0));
+}
+
+template <typename Sample>
+std::vector<Sample> StreamingFir<Sample>::snapshot() const {
+    return std::vector<Sample>(buffer_.begin(), buffer_.begin() + (taps_.size() - 1));
+}
+
+template <typename Sample>
+void StreamingFir<Sample>::restore(const std::vector<Sample>& history) {
+    if (history.size() != taps_.size() - 1) {
+        throw std::invalid_argument("StreamingFir history must hold taps - 1 samples");
+    }
+    buffer_ = history;
+}
+
+// ============================================================================
+// DECIMATOR
+// ============================================================================
+
+template <typename Sample>
+Decimator<Sample>::Decimator(int factor, std::vector<double> taps)
+    : factor_(factor), taps_(std::move(taps)) {
+    if (factor_ < 1) {
+        throw std::invalid_argument("Decimation factor must be >= 1");
+    }
+    if (taps_.empty()) {
+        throw std::invalid_argument("Decimator needs at least one tap");
+    }
+    reversed_taps_ = reversed(taps_);
+    reset();
+}
+
+template <typename Sample>
+Decimator<Sample>::Decimator(int factor, int num_taps)
+    : Decimator(factor, design_lowpass_filter(0.4 / std::max(factor, 1), num_taps)) {}
+
+template <typename Sample>
+std::size_t Decimator<Sample>::max_output(std::size_t length) const {
+    return (length + factor_ - 1) / factor_;
+}
+
+template <typename Sample>
+std::size_t Decimator<Sample>::process(const Sample* input, std::size_t length, Sample* output) {
+    /**
+     * Same buffer layout as StreamingFir, but outputs are only computed at
+     * new-sample positions phase_, phase_ + M, phase_ + 2M, ... The phase
+     * left over after the block carries the M-sample rhythm into the next
+     * one.
+     */
+    SP_INSTRUMENT("decimator", length);
+    SP_TRACE("decimator");
+
+    const std::size_t num_taps = taps_.size();
+    const std::size_t history = num_taps - 1;
+    const std::size_t step = static_cast<std::size_t>(factor_);
+
+    buffer_.resize(history + length);
+    std::copy(input, input + length, buffer_.begin() + history);
+
+    std::size_t produced = 0;
+    std::size_t i = static_cast<std::size_t>(phase_);
+    for (; i < length; i += step) {
+        output[produced++] = dot(reversed_taps_.data(), buffer_.data() + i, num_taps);
+    }
+    phase_ = static_cast<int>(i - length);
+
+    std::copy(buffer_.end() - history, buffer_.end(), buffer_.begin());
+    buffer_.resize(history);
+    return produced;
+}
+
+template <typename Sample>
+void Decimator<Sample>::reset() {
+    buffer_.assign(taps_.size() - 1, Sample(0));
+    phase_ = 0;
+}
+
+template <typename Sample>
+typename Decimator<Sample>::State Decimator<Sample>::snapshot() const {
+    State state;
+    state.history.assign(buffer_.begin(), buffer_.begin() + (taps_.size() - 1));
+    state.phase = phase_;
+    return state;
+}
+
+template <typename Sample>
+void Decimator<Sample>::restore(const State& state) {
+    if (state.history.size() != taps_.size() - 1) {
+        throw std::invalid_argument("Decimator history must hold taps - 1 samples");
+    }
+    if (state.phase < 0 || state.phase >= factor_) {
+        throw std::invalid_argument("Decimator phase must be in [0, factor)");
+    }
+    buffer_ = state.history;
+    phase_ = state.phase;
+}
+
+template class StreamingFir<double>;
+template class StreamingFir<std::complex<double>>;
+template class Decimator<double>;
+template class Decimator<std::complex<double>>;
+
+// ============================================================================
+// STFT
+// ============================================================================
+
+Stft::Stft(int frame_size, int hop_size)
+    : frame_size_(frame_size), hop_size_(hop_size) {
+    if (frame_size_ < 2 || hop_size_ < 1 || hop_size_ > frame_size_) {
+        throw std::invalid_argument("STFT needs frame_size >= 2 and 1 <= hop_size <= frame_size");
+    }
+
+    // Periodic Hann window: 0.5 - 0.5 * cos(2πn/N)
+    window_.resize(frame_size_);
+    for (int n = 0; n < frame_size_; ++n) {
+        window_[n] = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / frame_size_);
+    }
+
+    // Pooled (64-byte aligned, as FFTW's SIMD codelets prefer), so
+    // short-lived Stft objects reuse each other's buffers
+    fft_in_ = PooledBuffer<double>(default_buffer_pool(), frame_size_);
+    fft_out_ = PooledBuffer<std::complex<double>>(default_buffer_pool(), bins());
+
+    // Planned once with FFTW_MEASURE: slower to create, faster for every
+    // frame after. MEASURE scribbles over the buffers, which are not yet in use.
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+    plan_ = fftw_plan_dft_r2c_1d(frame_size_, fft_in_.data(),
+                                 reinterpret_cast<fftw_complex*>(fft_out_.data()), FFTW_MEASURE);
+}
+
+Stft::~Stft() {
+    {
+        std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+        fftw_destroy_plan(plan_);
+    }
+}
+
+std::size_t Stft::max_frames(std::size_t length) const {
+    std::size_t available = pending_.size() - pending_start_ + length;
+    if (available < static_cast<std::size_t>(frame_size_)) {
+        return 0;
+    }
+    return (available - frame_size_) / hop_size_ + 1;
+}
+
+std::size_t Stft::process(const double* input, std::size_t length, std::complex<double>* output) {
+    SP_INSTRUMENT("stft", length);
+    SP_TRACE("stft");
+    pending_.insert(pending_.end(), input, input + length);
+
+    const std::size_t frame = static_cast<std::size_t>(frame_size_);
+    const std::size_t num_bins = bins();
+    std::size_t frames = 0;
+
+    while (pending_.size() - pending_start_ >= frame) {
+        const double* start = pending_.data() + pending_start_;
+        for (std::size_t n = 0; n < frame; ++n) {
+            fft_in_[n] = start[n] * window_[n];
+        }
+        fftw_execute(plan_);
+        std::copy(fft_out_.begin(), fft_out_.begin() + num_bins, output + frames * num_bins);
+
+        ++frames;
+        pending_start_ += hop_size_;
+    }
+
+    // Compact once per block rather than once per frame
+    pending_.erase(pending_.begin(), pending_.begin() + pending_start_);
+    pending_start_ = 0;
+    return frames;
+}
+
+void Stft::reset() {
+    pending_.clear();
+    pending_start_ = 0;
+}
+
+std::vector<double> Stft::snapshot() const {
+    return std::vector<double>(pending_.begin() + pending_start_, pending_.end());
+}
+
+void Stft::restore(const std::vector<double>& pending) {
+    if (pending.size() >= static_cast<std::size_t>(frame_size_)) {
+        throw std::invalid_argument("STFT state must hold fewer than frame_size samples");
+    }
+    pending_ = pending;
+    pending_start_ = 0;
+}
+
+// ============================================================================
+// IQ STFT
+// ============================================================================
+
+IqStft::IqStft(int frame_size, int hop_size)
+    : frame_size_(frame_size), hop_size_(hop_size) {
+    if (frame_size_ < 2 || hop_size_ < 1 || hop_size_ > frame_size_) {
+        throw std::invalid_argument("STFT needs frame_size >= 2 and 1 <= hop_size <= frame_size");
+    }
+
+    window_.resize(frame_size_);
+    for (int n = 0; n < frame_size_; ++n) {
+        window_[n] = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / frame_size_);
+    }
+
+    fft_in_ = PooledBuffer<std::complex<double>>(default_buffer_pool(), frame_size_);
+    fft_out_ = PooledBuffer<std::complex<double>>(default_buffer_pool(), frame_size_);
+
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+    plan_ = fftw_plan_dft_1d(frame_size_, reinterpret_cast<fftw_complex*>(fft_in_.data()),
+                             reinterpret_cast<fftw_complex*>(fft_out_.data()), FFTW_FORWARD, FFTW_MEASURE);
+}
+
+IqStft::~IqStft() {
+    std::lock_guard<std::mutex> lock(fftw_planner_mutex());
+    fftw_destroy_plan(plan_);
+}
+
+std::size_t IqStft::max_frames(std::size_t length) const {
+    std::size_t available = pending_.size() + length;
+    if (available < static_cast<std::size_t>(frame_size_)) {
+        return 0;
+    }
+    return (available - frame_size_) / hop_size_ + 1;
+}
+
+std::size_t IqStft::process(const std::complex<double>* input, std::size_t length,
+                            std::complex<double>* output) {
+    SP_INSTRUMENT("iq_stft", length);
+    SP_TRACE("iq_stft");
+    pending_.insert(pending_.end(), input, input + length);
+
+    const std::size_t frame = static_cast<std::size_t>(frame_size_);
+    std::size_t start = 0;
+    std::size_t frames = 0;
+    while (pending_.size() - start >= frame) {
+        for (std::size_t n = 0; n < frame; ++n) {
+            fft_in_[n] = pending_[start + n] * window_[n];
+        }
+        fftw_execute(plan_);
+        std::copy(fft_out_.begin(), fft_out_.begin() + frame, output + frames * frame);
+        ++frames;
+        start += hop_size_;
+    }
+
+    pending_.erase(pending_.begin(), pending_.begin() + start);
+    return frames;
+}
+
+void IqStft::reset() {
+    pending_.clear();
+}
+
+void IqStft::restore(const std::vector<std::complex<double>>& pending) {
+    if (pending.size() >= static_cast<std::size_t>(frame_size_)) {
+        throw std::invalid_argument("STFT state must hold fewer than frame_size samples");
+    }
+    pending_ = pending;
+}
+
+// ============================================================================
+// CA-CFAR
+// ============================================================================
+
+CfarDetector::CfarDetector(int guard_cells, int training_cells, double factor)
+    : guard_cells_(guard_cells), training_cells_(training_cells), factor_(factor) {
+    if (training_cells_ < 1 || guard_cells_ < 0) {
+        throw std::invalid_argument("CFAR needs training_cells >= 1 and guard_cells >= 0");
+    }
+    if (!(factor_ > 0.0)) {
+        throw std::invalid_argument("CFAR threshold factor must be positive");
+    }
+}
+
+double CfarDetector::factor_for_pfa(int training_cells, double pfa) {
+    if (training_cells < 1 || !(pfa > 0.0 && pfa < 1.0)) {
+        throw std::invalid_argument("CFAR needs training_cells >= 1 and 0 < pfa < 1");
+    }
+    const double n = 2.0 * training_cells;
+    return n * (std::pow(pfa, -1.0 / n) - 1.0);
+}
+
+std::size_t CfarDetector::detect(const double* power, std::size_t frames, std::size_t bins,
+                                 std::vector<Detection>& detections) {
+    SP_INSTRUMENT("cfar", frames * bins);
+    SP_TRACE("cfar");
+    const std::size_t guard = static_cast<std::size_t>(guard_cells_);
+    const std::size_t train = static_cast<std::size_t>(training_cells_);
+    const std::size_t half = guard + train;   // Window cells on each side of the CUT
+    if (frames > 0 && bins < 2 * half + 1) {
+        throw std::invalid_argument("CFAR window (" + std::to_string(2 * half + 1) +
+                                    " cells) is wider than the frame (" + std::to_string(bins) + " bins)");
+    }
+
+    // prefix_[j] = sum of the first j cells of the frame extended by `half`
+    // wrapped cells on each side, so every window sum is two lookups
+    prefix_.resize(bins + 2 * half + 1);
+    const double scale = factor_ / (2.0 * static_cast<double>(train));
+    const std::size_t before = detections.size();
+
+    for (std::size_t f = 0; f < frames; ++f) {
+        const double* cells = power + f * bins;
+        double sum = 0.0;
+        std::size_t j = 0;
+        prefix_[0] = 0.0;
+        for (std::size_t i = bins - half; i < bins; ++i) {
+            prefix_[++j] = sum += cells[i];
+        }
+        for (std::size_t i = 0; i < bins; ++i) {
+            prefix_[++j] = sum += cells[i];
+        }
+        for (std::size_t i = 0; i < half; ++i) {
+            prefix_[++j] = sum += cells[i];
+        }
+        for (std::size_t k = 0; k < bins; ++k) {
+            // Extended index of the CUT is k + half
+            double leading = prefix_[k + train] - prefix_[k];
+            double trailing = prefix_[k + 2 * half + 1] - prefix_[k + half + guard + 1];
+            double threshold = (leading + trailing) * scale;
+            if (cells[k] > threshold) {
+                detections.push_back({frames_seen_ + f, k, cells[k], threshold / factor_});
+            }
+        }
+    }
+    frames_seen_ += frames;
+    return detections.size() - before;
+}
+
+// ============================================================================
+// NCO
+// ============================================================================
+
+Nco::Nco(double frequency)
+    : frequency_(frequency) {}
+
+void Nco::restore(double phase) {
+    phase_ = phase - std::floor(phase);
+}
+
+template <typename Input>
+void Nco::mix(const Input* input, std::size_t length, std::complex<double>* output) {
+    SP_INSTRUMENT("nco", length);
+    SP_TRACE("nco");
+    const std::complex<double> step = std::polar(1.0, 2.0 * M_PI * frequency_);
+    std::complex<double> phasor = std::polar(1.0, 2.0 * M_PI * phase_);
+
+    for (std::size_t n = 0; n < length; ++n) {
+        output[n] = input[n] * phasor;
+        phasor *= step;
+    }
+
+    // Exact phase for the next block (wrapped to [0, 1))
+    double next = phase_ + frequency_ * static_cast<double>(length);
+    phase_ = next - std::floor(next);
+}
+
+void Nco::process(const double* input, std::size_t length, std::complex<double>* output) {
+    mix(input, length, output);
+}
+
+void Nco::process(const std::complex<double>* input, std::size_t length,
+                  std::complex<double>* output) {
+    mix(input, length, output);
+}
+
+void Nco::generate(std::size_t length, std::complex<double>* output) {
+    std::fill(output, output + length, std::complex<double>(1.0, 0.0));
+    mix(output, length, output);
+}
+
+} // namespace signal_processor
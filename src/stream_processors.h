@@ -0,0 +1,342 @@
+#ifndef STREAM_PROCESSORS_H
+#define STREAM_PROCESSORS_H
+
+#include "buffer_pool.h"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// FFTW's opaque plan type, declared here so this header does not require
+// the FFTW headers (fftw_plan is `struct fftw_plan_s*`)
+struct fftw_plan_s;
+
+/**
+ * Stateful Streaming Processors
+ *
+ * The free functions in signal_processor.h treat every call as a complete
+ * signal: they redesign the filter, re-plan the FFT and zero-pad the edges
+ * each time. A receiver, however, sees one endless stream delivered in
+ * blocks. The classes here keep whatever must survive between blocks
+ * (filter history, decimation phase, partial STFT frames, oscillator
+ * phase), so that:
+ *
+ * 1. Setup (filter design, FFT planning) happens once, in the constructor
+ * 2. Filtering a stream block by block gives exactly the same output as
+ *    filtering it in one piece - no edge artifacts at block boundaries
+ * 3. process() writes into a caller-provided buffer and does not allocate
+ *    once the internal work buffers have grown to the block size
+ *
+ * Every processor supports reset() (back to the freshly-constructed state)
+ * and snapshot()/restore() (save state, e.g. to checkpoint or to replay a
+ * block with different parameters).
+ *
+ * Thread safety: an instance must not be used by two threads at once;
+ * separate instances are fully independent.
+ */
+
+namespace signal_processor {
+
+/**
+ * Streaming FIR filter
+ *
+ * Causal direct-form FIR: output[n] = Σ taps[k] * input[n - k], with the
+ * last (taps - 1) input samples carried over from the previous block.
+ * Unlike apply_lowpass_filter() (which centers the filter), the output is
+ * delayed by (taps - 1) / 2 samples - the unavoidable latency of a causal
+ * linear-phase filter.
+ *
+ * Sample may be double (real signals) or std::complex<double> (baseband IQ).
+ */
+template <typename Sample>
+class StreamingFir {
+public:
+    explicit StreamingFir(std::vector<double> taps);
+
+    /**
+     * Filter one block
+     *
+     * @param input `length` new samples
+     * @param output Receives `length` filtered samples (may be `input`
+     *               itself for in-place filtering)
+     */
+    void process(const Sample* input, std::size_t length, Sample* output);
+
+    void reset();
+
+    // State = the last (taps - 1) input samples
+    std::vector<Sample> snapshot() const;
+    void restore(const std::vector<Sample>& history);
+
+    const std::vector<double>& taps() const { return taps_; }
+
+private:
+    std::vector<double> taps_;
+    std::vector<double> reversed_taps_;  // Reversed so the MAC walks forward
+    std::vector<Sample> buffer_;         // History followed by the current block
+};
+
+/**
+ * Decimating FIR filter (anti-alias low-pass + downsample by `factor`)
+ *
+ * Only every factor-th output is computed, so the cost per input sample is
+ * taps / factor multiply-accumulates. The position of the next output
+ * within the stream ("phase") is kept across blocks, so any block size
+ * works - not only multiples of the factor.
+ */
+template <typename Sample>
+class Decimator {
+public:
+    /**
+     * @param factor Downsampling factor (>= 1)
+     * @param taps Anti-alias filter; should cut off below 0.5 / factor
+     */
+    Decimator(int factor, std::vector<double> taps);
+
+    /**
+     * Convenience: designs a num_taps low-pass at 0.4 / factor
+     */
+    Decimator(int factor, int num_taps);
+
+    /**
+     * Largest number of outputs process() can produce for `length` inputs
+     */
+    std::size_t max_output(std::size_t length) const;
+
+    /**
+     * Filter and downsample one block
+     *
+     * @param output Must have room for max_output(length) samples;
+     *               may be `input` itself
+     * @return Number of output samples written
+     */
+    std::size_t process(const Sample* input, std::size_t length, Sample* output);
+
+    void reset();
+
+    struct State {
+        std::vector<Sample> history;  // Last (taps - 1) inputs
+        int phase = 0;                // New samples to skip before the next output
+    };
+    State snapshot() const;
+    void restore(const State& state);
+
+    int factor() const { return factor_; }
+    const std::vector<double>& taps() const { return taps_; }
+
+private:
+    int factor_;
+    int phase_ = 0;
+    std::vector<double> taps_;
+    std::vector<double> reversed_taps_;
+    std::vector<Sample> buffer_;
+};
+
+/**
+ * Short-Time Fourier Transform over a real stream
+ *
+ * Splits the stream into Hann-windowed frames of `frame_size` samples
+ * taken every `hop_size` samples and transforms each with a persistent
+ * FFTW plan (FFTW_MEASURE - planned once, reused for every frame).
+ * Samples that do not yet complete a frame are held until the next block.
+ */
+class Stft {
+public:
+    Stft(int frame_size, int hop_size);
+    ~Stft();
+
+    Stft(const Stft&) = delete;
+    Stft& operator=(const Stft&) = delete;
+
+    // Complex bins per frame (frame_size / 2 + 1)
+    std::size_t bins() const { return static_cast<std::size_t>(frame_size_ / 2 + 1); }
+
+    // Frames process() will emit once `length` more samples arrive
+    std::size_t max_frames(std::size_t length) const;
+
+    /**
+     * Consume a block, emitting every frame it completes
+     *
+     * @param output Row-major frames x bins() array with room for
+     *               max_frames(length) frames
+     * @return Number of frames written
+     */
+    std::size_t process(const double* input, std::size_t length, std::complex<double>* output);
+
+    void reset();
+
+    // State = samples received but not yet consumed by a hop
+    std::vector<double> snapshot() const;
+    void restore(const std::vector<double>& pending);
+
+    int frame_size() const { return frame_size_; }
+    int hop_size() const { return hop_size_; }
+
+private:
+    int frame_size_;
+    int hop_size_;
+    std::vector<double> window_;
+    std::vector<double> pending_;
+    std::size_t pending_start_ = 0;             // First unconsumed sample (only non-zero inside process())
+    PooledBuffer<double> fft_in_;                 // frame_size samples
+    PooledBuffer<std::complex<double>> fft_out_;  // bins() bins
+    fftw_plan_s* plan_ = nullptr;
+};
+
+/**
+ * Short-Time Fourier Transform over a complex (IQ) stream
+ *
+ * Stft for baseband: positive and negative frequencies are distinct, so
+ * each Hann-windowed frame gives frame_size bins from a complex-to-complex
+ * FFT (bin k < frame_size / 2 is +k, the rest wrap to negative
+ * frequencies, as in numpy.fft.fft).
+ */
+class IqStft {
+public:
+    IqStft(int frame_size, int hop_size);
+    ~IqStft();
+
+    IqStft(const IqStft&) = delete;
+    IqStft& operator=(const IqStft&) = delete;
+
+    std::size_t bins() const { return static_cast<std::size_t>(frame_size_); }
+
+    // Frames process() will emit once `length` more samples arrive
+    std::size_t max_frames(std::size_t length) const;
+
+    /**
+     * Consume a block, emitting every frame it completes
+     *
+     * @param output Row-major frames x bins() array with room for
+     *               max_frames(length) frames
+     * @return Number of frames written
+     */
+    std::size_t process(const std::complex<double>* input, std::size_t length,
+                        std::complex<double>* output);
+
+    void reset();
+
+    // State = samples received but not yet consumed by a hop
+    std::vector<std::complex<double>> snapshot() const { return pending_; }
+    void restore(const std::vector<std::complex<double>>& pending);
+
+    int frame_size() const { return frame_size_; }
+    int hop_size() const { return hop_size_; }
+
+private:
+    int frame_size_;
+    int hop_size_;
+    std::vector<double> window_;
+    std::vector<std::complex<double>> pending_;
+    PooledBuffer<std::complex<double>> fft_in_;
+    PooledBuffer<std::complex<double>> fft_out_;
+    fftw_plan_s* plan_ = nullptr;
+};
+
+/**
+ * Cell-Averaging CFAR detector
+ *
+ * A fixed power threshold either misses weak emitters or floods with false
+ * alarms as the noise floor moves. CA-CFAR compares each bin with the mean
+ * of the `training_cells` bins on either side of it - skipping
+ * `guard_cells` next to it, where the signal's own leakage sits - so the
+ * threshold follows the local noise floor:
+ *
+ *   [train ... train][guard][ CUT ][guard][train ... train]
+ *
+ *   detection: power[cut] > factor * mean(train)
+ *
+ * For exponentially distributed noise power (|complex Gaussian|²) a factor
+ * of N·(Pfa^(-1/N) - 1), N = 2·training_cells, gives a false-alarm
+ * probability of Pfa per bin (factor_for_pfa()). Windows wrap around the
+ * frame, as FFT bins do.
+ */
+class CfarDetector {
+public:
+    struct Detection {
+        std::size_t frame;
+        std::size_t bin;
+        double power;
+        double noise;   // Mean power of the training cells
+    };
+
+    /**
+     * @throws std::invalid_argument if training_cells < 1, guard_cells < 0
+     *         or factor <= 0
+     */
+    CfarDetector(int guard_cells, int training_cells, double factor);
+
+    // Threshold factor giving a per-bin false-alarm probability of `pfa`
+    static double factor_for_pfa(int training_cells, double pfa);
+
+    /**
+     * Detect in `frames` consecutive frames of `bins` power values
+     *
+     * Appends to `detections` (frame numbers count on from earlier calls)
+     * and returns how many were added.
+     *
+     * @throws std::invalid_argument if a frame is narrower than the window
+     */
+    std::size_t detect(const double* power, std::size_t frames, std::size_t bins,
+                       std::vector<Detection>& detections);
+
+    void reset() { frames_seen_ = 0; }
+
+    int guard_cells() const { return guard_cells_; }
+    int training_cells() const { return training_cells_; }
+    double factor() const { return factor_; }
+
+private:
+    int guard_cells_;
+    int training_cells_;
+    double factor_;
+    std::size_t frames_seen_ = 0;
+    std::vector<double> prefix_;   // Running sums over one frame plus its wrap
+};
+
+/**
+ * Numerically Controlled Oscillator (digital mixer)
+ *
+ * Multiplies the stream by e^(j·2π·f·n) with a phase that continues
+ * seamlessly from block to block. Used to shift a signal of interest to
+ * 0 Hz ahead of decimation (f negative to shift down).
+ *
+ * Implementation: a unit phasor is rotated by a fixed step per sample
+ * (one complex multiply instead of sin + cos) and the exact phase is
+ * recomputed at every block boundary, so rounding error never accumulates
+ * beyond a single block.
+ */
+class Nco {
+public:
+    /**
+     * @param frequency Normalized frequency in cycles per sample (-0.5 to 0.5)
+     */
+    explicit Nco(double frequency);
+
+    void set_frequency(double frequency) { frequency_ = frequency; }
+    double frequency() const { return frequency_; }
+
+    // Mix a real or complex block: output[n] = input[n] * e^(j·phase[n])
+    void process(const double* input, std::size_t length, std::complex<double>* output);
+    void process(const std::complex<double>* input, std::size_t length,
+                 std::complex<double>* output);
+
+    // Emit the oscillator itself (a complex tone)
+    void generate(std::size_t length, std::complex<double>* output);
+
+    void reset() { phase_ = 0.0; }
+
+    // State = phase in cycles, [0, 1)
+    double snapshot() const { return phase_; }
+    void restore(double phase);
+
+private:
+    template <typename Input>
+    void mix(const Input* input, std::size_t length, std::complex<double>* output);
+
+    double frequency_;
+    double phase_ = 0.0;
+};
+
+} // namespace signal_processor
+
+#endif // STREAM_PROCESSORS_H
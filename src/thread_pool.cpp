@@ -0,0 +1,229 @@
+#include "thread_pool.h"
+#include <exception>
+
+namespace signal_processor {
+
+namespace {
+
+// Which pool (if any) the current thread works for, and as which worker
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_index = -1;
+
+} // namespace
+
+// ============================================================================
+// LIFECYCLE
+// ============================================================================
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+int ThreadPool::current_worker() const {
+    return current_pool == this ? current_index : -1;
+}
+
+RealtimeReport ThreadPool::set_realtime(const RealtimeConfig& config) {
+    validate_realtime_priority(config.priority);
+    RealtimeReport report;
+    if (config.lock_memory) {
+        std::string error = lock_process_memory();
+        report.memory_locked = error.empty();
+        if (!error.empty()) {
+            report.failures.push_back(error);
+        }
+    }
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+        std::thread::native_handle_type handle = workers_[i].native_handle();
+        std::string who = "worker " + std::to_string(i) + ": ";
+        if (i < config.cpus.size() && config.cpus[i] >= 0) {
+            std::string error = pin_thread(handle, config.cpus[i]);
+            if (!error.empty()) {
+                report.failures.push_back(who + error);
+            }
+        }
+        std::string error = set_fifo_priority(handle, config.priority);
+        if (!error.empty()) {
+            report.failures.push_back(who + error);
+        }
+    }
+    return report;
+}
+
+ThreadPoolStats ThreadPool::stats() const {
+    ThreadPoolStats result;
+    result.num_threads = size();
+    result.tasks_executed = tasks_executed_.load(std::memory_order_relaxed);
+    result.tasks_stolen = tasks_stolen_.load(std::memory_order_relaxed);
+    return result;
+}
+
+// ============================================================================
+// QUEUEING
+// ============================================================================
+
+void ThreadPool::push(Task task, std::size_t worker) {
+    WorkerQueue& queue = *queues_[worker % size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+}
+
+void ThreadPool::wake(bool all) {
+    // Taking the lock orders the queued_ update before a sleeper's check
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    if (all) {
+        wake_.notify_all();
+    } else {
+        wake_.notify_one();
+    }
+}
+
+void ThreadPool::submit(Task task, int affinity) {
+    std::size_t worker;
+    if (affinity >= 0) {
+        worker = static_cast<std::size_t>(affinity);
+    } else if (current_worker() >= 0) {
+        worker = static_cast<std::size_t>(current_worker());
+    } else {
+        worker = next_worker_.fetch_add(1, std::memory_order_relaxed);
+    }
+    push(std::move(task), worker);
+    wake(false);
+}
+
+/**
+ * Run one queued task: the newest from our own deque, else the oldest from
+ * the first non-empty deque after ours. `self` = -1 for non-worker threads.
+ */
+bool ThreadPool::try_run_one(int self) {
+    if (queued_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    Task task;
+    bool stolen = false;
+    if (self >= 0) {
+        WorkerQueue& own = *queues_[static_cast<std::size_t>(self)];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    if (!task) {
+        std::size_t start = self >= 0 ? static_cast<std::size_t>(self) + 1 : 0;
+        for (std::size_t k = 0; k < size() && !task; ++k) {
+            WorkerQueue& victim = *queues_[(start + k) % size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                stolen = self >= 0 && &victim != queues_[static_cast<std::size_t>(self)].get();
+            }
+        }
+    }
+    if (!task) {
+        return false;
+    }
+
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    if (stolen) {
+        tasks_stolen_.fetch_add(1, std::memory_order_relaxed);
+    }
+    task();
+    tasks_executed_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ThreadPool::worker_loop(std::size_t index) {
+    current_pool = this;
+    current_index = static_cast<int>(index);
+
+    for (;;) {
+        if (try_run_one(current_index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] {
+            return stopping_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        // Drain everything before exiting
+        if (stopping_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// FORK-JOIN
+// ============================================================================
+
+void ThreadPool::run_and_wait(std::vector<Task>& tasks) {
+    struct Group {
+        std::atomic<std::size_t> remaining;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    } group;
+    group.remaining.store(tasks.size(), std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        push([&group, &task = tasks[i]] {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(group.error_mutex);
+                if (!group.error) {
+                    group.error = std::current_exception();
+                }
+            }
+            group.remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }, i);
+    }
+    wake(true);
+
+    // Help instead of blocking: this keeps nested parallel loops from
+    // deadlocking and puts the calling core to work
+    int self = current_worker();
+    Backoff backoff;
+    while (group.remaining.load(std::memory_order_acquire) > 0) {
+        if (try_run_one(self)) {
+            backoff = Backoff();
+        } else {
+            backoff.pause();
+        }
+    }
+
+    if (group.error) {
+        std::rethrow_exception(group.error);
+    }
+}
+
+ThreadPool& default_thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+} // namespace signal_processor
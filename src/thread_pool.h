@@ -0,0 +1,164 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "realtime.h"
+#include "ring_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-Stealing Thread Pool
+ *
+ * Filtering 64 channels is 64 independent jobs, but rarely 64 equal ones:
+ * channels differ in length, and a one-queue pool either hands out work
+ * one lock round-trip at a time or leaves cores idle at the end while the
+ * last long channel finishes. ThreadPool gives every worker its own deque:
+ *
+ * 1. A worker pushes and pops at the back of its own deque (LIFO: the task
+ *    it just created is the one whose data is still in cache)
+ * 2. A worker whose deque is empty steals from the front of another's
+ *    (FIFO: the oldest, typically largest remaining piece of work), so
+ *    nobody idles while work is left anywhere
+ * 3. Tasks can carry an affinity hint - the worker whose deque they start
+ *    on. parallel_batch() places item i on worker i % size(), so repeated
+ *    batches over the same channels tend to land on the same core
+ * 4. The thread that calls parallel_for() runs tasks too while it waits,
+ *    so parallel loops may be nested (a task may itself call parallel_for)
+ *
+ * set_realtime() pins the workers, raises them to SCHED_FIFO and locks the
+ * process's memory (see realtime.h) for bounded worst-case latency.
+ *
+ * Unlike AsyncExecutor (fire-and-forget jobs behind a bounded queue), this
+ * pool is for fork-join parallelism: split, run everywhere, wait.
+ *
+ *   ThreadPool& pool = default_thread_pool();
+ *   pool.parallel_batch(channels.size(), [&](std::size_t ch) {
+ *       outputs[ch] = apply_lowpass_filter(channels[ch], 0.1, 101);
+ *   });
+ */
+
+namespace signal_processor {
+
+struct ThreadPoolStats {
+    std::size_t num_threads = 0;
+    std::uint64_t tasks_executed = 0;   // By workers and helping callers
+    std::uint64_t tasks_stolen = 0;     // Taken from another worker's deque
+};
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // num_threads = 0: std::thread::hardware_concurrency()
+    explicit ThreadPool(std::size_t num_threads = 0);
+
+    // Runs every queued task, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return queues_.size(); }
+
+    /**
+     * Queue a fire-and-forget task
+     *
+     * @param task Must not throw (exceptions terminate the program; use
+     *             parallel_for to get them back)
+     * @param affinity Worker to queue on; -1 = the calling worker, or
+     *                 round-robin from other threads
+     */
+    void submit(Task task, int affinity = -1);
+
+    /**
+     * Call fn(lo, hi) over [begin, end) split into chunks of `grain`
+     * indices and wait for all of them
+     *
+     * Chunk i starts on worker i % size(). The calling thread helps.
+     *
+     * @throws the first exception thrown by `fn` (the other chunks still run)
+     */
+    template <typename Fn>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, Fn&& fn) {
+        if (end <= begin) {
+            return;
+        }
+        grain = grain == 0 ? 1 : grain;
+        std::size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1) {
+            fn(begin, end);
+            return;
+        }
+        std::vector<Task> tasks;
+        tasks.reserve(chunks);
+        for (std::size_t lo = begin; lo < end; lo += grain) {
+            std::size_t hi = lo + std::min(grain, end - lo);
+            tasks.emplace_back([&fn, lo, hi] { fn(lo, hi); });
+        }
+        run_and_wait(tasks);
+    }
+
+    // Call fn(i) for every i in [0, count), one task each; waits
+    template <typename Fn>
+    void parallel_batch(std::size_t count, Fn&& fn) {
+        parallel_for(0, count, 1, [&fn](std::size_t lo, std::size_t) { fn(lo); });
+    }
+
+    ThreadPoolStats stats() const;
+
+    /**
+     * Apply real-time settings to the workers: worker i is pinned to
+     * config.cpus[i] and every worker runs at config.priority
+     *
+     * Refused settings are reported, not thrown; the pool keeps working.
+     *
+     * @throws std::invalid_argument if the priority is outside 0-99
+     */
+    RealtimeReport set_realtime(const RealtimeConfig& config);
+
+    // Index of the calling thread among this pool's workers, -1 if it is not one
+    int current_worker() const;
+
+private:
+    struct alignas(kCacheLine) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task, std::size_t worker);
+    void wake(bool all);
+    bool try_run_one(int self);
+    void run_and_wait(std::vector<Task>& tasks);
+    void worker_loop(std::size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<std::size_t> queued_{0};        // Tasks sitting in any deque
+    std::atomic<std::size_t> next_worker_{0};   // Round-robin for submit()
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+
+    std::atomic<std::uint64_t> tasks_executed_{0};
+    std::atomic<std::uint64_t> tasks_stolen_{0};
+};
+
+/**
+ * Process-wide pool (hardware_concurrency() workers), created on first use;
+ * used by the *_batch() functions when no pool is passed
+ */
+ThreadPool& default_thread_pool();
+
+} // namespace signal_processor
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,252 @@
+#include "trace.h"
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace signal_processor {
+
+namespace detail {
+std::atomic<bool> tracing_active{false};
+} // namespace detail
+
+namespace {
+
+// Counter samples are stored as events with this duration
+constexpr std::uint64_t kCounterEvent = ~std::uint64_t{0};
+
+struct TraceEvent {
+    const char* name;
+    std::uint64_t start_ns;
+    std::uint64_t duration_ns;   // kCounterEvent for counter samples
+    std::int64_t value;          // Block sequence (spans) or counter value
+};
+
+// One thread's ring of events. Only the owning thread writes; `written`
+// (release) publishes each event to the dump
+struct ThreadTrace {
+    std::unique_ptr<TraceEvent[]> events;
+    std::size_t capacity = 0;
+    std::atomic<std::uint64_t> written{0};
+    std::uint64_t generation = 0;
+    std::uint32_t tid = 0;
+    std::string name;
+};
+
+struct Tracer {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTrace>> threads;   // Kept after their thread exits
+    std::unordered_set<std::string> names;               // Interned; nodes never move
+    std::atomic<std::uint64_t> generation{1};            // Bumped by start/clear: new buffers
+    std::size_t capacity = 1 << 16;
+    std::uint64_t origin_ns = 0;
+    std::uint32_t next_tid = 1;
+};
+
+// Never destroyed: threads may still record during static destruction
+Tracer& tracer() {
+    static Tracer* instance = new Tracer();
+    return *instance;
+}
+
+thread_local std::shared_ptr<ThreadTrace> thread_trace;
+thread_local std::string thread_trace_name;
+
+// The calling thread's buffer for the current trace, created on first use
+ThreadTrace& current_thread_trace() {
+    Tracer& t = tracer();
+    ThreadTrace* trace = thread_trace.get();
+    if (trace != nullptr && trace->generation == t.generation.load(std::memory_order_acquire)) {
+        return *trace;
+    }
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto fresh = std::make_shared<ThreadTrace>();
+    fresh->capacity = t.capacity;
+    fresh->events = std::make_unique<TraceEvent[]>(t.capacity);
+    fresh->generation = t.generation.load(std::memory_order_relaxed);
+    fresh->tid = t.next_tid++;
+    fresh->name = thread_trace_name;
+    t.threads.push_back(fresh);
+    thread_trace = std::move(fresh);
+    return *thread_trace;
+}
+
+void append(const TraceEvent& event) {
+    ThreadTrace& trace = current_thread_trace();
+    std::uint64_t index = trace.written.load(std::memory_order_relaxed);
+    trace.events[index % trace.capacity] = event;
+    trace.written.store(index + 1, std::memory_order_release);
+}
+
+void append_json_string(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        auto byte = static_cast<unsigned char>(*c);
+        if (byte == '"' || byte == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (byte < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+            out += escaped;
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+int process_id() {
+#ifdef __linux__
+    return static_cast<int>(::getpid());
+#else
+    return 1;
+#endif
+}
+
+} // namespace
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+namespace detail {
+
+std::uint64_t trace_now_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+}
+
+void trace_span(const char* name, std::uint64_t start_ns, std::uint64_t end_ns, std::int64_t sequence) {
+    append({name, start_ns, end_ns - start_ns, sequence});
+}
+
+void trace_counter(const char* name, std::int64_t value) {
+    append({name, trace_now_ns(), kCounterEvent, value});
+}
+
+} // namespace detail
+
+void start_tracing(std::size_t events_per_thread) {
+    if (events_per_thread == 0) {
+        throw std::invalid_argument("Trace buffers need room for at least one event");
+    }
+    Tracer& t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.threads.clear();
+    t.capacity = events_per_thread;
+    t.origin_ns = detail::trace_now_ns();
+    t.generation.fetch_add(1, std::memory_order_release);
+    detail::tracing_active.store(true, std::memory_order_relaxed);
+}
+
+void stop_tracing() {
+    detail::tracing_active.store(false, std::memory_order_relaxed);
+}
+
+void clear_trace() {
+    Tracer& t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.threads.clear();
+    t.origin_ns = detail::trace_now_ns();
+    t.generation.fetch_add(1, std::memory_order_release);
+}
+
+void set_trace_thread_name(const std::string& name) {
+    thread_trace_name = name;
+    Tracer& t = tracer();
+    if (thread_trace && thread_trace->generation == t.generation.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        thread_trace->name = name;
+    }
+}
+
+const char* intern_trace_name(const std::string& name) {
+    Tracer& t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.names.insert(name).first->c_str();
+}
+
+// ============================================================================
+// EXPORT
+// ============================================================================
+
+std::string trace_json() {
+    Tracer& t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    const int pid = process_id();
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    char number[160];
+    auto begin_event = [&] {
+        out += first ? "\n" : ",\n";
+        first = false;
+    };
+    // Nanoseconds since the trace started, as Chrome's microsecond timestamps
+    auto micros = [&](std::uint64_t ns) {
+        return static_cast<double>(static_cast<std::int64_t>(ns - t.origin_ns)) / 1000.0;
+    };
+
+    for (const auto& thread : t.threads) {
+        if (!thread->name.empty()) {
+            begin_event();
+            std::snprintf(number, sizeof(number),
+                          "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%" PRIu32 ",\"args\":{\"name\":",
+                          pid, thread->tid);
+            out += number;
+            append_json_string(out, thread->name.c_str());
+            out += "}}";
+        }
+
+        std::uint64_t written = thread->written.load(std::memory_order_acquire);
+        std::uint64_t oldest = written > thread->capacity ? written - thread->capacity : 0;
+        for (std::uint64_t i = oldest; i < written; ++i) {
+            const TraceEvent& event = thread->events[i % thread->capacity];
+            begin_event();
+            out += "{\"name\":";
+            append_json_string(out, event.name);
+            if (event.duration_ns == kCounterEvent) {
+                std::snprintf(number, sizeof(number),
+                              ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%" PRIu32 ",\"args\":{\"value\":%" PRId64
+                              "}}",
+                              micros(event.start_ns), pid, thread->tid, event.value);
+            } else if (event.value != kNoTraceSequence) {
+                std::snprintf(number, sizeof(number),
+                              ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%" PRIu32
+                              ",\"args\":{\"sequence\":%" PRId64 "}}",
+                              micros(event.start_ns), static_cast<double>(event.duration_ns) / 1000.0, pid,
+                              thread->tid, event.value);
+            } else {
+                std::snprintf(number, sizeof(number),
+                              ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%" PRIu32 "}",
+                              micros(event.start_ns), static_cast<double>(event.duration_ns) / 1000.0, pid,
+                              thread->tid);
+            }
+            out += number;
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+void write_trace(const std::string& path) {
+    std::string json = trace_json();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(json.data(), static_cast<std::streamsize>(json.size())) || !file.flush()) {
+        throw std::runtime_error("Cannot write trace file " + path + ": " + std::strerror(errno));
+    }
+}
+
+} // namespace signal_processor
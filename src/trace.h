@@ -0,0 +1,123 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Pipeline Timeline Tracing
+ *
+ * Counters and histograms (instrumentation.h) say that a stage was slow
+ * once; a timeline says when, on which thread, what every other stage was
+ * doing at the time and how full the queues were. The tracer records:
+ *
+ *   spans     begin/duration of each scoped call (TraceScope), with the
+ *             block sequence number where there is one
+ *   counters  sampled values over time, e.g. flowgraph queue depths
+ *
+ * and writes them as Chrome trace JSON, which ui.perfetto.dev (or
+ * chrome://tracing) shows as one track per thread plus one per counter.
+ *
+ * Each thread appends to its own fixed-size event buffer - no lock, no
+ * allocation after the first event - and the oldest events are
+ * overwritten once it is full, so a long run keeps its most recent
+ * window. While tracing is stopped a TraceScope costs one relaxed atomic
+ * load and a branch, so the scopes stay compiled into every build.
+ *
+ *   start_tracing();
+ *   graph.run();
+ *   stop_tracing();
+ *   write_trace("pipeline.json");   // open in ui.perfetto.dev
+ *
+ * Dump after stop_tracing(): a dump taken while threads are still
+ * recording is best-effort (events being overwritten may be torn).
+ */
+
+namespace signal_processor {
+
+namespace detail {
+extern std::atomic<bool> tracing_active;
+std::uint64_t trace_now_ns();
+void trace_span(const char* name, std::uint64_t start_ns, std::uint64_t end_ns, std::int64_t sequence);
+void trace_counter(const char* name, std::int64_t value);
+} // namespace detail
+
+// Sequence argument meaning "no block sequence"
+constexpr std::int64_t kNoTraceSequence = -1;
+
+/**
+ * Start recording on every thread (discarding any earlier trace)
+ *
+ * @param events_per_thread Ring capacity of each thread's buffer (32 bytes per event)
+ * @throws std::invalid_argument if events_per_thread is 0
+ */
+void start_tracing(std::size_t events_per_thread = 1 << 16);
+
+// Stop recording; the events stay available for trace_json()/write_trace()
+void stop_tracing();
+
+inline bool tracing_enabled() {
+    return detail::tracing_active.load(std::memory_order_relaxed);
+}
+
+// Drop every recorded event
+void clear_trace();
+
+// Events recorded so far, as a Chrome trace JSON document
+std::string trace_json();
+
+// trace_json() into `path`; throws std::runtime_error if it cannot be written
+void write_trace(const std::string& path);
+
+// Label for the calling thread's track (kept until clear_trace())
+void set_trace_thread_name(const std::string& name);
+
+/**
+ * A name that stays valid for the rest of the process, for trace events
+ * whose names are built at run time (event names are stored as pointers)
+ */
+const char* intern_trace_name(const std::string& name);
+
+// One sample of counter `name` (a string literal or interned name)
+inline void trace_counter(const char* name, std::int64_t value) {
+    if (tracing_enabled()) {
+        detail::trace_counter(name, value);
+    }
+}
+
+// Records its own lifetime as a span named `name` (a string literal or interned name)
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, std::int64_t sequence = kNoTraceSequence)
+        : name_(name), sequence_(sequence),
+          start_(tracing_enabled() ? detail::trace_now_ns() : kInactive) {}
+
+    ~TraceScope() {
+        if (start_ != kInactive) {
+            detail::trace_span(name_, start_, detail::trace_now_ns(), sequence_);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    static constexpr std::uint64_t kInactive = ~std::uint64_t{0};
+
+    const char* name_;
+    std::int64_t sequence_;
+    std::uint64_t start_;
+};
+
+#define SP_TRACE_CONCAT_(a, b) a##b
+#define SP_TRACE_CONCAT(a, b) SP_TRACE_CONCAT_(a, b)
+
+// Trace the rest of the enclosing scope as a span named `name` (a literal)
+#define SP_TRACE(name) ::signal_processor::TraceScope SP_TRACE_CONCAT(sp_trace_, __LINE__)(name)
+
+} // namespace signal_processor
+
+#endif // TRACE_H
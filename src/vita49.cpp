@@ -0,0 +1,642 @@
+#include "vita49.h"
+#include "sample_convert.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace signal_processor {
+
+namespace {
+
+std::uint32_t load_be32(const std::uint8_t* p) {
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) |
+           std::uint32_t(p[3]);
+}
+
+void store_be32(std::uint32_t value, std::vector<std::uint8_t>& out) {
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+constexpr bool kLittleEndianHost = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+/**
+ * Swap each sample component between network and host byte order, in
+ * place (a no-op for int8 and on big-endian hosts). Payloads start on a
+ * 4-byte boundary of the slot, so the casts are aligned; the loops
+ * vectorize to byte shuffles.
+ */
+void swap_components(std::uint8_t* data, std::size_t bytes, SampleFormat format) {
+    if (!kLittleEndianHost) {
+        return;
+    }
+    if (format == SampleFormat::CS16) {
+        auto* values = reinterpret_cast<std::uint16_t*>(data);
+        for (std::size_t i = 0; i < bytes / 2; ++i) {
+            values[i] = __builtin_bswap16(values[i]);
+        }
+    } else if (format == SampleFormat::CF32) {
+        auto* values = reinterpret_cast<std::uint32_t*>(data);
+        for (std::size_t i = 0; i < bytes / 4; ++i) {
+            values[i] = __builtin_bswap32(values[i]);
+        }
+    }
+}
+
+void check_payload_format(SampleFormat format) {
+    if (format != SampleFormat::CS16 && format != SampleFormat::CS8 && format != SampleFormat::CF32) {
+        throw std::invalid_argument("VITA-49 payload format must be cs16, cs8 or cf32");
+    }
+}
+
+#ifdef __linux__
+sockaddr_in ipv4_address(const std::string& address, std::uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        throw std::invalid_argument("Not an IPv4 address: '" + address + "'");
+    }
+    return addr;
+}
+
+int udp_socket() {
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Cannot open UDP socket: ") + std::strerror(errno));
+    }
+    return fd;
+}
+#endif
+
+} // namespace
+
+// ============================================================================
+// PACKETS
+// ============================================================================
+
+bool parse_vita49(const std::uint8_t* data, std::size_t bytes, Vita49Packet& packet) {
+    /**
+     * Header word: type(31-28) C(27) T(26) -(25-24) TSI(23-22) TSF(21-20)
+     * count(19-16) size in 32-bit words(15-0); then, when present, stream
+     * ID, 2-word class ID, integer timestamp, 2-word fractional timestamp,
+     * payload and (data packets only) a trailer word.
+     */
+    if (bytes < 4) {
+        return false;
+    }
+    const std::uint32_t header = load_be32(data);
+    const unsigned type = header >> 28;
+    if (type > static_cast<unsigned>(Vita49PacketType::ExtensionContext)) {
+        return false;
+    }
+    packet.type = static_cast<Vita49PacketType>(type);
+    packet.has_class_id = (header >> 27) & 1;
+    packet.has_trailer = packet.is_data() && ((header >> 26) & 1);
+    packet.tsi = static_cast<Vita49Tsi>((header >> 22) & 3);
+    packet.tsf = static_cast<Vita49Tsf>((header >> 20) & 3);
+    packet.packet_count = static_cast<std::uint8_t>((header >> 16) & 0xF);
+    const std::size_t size = std::size_t(header & 0xFFFF) * 4;
+    if (size < 4 || size > bytes) {
+        return false;
+    }
+
+    std::size_t position = 4;
+    const std::size_t trailer_bytes = packet.has_trailer ? 4 : 0;
+    const std::size_t fields = (packet.has_stream_id() ? 4 : 0) + (packet.has_class_id ? 8 : 0) +
+                               (packet.tsi != Vita49Tsi::None ? 4 : 0) +
+                               (packet.tsf != Vita49Tsf::None ? 8 : 0);
+    if (position + fields + trailer_bytes > size) {
+        return false;
+    }
+    packet.stream_id = 0;
+    if (packet.has_stream_id()) {
+        packet.stream_id = load_be32(data + position);
+        position += 4;
+    }
+    packet.class_id = 0;
+    if (packet.has_class_id) {
+        packet.class_id = (std::uint64_t(load_be32(data + position)) << 32) | load_be32(data + position + 4);
+        position += 8;
+    }
+    packet.integer_timestamp = 0;
+    if (packet.tsi != Vita49Tsi::None) {
+        packet.integer_timestamp = load_be32(data + position);
+        position += 4;
+    }
+    packet.fractional_timestamp = 0;
+    if (packet.tsf != Vita49Tsf::None) {
+        packet.fractional_timestamp = (std::uint64_t(load_be32(data + position)) << 32) |
+                                      load_be32(data + position + 4);
+        position += 8;
+    }
+    packet.trailer = packet.has_trailer ? load_be32(data + size - 4) : 0;
+    packet.payload = data + position;
+    packet.payload_bytes = static_cast<std::uint32_t>(size - position - trailer_bytes);
+    packet.lost_packets = 0;
+    packet.lost_samples = 0;
+    return true;
+}
+
+void encode_vita49(const Vita49Packet& packet, const void* payload, std::vector<std::uint8_t>& out) {
+    if (packet.payload_bytes % 4 != 0) {
+        throw std::invalid_argument("VITA-49 payload must be a whole number of 32-bit words");
+    }
+    const bool trailer = packet.is_data() && packet.has_trailer;
+    const std::size_t words = 1 + (packet.has_stream_id() ? 1 : 0) + (packet.has_class_id ? 2 : 0) +
+                              (packet.tsi != Vita49Tsi::None ? 1 : 0) +
+                              (packet.tsf != Vita49Tsf::None ? 2 : 0) + packet.payload_bytes / 4 +
+                              (trailer ? 1 : 0);
+    if (words > 0xFFFF) {
+        throw std::invalid_argument("VITA-49 packet exceeds 65535 words");
+    }
+    out.reserve(out.size() + words * 4);
+    store_be32((std::uint32_t(packet.type) << 28) | (std::uint32_t(packet.has_class_id) << 27) |
+               (std::uint32_t(trailer) << 26) |
+               (std::uint32_t(packet.tsi) << 22) | (std::uint32_t(packet.tsf) << 20) |
+               (std::uint32_t(packet.packet_count & 0xF) << 16) | std::uint32_t(words),
+               out);
+    if (packet.has_stream_id()) {
+        store_be32(packet.stream_id, out);
+    }
+    if (packet.has_class_id) {
+        store_be32(static_cast<std::uint32_t>(packet.class_id >> 32), out);
+        store_be32(static_cast<std::uint32_t>(packet.class_id), out);
+    }
+    if (packet.tsi != Vita49Tsi::None) {
+        store_be32(packet.integer_timestamp, out);
+    }
+    if (packet.tsf != Vita49Tsf::None) {
+        store_be32(static_cast<std::uint32_t>(packet.fractional_timestamp >> 32), out);
+        store_be32(static_cast<std::uint32_t>(packet.fractional_timestamp), out);
+    }
+    const auto* bytes = static_cast<const std::uint8_t*>(payload);
+    out.insert(out.end(), bytes, bytes + packet.payload_bytes);
+    if (trailer) {
+        store_be32(packet.trailer, out);
+    }
+}
+
+// ============================================================================
+// RECEIVER
+// ============================================================================
+
+#ifdef __linux__
+
+struct Vita49Receiver::Batch {
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+};
+
+Vita49Receiver::Vita49Receiver(const Vita49Config& config)
+    : config_(config), ring_(config.ring_packets) {
+    check_payload_format(config_.format);
+    if (config_.batch == 0 || config_.max_packet_bytes < 4) {
+        throw std::invalid_argument("VITA-49 batch and max_packet_bytes must be positive");
+    }
+    sample_size_ = sample_format_size(config_.format);
+    // Cache-line aligned slots: payloads start 4-byte aligned and
+    // neighbouring slots never share a line
+    slot_bytes_ = (config_.max_packet_bytes + kCacheLine - 1) / kCacheLine * kCacheLine;
+    slots_ = MappedMemory(ring_.capacity() * slot_bytes_, config_.memory);
+
+    std::size_t batch = std::min(config_.batch, ring_.capacity());
+    batch_ = std::make_unique<Batch>();
+    batch_->messages.resize(batch);
+    batch_->vectors.resize(batch);
+
+    sockaddr_in addr = ipv4_address(config_.address, config_.port);
+    socket_ = udp_socket();
+    int reuse = 1;
+    ::setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    // A large socket buffer rides out scheduling hiccups of the receive
+    // thread; SO_RCVBUFFORCE exceeds rmem_max where permitted
+    int buffer = config_.socket_buffer_bytes;
+    if (::setsockopt(socket_, SOL_SOCKET, SO_RCVBUFFORCE, &buffer, sizeof(buffer)) != 0) {
+        ::setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+    if (::bind(socket_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int error = errno;
+        ::close(socket_);
+        throw std::runtime_error("Cannot bind UDP " + config_.address + ":" + std::to_string(config_.port) +
+                                 ": " + std::strerror(error));
+    }
+    socklen_t length = sizeof(addr);
+    ::getsockname(socket_, reinterpret_cast<sockaddr*>(&addr), &length);
+    port_ = ntohs(addr.sin_port);
+}
+
+Vita49Receiver::~Vita49Receiver() {
+    stop();
+    if (socket_ >= 0) {
+        ::close(socket_);
+    }
+}
+
+std::size_t Vita49Receiver::receive(double timeout_seconds) {
+    if (running()) {
+        throw std::runtime_error("receive() called while the receive thread is running");
+    }
+    if (ring_.reserve(1).empty()) {
+        ring_full_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    return receive_batch(timeout_seconds);
+}
+
+std::size_t Vita49Receiver::receive_batch(double timeout_seconds) {
+    RingSpan<Vita49Packet> free = ring_.reserve(batch_->messages.size());
+    if (free.empty()) {
+        return 0;
+    }
+    if (timeout_seconds != 0.0) {
+        pollfd poll_fd{socket_, POLLIN, 0};
+        int ms = timeout_seconds < 0.0 ? -1 : static_cast<int>(std::ceil(timeout_seconds * 1000.0));
+        int ready = ::poll(&poll_fd, 1, ms);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            return 0;
+        }
+        if (ready < 0) {
+            throw std::runtime_error(std::string("poll() on VITA-49 socket failed: ") + std::strerror(errno));
+        }
+    }
+
+    mmsghdr* messages = batch_->messages.data();
+    iovec* vectors = batch_->vectors.data();
+    for (std::size_t i = 0; i < free.count; ++i) {
+        vectors[i].iov_base = slot(free.position + i);
+        vectors[i].iov_len = slot_bytes_;
+        messages[i].msg_hdr = {};
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int received = ::recvmmsg(socket_, messages, static_cast<unsigned>(free.count), MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error(std::string("recvmmsg() on VITA-49 socket failed: ") + std::strerror(errno));
+    }
+    receive_calls_.fetch_add(1, std::memory_order_relaxed);
+
+    // Descriptor k must point into slot k: when a datagram is skipped, the
+    // ones after it move down a slot (rare - context or bad packets)
+    std::size_t kept = 0;
+    std::uint64_t payload = 0;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(received); ++i) {
+        std::uint8_t* data = slot(free.position + kept);
+        const std::size_t bytes = messages[i].msg_len;
+        if (kept != i) {
+            std::memcpy(data, slot(free.position + i), bytes);
+        }
+        Vita49Packet& packet = free.data[kept];
+        if ((messages[i].msg_hdr.msg_flags & MSG_TRUNC) || !parse_vita49(data, bytes, packet) ||
+            (packet.is_data() && packet.payload_bytes % sample_size_ != 0)) {
+            malformed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (!packet.is_data()) {
+            context_packets_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (config_.big_endian) {
+            swap_components(const_cast<std::uint8_t*>(packet.payload), packet.payload_bytes, config_.format);
+        }
+        packet.sample_size = static_cast<std::uint32_t>(sample_size_);
+        track_loss(packet);
+        payload += packet.payload_bytes;
+        ++kept;
+    }
+    ring_.commit(kept);
+    packets_.fetch_add(kept, std::memory_order_relaxed);
+    payload_bytes_.fetch_add(payload, std::memory_order_relaxed);
+    return static_cast<std::size_t>(received);
+}
+
+void Vita49Receiver::track_loss(Vita49Packet& packet) {
+    StreamState* state = last_stream_;
+    if (state == nullptr || packet.stream_id != last_stream_id_) {
+        auto [it, inserted] = streams_.try_emplace(packet.stream_id);
+        state = &it->second;    // Map nodes never move, so the cache stays valid
+        last_stream_ = state;
+        last_stream_id_ = packet.stream_id;
+        if (inserted) {
+            stream_count_.store(streams_.size(), std::memory_order_relaxed);
+            state->last_count = static_cast<std::uint8_t>(packet.packet_count - 1);
+        }
+    }
+
+    packet.lost_packets = (packet.packet_count - state->last_count - 1) & 0xF;
+    state->last_count = packet.packet_count;
+
+    // Sample-count timestamps restart every integer second when a TSI is
+    // present, so only compare within the same second
+    const bool sample_count = packet.tsf == Vita49Tsf::SampleCount;
+    if (sample_count && state->timestamp_valid && packet.integer_timestamp == state->integer_timestamp &&
+        packet.fractional_timestamp > state->next_timestamp) {
+        packet.lost_samples = packet.fractional_timestamp - state->next_timestamp;
+    }
+    state->timestamp_valid = sample_count;
+    state->integer_timestamp = packet.integer_timestamp;
+    state->next_timestamp = packet.fractional_timestamp + packet.sample_count();
+
+    if (packet.lost_packets != 0) {
+        lost_packets_.fetch_add(packet.lost_packets, std::memory_order_relaxed);
+    }
+    if (packet.lost_samples != 0) {
+        lost_samples_.fetch_add(packet.lost_samples, std::memory_order_relaxed);
+    }
+}
+
+void Vita49Receiver::start() {
+    if (running()) {
+        return;
+    }
+    if (ring_.closed()) {
+        throw std::runtime_error("A stopped VITA-49 receiver cannot be restarted");
+    }
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] { run(); });
+}
+
+void Vita49Receiver::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+        ring_.close();
+    }
+}
+
+void Vita49Receiver::run() {
+    Backoff backoff;
+    bool full = false;
+    while (running_.load(std::memory_order_acquire)) {
+        if (ring_.reserve(1).empty()) {
+            // Consumer behind: leave the datagrams to the socket buffer
+            if (!full) {
+                ring_full_.fetch_add(1, std::memory_order_relaxed);
+                full = true;
+            }
+            backoff.pause();
+            continue;
+        }
+        if (full) {
+            full = false;
+            backoff = Backoff();
+        }
+        // Short poll timeout so stop() is noticed promptly
+        receive_batch(0.05);
+    }
+}
+
+#else
+
+struct Vita49Receiver::Batch {};
+
+Vita49Receiver::Vita49Receiver(const Vita49Config& config) : config_(config), ring_(config.ring_packets) {
+    throw std::runtime_error("VITA-49 ingest needs Linux (recvmmsg)");
+}
+Vita49Receiver::~Vita49Receiver() = default;
+std::size_t Vita49Receiver::receive(double) { return 0; }
+std::size_t Vita49Receiver::receive_batch(double) { return 0; }
+void Vita49Receiver::track_loss(Vita49Packet&) {}
+void Vita49Receiver::start() {}
+void Vita49Receiver::stop() {}
+void Vita49Receiver::run() {}
+
+#endif
+
+bool Vita49Receiver::wait_packets(double timeout_seconds) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_seconds);
+    Backoff backoff;
+    for (;;) {
+        bool closed = ring_.closed();
+        if (ring_.size() > 0) {
+            return true;
+        }
+        if (closed) {
+            return false;
+        }
+        if (timeout_seconds >= 0.0 && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        backoff.pause();
+    }
+}
+
+Vita49Stats Vita49Receiver::stats() const {
+    Vita49Stats stats;
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.payload_bytes = payload_bytes_.load(std::memory_order_relaxed);
+    stats.context_packets = context_packets_.load(std::memory_order_relaxed);
+    stats.malformed = malformed_.load(std::memory_order_relaxed);
+    stats.lost_packets = lost_packets_.load(std::memory_order_relaxed);
+    stats.lost_samples = lost_samples_.load(std::memory_order_relaxed);
+    stats.receive_calls = receive_calls_.load(std::memory_order_relaxed);
+    stats.ring_full = ring_full_.load(std::memory_order_relaxed);
+    stats.streams = stream_count_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ============================================================================
+// SENDER
+// ============================================================================
+
+#ifdef __linux__
+
+struct Vita49Sender::Batch {
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+};
+
+Vita49Sender::Vita49Sender(const std::string& address, std::uint16_t port, std::uint32_t stream_id,
+                           SampleFormat format, bool big_endian, std::size_t batch)
+    : stream_id_(stream_id), format_(format), big_endian_(big_endian), batch_(std::max<std::size_t>(batch, 1)) {
+    check_payload_format(format_);
+    sockaddr_in addr = ipv4_address(address, port);
+    socket_ = udp_socket();
+    int buffer = 8 << 20;
+    ::setsockopt(socket_, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    // Connected, so sendmmsg() needs no per-message address
+    if (::connect(socket_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int error = errno;
+        ::close(socket_);
+        throw std::runtime_error("Cannot connect UDP socket to " + address + ": " + std::strerror(error));
+    }
+    queued_.resize(batch_);
+    messages_ = std::make_unique<Batch>();
+    messages_->messages.resize(batch_);
+    messages_->vectors.resize(batch_);
+}
+
+Vita49Sender::~Vita49Sender() {
+    if (socket_ >= 0) {
+        try {
+            flush();
+        } catch (const std::exception&) {
+            // Nothing sensible to do with a send error during destruction
+        }
+        ::close(socket_);
+    }
+}
+
+void Vita49Sender::send(const void* samples, std::size_t count) {
+    Vita49Packet packet;
+    packet.type = Vita49PacketType::SignalDataWithStreamId;
+    packet.stream_id = stream_id_;
+    packet.tsf = Vita49Tsf::SampleCount;
+    packet.fractional_timestamp = timestamp_;
+    packet.packet_count = packet_count_;
+    packet.payload_bytes = static_cast<std::uint32_t>(count * sample_format_size(format_));
+
+    std::vector<std::uint8_t>& out = queued_[queued_count_];
+    out.clear();
+    encode_vita49(packet, samples, out);
+    if (big_endian_) {
+        swap_components(out.data() + out.size() - packet.payload_bytes, packet.payload_bytes, format_);
+    }
+    packet_count_ = static_cast<std::uint8_t>((packet_count_ + 1) & 0xF);
+    timestamp_ += count;
+    if (++queued_count_ == batch_) {
+        flush();
+    }
+}
+
+void Vita49Sender::flush() {
+    mmsghdr* messages = messages_->messages.data();
+    iovec* vectors = messages_->vectors.data();
+    for (std::size_t i = 0; i < queued_count_; ++i) {
+        vectors[i].iov_base = queued_[i].data();
+        vectors[i].iov_len = queued_[i].size();
+        messages[i].msg_hdr = {};
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    std::size_t done = 0;
+    while (done < queued_count_) {
+        int sent = ::sendmmsg(socket_, messages + done, static_cast<unsigned>(queued_count_ - done), 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ECONNREFUSED) {
+                // Nobody listening (yet): the datagram is gone, as on a real link
+                ++done;
+                continue;
+            }
+            queued_count_ = 0;
+            throw std::runtime_error(std::string("sendmmsg() failed: ") + std::strerror(errno));
+        }
+        done += static_cast<std::size_t>(sent);
+        sent_ += static_cast<std::uint64_t>(sent);
+    }
+    queued_count_ = 0;
+}
+
+#else
+
+struct Vita49Sender::Batch {};
+
+Vita49Sender::Vita49Sender(const std::string&, std::uint16_t, std::uint32_t stream_id, SampleFormat format,
+                           bool big_endian, std::size_t batch)
+    : stream_id_(stream_id), format_(format), big_endian_(big_endian), batch_(batch) {
+    throw std::runtime_error("VITA-49 sender needs Linux (sendmmsg)");
+}
+Vita49Sender::~Vita49Sender() = default;
+void Vita49Sender::send(const void*, std::size_t) {}
+void Vita49Sender::flush() {}
+
+#endif
+
+void Vita49Sender::skip(std::size_t packets, std::size_t samples_per_packet) {
+    packet_count_ = static_cast<std::uint8_t>((packet_count_ + packets) & 0xF);
+    timestamp_ += packets * samples_per_packet;
+}
+
+// ============================================================================
+// FLOWGRAPH SOURCE
+// ============================================================================
+
+Vita49Source::Vita49Source(std::shared_ptr<Vita49Receiver> receiver, double idle_timeout, double scale)
+    : receiver_(std::move(receiver)), idle_timeout_(idle_timeout), scale_(scale) {
+    if (!receiver_) {
+        throw std::invalid_argument("Vita49Source needs a receiver");
+    }
+}
+
+bool Vita49Source::produce(SampleBlock& out, std::size_t block_size) {
+    if (!receiver_->running() && !receiver_->closed()) {
+        receiver_->start();
+    }
+    const SampleFormat format = receiver_->config().format;
+    out.resize(block_size, true);
+    std::complex<double>* iq = out.iq();
+    std::size_t filled = 0;
+
+    while (filled < block_size) {
+        RingSpan<const Vita49Packet> span = receiver_->peek(1);
+        if (span.empty()) {
+            // Hand on what we have rather than hold it back waiting
+            if (filled > 0) {
+                break;
+            }
+            if (!receiver_->wait_packets(idle_timeout_)) {
+                return false;
+            }
+            continue;
+        }
+        const Vita49Packet& packet = span.data[0];
+        if (!gap_taken_) {
+            zeros_ = packet.lost_samples <= kMaxGapFill ? packet.lost_samples : 0;
+            gap_taken_ = true;
+        }
+        if (zeros_ > 0) {
+            std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(zeros_, block_size - filled));
+            std::fill_n(iq + filled, n, std::complex<double>());
+            zeros_ -= n;
+            filled += n;
+            continue;
+        }
+
+        std::size_t n = std::min(packet.sample_count() - offset_, block_size - filled);
+        double* dest = reinterpret_cast<double*>(iq + filled);
+        switch (format) {
+            case SampleFormat::CS16:
+                convert_samples(packet.samples<std::int16_t>() + 2 * offset_, 2 * n, dest,
+                                scale_ > 0.0 ? scale_ : kScaleS16);
+                break;
+            case SampleFormat::CS8:
+                convert_samples(packet.samples<std::int8_t>() + 2 * offset_, 2 * n, dest,
+                                scale_ > 0.0 ? scale_ : kScaleS8);
+                break;
+            default:
+                convert_samples(packet.samples<float>() + 2 * offset_, 2 * n, dest,
+                                scale_ > 0.0 ? scale_ : 1.0);
+                break;
+        }
+        offset_ += n;
+        filled += n;
+        if (offset_ == packet.sample_count()) {
+            receiver_->consume(1);
+            offset_ = 0;
+            gap_taken_ = false;
+        }
+    }
+    out.resize(filled, true);
+    return true;
+}
+
+} // namespace signal_processor
@@ -7,8 +7,18 @@ Run with: python3 test_processor.py
 Or with pytest: pytest test_processor.py -v
 """
 
+import os
 import sys
+import json
 import math
+import shutil
+import subprocess
+import tempfile
+import asyncio
+import queue
+import threading
+import socket
+import struct
 
 try:
     import signal_processor_cpp as sp
@@ -150,6 +160,867 @@ class TestSNR:
         assert snr_low > snr_high, "More noise should decrease SNR"
 
 
+class TestNumpyInput:
+    """Test NumPy buffer input"""
+
+    def test_filter_accepts_ndarray(self):
+        """Contiguous float64 arrays should give the same result as lists"""
+        signal = np.asarray(sp.generate_test_signal(10.0, 1000.0, 1.0, 0.5))
+        from_array = sp.apply_lowpass_filter(signal, 0.1, 51)
+        from_list = sp.apply_lowpass_filter(signal.tolist(), 0.1, 51)
+        assert np.allclose(from_array, from_list), "ndarray and list input should match"
+
+    def test_filter_accepts_strided_view(self):
+        """Non-contiguous views should fall back to a contiguous copy"""
+        signal = np.asarray(sp.generate_test_signal(10.0, 2000.0, 1.0, 0.5))
+        strided = signal[::2]
+        filtered = sp.apply_lowpass_filter(strided, 0.1, 51)
+        expected = sp.apply_lowpass_filter(np.ascontiguousarray(strided), 0.1, 51)
+        assert np.allclose(filtered, expected), "Strided input should be handled"
+
+    def test_strided_raw_and_complex_keep_their_dtype(self):
+        """Strided int16 stays scaled, strided complex keeps its imaginary part"""
+        raw = (np.random.randn(4000, 2) * 8000).astype(np.int16)
+        assert np.allclose(sp.apply_lowpass_filter(raw[::2, 0], 0.1, 51),
+                           sp.apply_lowpass_filter(raw[::2, 0].copy(), 0.1, 51))
+        assert np.allclose(sp.compute_fft(raw[::2]), sp.compute_fft(raw[::2].copy()))
+        iq = np.random.randn(512) + 1j * np.random.randn(512)
+        assert np.allclose(sp.compute_fft(iq[::2]), np.fft.fft(iq[::2]))
+        assert np.allclose(sp.apply_lowpass_filter(iq[::2], 0.1, 31),
+                           sp.apply_lowpass_filter(iq[::2].copy(), 0.1, 31))
+
+    def test_rejects_multidimensional_input(self):
+        """2-D arrays are not valid signals"""
+        with pytest.raises(ValueError):
+            sp.compute_fft(np.zeros((4, 4)))
+
+
+class TestNumpyOutput:
+    """Test NumPy array results"""
+
+    def test_results_are_ndarrays(self):
+        """Results should come back as float64/complex128 arrays"""
+        signal = sp.generate_test_signal(10.0, 1000.0, 1.0, 0.1)
+        filtered = sp.apply_lowpass_filter(signal, 0.1, 51)
+        fft_result = sp.compute_fft(signal)
+        assert isinstance(signal, np.ndarray) and signal.dtype == np.float64
+        assert filtered.dtype == np.float64
+        assert fft_result.dtype == np.complex128
+
+    def test_float32_round_trip(self):
+        """float32 input should stay single precision end to end"""
+        signal = sp.generate_test_signal(10.0, 1000.0, 1.0, 0.1, dtype="float32")
+        assert signal.dtype == np.float32
+        filtered = sp.apply_lowpass_filter(signal, 0.1, 51)
+        fft_result = sp.compute_fft(signal)
+        assert filtered.dtype == np.float32
+        assert fft_result.dtype == np.complex64
+        reference = sp.apply_lowpass_filter(signal.astype(np.float64), 0.1, 51)
+        assert np.allclose(filtered, reference, atol=1e-4)
+
+
+class TestConcurrency:
+    """Test calls from several Python threads"""
+
+    def test_parallel_fft_matches_serial(self):
+        """Concurrent FFTs (GIL released, planner serialized) stay correct"""
+        signals = [sp.generate_test_signal(10.0 * (k + 1), 4096.0, 1.0, 0.0)
+                   for k in range(8)]
+        expected = [sp.compute_fft(s) for s in signals]
+        results = [None] * len(signals)
+
+        def worker(k):
+            for _ in range(5):
+                results[k] = sp.compute_fft(signals[k])
+
+        threads = [threading.Thread(target=worker, args=(k,)) for k in range(len(signals))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        for got, want in zip(results, expected):
+            assert np.allclose(got, want), "Threaded FFT result differs"
+
+    def test_shared_streaming_processor_is_serialized(self):
+        """Threads sharing one processor take turns instead of racing on its state"""
+        dec = sp.ComplexDecimator(4, 63)
+        block = np.ones(400, dtype=np.complex128)
+        produced = [0] * 4
+        done = threading.Event()
+
+        def worker(k):
+            for _ in range(200):
+                produced[k] += len(dec.process(block))
+
+        def resetter():
+            while not done.is_set():
+                dec.restore(dec.snapshot())
+                dec.reset()
+
+        threads = [threading.Thread(target=worker, args=(k,)) for k in range(4)]
+        other = threading.Thread(target=resetter)
+        other.start()
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        done.set()
+        other.join()
+        # Blocks are multiples of the factor, so every call yields 100 samples
+        assert produced == [200 * 100] * 4
+
+
+class TestBatchFunctions:
+    """Test the parallel multi-channel entry points"""
+
+    def test_filter_batch_matches_single_channel(self):
+        """Uneven channel lengths give the same result as one call each"""
+        channels = [np.random.randn(n) for n in (5, 1000, 70_000, 0, 333)]
+        outputs = sp.apply_lowpass_filter_batch(channels, 0.1, 51)
+        assert len(outputs) == len(channels)
+        for channel, output in zip(channels, outputs):
+            assert np.allclose(output, sp.apply_lowpass_filter(channel, 0.1, 51))
+
+    def test_fft_and_snr_batch(self):
+        """FFT and SNR batches match their single-channel functions"""
+        clean = [sp.generate_test_signal(f, 1000.0, 1.0, 0.0) for f in (10.0, 50.0, 120.0)]
+        noisy = [c + 0.1 * np.random.randn(len(c)) for c in clean]
+        spectra = sp.compute_fft_batch(noisy)
+        for channel, spectrum in zip(noisy, spectra):
+            assert np.allclose(spectrum, sp.compute_fft(channel))
+        snr = sp.calculate_snr_batch(clean, noisy)
+        assert np.allclose(snr, [sp.calculate_snr(c, n) for c, n in zip(clean, noisy)])
+        with pytest.raises(ValueError):
+            sp.calculate_snr_batch(clean, noisy[:2])
+
+
+class TestBufferPool:
+    """Test scratch-buffer reuse"""
+
+    def test_steady_state_reuses_buffers(self):
+        """Repeated same-size calls take no new memory from the system"""
+        signal = np.random.randn(4096)
+        raw = np.random.randint(-1000, 1000, size=(2048, 2)).astype(np.int16)
+        for _ in range(2):
+            sp.compute_fft(signal)
+            sp.apply_lowpass_filter(raw, 0.1, 51)
+        before = sp.buffer_pool_stats()["system_allocations"]
+        for _ in range(20):
+            sp.compute_fft(signal)
+            sp.apply_lowpass_filter(raw, 0.1, 51)
+            sp.Stft(1024, 512)
+        assert sp.buffer_pool_stats()["system_allocations"] == before
+
+    def test_memory_policy_falls_back_gracefully(self):
+        """Explicit huge pages and NUMA binding never fail an allocation"""
+        node = sp.current_numa_node()
+        assert 0 <= node < sp.numa_node_count()
+        try:
+            sp.set_memory_policy(huge_pages="2m", numa_node=node)
+            signal = np.random.randn(1 << 19)
+            assert np.allclose(sp.apply_lowpass_filter(signal, 0.1, 31),
+                               sp.apply_lowpass_filter(signal.copy(), 0.1, 31))
+            ring = sp.SampleRing(1000, huge_pages="2m", numa_node=node)
+            ring.first_touch()
+            assert ring.write(signal[:1000]) == 1000
+            assert np.array_equal(ring.read(), signal[:1000])
+            assert ring.huge_pages in ("2m", "transparent", "none")
+        finally:
+            sp.set_memory_policy()
+        with pytest.raises(ValueError):
+            sp.set_memory_policy(huge_pages="3m")
+
+
+class TestRawSampleFormats:
+    """Test int16/int8/complex inputs"""
+
+    def test_int16_filter_matches_scaled_float(self):
+        """int16 input is scaled by 1/32768 on the way in"""
+        raw = (np.random.randn(5000) * 8000).astype(np.int16)
+        got = sp.apply_lowpass_filter(raw, 0.1, 51)
+        want = sp.apply_lowpass_filter(raw / 32768.0, 0.1, 51)
+        assert got.dtype == np.float64
+        assert np.allclose(got, want)
+
+    def test_sc16_filter_matches_complex(self):
+        """(N, 2) int16 is interleaved I/Q"""
+        raw = (np.random.randn(3000, 2) * 8000).astype(np.int16)
+        iq = (raw[:, 0] + 1j * raw[:, 1]) / 32768.0
+        got = sp.apply_lowpass_filter(raw, 0.1, 51)
+        want = sp.apply_lowpass_filter(iq, 0.1, 51)
+        assert got.dtype == np.complex128
+        assert np.allclose(got, want)
+        real_part = sp.apply_lowpass_filter(iq.real.copy(), 0.1, 51)
+        assert np.allclose(got.real, real_part)
+
+    def test_sc8_fft_matches_numpy(self):
+        """sc8 FFT is a full complex FFT"""
+        raw = np.random.randint(-128, 128, size=(256, 2)).astype(np.int8)
+        iq = (raw[:, 0] + 1j * raw[:, 1]) / 128.0
+        assert np.allclose(sp.compute_fft(raw), np.fft.fft(iq))
+
+    def test_complex64_fft(self):
+        """complex64 input keeps its imaginary part"""
+        iq = (np.random.randn(128) + 1j * np.random.randn(128)).astype(np.complex64)
+        assert np.allclose(sp.compute_fft(iq), np.fft.fft(iq.astype(np.complex128)), atol=1e-4)
+
+
+class TestStreamingProcessors:
+    """Test stateful block-by-block processors"""
+
+    @staticmethod
+    def _blocks(signal, sizes=(1, 7, 100, 3, 999, 50)):
+        pos, k = 0, 0
+        while pos < len(signal):
+            n = sizes[k % len(sizes)]
+            yield signal[pos:pos + n]
+            pos += n
+            k += 1
+
+    def test_fir_blockwise_matches_whole(self):
+        """Arbitrary block sizes give the same output as one big block"""
+        signal = sp.generate_test_signal(10.0, 1000.0, 2.0, 0.5)
+        whole = sp.StreamingFir(0.1, 51).process(signal)
+        fir = sp.StreamingFir(0.1, 51)
+        parts = np.concatenate([fir.process(b) for b in self._blocks(signal)])
+        assert np.allclose(whole, parts)
+
+    def test_fir_writes_into_out(self):
+        """process(out=...) should reuse the caller's buffer"""
+        fir = sp.StreamingFir(0.1, 31)
+        out = np.empty(256)
+        result = fir.process(np.random.randn(256), out=out)
+        assert np.shares_memory(result, out)
+
+    def test_decimator_blockwise_matches_whole(self):
+        """Decimation phase is carried across blocks"""
+        signal = sp.generate_test_signal(10.0, 1000.0, 2.0, 0.5)
+        whole = sp.Decimator(4, 63).process(signal)
+        dec = sp.Decimator(4, 63)
+        parts = np.concatenate([dec.process(b) for b in self._blocks(signal)])
+        assert len(whole) == len(signal) // 4
+        assert np.allclose(whole, parts)
+
+    def test_snapshot_restore_replays_block(self):
+        """Restoring a snapshot reproduces the same output"""
+        fir = sp.StreamingFir(0.1, 31)
+        fir.process(np.random.randn(100))
+        state = fir.snapshot()
+        block = np.random.randn(64)
+        first = fir.process(block).copy()
+        fir.restore(state)
+        assert np.allclose(fir.process(block), first)
+
+    def test_nco_phase_continuity(self):
+        """Two half blocks equal one full block"""
+        a, b = sp.Nco(0.01), sp.Nco(0.01)
+        split = np.concatenate([a.generate(500), a.generate(500)])
+        assert np.allclose(split, b.generate(1000))
+
+    def test_stft_frame_count(self):
+        """STFT emits one frame per hop once a frame is full"""
+        stft = sp.Stft(64, 16)
+        frames = stft.process(np.random.randn(2000))
+        assert frames.shape == ((2000 - 64) // 16 + 1, 33)
+
+    def test_iq_stft_matches_numpy(self):
+        """Each IQ frame is the FFT of a Hann-windowed slice, across blocks"""
+        iq = np.random.randn(1000) + 1j * np.random.randn(1000)
+        stft = sp.IqStft(64, 16)
+        frames = np.concatenate([stft.process(b) for b in self._blocks(iq)])
+        window = 0.5 - 0.5 * np.cos(2 * np.pi * np.arange(64) / 64)
+        assert frames.shape == ((1000 - 64) // 16 + 1, 64)
+        assert np.allclose(frames[5], np.fft.fft(iq[80:144] * window))
+
+    def test_iq_stft_snapshot_restore(self):
+        """Restoring an IqStft snapshot replays the same frames"""
+        stft = sp.IqStft(64, 16)
+        stft.process(np.random.randn(100) + 1j * np.random.randn(100))
+        state = stft.snapshot()
+        assert state["pending"].dtype == np.complex128
+        block = np.random.randn(200) + 1j * np.random.randn(200)
+        first = stft.process(block).copy()
+        stft.restore(state)
+        assert np.allclose(stft.process(block), first)
+        with pytest.raises(ValueError):
+            stft.restore({"pending": np.zeros(64, dtype=np.complex128)})
+
+    def test_cfar_finds_tones_not_noise(self):
+        """CA-CFAR flags a strong tone on both sides of 0 Hz and little else"""
+        n = np.arange(64 * 200)
+        iq = (np.random.randn(n.size) + 1j * np.random.randn(n.size)) / np.sqrt(2)
+        iq += 3 * np.exp(2j * np.pi * 10 / 64 * n) + 3 * np.exp(-2j * np.pi * 20 / 64 * n)
+        power = np.abs(sp.IqStft(64, 64).process(iq)) ** 2
+        cfar = sp.CfarDetector(2, 8, sp.CfarDetector.factor_for_pfa(8, 1e-4))
+        found = cfar.detect(power)
+        assert np.count_nonzero(found["bin"] == 10) == 200
+        assert np.count_nonzero(found["bin"] == 44) == 200
+        assert np.all(found["power"] > cfar.factor * found["noise"])
+        # Away from the tones' main lobes only rare false alarms remain
+        far = np.min([np.abs((found["bin"] - b + 32) % 64 - 32) for b in (10, 44)], axis=0) > 2
+        assert np.count_nonzero(far) < 20
+        with pytest.raises(ValueError):
+            cfar.detect(np.ones((1, 8)))
+
+
+class TestSampleRings:
+    """Test the lock-free sample ring buffers"""
+
+    def test_wraparound_and_overrun(self):
+        """Samples come out in order across the wrap; excess is counted"""
+        ring = sp.ComplexSampleRing(1000)
+        cap = ring.capacity
+        assert cap >= 1000
+        data = np.arange(3 * cap) * (1 + 1j)
+        out = np.empty(cap, dtype=np.complex128)
+        for start in range(0, data.size, 700):
+            assert ring.write(data[start:start + 700]) == data[start:start + 700].size
+            got = ring.read(out=out)
+            assert np.shares_memory(got, out)
+            assert np.array_equal(got, data[start:start + 700])
+        assert ring.write(np.ones(cap + 10, dtype=np.complex128)) == cap
+        assert ring.overruns == 10 and len(ring) == cap
+
+    def test_threaded_handoff(self):
+        """A producer thread and a consumer thread see one ordered stream"""
+        ring = sp.SampleRing(4096)
+        data = np.random.randn(200_000)
+
+        def produce():
+            pos = 0
+            while pos < data.size:
+                pos += ring.write(data[pos:pos + 1000])
+            ring.close()
+
+        producer = threading.Thread(target=produce)
+        producer.start()
+        parts = []
+        while True:
+            closed = ring.closed
+            block = ring.read(1024)
+            if block.size:
+                parts.append(block)
+            elif closed:
+                break
+        producer.join()
+        assert np.array_equal(np.concatenate(parts), data)
+
+    def test_len_from_a_third_thread_stays_in_range(self):
+        """len() taken while both ends move never wraps past the capacity"""
+        ring = sp.SampleRing(256)
+        block = np.ones(64)
+        done = threading.Event()
+
+        def produce():
+            while not done.is_set():
+                ring.write(block)
+
+        def consume():
+            while not done.is_set():
+                ring.read(64)
+
+        threads = [threading.Thread(target=produce), threading.Thread(target=consume)]
+        for t in threads:
+            t.start()
+        try:
+            sizes = [len(ring) for _ in range(20_000)]
+        finally:
+            done.set()
+            for t in threads:
+                t.join()
+        assert 0 <= min(sizes) and max(sizes) <= ring.capacity
+
+
+class TestSharedMemoryRing:
+    """Test the shared-memory ring between two handles on one segment"""
+
+    def test_zero_copy_round_trip(self):
+        """Samples written in place by one handle are peeked by the other"""
+        name = f"sp_test_{os.getpid()}"
+        producer = sp.SharedMemoryRing.create(name, 1000, format="cs16")
+        consumer = sp.SharedMemoryRing.open(name)
+        assert consumer.format == "cs16" and consumer.capacity == producer.capacity
+        data = np.arange(2 * producer.capacity * 2, dtype=np.int16).reshape(-1, 2)
+        for start in range(0, len(data), 700):
+            chunk = data[start:start + 700]
+            free = producer.reserve(len(chunk))
+            assert free.shape == (len(chunk), 2)
+            free[:] = chunk
+            producer.commit(len(chunk))
+            ready = consumer.peek(timeout=1.0)
+            assert np.array_equal(ready, chunk)
+            consumer.consume(len(ready))
+        with pytest.raises(ValueError):
+            producer.write(np.ones((4, 2)))   # float64 would be truncated to int16
+        assert producer.write(np.ones((producer.capacity + 5, 2), dtype=np.int16)) == producer.capacity
+        assert consumer.overruns == 5
+
+    def test_wait_timeout_and_close(self):
+        """A consumer wait times out, then wakes for close()"""
+        ring = sp.SharedMemoryRing.create(f"sp_test_wait_{os.getpid()}", 64)
+        assert ring.wait_readable(1, timeout=0.05) is False
+        ring.write(np.ones(3, dtype=np.complex128))
+        with pytest.raises(ValueError):
+            ring.write(np.ones(3, dtype=np.float32))
+        ring.close()
+        assert ring.wait_readable(10, timeout=1.0) and ring.closed
+        assert np.array_equal(ring.read(), np.ones(3))
+        with pytest.raises(RuntimeError):
+            sp.SharedMemoryRing.open(f"sp_test_missing_{os.getpid()}")
+
+    def test_commit_and_consume_past_the_ring_are_rejected(self):
+        """Counts beyond the free space or the available samples raise"""
+        name = f"sp_test_counts_{os.getpid()}"
+        producer = sp.SharedMemoryRing.create(name, 64)
+        consumer = sp.SharedMemoryRing.open(name)
+        with pytest.raises(ValueError):
+            producer.commit(producer.capacity + 1)
+        with pytest.raises(ValueError):
+            consumer.consume(1)
+        producer.write(np.ones(10, dtype=np.complex128))
+        assert len(consumer.peek()) == 10
+        with pytest.raises(ValueError):
+            consumer.consume(11)
+        consumer.consume(10)
+        assert len(consumer) == 0
+        producer.commit(producer.capacity)
+        with pytest.raises(ValueError):
+            producer.commit(1)
+        assert len(consumer) == consumer.capacity
+
+
+class TestVita49Ingest:
+    """Test VITA-49 packet ingest from a loopback sender"""
+
+    @staticmethod
+    def packet(count, timestamp, iq, stream_id=7):
+        """IF data packet with stream ID and sample-count timestamp, sc16 big-endian"""
+        payload = struct.pack(f">{iq.size}h", *iq.ravel())
+        words = 4 + len(payload) // 4
+        header = (1 << 28) | (1 << 20) | ((count & 0xF) << 16) | words
+        return struct.pack(">IIQ", header, stream_id, timestamp) + payload
+
+    def test_loopback_packets_and_loss(self):
+        """Payloads arrive in order and scaled; gaps are counted"""
+        rx = sp.Vita49Receiver(address="127.0.0.1")
+        tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        iq = np.arange(-200, 200, dtype=np.int16).reshape(-1, 2) * 80
+        for n in [0, 1, 2, 5, 6]:      # packets 3 and 4 are "lost"
+            tx.sendto(self.packet(n, n * len(iq), iq), ("127.0.0.1", rx.port))
+        tx.sendto(b"junk", ("127.0.0.1", rx.port))
+        tx.close()
+        received = 0
+        while received < 6 and rx.receive(timeout=1.0):
+            received = rx.stats()["packets"] + rx.stats()["malformed"]
+        samples = rx.read()
+        expected = (iq[:, 0] + 1j * iq[:, 1]) / 32768.0
+        assert np.allclose(samples, np.tile(expected, 5))
+        stats = rx.stats()
+        assert stats["packets"] == 5 and stats["malformed"] == 1
+        assert stats["lost_packets"] == 2 and stats["lost_samples"] == 2 * len(iq)
+
+
+class TestAsyncAPI:
+    """Test the native executor and its futures"""
+
+    def test_submit_fft_matches_sync(self):
+        """Futures resolve to the same result as the blocking call"""
+        signal = sp.generate_test_signal(10.0, 1000.0, 1.0, 0.1)
+        futures = [sp.submit_fft(signal) for _ in range(20)]
+        expected = sp.compute_fft(signal)
+        for fut in futures:
+            assert np.allclose(fut.result(timeout=10), expected)
+
+    def test_await_from_asyncio(self):
+        """NativeFuture should be directly awaitable"""
+        signal = sp.generate_test_signal(10.0, 1000.0, 1.0, 0.1)
+
+        async def run():
+            return await sp.submit_filter(signal, 0.1, 51)
+
+        filtered = asyncio.run(run())
+        assert np.allclose(filtered, sp.apply_lowpass_filter(signal, 0.1, 51))
+
+    def test_invalid_arguments_raise_at_submit(self):
+        """Argument validation happens before anything is queued"""
+        with pytest.raises(ValueError):
+            sp.submit_snr([1.0, 2.0], [1.0, 2.0, 3.0])
+
+    def test_backpressure_rejects_when_full(self):
+        """block=False should raise once the bounded queue is full"""
+        sp.configure_executor(num_threads=1, max_queue_depth=1)
+        try:
+            big = np.random.randn(1_000_000)
+            futures = []
+            with pytest.raises(queue.Full):
+                for _ in range(50):
+                    futures.append(sp.submit_filter(big, 0.1, 101, block=False))
+            for fut in futures:
+                fut.result(timeout=60)
+            assert sp.executor_stats()["jobs_rejected"] >= 1
+        finally:
+            sp.configure_executor()
+
+
+class TestCaptureFiles:
+    """Test memory-mapped capture reading"""
+
+    def test_raw_block_is_readonly_native_view(self):
+        """cf32 blocks come back as complex64 views of the file"""
+        data = (np.random.randn(1000) + 1j * np.random.randn(1000)).astype(np.complex64)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "iq.cf32")
+            data.tofile(path)
+            cap = sp.MappedCapture(path, "cf32")
+            assert len(cap) == 1000
+            block = cap.block(100, 50)
+            assert block.dtype == np.complex64 and not block.flags.writeable
+            assert np.array_equal(block, data[100:150])
+            assert cap.block(990, 50).size == 10
+
+    def test_misaligned_header_gives_aligned_copies(self):
+        """A header that is not a multiple of the sample size still reads correctly"""
+        data = np.random.randn(600)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "iq.cf64")
+            with open(path, "wb") as f:
+                f.write(b"hdr")
+                f.write(data.tobytes())
+            cap = sp.MappedCapture(path, "cf64", header_bytes=3)
+            assert not cap.aligned and len(cap) == 300
+            block = cap.block(10, 100)
+            assert block.flags.aligned
+            assert np.array_equal(block, data.view(np.complex128)[10:110])
+
+    def test_sigmf_metadata(self):
+        """Format, rate and center frequency come from the .sigmf-meta file"""
+        raw = np.random.randint(-2000, 2000, size=(500, 2)).astype(np.int16)
+        meta = ('{"global": {"core:datatype": "ci16_le", "core:sample_rate": 2e6,'
+                ' "core:version": "1.0.0"}, "captures": [{"core:sample_start": 0,'
+                ' "core:frequency": 915e6}], "annotations": []}')
+        with tempfile.TemporaryDirectory() as tmp:
+            base = os.path.join(tmp, "rec")
+            raw.tofile(base + ".sigmf-data")
+            with open(base + ".sigmf-meta", "w") as f:
+                f.write(meta)
+            cap = sp.MappedCapture.open_sigmf(base + ".sigmf-meta")
+            assert cap.format == "cs16" and len(cap) == 500
+            assert cap.sample_rate == 2e6 and cap.center_frequency == 915e6
+            assert np.array_equal(cap.block(0, 500), raw)
+
+    def test_stream_feeds_streaming_filter(self):
+        """Filtering the stream block by block equals filtering the file"""
+        data = np.random.randn(20_000)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "real.f64")
+            data.tofile(path)
+            cap = sp.MappedCapture(path, "f64")
+            fir = sp.StreamingFir(0.1, 51)
+            blocks = [fir.process(block) for block in cap.stream(4096)]
+        assert len(blocks) == 5
+        expected = sp.StreamingFir(0.1, 51).process(data)
+        assert np.allclose(np.concatenate(blocks), expected)
+
+    def test_cs16_stream_feeds_complex_processors(self):
+        """(N, 2) int16 blocks of a cs16 capture go straight into complex processors"""
+        raw = (np.random.randn(20_000, 2) * 8000).astype(np.int16)
+        iq = (raw[:, 0] + 1j * raw[:, 1]) / 32768.0
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "iq.cs16")
+            raw.tofile(path)
+            cap = sp.MappedCapture(path, "cs16")
+            fir = sp.ComplexStreamingFir(0.1, 51)
+            dec = sp.ComplexDecimator(4, 63)
+            filtered, decimated = [], []
+            for block in cap.stream(4096):
+                assert block.dtype == np.int16 and block.shape[1] == 2
+                filtered.append(fir.process(block))
+                decimated.append(dec.process(block).copy())
+        assert np.allclose(np.concatenate(filtered), sp.ComplexStreamingFir(0.1, 51).process(iq))
+        assert np.allclose(np.concatenate(decimated), sp.ComplexDecimator(4, 63).process(iq))
+        half = sp.ComplexStreamingFir(0.1, 51).process(raw, scale=0.5)
+        assert np.allclose(half, sp.ComplexStreamingFir(0.1, 51).process(iq * 16384.0))
+
+    def test_writer_sigmf_round_trip(self):
+        """CaptureWriter output reads back through MappedCapture"""
+        data = np.exp(2j * np.pi * 0.01 * np.arange(30_001)) * 0.5
+        with tempfile.TemporaryDirectory() as tmp:
+            base = os.path.join(tmp, "rec")
+            with sp.CaptureWriter(base, format="cs16", sigmf=True, sample_rate=1e6,
+                                  buffer_bytes=8192) as out:
+                for start in range(0, data.size, 7000):
+                    assert out.write(data[start:start + 7000]) == data[start:start + 7000].size
+            stats = out.stats()
+            assert stats["samples_written"] == data.size and stats["samples_dropped"] == 0
+            cap = sp.MappedCapture.open_sigmf(base)
+            assert cap.format == "cs16" and cap.sample_rate == 1e6 and len(cap) == data.size
+            iq = cap.block(0, len(cap)).astype(np.float64) / 32768
+            assert np.allclose(iq[:, 0] + 1j * iq[:, 1], data, atol=1e-4)
+
+    def test_writer_rejects_complex_into_real_format(self):
+        """A complex block is never silently truncated to its real part"""
+        with tempfile.TemporaryDirectory() as tmp:
+            with sp.CaptureWriter(os.path.join(tmp, "x.f32"), format="f32") as out:
+                with pytest.raises(ValueError):
+                    out.write(np.ones(10, dtype=np.complex128))
+
+
+class TestFlowgraph:
+    """Test the threaded stage pipeline"""
+
+    def test_tone_peak(self):
+        """source → FIR → spectrum → peak finds the tone in every frame"""
+        peaks = sp.PeakSink(1e6)
+        graph = sp.Flowgraph([sp.ToneSource(50e3, 1e6, 0.1, 1 << 18),
+                              sp.FirStage(0.2, 63),
+                              sp.SpectrumStage(1024),
+                              peaks], block_size=4096, queue_depth=4)
+        stats = graph.run()
+        assert [s["name"] for s in stats["stages"]] == ["tone", "fir", "spectrum", "peak"]
+        assert stats["stages"][0]["samples"] == 1 << 18
+        assert len(peaks.peaks) == (1 << 18) // 1024
+        assert np.allclose(peaks.peaks, 50e3, atol=1e6 / 1024)
+
+    def test_matches_streaming_fir(self):
+        """Blocks crossing thread boundaries give the same samples as one call"""
+        signal = np.random.randn(50_000) + 1j * np.random.randn(50_000)
+        sink = sp.CollectSink()
+        sp.Flowgraph([sp.ArraySource(signal), sp.FirStage(0.1, 51), sink],
+                     block_size=1000).run()
+        expected = sp.ComplexStreamingFir(0.1, 51).process(signal)
+        assert sink.samples.dtype == np.complex128
+        assert np.allclose(sink.samples, expected)
+
+    def test_invalid_chain(self):
+        """A graph must run source → ... → sink"""
+        with pytest.raises(ValueError):
+            sp.Flowgraph([sp.FirStage(0.1, 51), sp.CollectSink()])
+        with pytest.raises(ValueError):
+            sp.Flowgraph([sp.ArraySource(np.ones(10)), sp.FirStage(0.1, 51)])
+
+    def test_realtime_failures_are_reported(self):
+        """Refused real-time settings are listed and the graph still runs"""
+        signal = np.random.randn(20_000)
+        sink = sp.CollectSink()
+        stats = sp.Flowgraph([sp.ArraySource(signal), sp.FirStage(0.1, 51), sink],
+                             block_size=1000, cpus=[4096, -1, -1], priority=1).run()
+        assert np.allclose(sink.samples, sp.StreamingFir(0.1, 51).process(signal))
+        assert stats["stages"][0]["pin_failed"]
+        assert any(f.startswith("stage 0 (array)") for f in stats["realtime_failures"])
+        for stage in stats["stages"]:
+            assert stage["priority_failed"] != (stage["priority"] == 1)
+        with pytest.raises(ValueError):
+            sp.Flowgraph([sp.ArraySource(signal), sink], priority=100)
+
+
+class TestBatchCli:
+    """Test the sp_batch command-line tool (skipped if it was not built)"""
+
+    @staticmethod
+    def _binary():
+        here = os.path.dirname(os.path.abspath(__file__))
+        for path in (os.path.join(here, "sp_batch"), os.path.join(here, "build", "sp_batch")):
+            if os.access(path, os.X_OK):
+                return path
+        found = shutil.which("sp_batch")
+        if found is None:
+            pytest.skip("sp_batch not built")
+        return found
+
+    def _run(self, *args):
+        result = subprocess.run([self._binary(), *args], capture_output=True, text=True, timeout=120)
+        return result.returncode, result.stdout.splitlines(), result.stderr
+
+    def test_iq_peak_and_decimation(self):
+        """A cs16 tone is found at its (negative) frequency after decimation"""
+        n = np.arange(200_000)
+        tone = np.exp(-2j * np.pi * 50e3 * n / 1e6) * 8000
+        raw = np.empty(2 * n.size, dtype=np.int16)
+        raw[0::2], raw[1::2] = tone.real, tone.imag
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "tone.cs16")
+            raw.tofile(path)
+            out = os.path.join(tmp, "out")
+            code, lines, _ = self._run("-f", "cs16", "-r", "1e6", "--decimate", "4",
+                                       "--fft", "1024", "-o", out, path)
+            assert code == 0
+            fields = lines[1].split("\t")
+            assert int(fields[1]) == 200_000 and int(fields[2]) == 50_000
+            assert abs(float(fields[3]) + 50e3) < 250e3 / 1024
+            filtered = np.fromfile(os.path.join(out, "tone.cf32"), dtype=np.complex64)
+            assert filtered.size == 50_000
+            assert os.path.exists(os.path.join(out, "tone.psd.csv"))
+
+    def test_matches_streaming_filter(self):
+        """The CLI low-pass is the library's streaming FIR"""
+        signal = np.random.randn(10_000)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "noise.f64")
+            signal.tofile(path)
+            code, _, _ = self._run("-f", "f64", "-r", "1000", "--cutoff", "100",
+                                   "--taps", "51", "--block", "777", "-o", tmp, path)
+            assert code == 0
+            filtered = np.fromfile(os.path.join(tmp, "noise.f32"), dtype=np.float32)
+        expected = sp.StreamingFir(0.1, 51).process(signal)
+        assert np.allclose(filtered, expected, atol=1e-5)
+
+    def test_missing_file_fails(self):
+        """Unreadable inputs are reported and set a non-zero exit code"""
+        code, _, err = self._run("/nonexistent/capture.cf32")
+        assert code == 1 and "nonexistent" in err
+
+    def test_output_name_collision_is_rejected(self):
+        """Inputs with the same stem cannot share an output directory"""
+        with tempfile.TemporaryDirectory() as tmp:
+            for sub in ("a", "b"):
+                os.mkdir(os.path.join(tmp, sub))
+                np.zeros(100, dtype=np.complex64).tofile(os.path.join(tmp, sub, "x.cf32"))
+            code, _, err = self._run("-o", os.path.join(tmp, "out"),
+                                     os.path.join(tmp, "a", "x.cf32"), os.path.join(tmp, "b", "x.cf32"))
+            assert code == 2 and "would both write" in err
+            assert not os.path.exists(os.path.join(tmp, "out"))
+
+
+class TestReceiverBench:
+    """Test the sp_receiver_bench tool (skipped if it was not built)"""
+
+    @staticmethod
+    def _run(*args):
+        here = os.path.dirname(os.path.abspath(__file__))
+        binary = next((path for path in (os.path.join(here, "sp_receiver_bench"),
+                                         os.path.join(here, "build", "sp_receiver_bench"))
+                       if os.access(path, os.X_OK)), shutil.which("sp_receiver_bench"))
+        if binary is None:
+            pytest.skip("sp_receiver_bench not built")
+        return subprocess.run([binary, "--seconds", "0.2", "--warmup", "0", "--samples", "65536", *args],
+                              capture_output=True, text=True, timeout=120)
+
+    def test_reports_throughput_per_thread_count(self):
+        """A short run prints and writes one result per thread count"""
+        with tempfile.TemporaryDirectory() as tmp:
+            out = os.path.join(tmp, "receiver.json")
+            result = self._run("-j", "1,2", "--fft", "64", "--json", out)
+            assert result.returncode == 0, result.stderr
+            with open(out) as f:
+                report = json.load(f)
+        assert [r["threads"] for r in report["results"]] == [1, 2]
+        assert all(r["msps"] > 0 for r in report["results"])
+        assert "IQ STFT" in result.stdout
+
+    def test_undecimated_and_short_blocks(self):
+        """More STFT frames per block than the block alone gives (pending samples)"""
+        for args in (("--decimate", "1", "--block", "1024"), ("--block", "100")):
+            result = self._run("-j", "1", "--fft", "64", "--train", "4", *args)
+            assert result.returncode == 0, result.stderr
+
+    def test_cfar_wider_than_fft_is_a_usage_error(self):
+        """Invalid chains are rejected before any worker starts"""
+        result = self._run("--fft", "16")
+        assert result.returncode == 2 and "CFAR window" in result.stderr
+
+
+class TestPerfRegression:
+    """Test the regression harness's comparison (no timing involved)"""
+
+    @staticmethod
+    def _results(times):
+        import perf_regression
+        return {
+            "schema": perf_regression.SCHEMA_VERSION,
+            "environment": {"key": "k", "source": "native"},
+            "benchmarks": {name: perf_regression.summarize(t, 4096, None) for name, t in times.items()},
+        }
+
+    def test_flags_only_significant_slowdowns(self):
+        """A consistent 20% slowdown fails; noise and speedups do not"""
+        import perf_regression
+        rng = np.random.default_rng(3)
+        base = 1000 + rng.normal(0, 10, 15)
+        baseline = self._results({"fir": list(base), "fft": list(base), "snr": list(base)})
+        current = self._results({"fir": list(base * 1.2), "fft": list(base + rng.normal(0, 10, 15)),
+                                 "snr": list(base * 0.7)})
+        rows, warnings = perf_regression.compare(baseline, current, threshold=0.05, alpha=0.01)
+        status = {r["name"]: r["status"] for r in rows}
+        assert status == {"fir": "REGRESSED", "fft": "ok", "snr": "faster"}
+        assert not [w for w in warnings if "different machine" in w]
+
+
+class TestInstrumentation:
+    """Test the stage instrumentation probes (counters only in instrumented builds)"""
+
+    def test_flowgraph_and_kernel_probes(self):
+        """Stages and kernels report calls, samples and latency budgets"""
+        sp.reset_instrumentation()
+        sp.set_latency_budget("flowgraph.1.fir", 1e-9)
+        sp.Flowgraph([sp.ToneSource(50e3, 1e6, 0.1, 40_000), sp.FirStage(0.1, 31),
+                      sp.CollectSink()], block_size=4000).run()
+        sp.compute_fft(np.ones(1024))
+        snapshot = sp.instrumentation_snapshot()
+        if not sp.instrumentation_enabled():
+            assert snapshot["probes"] == {} and not snapshot["enabled"]
+            return
+        probes = snapshot["probes"]
+        fir = probes["flowgraph.1.fir"]
+        assert fir["calls"] == 10 and fir["samples"] == 40_000
+        assert fir["budget_violations"] == 10 and fir["budget"] == pytest.approx(1e-9)
+        assert 0 < fir["min"] <= fir["p50"] <= fir["p99"] <= fir["max"]
+        assert sum(count for _, count in fir["histogram"]) == 10
+        assert probes["streaming_fir"]["samples"] == 40_000
+        assert probes["compute_fft"]["calls"] == 1
+        sp.reset_instrumentation()
+        assert sp.instrumentation_snapshot()["probes"] == {}
+        sp.set_latency_budget("flowgraph.1.fir", None)
+        with pytest.raises(ValueError):
+            sp.set_latency_budget("flowgraph.1.fir", 1e-10)   # Would round to "no budget"
+
+    def test_hardware_counters(self):
+        """Probes carry perf counters, or the reason they could not be opened"""
+        sp.reset_instrumentation()
+        errors = sp.set_probe_hardware_counters(True)
+        try:
+            sp.compute_fft(np.ones(1024))
+            probes = sp.instrumentation_snapshot()["probes"]
+        finally:
+            sp.set_probe_hardware_counters(False)
+        assert all(isinstance(e, str) for e in errors)
+        if not sp.instrumentation_enabled():
+            assert errors and probes == {}
+            return
+        fft = probes["compute_fft"]
+        assert set(fft["hardware"]) <= {"cycles", "instructions", "l1d_misses", "llc_misses",
+                                        "branch_misses", "task_clock_ns"}
+        assert len(fft["hardware"]) + len(errors) == 6
+        assert fft["hardware_calls"] == (1 if fft["hardware"] else 0)
+
+
+class TestTracing:
+    """Test the Chrome trace timeline export"""
+
+    def test_flowgraph_timeline(self):
+        """Every stage block is a span with its sequence; queue depths are counters"""
+        sp.start_tracing(events_per_thread=4096)
+        try:
+            sp.Flowgraph([sp.ToneSource(50e3, 1e6, 0.1, 40_000), sp.FirStage(0.1, 31),
+                          sp.CollectSink()], block_size=4000).run()
+        finally:
+            sp.stop_tracing()
+        events = json.loads(sp.trace_json())["traceEvents"]
+        spans = [e for e in events if e["ph"] == "X" and e["name"] == "flowgraph.1.fir"]
+        assert [e["args"]["sequence"] for e in spans] == list(range(10))
+        assert all(e["dur"] >= 0 for e in spans)
+        assert {e["name"] for e in events if e["ph"] == "C"} == {"queue 0 (tone -> fir)",
+                                                                 "queue 1 (fir -> collect)"}
+        assert "flowgraph.2.collect" in {e["args"]["name"] for e in events if e["ph"] == "M"}
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "trace.json")
+            sp.write_trace(path)
+            with open(path) as f:
+                assert len(json.load(f)["traceEvents"]) == len(events)
+        sp.clear_trace()
+        assert json.loads(sp.trace_json())["traceEvents"] == []
+
+
 class TestEdgeCases:
     """Test edge cases and error handling"""
 
@@ -0,0 +1,131 @@
+/*
+ * C99 smoke test for the C API (signal_processor_c.h)
+ *
+ * Compiled as C, so it also checks that the header stays valid C. Exits 0
+ * on success; each failed check prints its line and the process exits 1.
+ */
+
+#include "signal_processor_c.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                    #condition);                                            \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_OK(call)                                                      \
+    do {                                                                    \
+        sp_status status_ = (call);                                         \
+        if (status_ != SP_OK) {                                             \
+            fprintf(stderr, "%s:%d: %s returned %s (%s)\n", __FILE__,       \
+                    __LINE__, #call, sp_status_string(status_),             \
+                    sp_last_error());                                       \
+            ++failures;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void test_library_information(void) {
+    CHECK(sp_version() != NULL && sp_version()[0] != '\0');
+    CHECK(strcmp(sp_status_string(SP_OK), "ok") == 0);
+    CHECK(strcmp(sp_status_string(SP_ERROR_BUFFER_TOO_SMALL), "buffer too small") == 0);
+}
+
+/* Block-by-block filtering through a handle equals the one-shot filter's
+   interior (the one-shot filter zero-pads both edges, the stream only the
+   start, so compare with the delay removed) */
+static void test_fir_lifecycle(void) {
+    enum { kLength = 1000, kTaps = 31, kBlock = 128 };
+    double signal[kLength];
+    double streamed[kLength];
+    double whole[kLength];
+    size_t written = 0;
+    sp_fir* fir = NULL;
+
+    CHECK_OK(sp_generate_test_signal(10.0, 1000.0, 1.0, 0.5, signal, kLength, &written));
+    CHECK(written == kLength);
+    CHECK_OK(sp_lowpass_filter(signal, kLength, 0.1, kTaps, whole));
+
+    CHECK_OK(sp_fir_create_lowpass(0.1, kTaps, 0, &fir));
+    CHECK(fir != NULL);
+    for (size_t pos = 0; pos < kLength; pos += kBlock) {
+        size_t n = kLength - pos < kBlock ? kLength - pos : kBlock;
+        CHECK_OK(sp_fir_process(fir, signal + pos, n, streamed + pos));
+    }
+    for (size_t i = kTaps; i < kLength; ++i) {
+        CHECK(fabs(streamed[i] - whole[i - kTaps / 2]) < 1e-9);
+    }
+    CHECK_OK(sp_fir_reset(fir));
+    sp_fir_destroy(fir);
+    sp_fir_destroy(NULL);
+}
+
+static void test_decimator_and_nco(void) {
+    enum { kLength = 400 };
+    double iq[2 * kLength];
+    double out[2 * kLength];
+    size_t produced = 0;
+    double phase = 0.0;
+    sp_nco* nco = NULL;
+    sp_decimator* decimator = NULL;
+
+    CHECK_OK(sp_nco_create(0.01, &nco));
+    CHECK_OK(sp_nco_generate(nco, kLength, iq));
+    CHECK(fabs(iq[0] - 1.0) < 1e-12 && fabs(iq[1]) < 1e-12);
+    CHECK(fabs(hypot(iq[2 * 123], iq[2 * 123 + 1]) - 1.0) < 1e-9);
+    CHECK_OK(sp_nco_get_phase(nco, &phase));
+    sp_nco_destroy(nco);
+
+    CHECK_OK(sp_decimator_create_lowpass(4, 31, 1, &decimator));
+    CHECK(sp_decimator_max_output(decimator, kLength) >= kLength / 4);
+    CHECK_OK(sp_decimator_process(decimator, iq, kLength, out,
+                                  sp_decimator_max_output(decimator, kLength), &produced));
+    CHECK(produced == kLength / 4);
+    sp_decimator_destroy(decimator);
+}
+
+/* Failures come back as status codes with a message, never as a crash */
+static void test_error_paths(void) {
+    double taps[4] = {0};
+    double in[64] = {0};
+    double out[64];
+    size_t produced = 0;
+    sp_fir* fir = NULL;
+    sp_decimator* decimator = NULL;
+    sp_stft* stft = NULL;
+
+    CHECK(sp_fir_create_lowpass(0.1, 0, 0, &fir) == SP_ERROR_INVALID_ARGUMENT);
+    CHECK(fir == NULL);
+    CHECK(strlen(sp_last_error()) > 0);
+
+    CHECK(sp_fir_create(taps, 4, 0, NULL) == SP_ERROR_INVALID_ARGUMENT);
+    CHECK(sp_design_lowpass(0.1, 5, NULL) == SP_ERROR_INVALID_ARGUMENT);
+    CHECK(sp_stft_create(64, 0, &stft) == SP_ERROR_INVALID_ARGUMENT);
+    CHECK(stft == NULL);
+
+    CHECK_OK(sp_decimator_create_lowpass(2, 15, 0, &decimator));
+    CHECK(sp_decimator_process(decimator, in, 64, out, 1, &produced) == SP_ERROR_BUFFER_TOO_SMALL);
+    CHECK(strstr(sp_last_error(), "sp_decimator_max_output") != NULL);
+    sp_decimator_destroy(decimator);
+}
+
+int main(void) {
+    test_library_information();
+    test_fir_lifecycle();
+    test_decimator_and_nco();
+    test_error_paths();
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("c_api_test: all checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+// Round-trip test for the VITA-49 packet encoder and decoder (vita49.h).
+// Exits 0 on success.
+
+#include "vita49.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace sp = signal_processor;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "check failed: %s\n", what);
+        ++failures;
+    }
+}
+
+// Every optional header field, with and without the class ID
+void test_round_trip(bool class_id) {
+    const std::uint8_t payload[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    sp::Vita49Packet sent;
+    sent.type = sp::Vita49PacketType::SignalDataWithStreamId;
+    sent.stream_id = 0x12345678;
+    sent.has_class_id = class_id;
+    sent.class_id = class_id ? 0x00FFEEDD'11112222ULL : 0;
+    sent.tsi = sp::Vita49Tsi::Utc;
+    sent.integer_timestamp = 1700000000;
+    sent.tsf = sp::Vita49Tsf::SampleCount;
+    sent.fractional_timestamp = 0x0102030405060708ULL;
+    sent.packet_count = 9;
+    sent.has_trailer = true;
+    sent.trailer = 0xCAFEF00D;
+    sent.payload_bytes = sizeof(payload);
+
+    std::vector<std::uint8_t> datagram;
+    sp::encode_vita49(sent, payload, datagram);
+    check(datagram.size() == 4 * (1 + 1 + (class_id ? 2 : 0) + 1 + 2 + 4 + 1), "encoded size");
+
+    sp::Vita49Packet got;
+    check(sp::parse_vita49(datagram.data(), datagram.size(), got), "packet parses");
+    check(got.has_class_id == class_id && got.class_id == sent.class_id, "class ID");
+    check(got.stream_id == sent.stream_id, "stream ID");
+    check(got.integer_timestamp == sent.integer_timestamp, "integer timestamp");
+    check(got.fractional_timestamp == sent.fractional_timestamp, "fractional timestamp");
+    check(got.packet_count == sent.packet_count, "packet count");
+    check(got.has_trailer && got.trailer == sent.trailer, "trailer");
+    check(got.payload_bytes == sizeof(payload), "payload size");
+    bool same = got.payload_bytes == sizeof(payload);
+    for (std::size_t i = 0; same && i < sizeof(payload); ++i) {
+        same = got.payload[i] == payload[i];
+    }
+    check(same, "payload bytes");
+}
+
+} // namespace
+
+int main() {
+    test_round_trip(false);
+    test_round_trip(true);
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("vita49_test: all checks passed\n");
+    return EXIT_SUCCESS;
+}